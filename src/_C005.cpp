@@ -81,12 +81,11 @@ bool CPlugin_005(CPlugin::Function function, struct EventStruct *event, String&
       }
 
 
-      String pubname         = CPlugin_005_pubname;
+      String pubname;
       bool   mqtt_retainFlag = CPlugin_005_mqtt_retainFlag;
 
-      parseControllerVariables(pubname, event, false);
-
       uint8_t valueCount = getValueCountForTask(event->TaskIndex);
+      const TaskValues_Data_t *taskValues = UserVar.getTaskValues_Data(event->TaskIndex);
 
       for (uint8_t x = 0; x < valueCount; x++)
       {
@@ -94,14 +93,42 @@ bool CPlugin_005(CPlugin::Function function, struct EventStruct *event, String&
         if (getTaskValueName(event->TaskIndex, x).isEmpty()) {
           continue; // we skip values with empty labels
         }
-        String tmppubname = pubname;
-        parseSingleControllerVariable(tmppubname, event, x, false);
         String value;
+        // Only keep the task value in the queue when the plugin does not format its values.
+        // Topic and payload are then formatted when sent.
+        bool formatWhenSent = false;
         if (event->sensorType == Sensor_VType::SENSOR_TYPE_STRING) {
           value = event->String2.substring(0, 20); // For the log
-        } else {
-          value = formatUserVarNoCheck(event, x);
+        } else if (!pluginFormatUserVar(event, x, value)) {
+          formatWhenSent = taskValues != nullptr;
+          if (!formatWhenSent) {
+            value = formatUserVarNoCheck(event, x);
+          }
         }
+
+        if (formatWhenSent) {
+# ifndef BUILD_NO_DEBUG
+
+          if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+            String log = F("MQTT : ");
+            log += CPlugin_005_pubname;
+            log += ' ';
+            log += formatTaskValue(event->TaskIndex, x, event->getSensorType(), *taskValues);
+            addLogMove(LOG_LEVEL_DEBUG, log);
+          }
+# endif // ifndef BUILD_NO_DEBUG
+
+          if (MQTTpublish(event->ControllerIndex, event->TaskIndex, CPlugin_005_pubname, x, event->getSensorType(), *taskValues, mqtt_retainFlag))
+            success = true;
+          continue;
+        }
+
+        if (pubname.isEmpty()) {
+          pubname = CPlugin_005_pubname;
+          parseControllerVariables(pubname, event, false);
+        }
+        String tmppubname = pubname;
+        parseSingleControllerVariable(tmppubname, event, x, false);
 # ifndef BUILD_NO_DEBUG
 
         if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
@@ -111,18 +111,32 @@ bool CPlugin_006(CPlugin::Function function, struct EventStruct *event, String&
         break;
       }
 
-      String pubname         = CPlugin_006_pubname;
+      String pubname;
       bool   mqtt_retainFlag = CPlugin_006_mqtt_retainFlag;
 
       statusLED(true);
 
       //LoadTaskSettings(event->TaskIndex); // FIXME TD-er: This can probably be removed
-      parseControllerVariables(pubname, event, false);
 
       uint8_t valueCount = getValueCountForTask(event->TaskIndex);
+      const TaskValues_Data_t *taskValues = UserVar.getTaskValues_Data(event->TaskIndex);
 
       for (uint8_t x = 0; x < valueCount; x++)
       {
+        String value;
+
+        if ((event->sensorType != Sensor_VType::SENSOR_TYPE_STRING) &&
+            !pluginFormatUserVar(event, x, value) && (taskValues != nullptr)) {
+          // Only keep the task value in the queue, topic and payload are formatted when sent.
+          if (MQTTpublish(event->ControllerIndex, event->TaskIndex, CPlugin_006_pubname, x, event->getSensorType(), *taskValues, mqtt_retainFlag))
+            success = true;
+          continue;
+        }
+
+        if (pubname.isEmpty()) {
+          pubname = CPlugin_006_pubname;
+          parseControllerVariables(pubname, event, false);
+        }
         String tmppubname = pubname;
         parseSingleControllerVariable(tmppubname, event, x, false);
 
@@ -131,8 +145,10 @@ bool CPlugin_006(CPlugin::Function function, struct EventStruct *event, String&
           if (MQTTpublish(event->ControllerIndex, event->TaskIndex, tmppubname.c_str(), event->String2.c_str(), mqtt_retainFlag))
             success = true;
         } else {
-          String value = formatUserVarNoCheck(event, x);
-          if (MQTTpublish(event->ControllerIndex, event->TaskIndex, tmppubname.c_str(), value.c_str(), mqtt_retainFlag))
+          if (value.isEmpty()) {
+            value = formatUserVarNoCheck(event, x);
+          }
+          if (MQTTpublish(event->ControllerIndex, event->TaskIndex, std::move(tmppubname), std::move(value), mqtt_retainFlag))
             success = true;
         }
       }
@@ -20,7 +20,14 @@
 # define CPLUGIN_ID_013         13
 # define CPLUGIN_NAME_013       "ESPEasy P2P Networking"
 
-WiFiUDP C013_portUDP;
+// Frame collecting the task data to be sent as a single broadcast
+// to all nodes supporting NODE_FEATURE_P2P_DATA_BATCH
+C013_SensorDataBatch *C013_batch = nullptr;
+
+// Per task the sequence nr of the last applied batch entry, C013_BATCH_SEQUENCE_VALID set when applied.
+// Used to only apply delta entries on top of the values they were based on.
+# define C013_BATCH_SEQUENCE_VALID  0x100
+uint16_t C013_batchSequence[TASKS_MAX]{};
 
 // Forward declarations
 void C013_SendUDPTaskInfo(uint8_t destUnit,
@@ -29,10 +36,13 @@ void C013_SendUDPTaskInfo(uint8_t destUnit,
 void C013_SendUDPTaskData(struct EventStruct *event,
                           uint8_t             destUnit,
                           uint8_t             destTaskIndex);
-void C013_sendUDP(uint8_t        unit,
+void C013_SendBatch();
+bool C013_sendUDP(uint8_t        unit,
                   const uint8_t *data,
                   uint8_t        size);
 void C013_Receive(struct EventStruct *event);
+void C013_ReceiveSensorData(const struct C013_SensorDataStruct& dataReply);
+void C013_ReceiveSensorDataBatch(struct EventStruct *event);
 
 
 bool CPlugin_013(CPlugin::Function function, struct EventStruct *event, String& string)
@@ -61,6 +71,25 @@ bool CPlugin_013(CPlugin::Function function, struct EventStruct *event, String&
       break;
     }
 
+    case CPlugin::Function::CPLUGIN_INIT:
+    {
+      if (C013_batch == nullptr) {
+        C013_batch = new (std::nothrow) C013_SensorDataBatch();
+      }
+      success = true;
+      break;
+    }
+
+    case CPlugin::Function::CPLUGIN_EXIT:
+    {
+      if (C013_batch != nullptr) {
+        C013_SendBatch();
+        delete C013_batch;
+        C013_batch = nullptr;
+      }
+      break;
+    }
+
     case CPlugin::Function::CPLUGIN_TASK_CHANGE_NOTIFICATION:
     {
       C013_SendUDPTaskInfo(0, event->TaskIndex, event->TaskIndex);
@@ -86,14 +115,13 @@ bool CPlugin_013(CPlugin::Function function, struct EventStruct *event, String&
       break;
     }
 
-    /*
-        case CPlugin::Function::CPLUGIN_FLUSH:
-          {
-            process_c013_delay_queue(event->ControllerIndex);
-            delay(0);
-            break;
-          }
-     */
+    case CPlugin::Function::CPLUGIN_TEN_PER_SECOND:
+    case CPlugin::Function::CPLUGIN_FLUSH:
+    {
+      // Send the task data collected since the last call as a single frame
+      C013_SendBatch();
+      break;
+    }
 
     default:
       break;
@@ -175,22 +203,53 @@ void C013_SendUDPTaskData(struct EventStruct *event, uint8_t destUnit, uint8_t d
     dataReply.destUnit = destUnit;
     C013_sendUDP(destUnit, reinterpret_cast<const uint8_t *>(&dataReply), sizeof(C013_SensorDataStruct));
   } else {
+    bool sendBatch = false;
+
     for (auto it = Nodes.begin(); it != Nodes.end(); ++it) {
       if (it->first != Settings.Unit) {
-        dataReply.destUnit = it->first;
-        C013_sendUDP(it->first, reinterpret_cast<const uint8_t *>(&dataReply), sizeof(C013_SensorDataStruct));
+        if ((C013_batch != nullptr) && it->second.supportsP2P_DataBatch()) {
+          // Will receive the broadcast batch frame
+          sendBatch = true;
+        } else {
+          dataReply.destUnit = it->first;
+          C013_sendUDP(it->first, reinterpret_cast<const uint8_t *>(&dataReply), sizeof(C013_SensorDataStruct));
+        }
+      }
+    }
+
+    if (sendBatch) {
+      dataReply.destUnit = 0;
+
+      if (!C013_batch->add(dataReply)) {
+        // Frame is full or still holds older values of this task
+        C013_SendBatch();
+        C013_batch->add(dataReply);
       }
     }
   }
 }
 
+void C013_SendBatch()
+{
+  if ((C013_batch == nullptr) || C013_batch->empty()) {
+    return;
+  }
+  if (C013_sendUDP(255, C013_batch->getFrame(), C013_batch->getFrameSize())) {
+    C013_batch->markSent();
+  } else {
+    // Next frames will include the values of this frame again
+    C013_batch->clear();
+  }
+}
+
 /*********************************************************************************************\
    Send UDP message (unit 255=broadcast)
 \*********************************************************************************************/
-void C013_sendUDP(uint8_t unit, const uint8_t *data, uint8_t size)
+bool C013_sendUDP(uint8_t unit, const uint8_t *data, uint8_t size)
 {
-  if (!NetworkConnected(10)) {
-    return;
+  if (Settings.UDPPort == 0) {
+    // The p2p UDP socket is only opened when a port is set.
+    return false;
   }
 
 # ifndef BUILD_NO_DEBUG
@@ -200,19 +259,8 @@ void C013_sendUDP(uint8_t unit, const uint8_t *data, uint8_t size)
   }
 # endif // ifndef BUILD_NO_DEBUG
 
-  statusLED(true);
-
-  if (!beginWiFiUDP_randomPort(C013_portUDP)) { return; }
-
-  FeedSW_watchdog();
-  const IPAddress remoteNodeIP = getIPAddressForUnit(unit);
-
-  if (C013_portUDP.beginPacket(remoteNodeIP, Settings.UDPPort) == 0) { return; }
-  C013_portUDP.write(data, size);
-  C013_portUDP.endPacket();
-  C013_portUDP.stop();
-  FeedSW_watchdog();
-  delay(0);
+  // Use the already opened p2p socket instead of opening a new one per message.
+  return sendUDP(unit, data, size);
 }
 
 void C013_Receive(struct EventStruct *event) {
@@ -297,53 +345,110 @@ void C013_Receive(struct EventStruct *event) {
 
       if (event->Par2 < structSize) { structSize = event->Par2; }
       memcpy(reinterpret_cast<uint8_t *>(&dataReply), event->Data, structSize);
+      C013_ReceiveSensorData(dataReply);
+      break;
+    }
 
-      // FIXME TD-er: We should check for sensorType and pluginID on both sides.
-      // For example sending different sensor type data from one dummy to another is probably not going to work well
-      if (dataReply.isValid()) {
-        // only if this task has a remote feed, update values
-        const uint8_t remoteFeed = Settings.TaskDeviceDataFeed[dataReply.destTaskIndex];
+    case C013_SENSOR_DATA_BATCH_ID: // sensor data of multiple tasks
+    {
+      C013_ReceiveSensorDataBatch(event);
+      break;
+    }
+  }
+}
 
-        if ((remoteFeed != 0) && (remoteFeed == dataReply.sourceUnit))
-        {
-          if (!dataReply.matchesPluginID(Settings.getPluginID_for_task(dataReply.destTaskIndex))) {
-            // Mismatch in plugin ID from sending node
-            if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
-              String log = concat(F("P2P data : PluginID mismatch for task "), dataReply.destTaskIndex + 1);
-              log += concat(F(" from unit "), dataReply.sourceUnit);
-              log += concat(F(" remote: "), dataReply.deviceNumber.value);
-              log += concat(F(" local: "), Settings.getPluginID_for_task(dataReply.destTaskIndex).value);
-              addLogMove(LOG_LEVEL_ERROR, log);
-            }
-          } else {
-            struct EventStruct TempEvent(dataReply.destTaskIndex);
-            TempEvent.Source = EventValueSource::Enum::VALUE_SOURCE_UDP;
-
-            const Sensor_VType sensorType = TempEvent.getSensorType();
-
-            if (dataReply.matchesSensorType(sensorType)) {
-              TaskValues_Data_t *taskValues = UserVar.getTaskValues_Data(dataReply.destTaskIndex);
-
-              if (taskValues != nullptr) {
-                for (taskVarIndex_t x = 0; x < VARS_PER_TASK; ++x)
-                {
-                  taskValues->copyValue(dataReply.values, x, sensorType);
-                }
-              }
-
-              SensorSendTask(&TempEvent);
-            } else {
-              // Mismatch in sensor types
-              if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
-                String log = concat(F("P2P data : SensorType mismatch for task "), dataReply.destTaskIndex + 1);
-                log += concat(F(" from unit "), dataReply.sourceUnit);
-                addLogMove(LOG_LEVEL_ERROR, log);
-              }
-            }
-          }
-        }
+void C013_ReceiveSensorData(const struct C013_SensorDataStruct& dataReply)
+{
+  // FIXME TD-er: We should check for sensorType and pluginID on both sides.
+  // For example sending different sensor type data from one dummy to another is probably not going to work well
+  if (!dataReply.isValid()) {
+    return;
+  }
+
+  // only if this task has a remote feed, update values
+  const uint8_t remoteFeed = Settings.TaskDeviceDataFeed[dataReply.destTaskIndex];
+
+  if ((remoteFeed == 0) || (remoteFeed != dataReply.sourceUnit)) {
+    return;
+  }
+
+  if (!dataReply.matchesPluginID(Settings.getPluginID_for_task(dataReply.destTaskIndex))) {
+    // Mismatch in plugin ID from sending node
+    if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
+      String log = concat(F("P2P data : PluginID mismatch for task "), dataReply.destTaskIndex + 1);
+      log += concat(F(" from unit "), dataReply.sourceUnit);
+      log += concat(F(" remote: "), dataReply.deviceNumber.value);
+      log += concat(F(" local: "), Settings.getPluginID_for_task(dataReply.destTaskIndex).value);
+      addLogMove(LOG_LEVEL_ERROR, log);
+    }
+    return;
+  }
+
+  struct EventStruct TempEvent(dataReply.destTaskIndex);
+  TempEvent.Source = EventValueSource::Enum::VALUE_SOURCE_UDP;
+
+  const Sensor_VType sensorType = TempEvent.getSensorType();
+
+  if (dataReply.matchesSensorType(sensorType)) {
+    TaskValues_Data_t *taskValues = UserVar.getTaskValues_Data(dataReply.destTaskIndex);
+
+    if (taskValues != nullptr) {
+      for (taskVarIndex_t x = 0; x < VARS_PER_TASK; ++x)
+      {
+        taskValues->copyValue(dataReply.values, x, sensorType);
       }
-      break;
+    }
+
+    SensorSendTask(&TempEvent);
+  } else {
+    // Mismatch in sensor types
+    if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
+      String log = concat(F("P2P data : SensorType mismatch for task "), dataReply.destTaskIndex + 1);
+      log += concat(F(" from unit "), dataReply.sourceUnit);
+      addLogMove(LOG_LEVEL_ERROR, log);
+    }
+  }
+}
+
+void C013_ReceiveSensorDataBatch(struct EventStruct *event)
+{
+  C013_SensorDataBatchReader reader(event->Data, event->Par2);
+
+  if (!reader.isValid() || (reader.getSourceUnit() == Settings.Unit)) {
+    return;
+  }
+
+  if ((reader.getDestUnit() != 0) && (reader.getDestUnit() != Settings.Unit)) {
+    return;
+  }
+
+  struct C013_SensorDataStruct dataReply;
+
+  while (reader.next(dataReply)) {
+    if (validTaskIndex(dataReply.destTaskIndex) &&
+        (Settings.TaskDeviceDataFeed[dataReply.destTaskIndex] == dataReply.sourceUnit)) {
+      uint16_t& sequence = C013_batchSequence[dataReply.destTaskIndex];
+      const bool baseApplied = (sequence & C013_BATCH_SEQUENCE_VALID) &&
+                               (static_cast<uint8_t>(sequence + 1) == reader.getSequence());
+
+      if (!reader.isFullEntry() && !baseApplied) {
+        // Missed the entry this delta is based on, wait for the next full entry.
+        sequence = 0;
+        continue;
+      }
+      sequence = C013_BATCH_SEQUENCE_VALID | reader.getSequence();
+
+      // Values not included in the frame are unchanged since the previous frame,
+      // so start from the values last received for this task.
+      const TaskValues_Data_t *taskValues = UserVar.getTaskValues_Data(dataReply.destTaskIndex);
+
+      if (taskValues != nullptr) {
+        dataReply.values = *taskValues;
+      } else {
+        dataReply.values.clear();
+      }
+      reader.copyValues(dataReply.values);
+      C013_ReceiveSensorData(dataReply);
     }
   }
 }
@@ -36,6 +36,7 @@ boolean Plugin_002(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;
       Device[deviceCount].TaskLogsOwnPeaks   = true;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
@@ -75,6 +75,7 @@ boolean Plugin_003(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;
       Device[deviceCount].TaskLogsOwnPeaks   = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       break;
     }
 
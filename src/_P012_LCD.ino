@@ -54,6 +54,7 @@ boolean Plugin_012(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].ValueCount         = 0;
       Device[deviceCount].SendDataOption     = false;
       Device[deviceCount].TimerOption        = true;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
@@ -231,6 +232,13 @@ boolean Plugin_012(uint8_t function, struct EventStruct *event, String& string)
       break;
     }
 
+    case PLUGIN_GET_COMMAND_PREFIXES:
+    {
+      string  = F("lcd,lcdcmd");
+      success = true;
+      break;
+    }
+
     case PLUGIN_WRITE:
     {
       P012_data_struct *P012_data =
@@ -181,6 +181,7 @@ boolean Plugin_016(uint8_t function, struct EventStruct *event, String& string)
     {
       Device[++deviceCount].Number = PLUGIN_ID_016;
       Device[deviceCount].Type     = DEVICE_TYPE_SINGLE;
+      Device[deviceCount].TenPerSecond = true;
 
       if (P016_SEND_IR_TO_CONTROLLER) {
         Device[deviceCount].VType = Sensor_VType::SENSOR_TYPE_STRING;
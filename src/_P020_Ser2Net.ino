@@ -72,6 +72,7 @@ boolean Plugin_020(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].SendDataOption     = true;
       Device[deviceCount].TimerOption        = false;
       Device[deviceCount].GlobalSyncOption   = false;
+      Device[deviceCount].FiftyPerSecond     = true;
       break;
     }
     case PLUGIN_GET_DEVICENAME:
@@ -51,6 +51,7 @@ boolean Plugin_021(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].ValueCount         = 1;
       Device[deviceCount].SendDataOption     = true;
       Device[deviceCount].TimerOption        = false;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
@@ -49,6 +49,7 @@ boolean Plugin_023(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].SendDataOption     = false;
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].TimerOptional      = true;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
@@ -253,6 +254,13 @@ boolean Plugin_023(uint8_t function, struct EventStruct *event, String& string)
       break;
     }
 
+    case PLUGIN_GET_COMMAND_PREFIXES:
+    {
+      string  = F("oled,oledcmd");
+      success = true;
+      break;
+    }
+
     case PLUGIN_WRITE:
     {
       P023_data_struct *P023_data = static_cast<P023_data_struct *>(getPluginTaskData(event->TaskIndex));
@@ -45,6 +45,7 @@ boolean Plugin_044(uint8_t function, struct EventStruct *event, String& string)
         Device[deviceCount].Type = DEVICE_TYPE_SINGLE;
         Device[deviceCount].Custom = true;
         Device[deviceCount].TimerOption = false;
+        Device[deviceCount].TenPerSecond = true;
         break;
       }
 
@@ -42,6 +42,7 @@ boolean Plugin_053(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].Ports              = 0;
       Device[deviceCount].PullUpOption       = false;
       Device[deviceCount].InverseLogicOption = false;
+      Device[deviceCount].TenPerSecond = true;
       # ifdef PLUGIN_053_ENABLE_EXTRA_SENSORS
       Device[deviceCount].FormulaOption = true;
       Device[deviceCount].ValueCount    = 4;
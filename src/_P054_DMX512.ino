@@ -88,6 +88,7 @@ boolean Plugin_054(uint8_t function, struct EventStruct *event, String& string)
         Device[deviceCount].TimerOption = false;
         Device[deviceCount].TimerOptional = false;
         Device[deviceCount].GlobalSyncOption = true;
+        Device[deviceCount].TenPerSecond = true;
         break;
       }
 
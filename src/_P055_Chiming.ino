@@ -98,6 +98,8 @@ boolean Plugin_055(uint8_t function, struct EventStruct *event, String& string)
         Device[deviceCount].TimerOption = false;
         Device[deviceCount].TimerOptional = false;
         Device[deviceCount].GlobalSyncOption = true;
+        Device[deviceCount].TenPerSecond = true;
+        Device[deviceCount].FiftyPerSecond = true;
         break;
       }
 
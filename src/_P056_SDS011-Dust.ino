@@ -48,6 +48,7 @@ boolean Plugin_056(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOptional      = false;
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       break;
     }
 
@@ -92,6 +92,7 @@ boolean Plugin_057(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = false;
       Device[deviceCount].TimerOptional      = false;
       Device[deviceCount].GlobalSyncOption   = true;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
@@ -37,6 +37,7 @@ boolean Plugin_060(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
@@ -101,6 +101,7 @@ boolean Plugin_061(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].TimerOptional      = true;
       Device[deviceCount].GlobalSyncOption   = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       break;
     }
 
@@ -82,6 +82,7 @@ boolean Plugin_064(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOptional      = true;
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
@@ -55,6 +55,7 @@ boolean Plugin_067(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOptional      = false;
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       break;
     }
 
@@ -99,6 +99,7 @@ boolean Plugin_073(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = false;
       Device[deviceCount].TimerOptional      = false;
       Device[deviceCount].GlobalSyncOption   = true;
+      Device[deviceCount].TenPerSecond       = true;
 
       break;
     }
@@ -247,6 +248,12 @@ boolean Plugin_073(uint8_t function, struct EventStruct *event, String& string)
       break;
     }
 
+    case PLUGIN_GET_COMMAND_PREFIXES: {
+      string  = F("7*");
+      success = true;
+      break;
+    }
+
     case PLUGIN_WRITE: {
       success = p073_plugin_write(event, string);
       break;
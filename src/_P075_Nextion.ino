@@ -59,6 +59,7 @@ boolean Plugin_075(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].TimerOptional      = true; // Allow user to disable interval function.
       Device[deviceCount].GlobalSyncOption   = true;
+      Device[deviceCount].TenPerSecond       = true;
 
       // FIXME TD-er: Not sure if access to any existing task data is needed when saving
       Device[deviceCount].ExitTaskBeforeSave = false;
@@ -208,7 +209,6 @@ boolean Plugin_075(uint8_t function, struct EventStruct *event, String& string)
         // Get optional LINE command statements. Special RSSIBAR bargraph keyword is supported.
         for (uint8_t x = 0; x < P75_Nlines; x++) {
           if (P075_data->displayLines[x].length()) {
-            String tmpString = P075_data->displayLines[x];
             UcTmpString = P075_data->displayLines[x];
             UcTmpString.toUpperCase();
             RssiIndex = UcTmpString.indexOf(F("RSSIBAR")); // RSSI bargraph Keyword found, wifi value in dBm.
@@ -257,7 +257,8 @@ boolean Plugin_075(uint8_t function, struct EventStruct *event, String& string)
               newString += barVal;
             }
             else {
-              newString = parseTemplate(tmpString);
+              P075_data->compiledLines[x].setTemplate(P075_data->displayLines[x]);
+              newString = P075_data->compiledLines[x].render();
             }
 
             P075_sendCommand(event->TaskIndex, newString.c_str());
@@ -114,6 +114,7 @@ boolean Plugin_076(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].GlobalSyncOption   = false;
       Device[deviceCount].PluginStats        = true;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
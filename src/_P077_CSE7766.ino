@@ -55,6 +55,7 @@ boolean Plugin_077(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;
       Device[deviceCount].TaskLogsOwnPeaks   = true;
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
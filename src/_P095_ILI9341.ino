@@ -153,6 +153,8 @@ boolean Plugin_095(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].SendDataOption     = false;
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].TimerOptional      = true;
+      Device[deviceCount].TenPerSecond       = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       success                                = true;
       break;
     }
@@ -45,6 +45,7 @@ boolean Plugin_113(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       break;
     }
 
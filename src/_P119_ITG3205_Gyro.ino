@@ -57,6 +57,8 @@ boolean Plugin_119(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption    = true;
       Device[deviceCount].TimerOptional  = true;
       Device[deviceCount].PluginStats    = true;
+      Device[deviceCount].TenPerSecond   = true;
+      Device[deviceCount].FiftyPerSecond = true;
       break;
     }
 
@@ -62,6 +62,7 @@ boolean Plugin_122(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].SendDataOption     = true;
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].I2CNoDeviceCheck   = true;
+      Device[deviceCount].TenPerSecond       = true;
 
       // Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats    = true;
@@ -49,6 +49,8 @@ boolean Plugin_125(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOptional  = true;
       Device[deviceCount].PluginStats    = true;
       Device[deviceCount].OutputDataType = Output_Data_type_t::Simple;
+      Device[deviceCount].TenPerSecond = true;
+      Device[deviceCount].FiftyPerSecond = true;
 
       break;
     }
@@ -166,6 +166,7 @@ boolean Plugin_128(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOptional      = true;
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].DecimalsOnly       = false;
+      Device[deviceCount].FiftyPerSecond     = true;
       break;
     }
 
@@ -255,6 +256,13 @@ boolean Plugin_128(uint8_t function, struct EventStruct *event, String& string)
       break;
     }
 
+    case PLUGIN_GET_COMMAND_PREFIXES:
+    {
+      string  = F("neopixelfx,nfx");
+      success = true;
+      break;
+    }
+
     case PLUGIN_WRITE:
     {
       P128_data_struct *P128_data = static_cast<P128_data_struct *>(getPluginTaskData(event->TaskIndex));
@@ -74,6 +74,8 @@ boolean Plugin_129(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].FormulaOption      = false;
       Device[deviceCount].DecimalsOnly       = false;
       Device[deviceCount].ValueCount         =
+      Device[deviceCount].TenPerSecond       = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       # if P129_MAX_CHIP_COUNT <= 4
         1
       # elif P129_MAX_CHIP_COUNT <= 8
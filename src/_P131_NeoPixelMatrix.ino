@@ -51,6 +51,7 @@ boolean Plugin_131(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].SendDataOption     = false;
       Device[deviceCount].TimerOption        = true;
       Device[deviceCount].TimerOptional      = true;
+      Device[deviceCount].TenPerSecond       = true;
 
       break;
     }
@@ -58,6 +58,7 @@ boolean Plugin_138(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption    = true;
       Device[deviceCount].TimerOptional  = true;
       Device[deviceCount].PluginStats    = true;
+      Device[deviceCount].FiftyPerSecond = true;
       break;
     }
 
@@ -49,6 +49,8 @@ boolean Plugin_141(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].PullUpOption       = false;
       Device[deviceCount].InverseLogicOption = false;
       Device[deviceCount].FormulaOption      = false;
+      Device[deviceCount].TenPerSecond       = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       # if P141_FEATURE_CURSOR_XY_VALUES
       Device[deviceCount].ValueCount = 2;
       # endif // if P141_FEATURE_CURSOR_XY_VALUES
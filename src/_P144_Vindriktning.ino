@@ -71,6 +71,7 @@ boolean Plugin_144(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = true;                             // Allow to set the "Interval" timer for the plugin.
       Device[deviceCount].TimerOptional      = false;                            // When taskdevice timer is not set and not optional, use default "Interval" delay (Settings.Delay)
       Device[deviceCount].DecimalsOnly       = false;                            // Allow to set the number of decimals (otherwise treated a 0 decimals)
+      Device[deviceCount].TenPerSecond       = true;
       break;
     }
 
@@ -133,6 +133,7 @@ boolean Plugin_145(byte function, struct EventStruct *event, String& string)
       Device[deviceCount].SendDataOption = true;
       Device[deviceCount].TimerOption = true;
       Device[deviceCount].GlobalSyncOption = true;
+      Device[deviceCount].TenPerSecond = true;
       break;
     }
     
@@ -304,6 +304,15 @@ boolean Plugin_146(uint8_t function, struct EventStruct *event, String& string)
         if (equals(subcommand, F("setreadpos"))) {
           P146_data_struct::setPeekFilePos(event->Par2, event->Par3);
           success = true;
+        } else if (equals(subcommand, F("seektime"))) {
+          // cachereader,seektime,<unixtime>[,<task nr>]
+          unsigned int fromTime{};
+
+          if (validUIntFromString(parseString(string, 3), fromTime)) {
+            const taskIndex_t taskIndex = ((event->Par3 > 0) && (event->Par3 <= TASKS_MAX)) ? event->Par3 - 1 : INVALID_TASK_INDEX;
+            P146_data_struct::setPeekFilePosByTime(fromTime, taskIndex);
+            success = true;
+          }
         } else if (equals(subcommand, F("sendtaskinfo"))) {
           P146_data_struct *P146_data = static_cast<P146_data_struct *>(getPluginTaskData(event->TaskIndex));
 
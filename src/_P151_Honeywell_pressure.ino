@@ -35,6 +35,8 @@ boolean Plugin_151(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOptional      = true;
       Device[deviceCount].GlobalSyncOption   = true;
       Device[deviceCount].PluginStats        = true;      
+      Device[deviceCount].TenPerSecond       = true;
+      Device[deviceCount].FiftyPerSecond     = true;
       break;
     }
 
@@ -114,6 +114,7 @@ boolean Plugin_xxx(uint8_t function, struct EventStruct *event, String& string)
       Device[deviceCount].TimerOption        = false;                            // Allow to set the "Interval" timer for the plugin.
       Device[deviceCount].TimerOptional      = false;                            // When taskdevice timer is not set and not optional, use default "Interval" delay (Settings.Delay)
       Device[deviceCount].DecimalsOnly       = true;                             // Allow to set the number of decimals (otherwise treated a 0 decimals)
+      Device[deviceCount].TenPerSecond       = true;                             // Plugin handles PLUGIN_TEN_PER_SECOND (same for FiftyPerSecond)
       break;
     }
 
@@ -294,6 +295,16 @@ boolean Plugin_xxx(uint8_t function, struct EventStruct *event, String& string)
       break;
     }
 
+    case PLUGIN_GET_COMMAND_PREFIXES:
+    {
+      // Optional, comma separated list of the commands handled in PLUGIN_WRITE.
+      // An entry ending with '*' matches all commands starting with it.
+      // When set, PLUGIN_WRITE is only called for matching commands.
+      string  = F("dothis");
+      success = true;
+      break;
+    }
+
     case PLUGIN_WRITE:
     {
       // this case defines code to be executed when the plugin executes an action (command).
@@ -0,0 +1,75 @@
+#include "../Commands/ControllerCache.h"
+
+#ifdef USES_C016
+
+# include "../Commands/Common.h"
+
+# include "../DataStructs/ESPEasyControllerCache_query.h"
+
+# include "../Globals/Cache.h"
+# include "../Globals/EventQueue.h"
+# include "../Globals/Settings.h"
+
+# include "../Helpers/Numerical.h"
+# include "../Helpers/StringConverter.h"
+
+
+String Command_CacheQuery(struct EventStruct *event, const char *Line)
+{
+  ESPEasyControllerCache_query_filter filter;
+  unsigned int from{};
+  unsigned int to{};
+
+  if (!validUIntFromString(parseString(Line, 2), from) ||
+      !validUIntFromString(parseString(Line, 3), to) ||
+      (event->Par3 <= 0) || (event->Par3 > TASKS_MAX) ||
+      (event->Par4 <= 0) || (event->Par4 > VARS_PER_TASK)) {
+    return return_command_failed();
+  }
+  filter.from       = from;
+  filter.to         = to;
+  filter.taskIndex  = event->Par3 - 1;
+  filter.valueIndex = event->Par4 - 1;
+
+  uint32_t count = 0;
+  ESPEASY_RULES_FLOAT_TYPE min{};
+  ESPEASY_RULES_FLOAT_TYPE max{};
+  ESPEASY_RULES_FLOAT_TYPE sum{};
+
+  {
+    ESPEasyControllerCache_query query(filter);
+    ESPEasyControllerCache_query_result result;
+
+    while (query.next(result)) {
+      const ESPEASY_RULES_FLOAT_TYPE value = result.avg[filter.valueIndex];
+
+      if ((count == 0) || (value < min)) { min = value; }
+
+      if ((count == 0) || (value > max)) { max = value; }
+      sum += value;
+      ++count;
+    }
+  }
+
+  const uint8_t nrDecimals = Cache.getTaskDeviceValueDecimals(filter.taskIndex, filter.valueIndex);
+  const ESPEASY_RULES_FLOAT_TYPE values[] = { min, max, (count == 0) ? 0 : sum / count };
+  String res(count);
+
+  for (const ESPEASY_RULES_FLOAT_TYPE& value : values) {
+    res += ',';
+#  if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+    res += doubleToString(value, nrDecimals);
+#  else // if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+    res += floatToString(value, nrDecimals);
+#  endif // if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+  }
+
+  if (Settings.UseRules) {
+    String eventName = strformat(F("CacheQuery#Result=%d,%d,"), event->Par3, event->Par4);
+    eventName += res;
+    eventQueue.addMove(std::move(eventName));
+  }
+  return res;
+}
+
+#endif // ifdef USES_C016
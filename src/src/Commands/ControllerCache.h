@@ -0,0 +1,16 @@
+#ifndef COMMAND_CONTROLLERCACHE_H
+#define COMMAND_CONTROLLERCACHE_H
+
+#include "../../ESPEasy_common.h"
+
+#ifdef USES_C016
+
+// CacheQuery,<from>,<to>,<task nr>,<value nr>
+// Compute count, min, max and avg of a task value stored by the Cache Controller
+// in the time range from ... to (UNIX timestamps, inclusive).
+// The result is returned and sent as event: CacheQuery#Result=<task nr>,<value nr>,<count>,<min>,<max>,<avg>
+String Command_CacheQuery(struct EventStruct *event, const char* Line);
+
+#endif // ifdef USES_C016
+
+#endif // COMMAND_CONTROLLERCACHE_H
@@ -36,6 +36,17 @@ bool do_command_case(command_case_data& data, const __FlashStringHelper * cmd_te
 bool do_command_case(command_case_data& data, const __FlashStringHelper * cmd_test, command_function pFunc, int nrArguments, EventValueSourceGroup::Enum group);
 
 
+// FNV-1a hash of a (lower case) command.
+// Used at compile time to generate the case labels of the command dispatcher
+// and at run time to hash the received command.
+// Written as single return statement, to be a valid C++11 constexpr function.
+constexpr uint32_t internal_command_hash(const char *str, uint32_t hash = 2166136261u) {
+  return (*str == 0)
+    ? hash
+    : internal_command_hash(str + 1, (hash ^ static_cast<uint8_t>(*str)) * 16777619u);
+}
+
+
 /*********************************************************************************************\
 * Registers command
 \*********************************************************************************************/
@@ -77,7 +77,12 @@ const __FlashStringHelper * Command_Rules_Let(struct EventStruct *event, const c
     if (event->Par1 >= 0) {
       ESPEASY_RULES_FLOAT_TYPE result{};
 
-      if (!isError(Calculate(TmpStr1, result))) {
+      // Expression from a rules line without substitutions is the same on every call.
+      const CalculateReturnCode returnCode = rulesLineWithoutSubstitutions
+        ? CalculateCached(TmpStr1, result)
+        : Calculate(TmpStr1, result);
+
+      if (!isError(returnCode)) {
         setCustomFloatVar(event->Par1, result);
         return return_command_success_flashstr();
       }
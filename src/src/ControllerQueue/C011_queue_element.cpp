@@ -38,4 +38,25 @@ bool C011_queue_element::isDuplicate(const Queue_element_base& other) const {
          oth.postStr.equals(postStr);
 }
 
+# if FEATURE_CONTROLLER_QUEUE_SPILL
+bool C011_queue_element::serializeData(Queue_element_serializer& serializer) const {
+  serializer.writeString(uri);
+  serializer.writeString(HttpMethod);
+  serializer.writeString(header);
+  serializer.writeString(postStr);
+  serializer.write(idx);
+  serializer.write(sensorType);
+  return true;
+}
+
+bool C011_queue_element::deserializeData(Queue_element_serializer& serializer) {
+  return serializer.readString(uri) &&
+         serializer.readString(HttpMethod) &&
+         serializer.readString(header) &&
+         serializer.readString(postStr) &&
+         serializer.read(idx) &&
+         serializer.read(sensorType);
+}
+# endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
 #endif // ifdef USES_C011
@@ -45,6 +45,17 @@ public:
 
   size_t getSize() const;
 
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+
+protected:
+
+  bool serializeData(Queue_element_serializer& serializer) const override;
+
+  bool deserializeData(Queue_element_serializer& serializer) override;
+
+public:
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
   String uri;
   String HttpMethod;
   String header;
@@ -81,4 +81,34 @@ bool C015_queue_element::isDuplicate(const Queue_element_base& other) const {
   return true;
 }
 
+# if FEATURE_CONTROLLER_QUEUE_SPILL
+bool C015_queue_element::serializeData(Queue_element_serializer& serializer) const {
+  serializer.write(idx);
+  serializer.write(valuesSent);
+  serializer.write(valueCount);
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    serializer.write(vPin[i]);
+    serializer.writeString(txt[i]);
+  }
+  return true;
+}
+
+bool C015_queue_element::deserializeData(Queue_element_serializer& serializer) {
+  if (!serializer.read(idx) ||
+      !serializer.read(valuesSent) ||
+      !serializer.read(valueCount)) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    if (!serializer.read(vPin[i]) ||
+        !serializer.readString(txt[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+# endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
 #endif // ifdef USES_C015
@@ -51,6 +51,17 @@ public:
     return nullptr;
   }
 
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+
+protected:
+
+  bool serializeData(Queue_element_serializer& serializer) const override;
+
+  bool deserializeData(Queue_element_serializer& serializer) override;
+
+public:
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
   String txt[VARS_PER_TASK]  = {};
   int vPin[VARS_PER_TASK]    = { 0 };
   int idx                    = 0;
@@ -43,4 +43,15 @@ bool C018_queue_element::isDuplicate(const Queue_element_base& other) const {
   return true;
 }
 
+# if FEATURE_CONTROLLER_QUEUE_SPILL
+bool C018_queue_element::serializeData(Queue_element_serializer& serializer) const {
+  serializer.writeString(packed);
+  return true;
+}
+
+bool C018_queue_element::deserializeData(Queue_element_serializer& serializer) {
+  return serializer.readString(packed);
+}
+# endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
 #endif // ifdef USES_C018
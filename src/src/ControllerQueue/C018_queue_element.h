@@ -46,6 +46,17 @@ public:
     return nullptr;
   }
 
+# if FEATURE_CONTROLLER_QUEUE_SPILL
+
+protected:
+
+  bool serializeData(Queue_element_serializer& serializer) const override;
+
+  bool deserializeData(Queue_element_serializer& serializer) override;
+
+public:
+# endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
   String packed;
 };
 
@@ -1,5 +1,7 @@
 #include "../ControllerQueue/ControllerDelayHandlerStruct.h"
 
+#include "../Globals/MetricsRegistry.h"
+
 
 ControllerDelayHandlerStruct::ControllerDelayHandlerStruct() :
   lastSend(0),
@@ -11,7 +13,20 @@ ControllerDelayHandlerStruct::ControllerDelayHandlerStruct() :
   delete_oldest(false),
   must_check_reply(false),
   deduplicate(false),
-  useLocalSystemTime(false) {}
+  useLocalSystemTime(false),
+  sendBatch(false),
+  spillToFlash(false),
+  createElement(nullptr) {}
+
+#if FEATURE_METRICS_REGISTRY
+ControllerDelayHandlerStruct::~ControllerDelayHandlerStruct()
+{
+  Metrics.remove(queueDepthMetric);
+  Metrics.remove(retriesMetric);
+  Metrics.remove(droppedMetric);
+}
+
+#endif // if FEATURE_METRICS_REGISTRY
 
 bool ControllerDelayHandlerStruct::cacheControllerSettings(controllerIndex_t ControllerIndex)
 {
@@ -22,6 +37,12 @@ bool ControllerDelayHandlerStruct::cacheControllerSettings(controllerIndex_t Con
   }
   LoadControllerSettings(ControllerIndex, *ControllerSettings);
   cacheControllerSettings(*ControllerSettings);
+  #if FEATURE_CONTROLLER_QUEUE_SPILL
+  updateSpill(ControllerIndex);
+  #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+  #if FEATURE_METRICS_REGISTRY
+  registerMetrics(ControllerIndex);
+  #endif // if FEATURE_METRICS_REGISTRY
   return true;
 }
 
@@ -33,6 +54,8 @@ void ControllerDelayHandlerStruct::cacheControllerSettings(const ControllerSetti
   must_check_reply       = settings.MustCheckReply;
   deduplicate            = settings.deduplicate();
   useLocalSystemTime     = settings.useLocalSystemTime();
+  sendBatch              = settings.sendBatch();
+  spillToFlash           = settings.spillToFlash();
 
   if (settings.allowExpire()) {
     expire_timeout = max_queue_depth * max_retries * (minTimeBetweenMessages + settings.ClientTimeout);
@@ -56,7 +79,11 @@ void ControllerDelayHandlerStruct::cacheControllerSettings(const ControllerSetti
 }
 
 bool ControllerDelayHandlerStruct::readyToProcess(const Queue_element_base& element) const {
-  const protocolIndex_t protocolIndex = getProtocolIndex_from_ControllerIndex(element._controller_idx);
+  return readyToProcess(element._controller_idx);
+}
+
+bool ControllerDelayHandlerStruct::readyToProcess(controllerIndex_t controller_idx) const {
+  const protocolIndex_t protocolIndex = getProtocolIndex_from_ControllerIndex(controller_idx);
 
   if (protocolIndex == INVALID_PROTOCOL_INDEX) {
     return false;
@@ -69,6 +96,23 @@ bool ControllerDelayHandlerStruct::readyToProcess(const Queue_element_base& elem
 }
 
 bool ControllerDelayHandlerStruct::queueFull(controllerIndex_t controller_idx) const {
+  if (!ramQueueFull(controller_idx)) {
+    return false;
+  }
+  #if FEATURE_CONTROLLER_QUEUE_SPILL
+
+  if (spill && (spill->getControllerIndex() == controller_idx) && !spill->isFull()) {
+    return false;
+  }
+  #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+  return true;
+}
+
+void ControllerDelayHandlerStruct::setQueueElementFactory(create_queue_element_function func) {
+  createElement = func;
+}
+
+bool ControllerDelayHandlerStruct::ramQueueFull(controllerIndex_t controller_idx) const {
   if (sendQueue.size() >= max_queue_depth) { return true; }
 
   // Number of elements is not exceeding the limit, check memory
@@ -153,21 +197,36 @@ bool ControllerDelayHandlerStruct::addToQueue(std::unique_ptr<Queue_element_base
   if (isDuplicate(*element)) {
     return true;
   }
+  #if FEATURE_CONTROLLER_QUEUE_SPILL
+
+  if (spill && (spill->getControllerIndex() == element->_controller_idx)) {
+    // Once elements are spilled to the file system, new elements must also be spilled
+    // until all are restored, to keep the order of the elements.
+    if (spill->hasData() || ramQueueFull(element->_controller_idx)) {
+      if (spillToFile(*element)) {
+        return true;
+      }
+    }
+  }
+  #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
 
   if (delete_oldest) {
     // Force add to the queue.
     // If max buffer is reached, the oldest in the queue (first to be served) will be removed.
-    while (queueFull(element->_controller_idx)) {
-      sendQueue.pop_front();
+    while (ramQueueFull(element->_controller_idx)) {
+      popFront();
       attempt = 0;
+      countDropped();
     }
   }
 
-  if (!queueFull(element->_controller_idx)) {
+  if (!ramQueueFull(element->_controller_idx)) {
     sendQueue.push_back(std::move(element));
+    updateQueueDepthMetric();
 
     return true;
   }
+  countDropped();
 #ifndef BUILD_NO_DEBUG
 
   if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
@@ -186,8 +245,9 @@ Queue_element_base * ControllerDelayHandlerStruct::getNext() {
   if (sendQueue.empty()) { return nullptr; }
 
   if (attempt > max_retries) {
-    sendQueue.pop_front();
+    popFront();
     attempt = 0;
+    countDropped();
   }
 
   if (expire_timeout != 0) {
@@ -197,11 +257,13 @@ Queue_element_base * ControllerDelayHandlerStruct::getNext() {
       if ((sendQueue.front().get() != nullptr) && (timePassedSince(sendQueue.front()->_timestamp) < static_cast<long>(expire_timeout))) {
         done = true;
       } else {
-        sendQueue.pop_front();
+        popFront();
         attempt = 0;
+        countDropped();
       }
     }
   }
+  updateQueueDepthMetric();
 
   if (sendQueue.empty()) { return nullptr; }
   return sendQueue.front().get();
@@ -214,17 +276,80 @@ unsigned long ControllerDelayHandlerStruct::markProcessed(bool remove_from_queue
   if (sendQueue.empty()) { return 0; }
 
   if (remove_from_queue) {
-    sendQueue.pop_front();
+    popFront();
     attempt  = 0;
     lastSend = millis();
+    updateQueueDepthMetric();
   } else {
     ++attempt;
+    countRetry();
   }
   return getNextScheduleTime();
 }
 
+void ControllerDelayHandlerStruct::popFront() {
+  if (sendQueue.empty()) { return; }
+  #if FEATURE_CONTROLLER_QUEUE_SPILL
+
+  if (spill && sendQueue.front() && (sendQueue.front()->_spillBlockNr != 0)) {
+    spill->acknowledge(sendQueue.front()->_spillBlockNr);
+  }
+  #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+  sendQueue.pop_front();
+}
+
+void ControllerDelayHandlerStruct::updateQueueDepthMetric() {
+  #if FEATURE_METRICS_REGISTRY
+  Metrics.set(queueDepthMetric, sendQueue.size());
+  #endif // if FEATURE_METRICS_REGISTRY
+}
+
+void ControllerDelayHandlerStruct::countRetry() {
+  #if FEATURE_METRICS_REGISTRY
+  Metrics.increment(retriesMetric);
+  #endif // if FEATURE_METRICS_REGISTRY
+}
+
+void ControllerDelayHandlerStruct::countDropped() {
+  #if FEATURE_METRICS_REGISTRY
+  Metrics.increment(droppedMetric);
+  #endif // if FEATURE_METRICS_REGISTRY
+}
+
+#if FEATURE_METRICS_REGISTRY
+void ControllerDelayHandlerStruct::registerMetrics(controllerIndex_t ControllerIndex) {
+  if (queueDepthMetric != INVALID_METRIC_INDEX) {
+    // Already registered
+    return;
+  }
+  const String controller = get_formatted_Controller_number(getCPluginID_from_ControllerIndex(ControllerIndex));
+
+  queueDepthMetric = Metrics.addGauge(
+    F("controller_queue_depth"),
+    F("Nr of messages in the controller queue"),
+    nullptr, F("controller"), controller);
+  retriesMetric = Metrics.addCounter(
+    F("controller_queue_retries"),
+    F("Nr of failed attempts to send a queued message"),
+    nullptr, F("controller"), controller);
+  droppedMetric = Metrics.addCounter(
+    F("controller_queue_dropped"),
+    F("Nr of messages dropped as the queue was full, or the message expired or reached max retries"),
+    nullptr, F("controller"), controller);
+}
+
+#endif // if FEATURE_METRICS_REGISTRY
+
 unsigned long ControllerDelayHandlerStruct::getNextScheduleTime() const {
-  if (sendQueue.empty()) { return 0; }
+  if (sendQueue.empty()) {
+    #if FEATURE_CONTROLLER_QUEUE_SPILL
+
+    if (!spill || !spill->hasData())
+    #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+    {
+      return 0;
+    }
+  }
   unsigned long nextTime = lastSend + minTimeBetweenMessages;
 
   if (timePassedSince(nextTime) > 0) {
@@ -254,28 +379,205 @@ size_t ControllerDelayHandlerStruct::getQueueMemorySize() const {
   return totalSize;
 }
 
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+void ControllerDelayHandlerStruct::updateSpill(controllerIndex_t ControllerIndex) {
+  if (spillToFlash && (createElement != nullptr) && validControllerIndex(ControllerIndex)) {
+    if (!spill || (spill->getControllerIndex() != ControllerIndex)) {
+      spill.reset(new (std::nothrow) ControllerQueueSpill_struct(ControllerIndex));
+
+      if (spill) {
+        spill->init();
+      }
+    }
+  } else {
+    spill.reset();
+  }
+}
+
+void ControllerDelayHandlerStruct::restoreFromSpill() {
+  if (!spill || (createElement == nullptr) || !spill->hasData()) {
+    return;
+  }
+  const controllerIndex_t controller_idx = spill->getControllerIndex();
+
+  if (!readyToProcess(controller_idx)) {
+    // Keep the elements on the file system until they can be sent.
+    return;
+  }
+
+  // Only fill half the queue, to leave room for new elements which are spilled when the queue is full.
+  size_t maxQueueSize = max_queue_depth / 2;
+
+  if (maxQueueSize == 0) { maxQueueSize = 1; }
+
+  Queue_element_serializer serializer;
+  uint32_t blockNr = 0;
+
+  while (sendQueue.size() < maxQueueSize &&
+         !ramQueueFull(controller_idx) &&
+         spill->read(serializer, blockNr)) {
+    #ifdef USE_SECOND_HEAP
+    HeapSelectIram ephemeral;
+    #endif // ifdef USE_SECOND_HEAP
+
+    std::unique_ptr<Queue_element_base> element = createElement();
+
+    if (element && element->deserialize(serializer)) {
+      // The spill block is deleted once all its elements are removed from the queue.
+      element->_spillBlockNr = blockNr;
+      sendQueue.push_back(std::move(element));
+    } else {
+      spill->acknowledge(blockNr);
+    }
+  }
+}
+
+bool ControllerDelayHandlerStruct::spillToFile(const Queue_element_base& element) {
+  Queue_element_serializer serializer;
+
+  if (!element.serialize(serializer)) {
+    return false;
+  }
+
+  if (!spill->write(serializer, delete_oldest)) {
+    return false;
+  }
+#ifndef BUILD_NO_DEBUG
+
+  if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+    const cpluginID_t cpluginID = getCPluginID_from_ControllerIndex(element._controller_idx);
+    String log                  = get_formatted_Controller_number(cpluginID);
+    log += F(" : Queue full, spilled to file");
+    addLogMove(LOG_LEVEL_DEBUG, log);
+  }
+#endif // ifndef BUILD_NO_DEBUG
+  return true;
+}
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
 void ControllerDelayHandlerStruct::process(
   int                                controller_number,
   do_process_function                func,
   TimingStatsElements                timerstats_id,
   SchedulerIntervalTimer_e timerID) 
 {
+  #if FEATURE_CONTROLLER_QUEUE_SPILL
+  restoreFromSpill();
+  #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
   Queue_element_base *element(static_cast<Queue_element_base *>(getNext()));
 
-  if (element == nullptr) { return; }
+  if (element == nullptr) {
+    #if FEATURE_CONTROLLER_QUEUE_SPILL
+
+    if (spill && spill->hasData()) {
+      // Spilled elements could not yet be restored, check again later.
+      Scheduler.scheduleNextDelayQueue(timerID, millis() + CONTROLLER_QUEUE_SPILL_RETRY_INTERVAL);
+    }
+    #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+    return;
+  }
 
   if (readyToProcess(*element)) {
     MakeControllerSettings(ControllerSettings);
 
     if (AllocatedControllerSettings()) {
-      LoadControllerSettings(element->_controller_idx, *ControllerSettings);
+      const controllerIndex_t controller_idx = element->_controller_idx;
+      LoadControllerSettings(controller_idx, *ControllerSettings);
       cacheControllerSettings(*ControllerSettings);
-      START_TIMER;
-      markProcessed(func(controller_number, *element, *ControllerSettings));
-      #if FEATURE_TIMING_STATS
-      STOP_TIMER_VAR(timerstats_id);
-      #endif
+
+      const bool batch = sendBatch && (sendQueue.size() > 1);
+
+      if (!batch) {
+        START_TIMER;
+        markProcessed(func(controller_number, *element, *ControllerSettings));
+        #if FEATURE_TIMING_STATS
+        STOP_TIMER_VAR(timerstats_id);
+        #endif
+      } else {
+        processBatch(controller_number, func, timerstats_id, controller_idx, *ControllerSettings);
+      }
     }
   }
   Scheduler.scheduleNextDelayQueue(timerID, getNextScheduleTime());
 }
+
+void ControllerDelayHandlerStruct::processBatch(
+  int                       controller_number,
+  do_process_function       func,
+  TimingStatsElements       timerstats_id,
+  controllerIndex_t         controller_idx,
+  ControllerSettingsStruct& ControllerSettings)
+{
+  #if FEATURE_TIMING_STATS
+  const uint64_t batchTimerStart(getMicros64());
+  #endif // if FEATURE_TIMING_STATS
+  const unsigned long batchStart = millis();
+  uint8_t nrSent                 = 0;
+  size_t  bytesSent              = 0;
+
+  #if FEATURE_HTTP_CLIENT
+  http_keepAlive_begin();
+  #endif // if FEATURE_HTTP_CLIENT
+
+  Queue_element_base *element = getNext();
+
+  while (element != nullptr) {
+    const size_t elementSize = element->getSize();
+
+    START_TIMER;
+    const bool success = func(controller_number, *element, ControllerSettings);
+    markProcessed(success);
+    #if FEATURE_TIMING_STATS
+    STOP_TIMER_VAR(timerstats_id);
+    #endif // if FEATURE_TIMING_STATS
+
+    if (!success) {
+      // Leave retry handling to the next scheduled call.
+      break;
+    }
+    ++nrSent;
+    bytesSent += elementSize;
+
+    if ((nrSent >= CONTROLLER_DELAY_QUEUE_BATCH_MAX_ELEMENTS) ||
+        (timePassedSince(batchStart) >= CONTROLLER_DELAY_QUEUE_BATCH_MAX_DURATION)) {
+      break;
+    }
+    delay(0);
+
+    // getNext() also removes expired elements.
+    element = getNext();
+
+    if ((element != nullptr) &&
+        ((element->_controller_idx != controller_idx) ||
+         ((bytesSent + element->getSize()) > CONTROLLER_DELAY_QUEUE_BATCH_MAX_BYTES) ||
+         !readyToProcess(*element))) {
+      element = nullptr;
+    }
+  }
+
+  #if FEATURE_HTTP_CLIENT
+  http_keepAlive_end();
+  #endif // if FEATURE_HTTP_CLIENT
+
+  #if FEATURE_TIMING_STATS
+  stopTimer(TimingStatsElements::CONTROLLER_QUEUE_BATCH, batchTimerStart);
+  #endif // if FEATURE_TIMING_STATS
+
+#ifndef BUILD_NO_DEBUG
+
+  if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+    String log = get_formatted_Controller_number(getCPluginID_from_ControllerIndex(controller_idx));
+    log += F(" : Batch sent ");
+    log += nrSent;
+    log += F(" msg, ");
+    log += bytesSent;
+    log += F(" bytes in ");
+    log += timePassedSince(batchStart);
+    log += F(" ms, ");
+    log += sendQueue.size();
+    log += F(" left in queue");
+    addLogMove(LOG_LEVEL_DEBUG, log);
+  }
+#endif // ifndef BUILD_NO_DEBUG
+}
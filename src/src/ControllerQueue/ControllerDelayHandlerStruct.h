@@ -3,9 +3,11 @@
 
 #include "../../ESPEasy_common.h"
 
+#include "../ControllerQueue/ControllerQueueSpill.h"
 #include "../ControllerQueue/Queue_element_base.h"
 
 #include "../DataStructs/ControllerSettingsStruct.h"
+#include "../DataStructs/MetricsRegistry.h"
 #include "../DataStructs/TimingStats.h"
 #include "../DataStructs/UnitMessageCount.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
@@ -28,23 +30,52 @@
   # define CONTROLLER_QUEUE_MINIMAL_EXPIRE_TIME 10000
 #endif // ifndef CONTROLLER_QUEUE_MINIMAL_EXPIRE_TIME
 
+// Limits for sending queued messages in a single call to process() when "Send In Batches" is enabled.
+#ifndef CONTROLLER_DELAY_QUEUE_BATCH_MAX_ELEMENTS
+  # define CONTROLLER_DELAY_QUEUE_BATCH_MAX_ELEMENTS 8
+#endif // ifndef CONTROLLER_DELAY_QUEUE_BATCH_MAX_ELEMENTS
+#ifndef CONTROLLER_DELAY_QUEUE_BATCH_MAX_BYTES
+  # define CONTROLLER_DELAY_QUEUE_BATCH_MAX_BYTES 4096
+#endif // ifndef CONTROLLER_DELAY_QUEUE_BATCH_MAX_BYTES
+#ifndef CONTROLLER_DELAY_QUEUE_BATCH_MAX_DURATION
+  # define CONTROLLER_DELAY_QUEUE_BATCH_MAX_DURATION 1000
+#endif // ifndef CONTROLLER_DELAY_QUEUE_BATCH_MAX_DURATION
+
 typedef bool (*do_process_function)(int,
                                     const Queue_element_base&,
                                     ControllerSettingsStruct&);
 
+typedef std::unique_ptr<Queue_element_base> (*create_queue_element_function)();
+
+// Create an empty queue element of the type used by a controller, to restore elements spilled to the file system.
+template<class T>
+std::unique_ptr<Queue_element_base>createQueueElement() {
+  return std::unique_ptr<Queue_element_base>(new (std::nothrow) T());
+}
+
 /*********************************************************************************************\
 * ControllerDelayHandlerStruct
 \*********************************************************************************************/
 struct ControllerDelayHandlerStruct {
   ControllerDelayHandlerStruct();
 
+#if FEATURE_METRICS_REGISTRY
+  ~ControllerDelayHandlerStruct();
+#endif // if FEATURE_METRICS_REGISTRY
+
   bool cacheControllerSettings(controllerIndex_t ControllerIndex);
   void cacheControllerSettings(const ControllerSettingsStruct& settings);
 
   bool readyToProcess(const Queue_element_base& element) const;
+  bool readyToProcess(controllerIndex_t controller_idx) const;
 
+  // Return true when the queue in RAM is full and the element cannot be spilled to the file system.
   bool queueFull(controllerIndex_t controller_idx) const;
 
+  // Set the function to create an empty queue element of the type used by the controller.
+  // Needed to spill elements to the file system.
+  void setQueueElementFactory(create_queue_element_function func);
+
   // Return true if message is already present in the queue
   bool isDuplicate(const Queue_element_base& element) const;
 
@@ -70,12 +101,31 @@ struct ControllerDelayHandlerStruct {
 
   size_t getQueueMemorySize() const;
 
+  // Process the next element in the queue.
+  // When sendBatch is set, continue with the next ready elements as long as sending is successful
+  // and the CONTROLLER_DELAY_QUEUE_BATCH_MAX_xxx limits are not reached.
   void   process(
     int                                controller_number,
     do_process_function                func,
     TimingStatsElements                timerstats_id,
     SchedulerIntervalTimer_e timerID);
 
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+
+  // Create or delete the spill handler, based on the cached settings.
+  void updateSpill(controllerIndex_t ControllerIndex);
+
+  // Move spilled elements back into the queue when they can be processed.
+  void restoreFromSpill();
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
+  void   processBatch(
+    int                       controller_number,
+    do_process_function       func,
+    TimingStatsElements       timerstats_id,
+    controllerIndex_t         controller_idx,
+    ControllerSettingsStruct& ControllerSettings);
+
   std::list<std::unique_ptr<Queue_element_base> >sendQueue;
   mutable UnitLastMessageCount_map               unitLastMessageCount;
   unsigned long                                  lastSend               = 0;
@@ -88,6 +138,38 @@ struct ControllerDelayHandlerStruct {
   bool                                           must_check_reply       = false;
   bool                                           deduplicate            = false;
   bool                                           useLocalSystemTime     = false;
+  bool                                           sendBatch              = false;
+  bool                                           spillToFlash           = false;
+  create_queue_element_function                  createElement          = nullptr;
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+  std::unique_ptr<ControllerQueueSpill_struct>   spill;
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
+private:
+
+  bool ramQueueFull(controllerIndex_t controller_idx) const;
+
+  // Remove the front element, acknowledging it to the spill handler when restored from the file system.
+  void popFront();
+
+  // Update the queue metrics, no-op when FEATURE_METRICS_REGISTRY is not enabled.
+  void updateQueueDepthMetric();
+  void countRetry();
+  void countDropped();
+
+#if FEATURE_METRICS_REGISTRY
+
+  // Register the queue metrics, labeled with the controller number.
+  void registerMetrics(controllerIndex_t ControllerIndex);
+
+  metricIndex_t queueDepthMetric = INVALID_METRIC_INDEX;
+  metricIndex_t retriesMetric    = INVALID_METRIC_INDEX;
+  metricIndex_t droppedMetric    = INVALID_METRIC_INDEX;
+#endif // if FEATURE_METRICS_REGISTRY
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+  bool spillToFile(const Queue_element_base& element);
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
 };
 
 
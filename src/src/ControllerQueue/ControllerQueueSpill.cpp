@@ -0,0 +1,338 @@
+#include "../ControllerQueue/ControllerQueueSpill.h"
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+
+# include "../ESPEasyCore/ESPEasy_Log.h"
+# include "../Helpers/ESPEasy_Storage.h"
+# include "../Helpers/FS_Helper.h"
+# include "../Helpers/Numerical.h"
+# include "../Helpers/StringConverter.h"
+
+ControllerQueueSpill_struct::ControllerQueueSpill_struct(controllerIndex_t controllerIndex)
+  : _controllerIndex(controllerIndex) {}
+
+// Match filename like ctrlq1_123.bin and return the block number.
+static bool getSpillBlockNr(const String& prefix, String fname, uint32_t& blockNr)
+{
+  if (fname.startsWith(F("/"))) {
+    fname = fname.substring(1);
+  }
+
+  if (!fname.startsWith(prefix) || !fname.endsWith(F(".bin"))) {
+    return false;
+  }
+  unsigned int result = 0;
+
+  if (!validUIntFromString(fname.substring(prefix.length(), fname.length() - 4), result)) {
+    return false;
+  }
+  blockNr = result;
+  return true;
+}
+
+void ControllerQueueSpill_struct::init()
+{
+  String prefix = F("ctrlq");
+
+  prefix += _controllerIndex + 1;
+  prefix += '_';
+
+  uint32_t lowest      = 0;
+  uint32_t highest     = 0;
+  size_t   highestSize = 0;
+  bool     found       = false;
+  uint32_t blockNr     = 0;
+
+# ifdef ESP8266
+  fs::Dir dir = ESPEASY_FS.openDir("");
+
+  while (dir.next()) {
+    if (getSpillBlockNr(prefix, dir.fileName(), blockNr)) {
+      if (!found || (blockNr < lowest)) {
+        lowest = blockNr;
+      }
+
+      if (!found || (blockNr > highest)) {
+        highest     = blockNr;
+        highestSize = dir.fileSize();
+      }
+      found = true;
+    }
+  }
+# endif // ifdef ESP8266
+# ifdef ESP32
+  fs::File root = ESPEASY_FS.open(F("/"));
+  fs::File file = root.openNextFile();
+
+  while (file) {
+    if (!file.isDirectory() && getSpillBlockNr(prefix, String(file.name()), blockNr)) {
+      if (!found || (blockNr < lowest)) {
+        lowest = blockNr;
+      }
+
+      if (!found || (blockNr > highest)) {
+        highest     = blockNr;
+        highestSize = file.size();
+      }
+      found = true;
+    }
+    file = root.openNextFile();
+  }
+# endif // ifdef ESP32
+
+  _readPos = 0;
+
+  if (found) {
+    _readBlockNr    = lowest;
+    _writeBlockNr   = highest;
+    _writeBlockSize = highestSize;
+
+    if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+      String log = F("Controller-");
+      log += _controllerIndex + 1;
+      log += F(" : Queue spill files found: ");
+      log += nrBlocks();
+      addLogMove(LOG_LEVEL_INFO, log);
+    }
+  } else {
+    _readBlockNr    = 1;
+    _writeBlockNr   = 1;
+    _writeBlockSize = 0;
+  }
+}
+
+bool ControllerQueueSpill_struct::hasData() const
+{
+  return (_readBlockNr < _writeBlockNr) || (_readPos < _writeBlockSize);
+}
+
+bool ControllerQueueSpill_struct::isFull() const
+{
+  if (!enoughFreeSpace()) {
+    return true;
+  }
+  if (_writeBlockSize == 0) {
+    // Block to write is not yet created, but already counted.
+    return nrBlocks() > CONTROLLER_QUEUE_SPILL_MAX_BLOCKS;
+  }
+  return nrBlocks() >= CONTROLLER_QUEUE_SPILL_MAX_BLOCKS &&
+         _writeBlockSize >= CONTROLLER_QUEUE_SPILL_BLOCK_SIZE;
+}
+
+bool ControllerQueueSpill_struct::write(const Queue_element_serializer& serializer, bool deleteOldest)
+{
+  // Check before narrowing to the stored uint16_t size.
+  if ((serializer.size() == 0) || ((serializer.size() + sizeof(uint16_t)) > CONTROLLER_QUEUE_SPILL_BLOCK_SIZE)) {
+    return false;
+  }
+  const uint16_t recordSize = static_cast<uint16_t>(serializer.size());
+
+  const bool startNewBlock =
+    (_writeBlockSize > 0) &&
+    ((_writeBlockSize + sizeof(recordSize) + recordSize) > CONTROLLER_QUEUE_SPILL_BLOCK_SIZE);
+
+  // A new block file is created when the current one is full, or when it was not yet written.
+  // (e.g. a new block was started after the previous one was completely read)
+  if (startNewBlock || (_writeBlockSize == 0)) {
+    // Free at most one block for lack of space, but make sure the max. nr of blocks is never exceeded.
+    const uint32_t newBlocks     = startNewBlock ? 1 : 0;
+    bool           mustFreeSpace = !enoughFreeSpace();
+
+    while (mustFreeSpace || ((nrBlocks() + newBlocks) > CONTROLLER_QUEUE_SPILL_MAX_BLOCKS)) {
+      if (!deleteOldest || (oldestBlockNr() == _writeBlockNr)) {
+        // Not allowed to delete, or only a single block left, which is the one being written.
+        return false;
+      }
+      deleteOldestBlock();
+      mustFreeSpace = false;
+    }
+  }
+
+  if (startNewBlock) {
+    ++_writeBlockNr;
+    _writeBlockSize = 0;
+  }
+
+  fs::File f = tryOpenFile(getFileName(_writeBlockNr), "a");
+
+  if (!f) {
+    return false;
+  }
+  size_t bytesWritten = f.write(reinterpret_cast<const uint8_t *>(&recordSize), sizeof(recordSize));
+
+  bytesWritten += f.write(&serializer.data[0], recordSize);
+  f.close();
+
+  // Keep track of what is actually written, so a partial record can be detected when reading.
+  _writeBlockSize += bytesWritten;
+  return bytesWritten == (sizeof(recordSize) + recordSize);
+}
+
+bool ControllerQueueSpill_struct::read(Queue_element_serializer& serializer, uint32_t& blockNr)
+{
+  serializer.clear();
+  blockNr = 0;
+
+  while (hasData()) {
+    bool success   = false;
+    bool blockDone = true;
+    fs::File f     = tryOpenFile(getFileName(_readBlockNr), "r");
+
+    if (f) {
+      const size_t blockSize = (_readBlockNr == _writeBlockNr) ? _writeBlockSize : f.size();
+      uint16_t     recordSize = 0;
+
+      if (((_readPos + sizeof(recordSize)) <= blockSize) &&
+          f.seek(_readPos) &&
+          (f.read(reinterpret_cast<uint8_t *>(&recordSize), sizeof(recordSize)) == sizeof(recordSize)) &&
+          (recordSize > 0) &&
+          ((_readPos + sizeof(recordSize) + recordSize) <= blockSize)) {
+        serializer.data.resize(recordSize);
+        success = f.read(&serializer.data[0], recordSize) == recordSize;
+      }
+
+      if (success) {
+        _readPos += sizeof(recordSize) + recordSize;
+        blockDone = _readPos >= blockSize;
+        blockNr   = _readBlockNr;
+        ++_unacknowledged[blockNr];
+      }
+      f.close();
+    }
+
+    // Move on when a block is completely read, or when it is missing or corrupt.
+    // The block itself is kept until its elements are acknowledged.
+    if (blockDone) {
+      finishReadBlock();
+    }
+
+    if (success) {
+      return true;
+    }
+  }
+  serializer.clear();
+  return false;
+}
+
+void ControllerQueueSpill_struct::acknowledge(uint32_t blockNr)
+{
+  auto it = _unacknowledged.find(blockNr);
+
+  if (it == _unacknowledged.end()) {
+    // Block already deleted
+    return;
+  }
+
+  if (it->second > 1) {
+    --(it->second);
+    return;
+  }
+  _unacknowledged.erase(it);
+
+  if (blockNr < _readBlockNr) {
+    // Completely read, so no longer needed.
+    tryDeleteFile(getFileName(blockNr));
+  }
+}
+
+void ControllerQueueSpill_struct::clear()
+{
+  for (auto it = _unacknowledged.begin(); it != _unacknowledged.end(); ++it) {
+    if (it->first < _readBlockNr) {
+      tryDeleteFile(getFileName(it->first));
+    }
+  }
+  _unacknowledged.clear();
+
+  while (hasData() || (_writeBlockSize > 0)) {
+    deleteReadBlock();
+  }
+}
+
+String ControllerQueueSpill_struct::getFileName(uint32_t blockNr) const
+{
+  String fname;
+
+  fname.reserve(24);
+  # ifdef ESP32
+  fname = '/';
+  # endif // ifdef ESP32
+  fname += F("ctrlq");
+  fname += _controllerIndex + 1;
+  fname += '_';
+  fname += blockNr;
+  fname += F(".bin");
+  return fname;
+}
+
+uint32_t ControllerQueueSpill_struct::nrBlocks() const
+{
+  return _writeBlockNr - oldestBlockNr() + 1;
+}
+
+uint32_t ControllerQueueSpill_struct::oldestBlockNr() const
+{
+  if (_unacknowledged.empty() || (_unacknowledged.begin()->first > _readBlockNr)) {
+    return _readBlockNr;
+  }
+  return _unacknowledged.begin()->first;
+}
+
+bool ControllerQueueSpill_struct::enoughFreeSpace() const
+{
+  return SpiffsFreeSpace() > ((2 * CONTROLLER_QUEUE_SPILL_BLOCK_SIZE) + SpiffsBlocksize());
+}
+
+void ControllerQueueSpill_struct::deleteReadBlock()
+{
+  tryDeleteFile(getFileName(_readBlockNr));
+
+  // Elements already read from this block can no longer be replayed.
+  _unacknowledged.erase(_readBlockNr);
+
+  if (_readBlockNr < _writeBlockNr) {
+    ++_readBlockNr;
+  } else {
+    // Deleted the block being written, start with a new block.
+    // Do not reuse the block number, to spread writes over the flash.
+    ++_writeBlockNr;
+    _readBlockNr    = _writeBlockNr;
+    _writeBlockSize = 0;
+  }
+  _readPos = 0;
+}
+
+void ControllerQueueSpill_struct::deleteOldestBlock()
+{
+  const uint32_t blockNr = oldestBlockNr();
+
+  if (blockNr < _readBlockNr) {
+    // Completely read, only kept for its unacknowledged elements.
+    tryDeleteFile(getFileName(blockNr));
+    _unacknowledged.erase(blockNr);
+    return;
+  }
+  deleteReadBlock();
+}
+
+void ControllerQueueSpill_struct::finishReadBlock()
+{
+  const uint32_t blockNr = _readBlockNr;
+
+  if (_unacknowledged.find(blockNr) == _unacknowledged.end()) {
+    deleteReadBlock();
+    return;
+  }
+
+  if (_readBlockNr < _writeBlockNr) {
+    ++_readBlockNr;
+  } else {
+    // Keep the block being written until its elements are acknowledged, append to a new block.
+    ++_writeBlockNr;
+    _readBlockNr    = _writeBlockNr;
+    _writeBlockSize = 0;
+  }
+  _readPos = 0;
+}
+
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
@@ -0,0 +1,111 @@
+#ifndef CONTROLLERQUEUE_CONTROLLERQUEUESPILL_H
+#define CONTROLLERQUEUE_CONTROLLERQUEUESPILL_H
+
+#include "../../ESPEasy_common.h"
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+
+# include "../ControllerQueue/Queue_element_serializer.h"
+# include "../DataTypes/ControllerIndex.h"
+
+# include <map>
+
+// Max. size of a single spill file.
+// Matches the erase block size of the flash, so a full block is written before the next one is started.
+# ifndef CONTROLLER_QUEUE_SPILL_BLOCK_SIZE
+#  define CONTROLLER_QUEUE_SPILL_BLOCK_SIZE 4096
+# endif // ifndef CONTROLLER_QUEUE_SPILL_BLOCK_SIZE
+
+static_assert(CONTROLLER_QUEUE_SPILL_BLOCK_SIZE <= UINT16_MAX, "Record size is stored as uint16_t");
+
+// Max. number of spill files per controller.
+# ifndef CONTROLLER_QUEUE_SPILL_MAX_BLOCKS
+#  ifdef ESP8266
+#   define CONTROLLER_QUEUE_SPILL_MAX_BLOCKS 8
+#  else // ifdef ESP8266
+#   define CONTROLLER_QUEUE_SPILL_MAX_BLOCKS 32
+#  endif // ifdef ESP8266
+# endif // ifndef CONTROLLER_QUEUE_SPILL_MAX_BLOCKS
+
+// Interval in msec to check whether spilled elements can be restored when the queue is empty.
+# ifndef CONTROLLER_QUEUE_SPILL_RETRY_INTERVAL
+#  define CONTROLLER_QUEUE_SPILL_RETRY_INTERVAL 1000
+# endif // ifndef CONTROLLER_QUEUE_SPILL_RETRY_INTERVAL
+
+
+/*********************************************************************************************\
+* ControllerQueueSpill_struct
+* Append-only storage on the file system for controller queue elements which do not fit in
+* the queue in RAM. (e.g. during network outage)
+*
+* Elements are stored in a sequence of block files, named ctrlq<controllerNr>_<blockNr>.bin
+* Block numbers only increase, so each block file is written only once and deleted as soon as
+* all its elements are read back and acknowledged. This spreads the writes over the flash.
+*
+* The read position is only kept in RAM, so after a reboot the oldest block is replayed from
+* its start. Thus elements may be sent twice, but are not lost.
+\*********************************************************************************************/
+struct ControllerQueueSpill_struct {
+  explicit ControllerQueueSpill_struct(controllerIndex_t controllerIndex);
+
+  // Look for existing spill files of this controller.
+  void              init();
+
+  controllerIndex_t getControllerIndex() const {
+    return _controllerIndex;
+  }
+
+  bool              hasData() const;
+
+  // No room left to write another element.
+  bool              isFull() const;
+
+  // Append a serialized element.
+  // @param deleteOldest  Delete the oldest block when no room left.
+  bool              write(const Queue_element_serializer& serializer,
+                          bool                            deleteOldest);
+
+  // Read the oldest element not yet read.
+  // @param blockNr  Block the element was read from, to be passed to acknowledge().
+  bool              read(Queue_element_serializer& serializer,
+                         uint32_t                & blockNr);
+
+  // Mark an element read from the given block as handled (sent or dropped).
+  // A block is deleted when all its elements are read and acknowledged.
+  void              acknowledge(uint32_t blockNr);
+
+  // Delete all spill files of this controller.
+  void              clear();
+
+private:
+
+  String   getFileName(uint32_t blockNr) const;
+
+  uint32_t nrBlocks() const;
+
+  bool     enoughFreeSpace() const;
+
+  void     deleteReadBlock();
+
+  // Delete the oldest block, which may be a completely read block with unacknowledged elements.
+  void     deleteOldestBlock();
+
+  // Continue reading with the next block, delete the block when all its elements are acknowledged.
+  void     finishReadBlock();
+
+  // Oldest block still present on the file system.
+  uint32_t oldestBlockNr() const;
+
+  // Nr of elements read but not yet acknowledged per block.
+  std::map<uint32_t, uint16_t> _unacknowledged;
+
+  const controllerIndex_t _controllerIndex;
+  uint32_t                _readBlockNr    = 1;
+  uint32_t                _writeBlockNr   = 1;
+  size_t                  _readPos        = 0;
+  size_t                  _writeBlockSize = 0;
+};
+
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
+#endif // ifndef CONTROLLERQUEUE_CONTROLLERQUEUESPILL_H
@@ -27,7 +27,11 @@ bool init_mqtt_delay_queue(controllerIndex_t ControllerIndex, String& pubname, b
   if (MQTTDelayHandler == nullptr) {
     return false;
   }
+  MQTTDelayHandler->setQueueElementFactory(createQueueElement<MQTT_queue_element>);
   MQTTDelayHandler->cacheControllerSettings(*ControllerSettings);
+  # if FEATURE_CONTROLLER_QUEUE_SPILL
+  MQTTDelayHandler->updateSpill(ControllerIndex);
+  # endif // if FEATURE_CONTROLLER_QUEUE_SPILL
   pubname    = ControllerSettings->Publish;
   retainFlag = ControllerSettings->mqtt_retainFlag();
   Scheduler.setIntervalTimerOverride(SchedulerIntervalTimer_e::TIMER_MQTT, 10); // Make sure the MQTT is being processed as soon
@@ -70,6 +70,7 @@
       C##NNN####M##_DelayHandler = new (std::nothrow) (ControllerDelayHandlerStruct);                                \
     }                                                                                                                \
     if (C##NNN####M##_DelayHandler == nullptr) { return false; }                                                     \
+    C##NNN####M##_DelayHandler->setQueueElementFactory(createQueueElement<C##NNN####M##_queue_element>);             \
     return C##NNN####M##_DelayHandler->cacheControllerSettings(ControllerIndex);                                 \
   }                                                                                                                  \
   void exit_c##NNN####M##_delay_queue() {                                                                            \
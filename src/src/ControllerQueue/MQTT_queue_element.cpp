@@ -2,6 +2,10 @@
 
 #if FEATURE_MQTT
 
+# include "../DataStructs/ESPEasy_EventStruct.h"
+# include "../Globals/Settings.h"
+# include "../Helpers/StringConverter.h"
+
 MQTT_queue_element::MQTT_queue_element(int ctrl_idx,
                                        taskIndex_t TaskIndex,
                                        const String& topic, const String& payload,
@@ -57,6 +61,63 @@ MQTT_queue_element::MQTT_queue_element(int         ctrl_idx,
   removeEmptyTopics();
 }
 
+MQTT_queue_element::MQTT_queue_element(int                      ctrl_idx,
+                                       taskIndex_t              TaskIndex,
+                                       const String           & topicTemplate,
+                                       uint8_t                  valueIndex,
+                                       Sensor_VType             sensorType,
+                                       const TaskValues_Data_t& values,
+                                       bool                     retained)
+  : _topicTemplate(&topicTemplate), _sensorType(sensorType), _valueIndex(valueIndex), _retained(retained)
+{
+  _controller_idx      = ctrl_idx;
+  _taskIndex           = TaskIndex;
+  _processByController = true;
+
+  // Only keep the bytes of the task values which hold the value to send.
+  if (sensorType == Sensor_VType::SENSOR_TYPE_ULONG) {
+    _rawValueOffset = 0;
+  } else if (is32bitOutputDataType(sensorType)) {
+    _rawValueOffset = valueIndex * sizeof(uint32_t);
+  } else {
+    _rawValueOffset = valueIndex * sizeof(uint64_t);
+  }
+  constexpr uint8_t maxOffset = sizeof(values.binary) - sizeof(_rawValue);
+
+  if (_rawValueOffset > maxOffset) {
+    _rawValueOffset = maxOffset;
+  }
+  memcpy(_rawValue, values.binary + _rawValueOffset, sizeof(_rawValue));
+}
+
+String MQTT_queue_element::getTopic() const {
+  if (!_processByController || (_topicTemplate == nullptr)) {
+    return _topic;
+  }
+  String topic(*_topicTemplate);
+  struct EventStruct TempEvent(_taskIndex);
+
+  TempEvent.ControllerIndex = _controller_idx;
+  TempEvent.sensorType      = _sensorType;
+
+  if (validControllerIndex(_controller_idx) && validTaskIndex(_taskIndex)) {
+    TempEvent.idx = Settings.TaskDeviceID[_controller_idx][_taskIndex];
+  }
+  parseControllerVariables(topic, &TempEvent, false);
+  parseSingleControllerVariable(topic, &TempEvent, _valueIndex, false);
+  removeEmptyTopics(topic);
+  return topic;
+}
+
+String MQTT_queue_element::getPayload() const {
+  if (_processByController) {
+    TaskValues_Data_t values{};
+    memcpy(values.binary + _rawValueOffset, _rawValue, sizeof(_rawValue));
+    return formatTaskValue(_taskIndex, _valueIndex, _sensorType, values);
+  }
+  return _payload;
+}
+
 size_t MQTT_queue_element::getSize() const {
   return sizeof(*this) + _topic.length() + _payload.length();
 }
@@ -71,20 +132,64 @@ bool MQTT_queue_element::isDuplicate(const Queue_element_base& other) const {
   // If it were to make a difference, the topic would be different.
   if ((oth._controller_idx != _controller_idx) ||
       (oth._retained != _retained) ||
-      (oth._topic != _topic) ||
-      (oth._payload != _payload)) {
+      (oth._processByController != _processByController) ||
+      (oth._topic != _topic)) {
     return false;
   }
-  return true;
+
+  if (_processByController) {
+    // Topic is only known when sent, so compare the task and value it will be formatted from.
+    return (oth._topicTemplate == _topicTemplate) &&
+           (oth._taskIndex == _taskIndex) &&
+           (oth._valueIndex == _valueIndex) &&
+           (oth._sensorType == _sensorType) &&
+           (oth._rawValueOffset == _rawValueOffset) &&
+           (memcmp(oth._rawValue, _rawValue, sizeof(_rawValue)) == 0);
+  }
+  return oth._payload == _payload;
 }
 
 void MQTT_queue_element::removeEmptyTopics() {
+  removeEmptyTopics(_topic);
+}
+
+void MQTT_queue_element::removeEmptyTopics(String& topic) {
   // some parts of the topic may have been replaced by empty strings,
   // or "/status" may have been appended to a topic ending with a "/"
   // Get rid of "//"
-  while (_topic.indexOf(F("//")) != -1) {
-    _topic.replace(F("//"), F("/"));
+  while (topic.indexOf(F("//")) != -1) {
+    topic.replace(F("//"), F("/"));
   }
 }
 
+# if FEATURE_CONTROLLER_QUEUE_SPILL
+bool MQTT_queue_element::serializeData(Queue_element_serializer& serializer) const {
+  // The topic template may no longer be present when the element is restored,
+  // so store the formatted topic.
+  serializer.writeString(getTopic());
+  serializer.writeString(_payload);
+  serializer.write(UnitMessageCount.unit);
+  serializer.write(UnitMessageCount.count);
+  serializer.write(_retained);
+  serializer.write(_valueIndex);
+  serializer.write(_sensorType);
+  serializer.write(_rawValueOffset);
+  serializer.write(_rawValue);
+  return true;
+}
+
+bool MQTT_queue_element::deserializeData(Queue_element_serializer& serializer) {
+  _topicTemplate = nullptr;
+  return serializer.readString(_topic) &&
+         serializer.readString(_payload) &&
+         serializer.read(UnitMessageCount.unit) &&
+         serializer.read(UnitMessageCount.count) &&
+         serializer.read(_retained) &&
+         serializer.read(_valueIndex) &&
+         serializer.read(_sensorType) &&
+         serializer.read(_rawValueOffset) &&
+         serializer.read(_rawValue);
+}
+# endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
 #endif // if FEATURE_MQTT
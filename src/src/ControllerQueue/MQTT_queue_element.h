@@ -7,6 +7,8 @@
 
 # include "../ControllerQueue/Queue_element_base.h"
 # include "../DataStructs/UnitMessageCount.h"
+# include "../DataTypes/SensorVType.h"
+# include "../DataTypes/TaskValues_Data.h"
 # include "../Globals/CPlugins.h"
 
 /*********************************************************************************************\
@@ -39,6 +41,23 @@ public:
                               bool        retained,
                               bool        callbackTask);
 
+  // Only keep the topic template and the raw task value, topic and payload are formatted when the element is sent.
+  // The topic template must remain valid while the element is queued. (e.g. the controller's publish topic)
+  // This sets _processByController.
+  explicit MQTT_queue_element(int                      ctrl_idx,
+                              taskIndex_t              TaskIndex,
+                              const String           & topicTemplate,
+                              uint8_t                  valueIndex,
+                              Sensor_VType             sensorType,
+                              const TaskValues_Data_t& values,
+                              bool                     retained);
+
+  // Return the topic to publish to, formatted from the topic template when _processByController is set.
+  String                    getTopic() const;
+
+  // Return the payload to send, formatted from the stored task value when _processByController is set.
+  String                    getPayload() const;
+
   size_t                    getSize() const;
 
   bool                      isDuplicate(const Queue_element_base& other) const;
@@ -53,9 +72,32 @@ public:
 
   void removeEmptyTopics();
 
+  static void removeEmptyTopics(String& topic);
+
+# if FEATURE_CONTROLLER_QUEUE_SPILL
+
+protected:
+
+  bool serializeData(Queue_element_serializer& serializer) const override;
+
+  bool deserializeData(Queue_element_serializer& serializer) override;
+
+public:
+# endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
   String _topic{};
   String _payload{};
   UnitMessageCount_t UnitMessageCount{};
+
+  // Only used when _processByController is set.
+  const String *_topicTemplate = nullptr;
+
+  // Bytes of the task values holding the value at _valueIndex.
+  // Values of at most 64 bit are stored at an offset of 4 or 8 bytes in TaskValues_Data_t.
+  uint8_t _rawValue[sizeof(uint64_t)] = {};
+  uint8_t _rawValueOffset = 0;
+  Sensor_VType _sensorType = Sensor_VType::SENSOR_TYPE_NONE;
+  uint8_t _valueIndex = 0;
   bool _retained = false; 
 };
 
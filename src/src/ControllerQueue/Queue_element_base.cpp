@@ -10,3 +10,33 @@ Queue_element_base::Queue_element_base() :
 }
 
 Queue_element_base::~Queue_element_base() {}
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+bool Queue_element_base::serialize(Queue_element_serializer& serializer) const
+{
+  if (_call_PLUGIN_PROCESS_CONTROLLER_DATA) {
+    // Depends on data kept in the plugin, which will not be present after a reboot.
+    return false;
+  }
+  serializer.clear();
+  serializer.write(_controller_idx);
+  serializer.write(_taskIndex);
+  serializer.write(_processByController);
+  return serializeData(serializer);
+}
+
+bool Queue_element_base::deserialize(Queue_element_serializer& serializer)
+{
+  serializer.readPos = 0;
+
+  if (!serializer.read(_controller_idx) ||
+      !serializer.read(_taskIndex) ||
+      !serializer.read(_processByController)) {
+    return false;
+  }
+
+  // Stored timestamp is of no use, as it may be from before a reboot.
+  _timestamp = millis();
+  return deserializeData(serializer);
+}
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
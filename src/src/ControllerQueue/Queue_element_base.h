@@ -4,6 +4,7 @@
 
 #include "../../ESPEasy_common.h"
 
+#include "../ControllerQueue/Queue_element_serializer.h"
 #include "../DataStructs/UnitMessageCount.h"
 #include "../Globals/CPlugins.h"
 
@@ -23,6 +24,28 @@ public:
   virtual const UnitMessageCount_t* getUnitMessageCount() const = 0;
   virtual UnitMessageCount_t      * getUnitMessageCount()       = 0;
 
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+  // Store the element to be spilled to the file system when the queue is full.
+  // Return false when the element cannot be stored.
+  bool         serialize(Queue_element_serializer& serializer) const;
+
+  bool         deserialize(Queue_element_serializer& serializer);
+
+protected:
+
+  // Element specific data, called after the common members are (de)serialized.
+  // Default implementation does not support spilling to the file system.
+  virtual bool serializeData(Queue_element_serializer& serializer) const {
+    return false;
+  }
+
+  virtual bool deserializeData(Queue_element_serializer& serializer) {
+    return false;
+  }
+
+public:
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
   unsigned long _timestamp;
   controllerIndex_t _controller_idx;
   taskIndex_t _taskIndex;
@@ -34,6 +57,12 @@ public:
   // Some formatting of values can be done when actually sending it.
   // This may require less RAM than keeping formatted strings in memory
   bool _processByController;
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+  // Spill block the element was restored from, 0 when not restored from the file system.
+  // The block is kept until all its elements are removed from the queue.
+  uint32_t _spillBlockNr = 0;
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
 };
 
 #endif // ifndef CONTROLLERQUEUE_QUEUE_ELEMENT_BASE_H
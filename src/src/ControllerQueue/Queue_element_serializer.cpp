@@ -0,0 +1,43 @@
+#include "../ControllerQueue/Queue_element_serializer.h"
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+
+void Queue_element_serializer::writeString(const String& str)
+{
+  const uint16_t length = str.length();
+
+  write(length);
+
+  if (length > 0) {
+    const uint8_t *ptr = reinterpret_cast<const uint8_t *>(str.c_str());
+    data.insert(data.end(), ptr, ptr + length);
+  }
+}
+
+bool Queue_element_serializer::readString(String& str)
+{
+  uint16_t length = 0;
+
+  if (!read(length) || ((readPos + length) > data.size())) {
+    return false;
+  }
+  str.clear();
+
+  if (!str.reserve(length)) {
+    return false;
+  }
+
+  for (uint16_t i = 0; i < length; ++i) {
+    str += static_cast<char>(data[readPos + i]);
+  }
+  readPos += length;
+  return true;
+}
+
+void Queue_element_serializer::clear()
+{
+  data.clear();
+  readPos = 0;
+}
+
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
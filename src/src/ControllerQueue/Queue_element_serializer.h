@@ -0,0 +1,50 @@
+#ifndef CONTROLLERQUEUE_QUEUE_ELEMENT_SERIALIZER_H
+#define CONTROLLERQUEUE_QUEUE_ELEMENT_SERIALIZER_H
+
+#include "../../ESPEasy_common.h"
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+
+# include <string.h>
+# include <vector>
+
+/*********************************************************************************************\
+* Binary buffer to store a controller queue element, used to spill queue elements to the file system.
+* Values are stored in native byte order, as the data is only read back by the same build.
+\*********************************************************************************************/
+struct Queue_element_serializer {
+  template<typename T>
+  void write(const T& value) {
+    const uint8_t *ptr = reinterpret_cast<const uint8_t *>(&value);
+
+    data.insert(data.end(), ptr, ptr + sizeof(T));
+  }
+
+  template<typename T>
+  bool read(T& value) {
+    if ((readPos + sizeof(T)) > data.size()) {
+      return false;
+    }
+    memcpy(&value, &data[readPos], sizeof(T));
+    readPos += sizeof(T);
+    return true;
+  }
+
+  // Strings are stored as 16-bit length followed by the characters (without trailing 0)
+  void   writeString(const String& str);
+
+  bool   readString(String& str);
+
+  void   clear();
+
+  size_t size() const {
+    return data.size();
+  }
+
+  std::vector<uint8_t>data;
+  size_t              readPos = 0;
+};
+
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
+
+#endif // ifndef CONTROLLERQUEUE_QUEUE_ELEMENT_SERIALIZER_H
@@ -107,3 +107,33 @@ bool SimpleQueueElement_formatted_Strings::isDuplicate(const Queue_element_base&
   }
   return true;
 }
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+bool SimpleQueueElement_formatted_Strings::serializeData(Queue_element_serializer& serializer) const {
+  serializer.write(idx);
+  serializer.write(sensorType);
+  serializer.write(valuesSent);
+  serializer.write(valueCount);
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    serializer.writeString(txt[i]);
+  }
+  return true;
+}
+
+bool SimpleQueueElement_formatted_Strings::deserializeData(Queue_element_serializer& serializer) {
+  if (!serializer.read(idx) ||
+      !serializer.read(sensorType) ||
+      !serializer.read(valuesSent) ||
+      !serializer.read(valueCount)) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    if (!serializer.readString(txt[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
@@ -33,3 +33,14 @@ bool simple_queue_element_string_only::isDuplicate(const Queue_element_base& oth
   }
   return true;
 }
+
+#if FEATURE_CONTROLLER_QUEUE_SPILL
+bool simple_queue_element_string_only::serializeData(Queue_element_serializer& serializer) const {
+  serializer.writeString(txt);
+  return true;
+}
+
+bool simple_queue_element_string_only::deserializeData(Queue_element_serializer& serializer) {
+  return serializer.readString(txt);
+}
+#endif // if FEATURE_CONTROLLER_QUEUE_SPILL
@@ -153,6 +153,15 @@
 #ifndef UDP_PACKETSIZE_MAX
   #define UDP_PACKETSIZE_MAX               256 // Currently only needed for C013_Receive
 #endif
+#ifndef UDP_MAX_PACKETS_PER_CHECK
+  #define UDP_MAX_PACKETS_PER_CHECK         16 // Max nr of p2p UDP packets handled per call to checkUDP
+#endif
+#ifndef UDP_MAX_CHECK_DURATION_MSEC
+  #define UDP_MAX_CHECK_DURATION_MSEC       10 // Stop handling p2p UDP packets when exceeded
+#endif
+#ifndef UDP_COMMAND_QUEUE_MAX
+  #define UDP_COMMAND_QUEUE_MAX              8 // Max nr of commands received via p2p UDP waiting to be executed
+#endif
 #ifndef TIMER_GRATUITOUS_ARP_MAX
   #define TIMER_GRATUITOUS_ARP_MAX           5000
 #endif
@@ -2794,6 +2794,32 @@ To create/register a plugin, you have to :
   #undef USES_P148   // Sonoff POWR3xxD and THR3xxD display
 #endif
 
+// Registry of counters, gauges and histograms, served on the /metrics page
+#ifndef FEATURE_METRICS_REGISTRY
+  #ifdef WEBSERVER_METRICS
+    #define FEATURE_METRICS_REGISTRY   1
+  #else
+    #define FEATURE_METRICS_REGISTRY   0
+  #endif
+#endif
+
+#ifndef FEATURE_CONTROLLER_QUEUE_SPILL
+  #if defined(ESP8266_1M) || defined(LIMIT_BUILD_SIZE)
+    #define FEATURE_CONTROLLER_QUEUE_SPILL   0
+  #else
+    #define FEATURE_CONTROLLER_QUEUE_SPILL   1
+  #endif
+#endif
+
+// Write-back cache for settings blocks, coalescing writes to the settings files
+#ifndef FEATURE_SETTINGS_WRITE_CACHE
+  #if defined(ESP8266_1M) || defined(LIMIT_BUILD_SIZE)
+    #define FEATURE_SETTINGS_WRITE_CACHE   0
+  #else
+    #define FEATURE_SETTINGS_WRITE_CACHE   1
+  #endif
+#endif
+
 #ifndef FEATURE_ZEROFILLED_UNITNUMBER
   #ifdef ESP8266_1M
     #define FEATURE_ZEROFILLED_UNITNUMBER    0
@@ -2829,6 +2855,20 @@ To create/register a plugin, you have to :
 #define FEATURE_RTC_CACHE_STORAGE             0
 #endif
 
+// Store the Cache Controller samples in compressed blocks with a time range and task bitmap.
+// ESP8266 flushes only 10 samples per block, which does not compress well enough to be worth the code size.
+#ifndef FEATURE_C016_COMPRESSED_CACHE
+  #if FEATURE_RTC_CACHE_STORAGE && defined(ESP32)
+    #define FEATURE_C016_COMPRESSED_CACHE  1
+  #else
+    #define FEATURE_C016_COMPRESSED_CACHE  0
+  #endif
+#endif
+#if FEATURE_C016_COMPRESSED_CACHE && !FEATURE_RTC_CACHE_STORAGE
+  #undef FEATURE_C016_COMPRESSED_CACHE
+  #define FEATURE_C016_COMPRESSED_CACHE  0
+#endif
+
 #ifndef FEATURE_DNS_SERVER                    
 #define FEATURE_DNS_SERVER                    0
 #endif
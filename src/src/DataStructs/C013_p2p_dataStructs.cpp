@@ -41,4 +41,165 @@ bool C013_SensorDataStruct::matchesSensorType(Sensor_VType sensor_type) const
   return sensorType == sensor_type;
 }
 
+static_assert(TASKS_MAX <= 32, "C013_SensorDataBatch uses a 32 bit mask for the tasks in a frame");
+static_assert(C013_BATCH_NR_WORDS <= 7, "C013_SensorDataBatch uses a 8 bit value mask, including C013_BATCH_FULL_ENTRY");
+static_assert(C013_FULL_FRAME_INTERVAL > 0, "C013_FULL_FRAME_INTERVAL must be at least 1");
+
+C013_SensorDataBatch::C013_SensorDataBatch()
+{
+  for (taskIndex_t i = 0; i < TASKS_MAX; ++i) {
+    _lastSensorType[i] = Sensor_VType::SENSOR_TYPE_NONE;
+  }
+  clear();
+}
+
+void C013_SensorDataBatch::clear()
+{
+  memset(_frame, 0, C013_BATCH_HEADER_SIZE);
+  _frame[0]     = 255;
+  _frame[1]     = C013_SENSOR_DATA_BATCH_ID;
+  _size         = C013_BATCH_HEADER_SIZE;
+  _tasksInFrame = 0;
+}
+
+bool C013_SensorDataBatch::contains(taskIndex_t taskIndex) const
+{
+  return validTaskIndex(taskIndex) && ((_tasksInFrame & (1u << taskIndex)) != 0);
+}
+
+bool C013_SensorDataBatch::add(const C013_SensorDataStruct& data)
+{
+  const taskIndex_t taskIndex = data.sourceTaskIndex;
+
+  if (!validTaskIndex(taskIndex) || contains(taskIndex)) {
+    return false;
+  }
+
+  uint32_t words[C013_BATCH_NR_WORDS];
+  uint32_t lastWords[C013_BATCH_NR_WORDS];
+
+  memcpy(words,     data.values.binary,          sizeof(words));
+  memcpy(lastWords, _lastSent[taskIndex].binary, sizeof(lastWords));
+
+  const bool fullFrame = (_framesSinceFull[taskIndex] == 0) ||
+                         (_lastSensorType[taskIndex] != data.sensorType);
+  uint8_t valueMask = fullFrame ? C013_BATCH_FULL_ENTRY : 0;
+  size_t  entrySize = C013_BATCH_ENTRY_HEADER_SIZE;
+
+  for (uint8_t i = 0; i < C013_BATCH_NR_WORDS; ++i) {
+    if (fullFrame || (words[i] != lastWords[i])) {
+      valueMask |= (1 << i);
+      entrySize += sizeof(uint32_t);
+    }
+  }
+
+  if ((_size + entrySize) > sizeof(_frame)) {
+    return false;
+  }
+
+  _frame[2] = data.sourceUnit;
+  _frame[3] = data.destUnit;
+  ++_frame[4];
+
+  _frame[_size++] = taskIndex;
+  _frame[_size++] = data.destTaskIndex;
+  _frame[_size++] = data.deviceNumber.value;
+  _frame[_size++] = static_cast<uint8_t>(data.sensorType);
+  _frame[_size++] = static_cast<uint8_t>(_sequence[taskIndex] + 1);
+  _frame[_size++] = valueMask;
+
+  for (uint8_t i = 0; i < C013_BATCH_NR_WORDS; ++i) {
+    if (valueMask & (1 << i)) {
+      memcpy(&_frame[_size], &words[i], sizeof(uint32_t));
+      _size += sizeof(uint32_t);
+    }
+  }
+
+  _tasksInFrame |= (1u << taskIndex);
+  return true;
+}
+
+void C013_SensorDataBatch::markSent()
+{
+  // The frame holds all that is needed to update the state per task.
+  C013_SensorDataBatchReader reader(_frame, _size);
+  C013_SensorDataStruct data;
+
+  while (reader.next(data)) {
+    const taskIndex_t taskIndex = data.sourceTaskIndex;
+
+    reader.copyValues(_lastSent[taskIndex]);
+    _lastSensorType[taskIndex]  = data.sensorType;
+    _sequence[taskIndex]        = reader.getSequence();
+    _framesSinceFull[taskIndex] = reader.isFullEntry()
+      ? 1 % C013_FULL_FRAME_INTERVAL
+      : (_framesSinceFull[taskIndex] + 1) % C013_FULL_FRAME_INTERVAL;
+  }
+  clear();
+}
+
+C013_SensorDataBatchReader::C013_SensorDataBatchReader(const uint8_t *frame, size_t length)
+  : _frame(frame), _length(length) {}
+
+bool C013_SensorDataBatchReader::isValid() const
+{
+  return (_frame != nullptr) &&
+         (_length >= C013_BATCH_HEADER_SIZE) &&
+         (_frame[0] == 255) &&
+         (_frame[1] == C013_SENSOR_DATA_BATCH_ID);
+}
+
+uint8_t C013_SensorDataBatchReader::getSourceUnit() const
+{
+  return _frame[2];
+}
+
+uint8_t C013_SensorDataBatchReader::getDestUnit() const
+{
+  return _frame[3];
+}
+
+bool C013_SensorDataBatchReader::next(C013_SensorDataStruct& data)
+{
+  if (!isValid() ||
+      (_entryNr >= _frame[4]) ||
+      ((_pos + C013_BATCH_ENTRY_HEADER_SIZE) > _length)) {
+    return false;
+  }
+  data.sourceUnit      = getSourceUnit();
+  data.destUnit        = getDestUnit();
+  data.sourceTaskIndex = _frame[_pos++];
+  data.destTaskIndex   = _frame[_pos++];
+  data.deviceNumber    = pluginID_t::toPluginID(_frame[_pos++]);
+  data.sensorType      = static_cast<Sensor_VType>(_frame[_pos++]);
+  _sequence            = _frame[_pos++];
+  _valueMask           = _frame[_pos++];
+  _valuesPos           = _pos;
+
+  for (uint8_t i = 0; i < C013_BATCH_NR_WORDS; ++i) {
+    if (_valueMask & (1 << i)) {
+      _pos += sizeof(uint32_t);
+    }
+  }
+
+  if (_pos > _length) {
+    // Truncated frame
+    return false;
+  }
+  ++_entryNr;
+  return true;
+}
+
+void C013_SensorDataBatchReader::copyValues(TaskValues_Data_t& values) const
+{
+  size_t pos = _valuesPos;
+
+  for (uint8_t i = 0; i < C013_BATCH_NR_WORDS; ++i) {
+    if (_valueMask & (1 << i)) {
+      memcpy(&values.binary[i * sizeof(uint32_t)], &_frame[pos], sizeof(uint32_t));
+      pos += sizeof(uint32_t);
+    }
+  }
+}
+
 #endif // ifdef USES_C013
@@ -53,6 +53,133 @@ struct C013_SensorDataStruct
   TaskValues_Data_t values{};
 };
 
+
+/*********************************************************************************************\
+* Frame with the data of multiple tasks (ID 7)
+* Sent once as broadcast to all nodes announcing NODE_FEATURE_P2P_DATA_BATCH.
+* Nodes not supporting it ignore this ID and still receive C013_SensorDataStruct as unicast.
+*
+* Header:
+*   1 byte  255
+*   1 byte  ID 7
+*   1 byte  sourceUnit
+*   1 byte  destUnit (0 = all)
+*   1 byte  nr of entries
+*   1 byte  reserved
+* Per entry:
+*   1 byte  sourceTaskIndex
+*   1 byte  destTaskIndex
+*   1 byte  pluginID
+*   1 byte  sensorType
+*   1 byte  sequence nr, incremented per sent entry of this task
+*   1 byte  value mask, bit per 32-bit word of TaskValues_Data_t included in the frame,
+*           C013_BATCH_FULL_ENTRY set when all words are included.
+*   4 bytes per included word
+*
+* Only words changed since the previous sent entry of this task are included,
+* except for every C013_FULL_FRAME_INTERVAL-th entry.
+* A receiver only applies such a delta entry when it applied the entry with the previous
+* sequence nr of this task. Otherwise it waits for the next full entry.
+\*********************************************************************************************/
+# define C013_SENSOR_DATA_BATCH_ID       7 // ID 6 is reserved for "Data Format Version 1"
+# define C013_BATCH_HEADER_SIZE          6
+# define C013_BATCH_ENTRY_HEADER_SIZE    6
+# define C013_BATCH_FULL_ENTRY           0x80
+# define C013_BATCH_NR_WORDS             (sizeof(TaskValues_Data_t) / sizeof(uint32_t))
+
+// Receivers drop packets of UDP_PACKETSIZE_MAX bytes or more.
+# define C013_BATCH_MAX_SIZE             (UDP_PACKETSIZE_MAX - 1)
+
+# ifndef C013_FULL_FRAME_INTERVAL
+
+// Set to 1 to always send all values.
+#  define C013_FULL_FRAME_INTERVAL       10
+# endif // ifndef C013_FULL_FRAME_INTERVAL
+
+struct C013_SensorDataBatch
+{
+  C013_SensorDataBatch();
+
+  void           clear();
+
+  bool           empty() const {
+    return getNrEntries() == 0;
+  }
+
+  bool           contains(taskIndex_t taskIndex) const;
+
+  // Add the task values to the frame.
+  // Return false when the frame is full or already contains the task, thus must be sent first.
+  bool           add(const C013_SensorDataStruct& data);
+
+  // Call when the frame was sent, so the next frames only include the values changed since.
+  // When the frame could not be sent, just clear it.
+  void           markSent();
+
+  const uint8_t* getFrame() const {
+    return _frame;
+  }
+
+  size_t         getFrameSize() const {
+    return _size;
+  }
+
+private:
+
+  uint8_t getNrEntries() const {
+    return _frame[4];
+  }
+
+  uint8_t           _frame[C013_BATCH_MAX_SIZE]{};
+  size_t            _size = 0;
+  uint32_t          _tasksInFrame = 0;
+
+  // Last values sent per task, to only send the changed values
+  TaskValues_Data_t _lastSent[TASKS_MAX];
+  Sensor_VType      _lastSensorType[TASKS_MAX];
+  uint8_t           _framesSinceFull[TASKS_MAX]{};
+  uint8_t           _sequence[TASKS_MAX]{};
+};
+
+struct C013_SensorDataBatchReader
+{
+  C013_SensorDataBatchReader(const uint8_t *frame,
+                             size_t         length);
+
+  bool    isValid() const;
+
+  uint8_t getSourceUnit() const;
+
+  uint8_t getDestUnit() const;
+
+  // Read the next entry, setting all members of data except the values.
+  bool    next(C013_SensorDataStruct& data);
+
+  // Sequence nr of the last read entry.
+  uint8_t getSequence() const {
+    return _sequence;
+  }
+
+  // Return true when the last read entry includes all values, thus does not depend on earlier entries.
+  bool    isFullEntry() const {
+    return (_valueMask & C013_BATCH_FULL_ENTRY) != 0;
+  }
+
+  // Copy the values of the last read entry which are included in the frame.
+  // Values not included are unchanged since the previous frame and thus not touched.
+  void    copyValues(TaskValues_Data_t& values) const;
+
+private:
+
+  const uint8_t *_frame;
+  size_t         _length;
+  size_t         _pos       = C013_BATCH_HEADER_SIZE;
+  size_t         _valuesPos = 0;
+  uint8_t        _valueMask = 0;
+  uint8_t        _sequence  = 0;
+  uint8_t        _entryNr   = 0;
+};
+
 #endif // ifdef USES_C013
 
 #endif // DATASTRUCTS_C013_P2P_DATASTRUCTS_H
@@ -25,9 +25,11 @@ void Caches::clearAllButTaskCaches() {
 }
 
 void Caches::clearAllTaskCaches() {
+  ++taskNamesVersion;
   taskIndexName.clear();
   taskIndexValueName.clear();
   extraTaskSettings_cache.clear();
+  extraTaskSettingsLRU.clear();
   updateActiveTaskUseSerial0();
 }
 
@@ -39,6 +41,7 @@ void Caches::clearTaskCache(taskIndex_t TaskIndex) {
   if (it != extraTaskSettings_cache.end()) {
     extraTaskSettings_cache.erase(it);
   }
+  extraTaskSettingsLRU.erase(TaskIndex);
   updateActiveTaskUseSerial0();
 }
 
@@ -170,6 +173,20 @@ String Caches::getTaskDeviceFormula(taskIndex_t TaskIndex, uint8_t rel_index)
   return EMPTY_STRING;
 }
 
+CompiledExpression* Caches::getTaskDeviceFormula_compiled(taskIndex_t TaskIndex, uint8_t rel_index)
+{
+  if ((rel_index < VARS_PER_TASK) && hasFormula(TaskIndex)) {
+    auto it = extraTaskSettings_cache.find(TaskIndex);
+
+    if ((it != extraTaskSettings_cache.end()) &&
+        (rel_index < it->second.formulas.size()) &&
+        !it->second.formulas[rel_index].isEmpty()) {
+      return &(it->second.formulas[rel_index]);
+    }
+  }
+  return nullptr;
+}
+
 long Caches::getTaskDevicePluginConfigLong(taskIndex_t TaskIndex, uint8_t rel_index)
 {
   if (validTaskIndex(TaskIndex) && (rel_index < PLUGIN_EXTRACONFIGVAR_MAX)) {
@@ -258,9 +275,20 @@ void Caches::updateExtraTaskSettingsCache()
       tmp.md5checksum = it->second.md5checksum;
       tmp.defaultTaskDeviceValueName = it->second.defaultTaskDeviceValueName;
 
+      // Keep the compiled formulas, they are compiled again when the formula is changed.
+      // Swapping the vector does not move the elements, so pointers to them remain valid.
+      tmp.formulas.swap(it->second.formulas);
+
+      // Task (value) names can only have changed when the settings differ from what is cached.
+      // Clearing the name lookup maps also forces all compiled templates and formulas to be compiled again.
+      const bool settingsChanged = !(tmp.md5checksum == ExtraTaskSettings.computeChecksum());
+
       // Now clear it so we can create a fresh copy.
       extraTaskSettings_cache.erase(it);
-      clearTaskIndexFromMaps(TaskIndex);
+
+      if (settingsChanged) {
+        clearTaskIndexFromMaps(TaskIndex);
+      }
     }
 
     tmp.TaskDeviceName = ExtraTaskSettings.TaskDeviceName;
@@ -285,6 +313,16 @@ void Caches::updateExtraTaskSettingsCache()
       }
       #endif // if FEATURE_PLUGIN_STATS
     }
+
+    if (tmp.hasFormula) {
+      tmp.formulas.resize(VARS_PER_TASK);
+
+      for (size_t i = 0; i < VARS_PER_TASK; ++i) {
+        tmp.formulas[i].setExpression(String(ExtraTaskSettings.TaskDeviceFormula[i]));
+      }
+    } else {
+      tmp.formulas.clear();
+    }
     #ifdef ESP32
     tmp.TaskDevicePluginConfigLong_index_used = 0;
     tmp.TaskDevicePluginConfig_index_used     = 0;
@@ -303,7 +341,7 @@ void Caches::updateExtraTaskSettingsCache()
     }
     #endif // ifdef ESP32
 
-    extraTaskSettings_cache[TaskIndex] = tmp;
+    extraTaskSettings_cache[TaskIndex] = std::move(tmp);
   }
 }
 
@@ -344,6 +382,7 @@ ExtraTaskSettingsMap::const_iterator Caches::getExtraTaskSettings(taskIndex_t Ta
 
 void Caches::clearTaskIndexFromMaps(taskIndex_t TaskIndex)
 {
+  ++taskNamesVersion;
   {
     auto it = taskIndexName.begin();
 
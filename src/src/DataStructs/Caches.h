@@ -5,6 +5,8 @@
 #include "../../ESPEasy_common.h"
 #include "../CustomBuild/ESPEasyLimits.h"
 #include "../DataStructs/ChecksumType.h"
+#include "../DataStructs/CompiledExpression.h"
+#include "../DataStructs/ExtraTaskSettingsLRU.h"
 #ifdef ESP32
 # include "../DataStructs/ControllerSettingsStruct.h"
 # include "../DataTypes/ControllerIndex.h"
@@ -12,6 +14,7 @@
 #include "../Globals/Plugins.h"
 
 #include "../Helpers/RulesHelper.h"
+#include "../Helpers/SettingsBlockCache.h"
 
 #include <map>
 
@@ -46,6 +49,10 @@ struct ExtraTaskSettings_cache_t {
   uint8_t enabledPluginStats = 0;
   #endif // if FEATURE_PLUGIN_STATS
   bool hasFormula = false;
+
+  // Only filled when hasFormula is set, one per task value.
+  // Formulas are only compiled again when changed.
+  std::vector<CompiledExpression> formulas;
 };
 
 typedef std::map<String, taskIndex_t>                    TaskIndexNameMap;
@@ -86,6 +93,11 @@ struct Caches {
   String  getTaskDeviceFormula(taskIndex_t TaskIndex,
                                uint8_t     rel_index);
 
+  // Returns nullptr when the task value has no formula.
+  // The returned pointer must not be kept, as it is invalid after the task cache is cleared.
+  CompiledExpression* getTaskDeviceFormula_compiled(taskIndex_t TaskIndex,
+                                                    uint8_t     rel_index);
+
   long    getTaskDevicePluginConfigLong(taskIndex_t TaskIndex,
                                         uint8_t     rel_index);
 
@@ -124,11 +136,20 @@ private:
 
 public:
 
+  // Incremented when task names or task value names may have changed.
+  uint32_t              taskNamesVersion = 0;
+
   TaskIndexNameMap      taskIndexName;
   TaskIndexValueNameMap taskIndexValueName;
   FilePresenceMap       fileExistsMap;
   RulesHelperClass      rulesHelper;
 
+  // Complete ExtraTaskSettings of recently loaded tasks, used by LoadTaskSettings()
+  ExtraTaskSettingsLRU  extraTaskSettingsLRU;
+  #if FEATURE_SETTINGS_WRITE_CACHE
+  SettingsBlockCacheClass settingsBlockCache;
+  #endif // if FEATURE_SETTINGS_WRITE_CACHE
+
 private:
 
   ExtraTaskSettingsMap extraTaskSettings_cache;
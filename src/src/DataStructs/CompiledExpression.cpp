@@ -0,0 +1,304 @@
+#include "../DataStructs/CompiledExpression.h"
+
+#include "../../_Plugin_Helper.h"
+
+#include "../Globals/Cache.h"
+#include "../Globals/Device.h"
+#include "../Globals/RulesCalculate.h"
+#include "../Globals/Settings.h"
+
+#include "../Helpers/ESPEasy_math.h"
+#include "../Helpers/Numerical.h"
+#include "../Helpers/StringConverter.h"
+#include "../Helpers/StringParser.h"
+
+
+CompiledExpression::CompiledExpression(const String& expression)
+{
+  setExpression(expression);
+}
+
+void CompiledExpression::setExpression(const String& expression)
+{
+  if (!_expression.equals(expression)) {
+    clear();
+    _expression        = expression;
+    _usesValue         = _expression.indexOf(F("%value%")) != -1;
+    _usesPreviousValue = _expression.indexOf(F("%pvalue%")) != -1;
+  }
+}
+
+void CompiledExpression::clear()
+{
+  _expression = String();
+  _program.clear();
+  _taskValues.clear();
+  _compiled          = false;
+  _valid             = false;
+  _usesValue         = false;
+  _usesPreviousValue = false;
+}
+
+bool CompiledExpression::canEvaluate()
+{
+  if (_expression.isEmpty()) {
+    return false;
+  }
+
+  if (!isCompiled()) {
+    compile();
+  }
+  return collectTaskValues();
+}
+
+bool CompiledExpression::collectTaskValues()
+{
+  if (!_valid || !isCompiled()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < _taskValues.size(); ++i) {
+    const TaskValueRef& ref = _taskValues[i];
+
+    // Same checks as done by formatUserVar(), which is used to parse [task#value] in the text based expression.
+    if (!Settings.TaskDeviceEnabled[ref.taskIndex]) {
+      return false;
+    }
+    const deviceIndex_t DeviceIndex = getDeviceIndex_from_TaskIndex(ref.taskIndex);
+
+    if (!validDeviceIndex(DeviceIndex) ||
+        (getValueCountForTask(ref.taskIndex) <= ref.valueIndex)) {
+      return false;
+    }
+    struct EventStruct TempEvent(ref.taskIndex);
+    const Sensor_VType sensorType = TempEvent.getSensorType();
+
+    if ((sensorType == Sensor_VType::SENSOR_TYPE_STRING) ||
+        !UserVar.isValid(ref.taskIndex, ref.valueIndex, sensorType)) {
+      return false;
+    }
+
+    uint8_t nrDecimals = 0;
+
+    if (Device[DeviceIndex].configurableDecimals()) {
+      nrDecimals = Cache.getTaskDeviceValueDecimals(ref.taskIndex, ref.valueIndex);
+    }
+    _variables[Variable::FirstTaskValue + i] = roundToDecimals(
+      UserVar.getAsDouble(ref.taskIndex, ref.valueIndex, sensorType),
+      nrDecimals);
+  }
+  return true;
+}
+
+CalculateReturnCode CompiledExpression::evaluate(
+  ESPEASY_RULES_FLOAT_TYPE  value,
+  ESPEASY_RULES_FLOAT_TYPE  previousValue,
+  ESPEASY_RULES_FLOAT_TYPE& result) const
+{
+  result = 0;
+
+  // A formatted "nan" or "inf" is not a valid token in the text based expression.
+  if ((_usesValue && !isValidDouble(value)) ||
+      (_usesPreviousValue && !isValidDouble(previousValue))) {
+    return CalculateReturnCode::ERROR_UNKNOWN_TOKEN;
+  }
+
+  // Same stack behavior as RulesCalculate_t, popping from an empty stack returns 0.
+  ESPEASY_RULES_FLOAT_TYPE stack[STACK_SIZE];
+  int sp = -1;
+
+  for (auto it = _program.begin(); it != _program.end(); ++it) {
+    ESPEASY_RULES_FLOAT_TYPE res{};
+
+    switch (it->type) {
+      case Instruction::Type::Constant:
+        res = it->value;
+        break;
+      case Instruction::Type::Variable:
+      case Instruction::Type::NegatedVariable:
+
+        if (it->arg == Variable::Value) {
+          res = value;
+        } else if (it->arg == Variable::PreviousValue) {
+          res = previousValue;
+        } else {
+          res = _variables[it->arg];
+        }
+
+        if (it->type == Instruction::Type::NegatedVariable) {
+          res = -res;
+        }
+        break;
+      case Instruction::Type::Operator:
+      {
+        const ESPEASY_RULES_FLOAT_TYPE second = (sp >= 0) ? stack[sp--] : 0;
+        const ESPEASY_RULES_FLOAT_TYPE first  = (sp >= 0) ? stack[sp--] : 0;
+        res = RulesCalculate_t::apply_operator(it->arg, first, second);
+        break;
+      }
+      case Instruction::Type::UnaryOperator:
+      {
+        const ESPEASY_RULES_FLOAT_TYPE first = (sp >= 0) ? stack[sp--] : 0;
+        res = RulesCalculate_t::apply_unary_operator(it->arg, first);
+        break;
+      }
+    }
+
+    if (sp >= (STACK_SIZE - 1)) {
+      return CalculateReturnCode::ERROR_STACK_OVERFLOW;
+    }
+    stack[++sp] = res;
+  }
+
+  if (sp >= 0) {
+    result = stack[sp];
+  }
+  return CalculateReturnCode::OK;
+}
+
+ESPEASY_RULES_FLOAT_TYPE CompiledExpression::roundToDecimals(ESPEASY_RULES_FLOAT_TYPE value, uint8_t nrDecimals)
+{
+#if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+
+  if (nrDecimals >= ESPEASY_DOUBLE_NR_DECIMALS) {
+    return value;
+  }
+#else // if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+
+  if (nrDecimals >= ESPEASY_FLOAT_NR_DECIMALS) {
+    return value;
+  }
+#endif // if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+  ESPEASY_RULES_FLOAT_TYPE factor = 1;
+
+  for (uint8_t i = 0; i < nrDecimals; ++i) {
+    factor *= 10;
+  }
+#if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+  return round(value * factor) / factor;
+#else
+  return roundf(value * factor) / factor;
+#endif
+}
+
+bool CompiledExpression::isCompiled() const
+{
+  return _compiled && (_taskNamesVersion == Cache.taskNamesVersion);
+}
+
+void CompiledExpression::compile()
+{
+  _program.clear();
+  _taskValues.clear();
+  _valid            = false;
+  _compiled         = true;
+  _taskNamesVersion = Cache.taskNamesVersion;
+
+  String expression;
+
+  {
+    // Replace [task#value] references by variable placeholders
+    int startpos     = 0;
+    int lastStartpos = 0;
+    int endpos       = 0;
+    String deviceName, valueName, format;
+
+    while (findNextDevValNameInString(_expression, startpos, endpos, deviceName, valueName, format)) {
+      if (!format.isEmpty() ||
+          ((_taskValues.size() + Variable::FirstTaskValue) >= RULES_CALCULATE_NR_VARIABLES)) {
+        return;
+      }
+      const taskIndex_t taskIndex = findTaskIndexByName(deviceName, true);
+
+      if (!validTaskIndex(taskIndex)) {
+        return;
+      }
+      const uint8_t valueIndex = findDeviceValueIndexByName(valueName, taskIndex);
+
+      if (valueIndex == VARS_PER_TASK) {
+        return;
+      }
+      TaskValueRef ref;
+      ref.taskIndex  = taskIndex;
+      ref.valueIndex = valueIndex;
+
+      expression += _expression.substring(lastStartpos, startpos);
+      expression += static_cast<char>(RULES_CALCULATE_FIRST_VARIABLE + Variable::FirstTaskValue + _taskValues.size());
+      _taskValues.push_back(ref);
+
+      lastStartpos = endpos + 1;
+      startpos     = endpos + 1;
+    }
+    expression += _expression.substring(lastStartpos);
+  }
+
+  if (_usesPreviousValue) {
+    expression.replace(F("%pvalue%"), String(static_cast<char>(RULES_CALCULATE_FIRST_VARIABLE + Variable::PreviousValue)));
+  }
+
+  if (_usesValue) {
+    expression.replace(F("%value%"), String(static_cast<char>(RULES_CALCULATE_FIRST_VARIABLE + Variable::Value)));
+  }
+
+  // Any other markup must be parsed every time the expression is evaluated.
+  if ((expression.indexOf('[') != -1) ||
+      (expression.indexOf('{') != -1) ||
+      (expression.indexOf('&') != -1)) {
+    return;
+  }
+
+  if (expression.indexOf('%') != -1) {
+    // Percent sign may also be the modulo operator
+    String tmp(expression);
+    parseSystemVariables(tmp, false);
+
+    if (!tmp.equals(expression)) {
+      return;
+    }
+  }
+
+  _valid = !isError(RulesCalculate.doCompile(RulesCalculate_t::preProces(expression).c_str(), *this));
+
+  if (!_valid) {
+    _program.clear();
+  }
+}
+
+CalculateReturnCode CompiledExpression::addToken(const char *token)
+{
+  Instruction instruction;
+
+  if (RulesCalculate_t::is_operator(token[0]) && (token[1] == 0)) {
+    instruction.type = Instruction::Type::Operator;
+    instruction.arg  = token[0];
+  } else if (RulesCalculate_t::is_unary_operator(token[0]) && (token[1] == 0)) {
+    instruction.type = Instruction::Type::UnaryOperator;
+    instruction.arg  = token[0];
+  } else if (RulesCalculate_t::is_variable(token[0]) && (token[1] == 0)) {
+    instruction.type = Instruction::Type::Variable;
+    instruction.arg  = static_cast<uint8_t>(token[0]) - RULES_CALCULATE_FIRST_VARIABLE;
+  } else if ((token[0] == '-') && RulesCalculate_t::is_variable(token[1]) && (token[2] == 0)) {
+    instruction.type = Instruction::Type::NegatedVariable;
+    instruction.arg  = static_cast<uint8_t>(token[1]) - RULES_CALCULATE_FIRST_VARIABLE;
+  } else {
+    for (const char *c = token; *c != 0; ++c) {
+      if (RulesCalculate_t::is_variable(*c)) {
+        // Variable combined with other characters, like "%value%5"
+        return CalculateReturnCode::ERROR_UNKNOWN_TOKEN;
+      }
+    }
+
+    // Same as RulesCalculate_t::RPNCalculate(), an invalid number is pushed as 0
+    validDoubleFromString(token, instruction.value);
+  }
+
+  if ((instruction.type == Instruction::Type::Variable) ||
+      (instruction.type == Instruction::Type::NegatedVariable)) {
+    if ((instruction.arg >= Variable::FirstTaskValue) &&
+        ((instruction.arg - Variable::FirstTaskValue) >= _taskValues.size())) {
+      return CalculateReturnCode::ERROR_UNKNOWN_TOKEN;
+    }
+  }
+  _program.push_back(instruction);
+  return CalculateReturnCode::OK;
+}
@@ -0,0 +1,121 @@
+#ifndef DATASTRUCTS_COMPILEDEXPRESSION_H
+#define DATASTRUCTS_COMPILEDEXPRESSION_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../DataTypes/TaskIndex.h"
+#include "../Helpers/Rules_calculate.h"
+
+#include <vector>
+
+/*********************************************************************************************\
+* Expression which is converted once into an RPN program.
+* Operands can be constants, %value%, %pvalue% or [task#value] references.
+* Evaluating the program does not need any String operations, so it is suitable for
+* expressions which are evaluated often, like task value formulas.
+*
+* Expressions containing other markup, like system variables or [var#1], cannot be compiled.
+* For those, use Calculate() on the expression after parseTemplate().
+\*********************************************************************************************/
+class CompiledExpression {
+public:
+
+  CompiledExpression() = default;
+
+  explicit CompiledExpression(const String& expression);
+
+  // Only needs to be compiled again when the expression is different.
+  void setExpression(const String& expression);
+
+  const String& getExpression() const {
+    return _expression;
+  }
+
+  bool isEmpty() const {
+    return _expression.isEmpty();
+  }
+
+  void clear();
+
+  // Compile the expression when needed and collect the current values of referenced tasks.
+  // Returns false when the expression must be evaluated using the text based Calculate().
+  bool canEvaluate();
+
+  // Collect the current values of referenced tasks, without compiling the expression.
+  // Use this to update the values when canEvaluate() already returned true before.
+  // Returns false when the expression is no longer compiled or a referenced value is not valid.
+  bool collectTaskValues();
+
+  bool usesValue() const {
+    return _usesValue;
+  }
+
+  bool usesPreviousValue() const {
+    return _usesPreviousValue;
+  }
+
+  // Must only be called after canEvaluate() returned true.
+  // value and previousValue are used for %value% and %pvalue% respectively.
+  CalculateReturnCode evaluate(ESPEASY_RULES_FLOAT_TYPE  value,
+                               ESPEASY_RULES_FLOAT_TYPE  previousValue,
+                               ESPEASY_RULES_FLOAT_TYPE& result) const;
+
+  // Round the same way as formatting the value using nrDecimals and parsing it again.
+  static ESPEASY_RULES_FLOAT_TYPE roundToDecimals(ESPEASY_RULES_FLOAT_TYPE value,
+                                                  uint8_t                  nrDecimals);
+
+private:
+
+  friend class RulesCalculate_t;
+
+  enum Variable : uint8_t {
+    Value,
+    PreviousValue,
+    FirstTaskValue // Keep as last
+  };
+
+  struct Instruction {
+    enum class Type : uint8_t {
+      Constant,
+      Variable,
+      NegatedVariable,
+      Operator,
+      UnaryOperator
+    };
+
+    ESPEASY_RULES_FLOAT_TYPE value{};
+    Type                     type = Type::Constant;
+
+    // Operator character or variable index
+    uint8_t arg = 0;
+  };
+
+  struct TaskValueRef {
+    taskIndex_t taskIndex  = INVALID_TASK_INDEX;
+    uint8_t     valueIndex = 0;
+  };
+
+  bool                isCompiled() const;
+
+  void                compile();
+
+  // Called by RulesCalculate_t::doCompile() for each RPN token.
+  CalculateReturnCode addToken(const char *token);
+
+  String _expression;
+  std::vector<Instruction> _program;
+  std::vector<TaskValueRef> _taskValues;
+
+  // Values of the referenced task values, collected in collectTaskValues()
+  ESPEASY_RULES_FLOAT_TYPE _variables[RULES_CALCULATE_NR_VARIABLES]{};
+
+  uint32_t _taskNamesVersion = 0;
+  bool     _compiled         = false;
+
+  // Whether the compiled program can be used.
+  bool _valid             = false;
+  bool _usesValue         = false;
+  bool _usesPreviousValue = false;
+};
+
+#endif // ifndef DATASTRUCTS_COMPILEDEXPRESSION_H
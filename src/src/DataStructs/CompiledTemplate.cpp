@@ -0,0 +1,197 @@
+#include "../DataStructs/CompiledTemplate.h"
+
+#include "../DataStructs/TimingStats.h"
+
+#include "../Globals/Cache.h"
+#include "../Globals/ExtraTaskSettings.h"
+#include "../Globals/Plugins_other.h"
+#include "../Globals/Settings.h"
+
+#include "../Helpers/ESPEasy_Storage.h"
+#include "../Helpers/StringConverter.h"
+#include "../Helpers/StringParser.h"
+
+
+CompiledTemplate::CompiledTemplate(const String& templateString)
+  : _template(templateString) {}
+
+void CompiledTemplate::setTemplate(const String& templateString)
+{
+  if (!_template.equals(templateString)) {
+    clear();
+    _template = templateString;
+  }
+}
+
+void CompiledTemplate::clear()
+{
+  _template = String();
+  _segments.clear();
+  _compiled       = false;
+  _needsFullParse = false;
+}
+
+String CompiledTemplate::render(uint8_t minimal_lineSize, bool useURLencode)
+{
+  if (_template.isEmpty()) {
+    String res;
+
+    parseTemplate_finalize(res, minimal_lineSize, useURLencode);
+    return res;
+  }
+
+  // Keep current loaded taskSettings to restore at the end.
+  const taskIndex_t currentTaskIndex = ExtraTaskSettings.TaskIndex;
+
+  if (!isCompiled()) {
+    compile();
+  }
+
+  if (_needsFullParse || (parseTemplate_CallBack_ptr != nullptr)) {
+    String tmpString(_template);
+    return parseTemplate_padded(tmpString, minimal_lineSize, useURLencode);
+  }
+  START_TIMER;
+
+  // First parse the literal parts, as the length of the template
+  // after parsing system variables is needed for right justified values.
+  std::vector<String> parsedLiterals;
+  int templateLength = 0;
+
+  for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+    if (it->parse) {
+      parsedLiterals.emplace_back(it->text);
+      parseSystemVariables(parsedLiterals.back(), useURLencode);
+      templateLength += parsedLiterals.back().length();
+    } else {
+      templateLength += it->length;
+    }
+  }
+
+  String newString;
+
+  newString.reserve(std::max(static_cast<int>(minimal_lineSize), templateLength));
+
+  auto parsedLiteral = parsedLiterals.begin();
+
+  for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+    switch (it->type) {
+      case Segment::Type::Literal:
+
+        if (it->parse) {
+          newString += *parsedLiteral;
+          ++parsedLiteral;
+        } else {
+          newString += it->text;
+        }
+        break;
+      case Segment::Type::TaskValue:
+
+        if (Settings.TaskDeviceEnabled[it->taskIndex]) {
+          bool   isvalid;
+          String value = formatUserVar(it->taskIndex, it->valueIndex, isvalid);
+
+          if (isvalid) {
+            // transformValue() may alter the format
+            String format(it->text);
+            transformValue(newString, minimal_lineSize, std::move(value), format, templateLength);
+          }
+        }
+        break;
+      case Segment::Type::Marker:
+      {
+        String format(it->text);
+        parseTemplate_marker(newString, minimal_lineSize, it->deviceName, it->valueName, format, templateLength);
+        break;
+      }
+    }
+  }
+
+  // Restore previous loaded taskSettings
+  if (validTaskIndex(currentTaskIndex))
+  {
+    LoadTaskSettings(currentTaskIndex);
+  }
+
+  parseTemplate_finalize(newString, minimal_lineSize, useURLencode);
+
+  STOP_TIMER(PARSE_TEMPLATE_COMPILED);
+  return newString;
+}
+
+bool CompiledTemplate::isCompiled() const
+{
+  return _compiled && (_taskNamesVersion == Cache.taskNamesVersion);
+}
+
+void CompiledTemplate::compile()
+{
+  _segments.clear();
+  _needsFullParse   = false;
+  _taskNamesVersion = Cache.taskNamesVersion;
+
+  int startpos     = 0;
+  int lastStartpos = 0;
+  int endpos       = 0;
+  String deviceName, valueName, format;
+
+  while (findNextDevValNameInString(_template, startpos, endpos, deviceName, valueName, format)) {
+    addLiteral(lastStartpos, startpos);
+
+    for (int i = startpos; i <= endpos && !_needsFullParse; ++i) {
+      const char c = _template[i];
+
+      if ((c == '%') || (c == '{') || (c == '&')) {
+        _needsFullParse = true;
+      }
+    }
+
+    Segment segment;
+    segment.length = endpos - startpos + 1;
+    segment.text   = std::move(format);
+    segment.type   = Segment::Type::Marker;
+
+    if (!equals(deviceName, F("int")) &&
+        !equals(deviceName, F("var")) &&
+        !equals(deviceName, F("plugin"))) {
+      const taskIndex_t taskIndex = findTaskIndexByName(deviceName, true);
+
+      if (validTaskIndex(taskIndex)) {
+        const uint8_t valueIndex = findDeviceValueIndexByName(valueName, taskIndex);
+
+        if (valueIndex != VARS_PER_TASK) {
+          segment.type       = Segment::Type::TaskValue;
+          segment.taskIndex  = taskIndex;
+          segment.valueIndex = valueIndex;
+        }
+      }
+    }
+
+    if (segment.type == Segment::Type::Marker) {
+      segment.deviceName = std::move(deviceName);
+      segment.valueName  = std::move(valueName);
+    }
+    _segments.push_back(std::move(segment));
+
+    lastStartpos = endpos + 1;
+    startpos     = endpos + 1;
+  }
+  addLiteral(lastStartpos, _template.length());
+  _compiled = true;
+}
+
+void CompiledTemplate::addLiteral(int start, int end)
+{
+  if (start >= end) {
+    return;
+  }
+  Segment segment;
+
+  segment.text   = _template.substring(start, end);
+  segment.length = segment.text.length();
+  segment.parse  =
+    (segment.text.indexOf('%') != -1) ||
+    (segment.text.indexOf('{') != -1) ||
+    (segment.text.indexOf('&') != -1);
+  _segments.push_back(std::move(segment));
+}
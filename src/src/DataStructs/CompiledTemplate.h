@@ -0,0 +1,80 @@
+#ifndef DATASTRUCTS_COMPILEDTEMPLATE_H
+#define DATASTRUCTS_COMPILEDTEMPLATE_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../DataTypes/TaskIndex.h"
+
+#include <vector>
+
+/*********************************************************************************************\
+* Template which is parsed once into literal parts and [task#value#format] references.
+* Rendering gives the same result as parseTemplate_padded() on the same template string,
+* without searching for markers and looking up task and value names on every call.
+* The template is compiled again when task names or task value names may have changed.
+\*********************************************************************************************/
+struct CompiledTemplate {
+  CompiledTemplate() = default;
+
+  explicit CompiledTemplate(const String& templateString);
+
+  // Only needs to be compiled again when the template is different.
+  void setTemplate(const String& templateString);
+
+  const String& getTemplate() const {
+    return _template;
+  }
+
+  bool isEmpty() const {
+    return _template.isEmpty();
+  }
+
+  void   clear();
+
+  String render(uint8_t minimal_lineSize = 0,
+                bool    useURLencode     = false);
+
+private:
+
+  struct Segment {
+    enum class Type : uint8_t {
+      Literal,   // Plain text, may contain system variables
+      TaskValue, // [task#value#format] with task and value index already resolved
+      Marker     // Any other [...#...], like [var#1] or [plugin#gpio#pinstate#1]
+    };
+
+    // Literal text or format of the marker
+    String text;
+
+    // Only used for Type::Marker, stored in lower case
+    String deviceName;
+    String valueName;
+
+    // Length of the original marker, or of the literal text.
+    uint16_t    length     = 0;
+    taskIndex_t taskIndex  = INVALID_TASK_INDEX;
+    uint8_t     valueIndex = 0;
+    Type        type       = Type::Literal;
+
+    // Literal text may contain system variables or special characters.
+    bool        parse = false;
+  };
+
+  bool isCompiled() const;
+
+  void compile();
+
+  void addLiteral(int start,
+                  int end);
+
+  String _template;
+  std::vector<Segment> _segments;
+  uint32_t _taskNamesVersion = 0;
+  bool _compiled             = false;
+
+  // Markers containing characters which may be changed by parsing system variables
+  // or special characters. These templates are rendered using parseTemplate_padded().
+  bool _needsFullParse = false;
+};
+
+#endif // ifndef DATASTRUCTS_COMPILEDTEMPLATE_H
@@ -72,6 +72,8 @@ struct ControllerSettingsStruct
     CONTROLLER_FULL_QUEUE_ACTION,
     CONTROLLER_ALLOW_EXPIRE,
     CONTROLLER_DEDUPLICATE,
+    CONTROLLER_SEND_BATCH,
+    CONTROLLER_SPILL_TO_FLASH,
     CONTROLLER_USE_LOCAL_SYSTEM_TIME,
     CONTROLLER_CHECK_REPLY,
     CONTROLLER_CLIENT_ID,
@@ -155,6 +157,12 @@ struct ControllerSettingsStruct
   bool         useLocalSystemTime() const { return VariousBits1.useLocalSystemTime; }
   void         useLocalSystemTime(bool value) { VariousBits1.useLocalSystemTime = value; }
 
+  bool         sendBatch() const { return VariousBits1.sendBatch; }
+  void         sendBatch(bool value) { VariousBits1.sendBatch = value; }
+
+  bool         spillToFlash() const { return VariousBits1.spillToFlash; }
+  void         spillToFlash(bool value) { VariousBits1.spillToFlash = value; }
+
   bool         UseDNS;
   uint8_t      IP[4];
   unsigned int Port;
@@ -186,8 +194,8 @@ struct ControllerSettingsStruct
       uint32_t allowExpire                      : 1; // Bit 09
       uint32_t deduplicate                      : 1; // Bit 10
       uint32_t useLocalSystemTime               : 1; // Bit 11
-      uint32_t unused_12                        : 1; // Bit 12
-      uint32_t unused_13                        : 1; // Bit 13
+      uint32_t sendBatch                        : 1; // Bit 12
+      uint32_t spillToFlash                     : 1; // Bit 13
       uint32_t unused_14                        : 1; // Bit 14
       uint32_t unused_15                        : 1; // Bit 15
       uint32_t unused_16                        : 1; // Bit 16
@@ -50,6 +50,10 @@ struct ControllerCache_struct {
 
   void   setPeekFilePos(int peekFileNr, int peekReadPos);
 
+  // Set the peek position to the first sample at or after fromTime.
+  bool   setPeekFilePosByTime(uint32_t    fromTime,
+                              taskIndex_t taskIndex = INVALID_TASK_INDEX);
+
   // Read data without marking it as being read.
   bool   peek(uint8_t     *data,
               unsigned int size) const;
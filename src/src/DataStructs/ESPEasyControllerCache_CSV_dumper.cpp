@@ -5,9 +5,12 @@
 
 # include "../Globals/C016_ControllerCache.h"
 # include "../Globals/MQTT.h"
+# include "../Globals/TXBuffer.h"
 
 # include "../../_Plugin_Helper.h"
 
+# include <algorithm>
+
 void ESPEasyControllerCache_CSV_element::markBegin()
 {
   line.clear();
@@ -29,17 +32,15 @@ ESPEasyControllerCache_CSV_dumper::ESPEasyControllerCache_CSV_dumper(bool joinTi
   : _joinTimestamp(joinTimestamp), _onlySetTasks(onlySetTasks), _separator(separator), _target(target)
 {
   // Initialize arrays
-  const String sep_zero = String(separator);
-
   constexpr size_t nrTaskValues = VARS_PER_TASK * TASKS_MAX;
 
   for (size_t i = 0; i < nrTaskValues; ++i) {
-    _csv_values[i] = sep_zero;
     _nrDecimals[i] = Cache.getTaskDeviceValueDecimals(i / VARS_PER_TASK, i % VARS_PER_TASK);
   }
 
   for (size_t task = 0; validTaskIndex(task); ++task) {
     _includeTask[task] = _onlySetTasks ? validPluginID(Settings.getPluginID_for_task(task)) : true;
+    _sensorTypes[task] = Sensor_VType::SENSOR_TYPE_NONE;
   }
 
   if (_target == Target::CSV_file) {
@@ -49,7 +50,6 @@ ESPEasyControllerCache_CSV_dumper::ESPEasyControllerCache_CSV_dumper(bool joinTi
     // Set peek file position to first entry:
     ControllerCache.setPeekFilePos(0, 0);
   }
-  C016_flush();
 }
 
 ESPEasyControllerCache_CSV_dumper::~ESPEasyControllerCache_CSV_dumper() {
@@ -81,6 +81,17 @@ uint32_t ESPEasyControllerCache_CSV_dumper::writeToTarget(const char& c, bool se
   return 1;
 }
 
+uint32_t ESPEasyControllerCache_CSV_dumper::writeToTarget(const char *buf, size_t length, bool send) const {
+  if (send) {
+    if (_target == Target::CSV_file) {
+      TXBuffer.addBuffer(buf, length);
+    } else {
+      MQTTclient.write(reinterpret_cast<const uint8_t *>(buf), length);
+    }
+  }
+  return length;
+}
+
 size_t ESPEasyControllerCache_CSV_dumper::generateCSVHeader(bool send) const
 {
   size_t count = 0;
@@ -96,6 +107,10 @@ size_t ESPEasyControllerCache_CSV_dumper::generateCSVHeader(bool send) const
   // TaskIndex and Plugin ID will be a list of numbers when lines are joined.
   header += F(";taskindex;plugin ID");
 
+  if (_includePosition) {
+    header += F(";next position");
+  }
+
   if (_separator != ';') { header.replace(';', _separator); }
   count += writeToTarget(header, send);
 
@@ -121,127 +136,286 @@ size_t ESPEasyControllerCache_CSV_dumper::generateCSVHeader(bool send) const
 bool ESPEasyControllerCache_CSV_dumper::createCSVLine()
 {
   _outputLine.markBegin();
-
-
-  uint32_t lastTimestamp   = 0;
-  uint32_t csv_values_left = 0;
-
-  _taskIndex_str.clear();
-  _pluginID_str.clear();
-
+  _nrJoinedSamples = 0;
 
   // Fetch samples from Cache Controller bin files.
   if (_element_processed) {
-    if (!C016_getTaskSample(_element)) {
-      return !_outputLine.line.isEmpty();
+    if (!readSample()) {
+      return false;
     }
-    _outputLine.markEnd();
     _element_processed = false;
   }
 
   while (!_element_processed) {
-    if (!_joinTimestamp || (lastTimestamp != static_cast<uint32_t>(_element.unixTime))) {
-      // Flush the collected CSV values
-      if (csv_values_left > 0) {
-        flushValuesLeft(csv_values_left);
-        return !_outputLine.line.isEmpty();
-      }
-
-      // Start writing a new line in the CSV file
-      // Begin with the non taskvalues
-      _outputLine.line += _element.unixTime;
-      _outputLine.line += _separator;
-      struct tm ts;
-      breakTime(_element.unixTime, ts);
-      _outputLine.line += formatDateTimeString(ts);
-
-      if (!_joinTimestamp) {
-        _outputLine.line += _separator;
-        _outputLine.line += _element.TaskIndex;
-        _outputLine.line += _separator;
-        _outputLine.line += _element.pluginID.value;
-      }
-
-      lastTimestamp = static_cast<uint32_t>(_element.unixTime);
+    if ((_nrJoinedSamples != 0) &&
+        (!_joinTimestamp ||
+         (_lineTimestamp != static_cast<uint32_t>(_element.unixTime)) ||
+         (_nrJoinedSamples >= CSV_DUMPER_MAX_JOINED_SAMPLES))) {
+      // Sample belongs to the next line
+      break;
     }
 
-    if (validTaskIndex(_element.TaskIndex)) {
-      // Collect the task values for this row in the CSV
-      size_t valindex = _element.TaskIndex * VARS_PER_TASK;
-
-      for (size_t i = 0; i < VARS_PER_TASK; ++i) {
-        _csv_values[valindex] = _separator;
-
-        if (isFloatOutputDataType(_element.sensorType)) {
-          const float value = _element.values.getFloat(i);
-
-          if (essentiallyZero(value)) {
-            _csv_values[valindex] += '0';
-          } else {
-            _csv_values[valindex] += toString(value, static_cast<unsigned int>(_nrDecimals[valindex]));
-          }
-        } else {
-          const String formatted = _element.values.getAsString(i, _element.sensorType, _nrDecimals[valindex]);
-
-          if (formatted.isEmpty()) {
-            _csv_values[valindex] += '0';
-          }
-          else {
-            _csv_values[valindex] += formatted;
-          }
-        }
-        ++valindex;
-      }
+    if (_nrJoinedSamples == 0) {
+      _lineTimestamp = static_cast<uint32_t>(_element.unixTime);
+    }
 
-      if (_joinTimestamp) {
-        if (!_taskIndex_str.isEmpty()) { _taskIndex_str += '/'; }
+    // Keep the task values for this row in the CSV
+    _values[_element.TaskIndex]      = _element.values;
+    _sensorTypes[_element.TaskIndex] = _element.sensorType;
 
-        if (!_pluginID_str.isEmpty()) { _pluginID_str += '/'; }
+    _joinedTaskIndex[_nrJoinedSamples] = _element.TaskIndex;
+    _joinedPluginID[_nrJoinedSamples]  = _element.pluginID.value;
+    ++_nrJoinedSamples;
 
-        _taskIndex_str += _element.TaskIndex;
-        _pluginID_str  += _element.pluginID.value;
-      }
-      ++csv_values_left;
-    }
     _outputLine.markEnd();
-    _element_processed = !C016_getTaskSample(_element);
+    _element_processed = !readSample();
   }
 
-  if (csv_values_left > 0) {
-    flushValuesLeft(csv_values_left);
+  if (_target == Target::MQTT) {
+    // Line length must be known before sending
+    formatCSVLine(&_outputLine.line, false);
   }
-  return !_outputLine.line.isEmpty();
+  return _nrJoinedSamples != 0;
 }
 
-void ESPEasyControllerCache_CSV_dumper::setPeekFilePos(int peekFileNr, int peekReadPos)
+size_t ESPEasyControllerCache_CSV_dumper::writeCSVLine(bool send) const
 {
+  if (_target == Target::MQTT) {
+    return writeToTarget(_outputLine.line, send);
+  }
+  return formatCSVLine(nullptr, send);
+}
+
+bool ESPEasyControllerCache_CSV_dumper::setPeekFilePos(int peekFileNr, int peekReadPos)
+{
+  // Must be the start of a sample
+  if ((peekFileNr < 0) || (peekReadPos < 0) ||
+      ((peekReadPos % sizeof(C016_binary_element)) != 0)) {
+    return false;
+  }
+
   ControllerCache.setPeekFilePos(peekFileNr, peekReadPos);
-  _element_processed = true;
+
+  // The cache moves the position when the file no longer exists or is shorter.
+  int fileNr        = 0;
+  const int readPos = ControllerCache.getPeekFilePos(fileNr);
+
+  if ((fileNr != peekFileNr) || (readPos != peekReadPos)) {
+    return false;
+  }
+
+  seedValues(peekFileNr, peekReadPos);
+
+  ControllerCache.setPeekFilePos(peekFileNr, peekReadPos);
+  _element_processed    = true;
+  _outputLine.endFileNr = 0;
+  _outputLine.endPos    = 0;
+  return true;
 }
 
-void ESPEasyControllerCache_CSV_dumper::flushValuesLeft(uint32_t csv_values_left)
+void ESPEasyControllerCache_CSV_dumper::seedValues(int peekFileNr, int peekReadPos)
 {
+  // Timestamp of the first sample to export
+  if (!readSample()) {
+    return;
+  }
+  const uint32_t resumeTime = static_cast<uint32_t>(_element.unixTime);
+
+  // Largest interval of the included tasks, in seconds
+  uint32_t interval = 0;
+
+  for (taskIndex_t task = 0; task < TASKS_MAX; ++task) {
+    if (_includeTask[task] && Settings.TaskDeviceEnabled[task]) {
+      interval = std::max(interval, static_cast<uint32_t>(Settings.TaskDeviceTimer[task]));
+    }
+  }
+
+  if ((interval == 0) ||
+      !ControllerCache.setPeekFilePosByTime((resumeTime > interval) ? resumeTime - interval : 0)) {
+    return;
+  }
+
+  size_t nrSamples = 0;
+
+  while (true) {
+    int fileNr        = 0;
+    const int readPos = ControllerCache.getPeekFilePos(fileNr);
+
+    if ((fileNr > peekFileNr) ||
+        ((fileNr == peekFileNr) && (readPos >= peekReadPos)) ||
+        !C016_getTaskSample(_element)) {
+      return;
+    }
+
+    if (validTaskIndex(_element.TaskIndex)) {
+      _values[_element.TaskIndex]      = _element.values;
+      _sensorTypes[_element.TaskIndex] = _element.sensorType;
+    }
+
+    if ((++nrSamples % 16) == 0) {
+      delay(0);
+    }
+  }
+}
+
+bool ESPEasyControllerCache_CSV_dumper::readSample()
+{
+  while (C016_getTaskSample(_element)) {
+    if (validTaskIndex(_element.TaskIndex)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t ESPEasyControllerCache_CSV_dumper::formatCSVLine(String *line, bool send) const
+{
+  if (_nrJoinedSamples == 0) { return 0; }
+
+  // Large enough for a float with 16 decimals or a date/time string
+  char   buf[64];
+  size_t count = 0;
+
+  auto append = [&](size_t length) {
+    if (line != nullptr) {
+      *line += buf;
+    } else {
+      count += writeToTarget(buf, length, send);
+    }
+  };
+  auto appendChar = [&](char c) {
+    buf[0] = c;
+    buf[1] = '\0';
+    append(1);
+  };
+
+  // Begin with the non taskvalues
+  append(snprintf_P(buf, sizeof(buf), PSTR("%u"), static_cast<unsigned int>(_lineTimestamp)));
+  appendChar(_separator);
+  {
+    struct tm ts;
+    breakTime(_lineTimestamp, ts);
+    append(snprintf_P(buf, sizeof(buf), PSTR("%4d-%02d-%02d %02d:%02d:%02d"),
+                      1900 + ts.tm_year, ts.tm_mon + 1, ts.tm_mday,
+                      ts.tm_hour, ts.tm_min, ts.tm_sec));
+  }
+
   if (_joinTimestamp) {
-    _outputLine.line += _separator;
-    _outputLine.line += csv_values_left; // Add column with nr of joined samples
-    _outputLine.line += _separator;
-    _outputLine.line += _taskIndex_str;
-    _outputLine.line += _separator;
-    _outputLine.line += _pluginID_str;
+    // Add column with nr of joined samples
+    appendChar(_separator);
+    append(snprintf_P(buf, sizeof(buf), PSTR("%u"), _nrJoinedSamples));
   }
 
-  constexpr size_t nrTaskValues = VARS_PER_TASK * TASKS_MAX;
+  // TaskIndex and Plugin ID are a list of numbers when lines are joined.
+  appendChar(_separator);
 
-  for (size_t i = 0; i < nrTaskValues; ++i) {
-    if (_includeTask[i / VARS_PER_TASK]) {
-      _outputLine.line += _csv_values[i];
+  for (uint8_t i = 0; i < _nrJoinedSamples; ++i) {
+    append(snprintf_P(buf, sizeof(buf), (i == 0) ? PSTR("%u") : PSTR("/%u"), _joinedTaskIndex[i]));
+  }
+  appendChar(_separator);
+
+  for (uint8_t i = 0; i < _nrJoinedSamples; ++i) {
+    append(snprintf_P(buf, sizeof(buf), (i == 0) ? PSTR("%u") : PSTR("/%u"), _joinedPluginID[i]));
+  }
+
+  if (_includePosition) {
+    appendChar(_separator);
+    append(snprintf_P(buf, sizeof(buf), PSTR("%d_%d"), _outputLine.endFileNr, _outputLine.endPos));
+  }
+
+  for (taskIndex_t task = 0; task < TASKS_MAX; ++task) {
+    if (_includeTask[task]) {
+      for (uint8_t varNr = 0; varNr < VARS_PER_TASK; ++varNr) {
+        appendChar(_separator);
+
+        if (_sensorTypes[task] != Sensor_VType::SENSOR_TYPE_NONE) {
+          append(formatValue(buf, sizeof(buf), task, varNr));
+        }
+      }
     }
   }
 
   if (_target == Target::CSV_file) {
-    _outputLine.line += '\r';
-    _outputLine.line += '\n';
+    appendChar('\r');
+    appendChar('\n');
+  }
+  return (line != nullptr) ? line->length() : count;
+}
+
+size_t ESPEasyControllerCache_CSV_dumper::formatValue(char *buf, size_t bufSize, taskIndex_t taskIndex, uint8_t varNr) const
+{
+  const TaskValues_Data_t& values    = _values[taskIndex];
+  const Sensor_VType       sensorType = _sensorTypes[taskIndex];
+
+  // Max. 39 digits for a float, minus sign, dot and decimals.
+  constexpr unsigned int maxDecimals = 16;
+  const unsigned int     nrDecimals  = std::min(
+    static_cast<unsigned int>(_nrDecimals[taskIndex * VARS_PER_TASK + varNr]),
+    maxDecimals);
+
+  buf[0] = '\0';
+
+  if (isFloatOutputDataType(sensorType)) {
+    const float value = values.getFloat(varNr);
+
+    if (!essentiallyZero(value)) {
+      dtostrf(value, 0, nrDecimals, buf);
+    }
+  #if FEATURE_EXTENDED_TASK_VALUE_TYPES
+  } else if (isDoubleOutputDataType(sensorType)) {
+    // Stored as double, also when rules do not use double as float type
+    double value{};
+
+    if (varNr < (VARS_PER_TASK / 2)) {
+      memcpy(&value, &values.binary[varNr * sizeof(double)], sizeof(double));
+    }
+
+    if ((value > 1e32) || (value < -1e32)) {
+      // Would not fit in buf
+      strncpy(buf, doubleToString(value, nrDecimals).c_str(), bufSize - 1);
+      buf[bufSize - 1] = '\0';
+    } else if (!essentiallyZero(value)) {
+      dtostrf(value, 0, nrDecimals, buf);
+    }
+  } else if (isUInt32OutputDataType(sensorType)) {
+    snprintf_P(buf, bufSize, PSTR("%u"), static_cast<unsigned int>(values.getUint32(varNr)));
+  } else if (isInt32OutputDataType(sensorType)) {
+    snprintf_P(buf, bufSize, PSTR("%d"), static_cast<int>(values.getInt32(varNr)));
+  } else if (isUInt64OutputDataType(sensorType) || isInt64OutputDataType(sensorType)) {
+    // printf support for 64 bit integers is not available on all platforms
+    const int64_t signedValue = values.getInt64(varNr);
+    const bool    negative    = isInt64OutputDataType(sensorType) && (signedValue < 0);
+    uint64_t value            = negative
+      ? (0 - static_cast<uint64_t>(signedValue))
+      : values.getUint64(varNr);
+
+    char  tmp[21];
+    char *pos = tmp + sizeof(tmp);
+
+    do {
+      *(--pos) = '0' + (value % 10);
+      value   /= 10;
+    } while (value != 0);
+    size_t length = 0;
+
+    if (negative) {
+      buf[length++] = '-';
+    }
+
+    while (pos < tmp + sizeof(tmp)) {
+      buf[length++] = *(pos++);
+    }
+    buf[length] = '\0';
+  #endif // if FEATURE_EXTENDED_TASK_VALUE_TYPES
+  } else if (sensorType == Sensor_VType::SENSOR_TYPE_ULONG) {
+    snprintf_P(buf, bufSize, PSTR("%lu"), values.getSensorTypeLong());
+  }
+
+  if (buf[0] == '\0') {
+    buf[0] = '0';
+    buf[1] = '\0';
   }
+  return strlen(buf);
 }
 
 #endif // if FEATURE_RTC_CACHE_STORAGE
@@ -7,6 +7,9 @@
 #if FEATURE_RTC_CACHE_STORAGE
 
 # include "../ControllerQueue/C016_queue_element.h"
+# include "../DataTypes/SensorVType.h"
+# include "../DataTypes/TaskIndex.h"
+# include "../DataTypes/TaskValues_Data.h"
 
 struct ESPEasyControllerCache_CSV_element {
   void markBegin();
@@ -19,6 +22,17 @@ struct ESPEasyControllerCache_CSV_element {
   int    endPos      = 0;
 };
 
+// Max. number of samples joined in a single CSV line
+# ifndef CSV_DUMPER_MAX_JOINED_SAMPLES
+#  define CSV_DUMPER_MAX_JOINED_SAMPLES  (2 * TASKS_MAX)
+# endif // ifndef CSV_DUMPER_MAX_JOINED_SAMPLES
+
+/*********************************************************************************************\
+* Export the samples of the Cache Controller as CSV.
+* Only the last sample of each task is kept in binary form.
+* For the CSV_file target, lines are formatted using fixed size buffers straight into the TXBuffer.
+* For the MQTT target, the line is kept as String, as the length is needed before sending.
+\*********************************************************************************************/
 struct ESPEasyControllerCache_CSV_dumper {
   enum class Target {
     CSV_file,
@@ -32,6 +46,12 @@ struct ESPEasyControllerCache_CSV_dumper {
 
   ~ESPEasyControllerCache_CSV_dumper();
 
+  // Add a column with the peek position following the line.
+  // Can be used to resume an interrupted export via setPeekFilePos()
+  void   setIncludePosition(bool includePosition) {
+    _includePosition = includePosition;
+  }
+
   size_t generateCSVHeader(bool send) const;
 
   bool   createCSVLine();
@@ -44,12 +64,13 @@ struct ESPEasyControllerCache_CSV_dumper {
     return _outputLine;
   }
 
-  size_t writeCSVLine(bool send) const {
-    return writeToTarget(_outputLine.line, send);
-  }
+  size_t writeCSVLine(bool send) const;
 
-  void setPeekFilePos(int peekFileNr,
-                      int peekReadPos);
+  // Continue at the given position, e.g. to resume an interrupted export.
+  // The last values of each task are restored by scanning back one task interval.
+  // Return false when the position is not the start of a sample present in the cache.
+  bool   setPeekFilePos(int peekFileNr,
+                        int peekReadPos);
 
 private:
 
@@ -59,19 +80,48 @@ private:
   uint32_t writeToTarget(const char& c,
                          bool        send = true) const;
 
-  void     flushValuesLeft(uint32_t csv_values_left);
+  uint32_t writeToTarget(const char *buf,
+                         size_t      length,
+                         bool        send) const;
+
+  // Format the current line to the target, or append to line when not nullptr.
+  size_t   formatCSVLine(String *line,
+                         bool    send) const;
+
+  // Read the next sample with a valid task index.
+  bool     readSample();
+
+  // Fill the last values of each task with the samples stored within one task interval
+  // before the given position.
+  void     seedValues(int peekFileNr,
+                      int peekReadPos);
+
+  // Format a task value into buf, return the length.
+  size_t   formatValue(char       *buf,
+                       size_t      bufSize,
+                       taskIndex_t taskIndex,
+                       uint8_t     varNr) const;
+
+  // Last received sample of each task
+  TaskValues_Data_t _values[TASKS_MAX];
+  Sensor_VType      _sensorTypes[TASKS_MAX];
 
-  String  _csv_values[VARS_PER_TASK * TASKS_MAX];
   uint8_t _nrDecimals[VARS_PER_TASK * TASKS_MAX] = { 0 };
   bool    _includeTask[TASKS_MAX]                = { 0 };
   bool    _joinTimestamp                         = true;
   bool    _onlySetTasks                          = true;
+  bool    _includePosition                       = false;
   char    _separator                             = ',';
 
   C016_binary_element                _element;
   bool                               _element_processed = true;
   ESPEasyControllerCache_CSV_element _outputLine;
-  String                             _taskIndex_str, _pluginID_str;
+
+  // Samples included in the current line
+  uint32_t    _lineTimestamp   = 0;
+  uint8_t     _nrJoinedSamples = 0;
+  taskIndex_t _joinedTaskIndex[CSV_DUMPER_MAX_JOINED_SAMPLES] = { 0 };
+  uint8_t     _joinedPluginID[CSV_DUMPER_MAX_JOINED_SAMPLES]  = { 0 };
 
 
   int _backup_peekFileNr  = 0;
@@ -0,0 +1,385 @@
+#include "../DataStructs/ESPEasyControllerCache_block.h"
+
+#if FEATURE_C016_COMPRESSED_CACHE
+
+static_assert(TASKS_MAX <= 32,                    "taskBitmap of ESPEasyControllerCache_block_header too small");
+static_assert(sizeof(TaskValues_Data_t) % 4 == 0, "TaskValues_Data_t must be compressed as uint32_t words");
+static_assert(sizeof(ESPEasyControllerCache_block_header) == 20, "Stored format of ESPEasyControllerCache_block_header changed");
+
+# define CONTROLLER_CACHE_BLOCK_NR_WORDS  (sizeof(TaskValues_Data_t) / sizeof(uint32_t))
+
+bool ESPEasyControllerCache_block_header::isValid() const
+{
+  return magic == CONTROLLER_CACHE_BLOCK_MAGIC &&
+         nrSamples != 0 &&
+         startTime <= endTime;
+}
+
+bool ESPEasyControllerCache_block_header::containsTask(taskIndex_t taskIndex) const
+{
+  if (!validTaskIndex(taskIndex)) {
+    return false;
+  }
+  return (taskBitmap & (1ul << taskIndex)) != 0;
+}
+
+bool ESPEasyControllerCache_block_header::overlaps(uint32_t from, uint32_t to) const
+{
+  return endTime >= from && startTime <= to;
+}
+
+/*********************************************************************************************\
+* Bit stream, most significant bit first
+\*********************************************************************************************/
+struct CacheBlock_BitWriter {
+  explicit CacheBlock_BitWriter(std::vector<uint8_t>& output) : _output(output) {}
+
+  void write(uint32_t value, uint8_t nrBits)
+  {
+    while (nrBits > 0) {
+      if (_bitPos == 0) {
+        _output.push_back(0);
+      }
+      --nrBits;
+
+      if ((value >> nrBits) & 1) {
+        _output.back() |= (0x80 >> _bitPos);
+      }
+      _bitPos = (_bitPos + 1) & 7;
+    }
+  }
+
+  std::vector<uint8_t>& _output;
+  uint8_t               _bitPos = 0;
+};
+
+struct CacheBlock_BitReader {
+  CacheBlock_BitReader(const uint8_t *data, size_t size) : _data(data), _nrBits(size * 8) {}
+
+  // Return false when reading beyond the end of the data.
+  bool read(uint32_t& value, uint8_t nrBits)
+  {
+    if ((_pos + nrBits) > _nrBits) {
+      return false;
+    }
+    value = 0;
+
+    while (nrBits > 0) {
+      --nrBits;
+      value <<= 1;
+
+      if (_data[_pos >> 3] & (0x80 >> (_pos & 7))) {
+        value |= 1;
+      }
+      ++_pos;
+    }
+    return true;
+  }
+
+  const uint8_t *_data;
+  size_t         _nrBits;
+  size_t         _pos = 0;
+};
+
+/*********************************************************************************************\
+* State per task, as the samples of several tasks are interleaved.
+\*********************************************************************************************/
+struct CacheBlock_TaskState {
+  uint32_t     words[CONTROLLER_CACHE_BLOCK_NR_WORDS]{};
+  uint8_t      leading[CONTROLLER_CACHE_BLOCK_NR_WORDS]{};
+  uint8_t      trailing[CONTROLLER_CACHE_BLOCK_NR_WORDS]{};
+  pluginID_t   pluginID{ INVALID_PLUGIN_ID };
+  Sensor_VType sensorType{ Sensor_VType::SENSOR_TYPE_NONE };
+  uint8_t      valueCount{};
+  bool         hasMeta   = false;
+  bool         hasWindow[CONTROLLER_CACHE_BLOCK_NR_WORDS]{};
+};
+
+// Last entry is used for samples with an invalid task index.
+static uint8_t getTaskStateIndex(taskIndex_t taskIndex)
+{
+  return validTaskIndex(taskIndex) ? taskIndex : TASKS_MAX;
+}
+
+// Delta-of-delta buckets, like used in Gorilla: '0', '10', '110', '1110' and '1111' prefix.
+static const uint8_t timestamp_bucket_bits[] = { 7, 9, 12 };
+
+static bool fitsSigned(int32_t value, uint8_t nrBits)
+{
+  const int32_t limit = 1l << (nrBits - 1);
+
+  return value >= -limit && value < limit;
+}
+
+static uint8_t countLeadingZeros(uint32_t value)
+{
+  return value == 0 ? 32 : __builtin_clz(value);
+}
+
+static uint8_t countTrailingZeros(uint32_t value)
+{
+  return value == 0 ? 32 : __builtin_ctz(value);
+}
+
+bool ESPEasyControllerCache_block::encode(const uint8_t        *samples,
+                                          uint16_t              nrSamples,
+                                          std::vector<uint8_t>& block)
+{
+  block.clear();
+
+  if ((samples == nullptr) || (nrSamples == 0)) {
+    return false;
+  }
+  ESPEasyControllerCache_block_header header;
+
+  header.nrSamples = nrSamples;
+  header.startTime = UINT32_MAX;
+
+  std::vector<CacheBlock_TaskState> states;
+
+  states.resize(TASKS_MAX + 1);
+  block.resize(sizeof(header));
+  block.reserve(sizeof(header) + nrSamples * sizeof(C016_binary_element) / 2);
+
+  CacheBlock_BitWriter writer(block);
+
+  uint32_t    prevTime  = 0;
+  int32_t     prevDelta = 0;
+  taskIndex_t prevTask  = INVALID_TASK_INDEX;
+
+  for (uint16_t i = 0; i < nrSamples; ++i) {
+    C016_binary_element sample;
+    memcpy(&sample, samples + (i * sizeof(C016_binary_element)), sizeof(C016_binary_element));
+    const uint32_t unixTime = sample.unixTime;
+
+    if (unixTime < header.startTime) { header.startTime = unixTime; }
+
+    if (unixTime > header.endTime) { header.endTime = unixTime; }
+
+    if (validTaskIndex(sample.TaskIndex)) {
+      header.taskBitmap |= (1ul << sample.TaskIndex);
+    }
+
+    // Timestamp
+    {
+      // Use unsigned arithmetic, as signed overflow is undefined.
+      const int32_t delta = static_cast<int32_t>(unixTime - prevTime);
+      const int32_t dod   = static_cast<int32_t>(static_cast<uint32_t>(delta) - static_cast<uint32_t>(prevDelta));
+
+      if (dod == 0) {
+        writer.write(0, 1);
+      } else {
+        uint8_t bucket = 0;
+
+        while (bucket < NR_ELEMENTS(timestamp_bucket_bits) &&
+               !fitsSigned(dod, timestamp_bucket_bits[bucket])) {
+          ++bucket;
+        }
+
+        // Prefix of (bucket + 1) ones, followed by a 0 except for the last bucket
+        writer.write(0xFF, bucket + 1);
+
+        if (bucket < NR_ELEMENTS(timestamp_bucket_bits)) {
+          writer.write(0, 1);
+          writer.write(static_cast<uint32_t>(dod), timestamp_bucket_bits[bucket]);
+        } else {
+          writer.write(static_cast<uint32_t>(dod), 32);
+        }
+      }
+      prevTime  = unixTime;
+      prevDelta = delta;
+    }
+
+    // TaskIndex
+    if (sample.TaskIndex == prevTask) {
+      writer.write(0, 1);
+    } else {
+      writer.write(1, 1);
+      writer.write(sample.TaskIndex, 8);
+      prevTask = sample.TaskIndex;
+    }
+
+    CacheBlock_TaskState& state = states[getTaskStateIndex(sample.TaskIndex)];
+
+    // pluginID, sensorType and valueCount
+    if (state.hasMeta &&
+        (state.pluginID == sample.pluginID) &&
+        (state.sensorType == sample.sensorType) &&
+        (state.valueCount == sample.valueCount)) {
+      writer.write(0, 1);
+    } else {
+      writer.write(1, 1);
+      writer.write(sample.pluginID.value,                     8);
+      writer.write(static_cast<uint8_t>(sample.sensorType),   8);
+      writer.write(sample.valueCount,                         8);
+      state.pluginID   = sample.pluginID;
+      state.sensorType = sample.sensorType;
+      state.valueCount = sample.valueCount;
+      state.hasMeta    = true;
+    }
+
+    // Task values
+    for (size_t w = 0; w < CONTROLLER_CACHE_BLOCK_NR_WORDS; ++w) {
+      uint32_t word;
+      memcpy(&word, sample.values.binary + (w * sizeof(uint32_t)), sizeof(uint32_t));
+      const uint32_t xored = word ^ state.words[w];
+
+      state.words[w] = word;
+
+      if (xored == 0) {
+        writer.write(0, 1);
+        continue;
+      }
+      writer.write(1, 1);
+      uint8_t leading        = countLeadingZeros(xored);
+      const uint8_t trailing = countTrailingZeros(xored);
+
+      if (leading > 31) { leading = 31; }
+
+      if (state.hasWindow[w] &&
+          (leading >= state.leading[w]) &&
+          (trailing >= state.trailing[w])) {
+        // Meaningful bits fit in the window of the previous value
+        writer.write(0, 1);
+        writer.write(xored >> state.trailing[w], 32 - state.leading[w] - state.trailing[w]);
+      } else {
+        const uint8_t nrBits = 32 - leading - trailing;
+        writer.write(1,          1);
+        writer.write(leading,    5);
+        writer.write(nrBits - 1, 5);
+        writer.write(xored >> trailing, nrBits);
+        state.leading[w]   = leading;
+        state.trailing[w]  = trailing;
+        state.hasWindow[w] = true;
+      }
+    }
+  }
+
+  const size_t payloadSize = block.size() - sizeof(header);
+
+  if (payloadSize > 0xFFFF) {
+    block.clear();
+    return false;
+  }
+  header.payloadSize = payloadSize;
+  memcpy(&block[0], &header, sizeof(header));
+  return true;
+}
+
+bool ESPEasyControllerCache_block::decode(const ESPEasyControllerCache_block_header& header,
+                                          const uint8_t                            *payload,
+                                          std::vector<C016_binary_element>         & samples)
+{
+  samples.clear();
+
+  if (!header.isValid() || (payload == nullptr)) {
+    return false;
+  }
+  samples.resize(header.nrSamples);
+
+  std::vector<CacheBlock_TaskState> states;
+
+  states.resize(TASKS_MAX + 1);
+
+  CacheBlock_BitReader reader(payload, header.payloadSize);
+
+  uint32_t    prevTime  = 0;
+  int32_t     prevDelta = 0;
+  taskIndex_t prevTask  = INVALID_TASK_INDEX;
+  uint32_t    bits      = 0;
+
+  for (uint16_t i = 0; i < header.nrSamples; ++i) {
+    C016_binary_element& sample = samples[i];
+
+    // Timestamp
+    {
+      int32_t dod    = 0;
+      uint8_t nrOnes = 0;
+
+      while (nrOnes <= NR_ELEMENTS(timestamp_bucket_bits)) {
+        if (!reader.read(bits, 1)) { return false; }
+
+        if (bits == 0) { break; }
+        ++nrOnes;
+      }
+
+      if (nrOnes > 0) {
+        if (nrOnes <= NR_ELEMENTS(timestamp_bucket_bits)) {
+          const uint8_t nrBits = timestamp_bucket_bits[nrOnes - 1];
+
+          if (!reader.read(bits, nrBits)) { return false; }
+
+          // Sign extend
+          dod = static_cast<int32_t>(bits << (32 - nrBits)) >> (32 - nrBits);
+        } else {
+          if (!reader.read(bits, 32)) { return false; }
+          dod = static_cast<int32_t>(bits);
+        }
+      }
+      prevDelta       = static_cast<int32_t>(static_cast<uint32_t>(prevDelta) + static_cast<uint32_t>(dod));
+      prevTime       += static_cast<uint32_t>(prevDelta);
+      sample.unixTime = prevTime;
+    }
+
+    // TaskIndex
+    if (!reader.read(bits, 1)) { return false; }
+
+    if (bits != 0) {
+      if (!reader.read(bits, 8)) { return false; }
+      prevTask = bits;
+    }
+    sample.TaskIndex = prevTask;
+
+    CacheBlock_TaskState& state = states[getTaskStateIndex(sample.TaskIndex)];
+
+    // pluginID, sensorType and valueCount
+    if (!reader.read(bits, 1)) { return false; }
+
+    if (bits != 0) {
+      uint32_t meta = 0;
+
+      if (!reader.read(meta, 24)) { return false; }
+      state.pluginID   = pluginID_t::toPluginID((meta >> 16) & 0xFF);
+      state.sensorType = static_cast<Sensor_VType>((meta >> 8) & 0xFF);
+      state.valueCount = meta & 0xFF;
+      state.hasMeta    = true;
+    }
+
+    if (!state.hasMeta) { return false; }
+    sample.pluginID   = state.pluginID;
+    sample.sensorType = state.sensorType;
+    sample.valueCount = state.valueCount;
+
+    // Task values
+    for (size_t w = 0; w < CONTROLLER_CACHE_BLOCK_NR_WORDS; ++w) {
+      if (!reader.read(bits, 1)) { return false; }
+
+      if (bits != 0) {
+        if (!reader.read(bits, 1)) { return false; }
+
+        if (bits != 0) {
+          uint32_t leading = 0;
+          uint32_t nrBits  = 0;
+
+          if (!reader.read(leading, 5) || !reader.read(nrBits, 5)) { return false; }
+          ++nrBits;
+
+          if ((leading + nrBits) > 32) { return false; }
+          state.leading[w]   = leading;
+          state.trailing[w]  = 32 - leading - nrBits;
+          state.hasWindow[w] = true;
+        } else if (!state.hasWindow[w]) {
+          return false;
+        }
+        const uint8_t nrBits = 32 - state.leading[w] - state.trailing[w];
+
+        if (!reader.read(bits, nrBits)) { return false; }
+        state.words[w] ^= (bits << state.trailing[w]);
+      }
+      memcpy(sample.values.binary + (w * sizeof(uint32_t)), &state.words[w], sizeof(uint32_t));
+    }
+  }
+  return true;
+}
+
+#endif // if FEATURE_C016_COMPRESSED_CACHE
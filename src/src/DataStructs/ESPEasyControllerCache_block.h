@@ -0,0 +1,65 @@
+#ifndef DATASTRUCTS_ESPEASYCONTROLLERCACHE_BLOCK_H
+#define DATASTRUCTS_ESPEASYCONTROLLERCACHE_BLOCK_H
+
+#include "../../ESPEasy_common.h"
+
+// "C16Z" as little endian uint32_t
+// Also defined without compression, to recognize files written by a build with compression.
+#define CONTROLLER_CACHE_BLOCK_MAGIC  0x5A363143u
+
+#if FEATURE_C016_COMPRESSED_CACHE
+
+# include "../ControllerQueue/C016_queue_element.h"
+
+# include <vector>
+
+
+// Header in front of every compressed block of samples in the cache files.
+// A block is the content of the RTC cache buffer at the moment it was flushed to the file.
+// The headers form the block index of a file, to seek to a time range or task
+// without decoding the samples.
+// Do NOT change order of members!
+struct __attribute__((__packed__)) ESPEasyControllerCache_block_header {
+  bool isValid() const;
+
+  bool containsTask(taskIndex_t taskIndex) const;
+
+  // Return true when the block has samples in the range from ... to (inclusive)
+  bool overlaps(uint32_t from,
+                uint32_t to) const;
+
+  uint32_t magic       = CONTROLLER_CACHE_BLOCK_MAGIC;
+  uint32_t startTime   = 0; // Lowest unixTime of the samples in the block
+  uint32_t endTime     = 0; // Highest unixTime of the samples in the block
+  uint32_t taskBitmap  = 0; // Bit set for each taskIndex present in the block
+  uint16_t nrSamples   = 0;
+  uint16_t payloadSize = 0; // Nr of bytes of compressed samples following the header
+};
+
+
+/*********************************************************************************************\
+* Compression of C016_binary_element samples, similar to the Gorilla time series format:
+* - Timestamps are stored as delta-of-delta, usually taking only 1 bit per sample
+* - Task values are stored as XOR with the previous sample of the same task,
+*   storing only the meaningful bits. Unchanged values take 1 bit.
+* - TaskIndex, pluginID, sensorType and valueCount are only stored when changed.
+*
+* Each block can be decoded on its own, so a reader only has to decode the block
+* containing the sample it needs.
+\*********************************************************************************************/
+struct ESPEasyControllerCache_block {
+  // Compress the samples into block, including the header.
+  // The samples are C016_binary_element as stored in the RTC cache, which may not be aligned.
+  static bool encode(const uint8_t        *samples,
+                     uint16_t              nrSamples,
+                     std::vector<uint8_t>& block);
+
+  // Decode the payload following header into samples.
+  static bool decode(const ESPEasyControllerCache_block_header& header,
+                     const uint8_t                            *payload,
+                     std::vector<C016_binary_element>         & samples);
+};
+
+#endif // if FEATURE_C016_COMPRESSED_CACHE
+
+#endif // ifndef DATASTRUCTS_ESPEASYCONTROLLERCACHE_BLOCK_H
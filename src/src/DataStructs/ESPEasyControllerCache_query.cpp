@@ -0,0 +1,130 @@
+#include "../DataStructs/ESPEasyControllerCache_query.h"
+
+#if FEATURE_RTC_CACHE_STORAGE
+
+# include "../Globals/C016_ControllerCache.h"
+
+ESPEasyControllerCache_query::ESPEasyControllerCache_query(const ESPEasyControllerCache_query_filter& filter)
+  : _filter(filter)
+{
+  // No need to flush, samples still in the RTC buffer can be peeked too.
+
+  // First backup the peek file positions.
+  _backup_peekFilePos = ControllerCache.getPeekFilePos(_backup_peekFileNr);
+
+  if (_filter.interval > 0) {
+    _intervals.resize(validTaskIndex(_filter.taskIndex) ? 1 : TASKS_MAX);
+  }
+
+  _endOfRange = (_filter.from > _filter.to) ||
+                !ControllerCache.setPeekFilePosByTime(_filter.from, _filter.taskIndex);
+}
+
+ESPEasyControllerCache_query::~ESPEasyControllerCache_query()
+{
+  // Restore peek file positions.
+  ControllerCache.setPeekFilePos(_backup_peekFileNr, _backup_peekFilePos);
+}
+
+bool ESPEasyControllerCache_query::next(ESPEasyControllerCache_query_result& result)
+{
+  C016_binary_element element;
+
+  while (readSample(element)) {
+    if (_filter.interval == 0) {
+      setResult(element, result);
+      return true;
+    }
+
+    ESPEasyControllerCache_query_result& interval =
+      _intervals[validTaskIndex(_filter.taskIndex) ? 0 : element.TaskIndex];
+    const uint32_t intervalStart = element.unixTime - (element.unixTime % _filter.interval);
+
+    if ((interval.nrSamples != 0) && (interval.unixTime != intervalStart)) {
+      // Sample is in the next interval, return the finished one.
+      finishInterval(interval, result);
+      setResult(element, interval);
+      interval.unixTime = intervalStart;
+      return true;
+    }
+
+    if (interval.nrSamples == 0) {
+      setResult(element, interval);
+      interval.unixTime = intervalStart;
+    } else {
+      addToInterval(element, interval);
+    }
+  }
+
+  // No more samples, return the intervals still being aggregated.
+  for (auto it = _intervals.begin(); it != _intervals.end(); ++it) {
+    if (it->nrSamples != 0) {
+      finishInterval(*it, result);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ESPEasyControllerCache_query::readSample(C016_binary_element& element)
+{
+  while (!_endOfRange) {
+    if (!C016_getTaskSample(element)) {
+      _endOfRange = true;
+    } else if (element.unixTime > _filter.to) {
+      _endOfRange = true;
+    } else if ((element.unixTime >= _filter.from) &&
+               validTaskIndex(element.TaskIndex) &&
+               (!validTaskIndex(_filter.taskIndex) || (element.TaskIndex == _filter.taskIndex))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ESPEasyControllerCache_query::setResult(const C016_binary_element         & element,
+                                             ESPEasyControllerCache_query_result& result) const
+{
+  result.unixTime   = element.unixTime;
+  result.taskIndex  = element.TaskIndex;
+  result.valueCount = element.valueCount;
+  result.nrSamples  = 1;
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    const ESPEASY_RULES_FLOAT_TYPE value =
+      _filter.acceptsValue(i) ? element.values.getAsDouble(i, element.sensorType) : 0;
+    result.min[i] = value;
+    result.max[i] = value;
+    result.avg[i] = value;
+  }
+}
+
+void ESPEasyControllerCache_query::addToInterval(const C016_binary_element         & element,
+                                                 ESPEasyControllerCache_query_result& interval) const
+{
+  ++interval.nrSamples;
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    if (_filter.acceptsValue(i)) {
+      const ESPEASY_RULES_FLOAT_TYPE value = element.values.getAsDouble(i, element.sensorType);
+
+      if (value < interval.min[i]) { interval.min[i] = value; }
+
+      if (value > interval.max[i]) { interval.max[i] = value; }
+      interval.avg[i] += value;
+    }
+  }
+}
+
+void ESPEasyControllerCache_query::finishInterval(ESPEasyControllerCache_query_result& interval,
+                                                  ESPEasyControllerCache_query_result& result)
+{
+  result = interval;
+
+  for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+    result.avg[i] /= result.nrSamples;
+  }
+  interval.nrSamples = 0;
+}
+
+#endif // if FEATURE_RTC_CACHE_STORAGE
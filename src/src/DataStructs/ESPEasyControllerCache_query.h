@@ -0,0 +1,96 @@
+#ifndef DATASTRUCTS_ESPEASYCONTROLLERCACHE_QUERY_H
+#define DATASTRUCTS_ESPEASYCONTROLLERCACHE_QUERY_H
+
+
+#include "../../ESPEasy_common.h"
+
+#if FEATURE_RTC_CACHE_STORAGE
+
+# include "../ControllerQueue/C016_queue_element.h"
+# include "../DataTypes/SensorVType.h"
+# include "../DataTypes/TaskIndex.h"
+
+# include <vector>
+
+struct ESPEasyControllerCache_query_filter {
+  bool acceptsValue(uint8_t valueIndex) const {
+    return valueIndex_all() || (valueIndex == this->valueIndex);
+  }
+
+  bool valueIndex_all() const {
+    return valueIndex >= VARS_PER_TASK;
+  }
+
+  uint32_t    from       = 0;
+  uint32_t    to         = UINT32_MAX;
+  taskIndex_t taskIndex  = INVALID_TASK_INDEX; // Invalid task index: all tasks
+  uint8_t     valueIndex = VARS_PER_TASK;      // Out of range: all task values
+
+  // Downsample interval in seconds.
+  // 0 = return the stored samples.
+  uint32_t interval = 0;
+};
+
+// A single stored sample, or the aggregate of all samples of a task within an interval.
+// For a single sample min, max and avg are the same.
+struct ESPEasyControllerCache_query_result {
+  uint32_t                 unixTime   = 0; // Time of the sample, or start of the interval
+  taskIndex_t              taskIndex  = INVALID_TASK_INDEX;
+  uint8_t                  valueCount = 0;
+  uint32_t                 nrSamples  = 0;
+  ESPEASY_RULES_FLOAT_TYPE min[VARS_PER_TASK]{};
+  ESPEASY_RULES_FLOAT_TYPE max[VARS_PER_TASK]{};
+  ESPEASY_RULES_FLOAT_TYPE avg[VARS_PER_TASK]{};
+};
+
+
+/*********************************************************************************************\
+* Query the samples stored by the Cache Controller.
+* The peek position is moved to the start of the time range using the block index
+* of the cache files, so files and blocks before the range are not read.
+* Reading stops at the first sample after the time range, as samples are stored
+* in chronological order.
+*
+* The peek position is restored when the query object is destructed.
+\*********************************************************************************************/
+struct ESPEasyControllerCache_query {
+  explicit ESPEasyControllerCache_query(const ESPEasyControllerCache_query_filter& filter);
+
+  ~ESPEasyControllerCache_query();
+
+  // Return false when no more results are available.
+  bool next(ESPEasyControllerCache_query_result& result);
+
+  const ESPEasyControllerCache_query_filter& getFilter() const {
+    return _filter;
+  }
+
+private:
+
+  // Read the next sample matching the filter
+  bool readSample(C016_binary_element& element);
+
+  void setResult(const C016_binary_element         & element,
+                 ESPEasyControllerCache_query_result& result) const;
+
+  void addToInterval(const C016_binary_element         & element,
+                     ESPEasyControllerCache_query_result& interval) const;
+
+  // Compute the average of an interval and mark it as no longer active.
+  static void finishInterval(ESPEasyControllerCache_query_result& interval,
+                             ESPEasyControllerCache_query_result& result);
+
+  ESPEasyControllerCache_query_filter _filter;
+
+  // Interval being aggregated, per task.
+  // avg holds the sum while aggregating, nrSamples = 0 when not active.
+  std::vector<ESPEasyControllerCache_query_result> _intervals;
+
+  int  _backup_peekFileNr  = 0;
+  int  _backup_peekFilePos = 0;
+  bool _endOfRange         = false;
+};
+
+#endif // if FEATURE_RTC_CACHE_STORAGE
+
+#endif // ifndef DATASTRUCTS_ESPEASYCONTROLLERCACHE_QUERY_H
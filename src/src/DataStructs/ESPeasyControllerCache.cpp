@@ -107,6 +107,13 @@ void ControllerCache_struct::setPeekFilePos(int peekFileNr, int peekReadPos) {
   }
 }
 
+bool ControllerCache_struct::setPeekFilePosByTime(uint32_t fromTime, taskIndex_t taskIndex) {
+  if (_RTC_cache_handler == nullptr) {
+    return false;
+  }
+  return _RTC_cache_handler->setPeekFilePosByTime(fromTime, taskIndex);
+}
+
 // Read data without marking it as being read.
 bool ControllerCache_struct::peek(uint8_t *data, unsigned int size) const {
   if (_RTC_cache_handler == nullptr) {
@@ -1,19 +1,98 @@
 #include "../DataStructs/EventQueue.h"
 
 #include "../../ESPEasy_common.h"
+#include "../../_Plugin_Helper.h"
 
+#include "../Globals/Cache.h"
+#include "../Globals/Device.h"
 #include "../Globals/Settings.h"
+#include "../Helpers/CRC_functions.h"
 #include "../Helpers/Misc.h"
 
 
+/*********************************************************************************************\
+* EventQueueElement
+\*********************************************************************************************/
+EventQueueElement::EventQueueElement(String&& event)
+  : _event(std::move(event))
+{
+  _hash = computeHash(_event);
+}
+
+EventQueueElement::EventQueueElement(taskIndex_t              taskIndex,
+                                     uint8_t                  valueIndex,
+                                     Sensor_VType             sensorType,
+                                     const TaskValues_Data_t& values)
+  : _values(values), _taskIndex(taskIndex), _valueIndex(valueIndex), _sensorType(sensorType)
+{}
+
+String EventQueueElement::toString() const
+{
+  if (!isTaskValueEvent()) {
+    return _event;
+  }
+  const bool combined = _valueIndex >= VARS_PER_TASK;
+  String eventValue;
+
+  if (combined) {
+    const uint8_t valueCount = getValueCountForTask(_taskIndex);
+
+    eventValue.reserve(32); // Enough for most use cases, prevent lots of memory allocations.
+
+    for (uint8_t varNr = 0; varNr < valueCount; varNr++) {
+      if (varNr != 0) {
+        eventValue += ',';
+      }
+      eventValue += formatValue(varNr);
+    }
+  } else {
+    eventValue = formatValue(_valueIndex);
+  }
+
+  String event = getTaskDeviceName(_taskIndex);
+
+  if (combined) {
+    event.reserve(event.length() + 5 + eventValue.length());
+    event += F("#All");
+  } else {
+    const String valueName = getTaskValueName(_taskIndex, _valueIndex);
+    event.reserve(event.length() + 2 + valueName.length() + eventValue.length());
+    event += '#';
+    event += valueName;
+  }
+
+  if (!eventValue.isEmpty()) {
+    event += '='; // Add arguments
+    event += eventValue;
+  }
+  return event;
+}
+
+String EventQueueElement::formatValue(uint8_t valueIndex) const
+{
+  // Same as formatUserVarNoCheck(), but using the copy of the task values
+  // taken when the event was added.
+  return formatTaskValue(_taskIndex, valueIndex, _sensorType, _values);
+}
+
+uint16_t EventQueueElement::computeHash(const String& event)
+{
+  return static_cast<uint16_t>(calc_CRC16(event));
+}
+
+/*********************************************************************************************\
+* EventQueueStruct
+\*********************************************************************************************/
 void EventQueueStruct::add(const String& event, bool deduplicate)
 {
   #ifdef USE_SECOND_HEAP
   HeapSelectIram ephemeral;
   #endif // ifdef USE_SECOND_HEAP
 
-  if (!deduplicate || !isDuplicate(event)) {
-    _eventQueue.push_back(event);
+  const uint16_t hash = EventQueueElement::computeHash(event);
+
+  if (!deduplicate || !isDuplicate(event, hash)) {
+    push_back(EventQueueElement(String(event)));
   }
 }
 
@@ -24,9 +103,7 @@ void EventQueueStruct::add(const __FlashStringHelper *event, bool deduplicate)
   #endif // ifdef USE_SECOND_HEAP
 
   // Wrap in String() constructor to make sure it is using the 2nd heap allocator if present.
-  if (!deduplicate || !isDuplicate(event)) {
-    _eventQueue.push_back(String(event));
-  }
+  addMove(String(event), deduplicate);
 }
 
 void EventQueueStruct::addMove(String&& event, bool deduplicate)
@@ -37,15 +114,15 @@ void EventQueueStruct::addMove(String&& event, bool deduplicate)
 
   if (!mmu_is_iram(&(event[0]))) {
     // Wrap in String constructor to make sure it is stored in the 2nd heap.
-    if (!deduplicate || !isDuplicate(event)) {
-      _eventQueue.push_back(String(event));
-    }
+    add(event, deduplicate);
     return;
   }
   #endif // ifdef USE_SECOND_HEAP
 
-  if (!deduplicate || !isDuplicate(event)) {
-    _eventQueue.emplace_back(std::move(event));
+  const uint16_t hash = EventQueueElement::computeHash(event);
+
+  if (!deduplicate || !isDuplicate(event, hash)) {
+    push_back(EventQueueElement(std::move(event)));
   }
 }
 
@@ -86,35 +163,144 @@ void EventQueueStruct::add(taskIndex_t TaskIndex, const __FlashStringHelper *var
   }
 }
 
+void EventQueueStruct::addTaskValueEvent(taskIndex_t              TaskIndex,
+                                         uint8_t                  valueIndex,
+                                         Sensor_VType             sensorType,
+                                         const TaskValues_Data_t& values)
+{
+  if (Settings.UseRules && validTaskIndex(TaskIndex)) {
+    #ifdef USE_SECOND_HEAP
+    HeapSelectIram ephemeral;
+    #endif // ifdef USE_SECOND_HEAP
+
+    push_back(EventQueueElement(TaskIndex, valueIndex, sensorType, values));
+  }
+}
+
 bool EventQueueStruct::getNext(String& event)
 {
-  if (_eventQueue.empty()) {
+  if (_count == 0) {
     return false;
   }
+  EventQueueElement& element = _eventQueue[_head];
+
+  if (!element.isTaskValueEvent()) {
+    indexRemove(_head);
+  }
   #ifdef USE_SECOND_HEAP
   {
     // Fetch the event and make sure it is allocated on the DRAM heap, not the 2nd heap
     // Otherwise checks like strnlen_P may crash on it.
     HeapSelectDram ephemeral;
-    event = std::move(String(_eventQueue.front()));
+    event = std::move(element.toString());
   }
   #else // ifdef USE_SECOND_HEAP
-  event = std::move(_eventQueue.front());
+  if (element.isTaskValueEvent()) {
+    event = element.toString();
+  } else {
+    event = std::move(element._event);
+  }
   #endif // ifdef USE_SECOND_HEAP
-  _eventQueue.pop_front();
+
+  // Free any allocated memory, but keep the slot in the ring buffer.
+  element = EventQueueElement();
+
+  _head = (_head + 1) % EVENT_QUEUE_MAX_SIZE;
+  --_count;
   return true;
 }
 
 void EventQueueStruct::clear()
 {
   _eventQueue.clear();
+  _head  = 0;
+  _count = 0;
+
+  for (size_t i = 0; i < EVENT_QUEUE_INDEX_SIZE; ++i) {
+    _index[i] = 0;
+  }
 }
 
 bool EventQueueStruct::isEmpty() const
 {
-  return _eventQueue.empty();
+  return _count == 0;
+}
+
+bool EventQueueStruct::isDuplicate(const String& event, uint16_t hash) const {
+  size_t pos = hash % EVENT_QUEUE_INDEX_SIZE;
+
+  while (_index[pos] != 0) {
+    const EventQueueElement& element = _eventQueue[_index[pos] - 1];
+
+    if ((element._hash == hash) &&
+        element._event.equals(event)) {
+      return true;
+    }
+    pos = (pos + 1) % EVENT_QUEUE_INDEX_SIZE;
+  }
+  return false;
 }
 
-bool EventQueueStruct::isDuplicate(const String& event) {
-  return std::find(_eventQueue.begin(), _eventQueue.end(), event) != _eventQueue.end();
+void EventQueueStruct::push_back(EventQueueElement&& element)
+{
+  if (_eventQueue.empty()) {
+    _eventQueue.resize(EVENT_QUEUE_MAX_SIZE);
+  }
+
+  if (_count >= EVENT_QUEUE_MAX_SIZE) {
+    // Queue is full, drop the new event.
+    if (_nrDropped == 0 || loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+      addLog(LOG_LEVEL_ERROR, concat(F("Event queue full, dropped: "), element.toString()));
+    }
+    ++_nrDropped;
+    return;
+  }
+
+  const size_t slot = (_head + _count) % EVENT_QUEUE_MAX_SIZE;
+
+  _eventQueue[slot] = std::move(element);
+  ++_count;
+
+  if (!_eventQueue[slot].isTaskValueEvent()) {
+    indexInsert(slot);
+  }
+}
+
+void EventQueueStruct::indexInsert(size_t slot)
+{
+  size_t pos = _eventQueue[slot]._hash % EVENT_QUEUE_INDEX_SIZE;
+
+  while (_index[pos] != 0) {
+    pos = (pos + 1) % EVENT_QUEUE_INDEX_SIZE;
+  }
+  _index[pos] = slot + 1;
+}
+
+void EventQueueStruct::indexRemove(size_t slot)
+{
+  size_t hole = _eventQueue[slot]._hash % EVENT_QUEUE_INDEX_SIZE;
+
+  while (_index[hole] != (slot + 1)) {
+    if (_index[hole] == 0) {
+      // Not present in the index
+      return;
+    }
+    hole = (hole + 1) % EVENT_QUEUE_INDEX_SIZE;
+  }
+
+  // Shift entries back into the hole when their preferred position is
+  // not between the hole and their current position.
+  // This keeps all probe sequences intact without using "deleted" markers.
+  size_t next = (hole + 1) % EVENT_QUEUE_INDEX_SIZE;
+
+  while (_index[next] != 0) {
+    const size_t home = _eventQueue[_index[next] - 1]._hash % EVENT_QUEUE_INDEX_SIZE;
+
+    if (((next - home) % EVENT_QUEUE_INDEX_SIZE) >= ((next - hole) % EVENT_QUEUE_INDEX_SIZE)) {
+      _index[hole] = _index[next];
+      hole         = next;
+    }
+    next = (next + 1) % EVENT_QUEUE_INDEX_SIZE;
+  }
+  _index[hole] = 0;
 }
@@ -2,12 +2,80 @@
 #define DATASTRUCTS_EVENTQUEUE_H
 
 
-#include <list>
+#include <vector>
 
 
 #include "../Globals/Plugins.h"
 
+#include "../DataTypes/SensorVType.h"
+#include "../DataTypes/TaskValues_Data.h"
 
+
+// Max. number of events in the queue.
+// When the queue is full, new events are dropped and counted.
+#ifndef EVENT_QUEUE_MAX_SIZE
+# ifdef ESP8266
+#  define EVENT_QUEUE_MAX_SIZE  32
+# else // ifdef ESP8266
+#  define EVENT_QUEUE_MAX_SIZE  128
+# endif // ifdef ESP8266
+#endif // ifndef EVENT_QUEUE_MAX_SIZE
+
+// Size of the hash index used to check for duplicate events.
+// Must be a power of 2 and larger than EVENT_QUEUE_MAX_SIZE.
+#define EVENT_QUEUE_INDEX_SIZE  (2 * EVENT_QUEUE_MAX_SIZE)
+
+static_assert(EVENT_QUEUE_MAX_SIZE < 256, "Event queue index uses uint8_t slot numbers");
+static_assert((EVENT_QUEUE_INDEX_SIZE & (EVENT_QUEUE_INDEX_SIZE - 1)) == 0, "EVENT_QUEUE_INDEX_SIZE must be a power of 2");
+
+
+/*********************************************************************************************\
+* Single element in the event queue.
+* Events for task values are stored as task index, value index and a copy of the task values.
+* The event string (Taskname#varName=value) is only generated when the event is processed.
+* All other events are stored as string.
+\*********************************************************************************************/
+struct EventQueueElement {
+  EventQueueElement() = default;
+
+  explicit EventQueueElement(String&& event);
+
+  EventQueueElement(taskIndex_t              taskIndex,
+                    uint8_t                  valueIndex,
+                    Sensor_VType             sensorType,
+                    const TaskValues_Data_t& values);
+
+  bool   isTaskValueEvent() const {
+    return validTaskIndex(_taskIndex);
+  }
+
+  // Generate the event string.
+  String toString() const;
+
+  static uint16_t computeHash(const String& event);
+
+  String            _event;
+  TaskValues_Data_t _values;
+
+  // Only computed for string events, used for deduplication
+  uint16_t     _hash       = 0;
+  taskIndex_t  _taskIndex  = INVALID_TASK_INDEX;
+
+  // VARS_PER_TASK is used for combined events: Taskname#All=value1,value2,...
+  uint8_t      _valueIndex = 0;
+  Sensor_VType _sensorType = Sensor_VType::SENSOR_TYPE_NONE;
+
+private:
+
+  String formatValue(uint8_t valueIndex) const;
+};
+
+
+/*********************************************************************************************\
+* Event queue, stored in a fixed size ring buffer.
+* The buffer is allocated when the first event is added.
+* String events are kept in a hash index (open addressing) for quick deduplication.
+\*********************************************************************************************/
 struct EventQueueStruct {
   EventQueueStruct() = default;
 
@@ -26,6 +94,14 @@ struct EventQueueStruct {
   void        add(taskIndex_t TaskIndex, const __FlashStringHelper * varName, const String& eventValue);
   void        add(taskIndex_t TaskIndex, const __FlashStringHelper * varName, int eventValue);
 
+  // Add event for a task value, which will be formatted as Taskname#varName=eventvalue
+  // when the event is processed.
+  // Use valueIndex = VARS_PER_TASK to add a combined event: Taskname#All=value1,value2,...
+  void        addTaskValueEvent(taskIndex_t              TaskIndex,
+                                uint8_t                  valueIndex,
+                                Sensor_VType             sensorType,
+                                const TaskValues_Data_t& values);
+
   bool        getNext(String& event);
 
   void        clear();
@@ -33,14 +109,36 @@ struct EventQueueStruct {
   bool        isEmpty() const;
 
   std::size_t size() {
-    return _eventQueue.size();
+    return _count;
+  }
+
+  // Nr of events dropped because the queue was full.
+  uint32_t getNrDropped() const {
+    return _nrDropped;
   }
 
 private:
 
-  bool isDuplicate(const String& event);
+  bool isDuplicate(const String& event,
+                   uint16_t      hash) const;
+
+  void push_back(EventQueueElement&& element);
+
+  void indexInsert(size_t slot);
+
+  void indexRemove(size_t slot);
+
+  std::vector<EventQueueElement>_eventQueue;
+
+  // Position of the first element in the ring buffer
+  std::size_t _head  = 0;
+  std::size_t _count = 0;
+
+  uint32_t _nrDropped = 0;
 
-  std::list<String>_eventQueue;
+  // Slot nr + 1 of string events in the ring buffer, 0 = empty.
+  // Position is determined by the hash of the event, using linear probing.
+  uint8_t _index[EVENT_QUEUE_INDEX_SIZE] = {};
 };
 
 
@@ -0,0 +1,148 @@
+#include "../DataStructs/ExtraTaskSettingsLRU.h"
+
+#include "../Helpers/Hardware.h"
+#include "../Helpers/Memory.h"
+
+#include <type_traits>
+
+
+// Entries are allocated using special_calloc and copied using memcpy.
+static_assert(std::is_trivially_copyable<ExtraTaskSettingsStruct>::value, "ExtraTaskSettingsStruct must be trivially copyable");
+static_assert(EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM <= TASKS_MAX, "EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM larger than TASKS_MAX");
+
+
+ExtraTaskSettingsLRU::~ExtraTaskSettingsLRU()
+{
+  clear();
+}
+
+bool ExtraTaskSettingsLRU::get(taskIndex_t TaskIndex, ExtraTaskSettingsStruct& dest)
+{
+  const uint8_t index = find(TaskIndex);
+
+  if (index >= _nrEntries) {
+    ++_misses;
+    return false;
+  }
+  ++_hits;
+  memcpy(&dest, _entries[index], sizeof(ExtraTaskSettingsStruct));
+  moveToFront(index);
+  return true;
+}
+
+void ExtraTaskSettingsLRU::put(const ExtraTaskSettingsStruct& settings)
+{
+  if (!validTaskIndex(settings.TaskIndex)) {
+    return;
+  }
+  uint8_t index = find(settings.TaskIndex);
+
+  if (index >= _nrEntries) {
+    // Release the least recently used entry when full or running low on heap.
+    if ((_nrEntries >= maxSize()) || !enoughFreeMemory()) {
+      releaseLast();
+    }
+
+    if ((_nrEntries >= maxSize()) || !enoughFreeMemory()) {
+      return;
+    }
+    {
+      #ifdef USE_SECOND_HEAP
+
+      // Allow to store the entries in 2nd heap if present.
+      HeapSelectIram ephemeral;
+      #endif // ifdef USE_SECOND_HEAP
+
+      _entries[_nrEntries] = static_cast<ExtraTaskSettingsStruct *>(special_calloc(1, sizeof(ExtraTaskSettingsStruct)));
+    }
+
+    if (_entries[_nrEntries] == nullptr) {
+      return;
+    }
+    index = _nrEntries;
+    ++_nrEntries;
+  }
+  memcpy(_entries[index], &settings, sizeof(ExtraTaskSettingsStruct));
+  moveToFront(index);
+}
+
+void ExtraTaskSettingsLRU::erase(taskIndex_t TaskIndex)
+{
+  const uint8_t index = find(TaskIndex);
+
+  if (index < _nrEntries) {
+    moveToFront(index);
+
+    // Now shift all others to the front and free the first one.
+    ExtraTaskSettingsStruct *entry = _entries[0];
+
+    for (uint8_t i = 1; i < _nrEntries; ++i) {
+      _entries[i - 1] = _entries[i];
+    }
+    --_nrEntries;
+    _entries[_nrEntries] = nullptr;
+    free(entry);
+  }
+}
+
+void ExtraTaskSettingsLRU::clear()
+{
+  while (_nrEntries > 0) {
+    releaseLast();
+  }
+}
+
+uint8_t ExtraTaskSettingsLRU::maxSize()
+{
+  #ifdef ESP32
+
+  if (UsePSRAM()) {
+    return EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM;
+  }
+  #endif // ifdef ESP32
+  return EXTRA_TASK_SETTINGS_LRU_SIZE;
+}
+
+uint8_t ExtraTaskSettingsLRU::find(taskIndex_t TaskIndex) const
+{
+  for (uint8_t i = 0; i < _nrEntries; ++i) {
+    if (_entries[i]->TaskIndex == TaskIndex) {
+      return i;
+    }
+  }
+  return _nrEntries;
+}
+
+void ExtraTaskSettingsLRU::moveToFront(uint8_t index)
+{
+  if ((index == 0) || (index >= _nrEntries)) {
+    return;
+  }
+  ExtraTaskSettingsStruct *entry = _entries[index];
+
+  for (uint8_t i = index; i > 0; --i) {
+    _entries[i] = _entries[i - 1];
+  }
+  _entries[0] = entry;
+}
+
+void ExtraTaskSettingsLRU::releaseLast()
+{
+  if (_nrEntries > 0) {
+    --_nrEntries;
+    free(_entries[_nrEntries]);
+    _entries[_nrEntries] = nullptr;
+  }
+}
+
+bool ExtraTaskSettingsLRU::enoughFreeMemory()
+{
+  #ifdef ESP32
+
+  if (UsePSRAM()) {
+    // Allocated in PSRAM
+    return true;
+  }
+  #endif // ifdef ESP32
+  return FreeMem() > (EXTRA_TASK_SETTINGS_LRU_MIN_FREE_HEAP + sizeof(ExtraTaskSettingsStruct));
+}
@@ -0,0 +1,111 @@
+#ifndef DATASTRUCTS_EXTRATASKSETTINGSLRU_H
+#define DATASTRUCTS_EXTRATASKSETTINGSLRU_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../CustomBuild/ESPEasyLimits.h"
+#include "../DataStructs/ExtraTaskSettingsStruct.h"
+#include "../DataTypes/TaskIndex.h"
+
+// Nr of ExtraTaskSettings kept in RAM, to prevent reading them from flash
+// every time another task is accessed.
+#ifndef EXTRA_TASK_SETTINGS_LRU_SIZE
+# ifdef ESP32
+#  define EXTRA_TASK_SETTINGS_LRU_SIZE        8
+# else // ifdef ESP32
+#  define EXTRA_TASK_SETTINGS_LRU_SIZE        2
+# endif // ifdef ESP32
+#endif // ifndef EXTRA_TASK_SETTINGS_LRU_SIZE
+
+// Nr of entries when PSRAM is available.
+#ifndef EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM
+# ifdef ESP32
+#  define EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM  TASKS_MAX
+# else // ifdef ESP32
+#  define EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM  EXTRA_TASK_SETTINGS_LRU_SIZE
+# endif // ifdef ESP32
+#endif // ifndef EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM
+
+// Do not allocate a new entry when free heap would drop below this value.
+// Entries are released again when free heap is below this value.
+#ifndef EXTRA_TASK_SETTINGS_LRU_MIN_FREE_HEAP
+# ifdef ESP32
+#  define EXTRA_TASK_SETTINGS_LRU_MIN_FREE_HEAP  32768
+# else // ifdef ESP32
+#  define EXTRA_TASK_SETTINGS_LRU_MIN_FREE_HEAP  12000
+# endif // ifdef ESP32
+#endif // ifndef EXTRA_TASK_SETTINGS_LRU_MIN_FREE_HEAP
+
+
+/*********************************************************************************************\
+* Least recently used cache of complete ExtraTaskSettingsStruct entries, as loaded
+* by LoadTaskSettings() and thus including the patches applied after loading.
+* Only a single ExtraTaskSettings is kept as global, so a loop over several tasks
+* would otherwise read each of them from flash every time.
+*
+* Entries must be erased whenever the stored task settings or the task's plugin change.
+* This is done via Caches::clearTaskCache() and Caches::clearAllTaskCaches().
+\*********************************************************************************************/
+class ExtraTaskSettingsLRU {
+public:
+
+  ExtraTaskSettingsLRU() = default;
+
+  ~ExtraTaskSettingsLRU();
+
+  ExtraTaskSettingsLRU(const ExtraTaskSettingsLRU&)            = delete;
+  ExtraTaskSettingsLRU& operator=(const ExtraTaskSettingsLRU&) = delete;
+
+  // Copy the cached settings of the task to dest.
+  // Return false (cache miss) when the task is not cached.
+  bool     get(taskIndex_t              TaskIndex,
+               ExtraTaskSettingsStruct& dest);
+
+  // Store a copy of settings, using settings.TaskIndex as key.
+  void     put(const ExtraTaskSettingsStruct& settings);
+
+  void     erase(taskIndex_t TaskIndex);
+
+  void     clear();
+
+  uint8_t  size() const {
+    return _nrEntries;
+  }
+
+  // Depends on the availability of PSRAM
+  static uint8_t maxSize();
+
+  uint32_t getHits() const {
+    return _hits;
+  }
+
+  uint32_t getMisses() const {
+    return _misses;
+  }
+
+private:
+
+  // Return _nrEntries when not found
+  uint8_t     find(taskIndex_t TaskIndex) const;
+
+  // Move the entry at index to the front, shifting the more recently used entries back.
+  void        moveToFront(uint8_t index);
+
+  // Free the least recently used entry
+  void        releaseLast();
+
+  static bool enoughFreeMemory();
+
+  static constexpr uint8_t _maxEntries =
+    (EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM > EXTRA_TASK_SETTINGS_LRU_SIZE)
+    ? EXTRA_TASK_SETTINGS_LRU_SIZE_PSRAM : EXTRA_TASK_SETTINGS_LRU_SIZE;
+
+  // Ordered from most recently used to least recently used.
+  ExtraTaskSettingsStruct *_entries[_maxEntries] = {};
+
+  uint32_t _hits      = 0;
+  uint32_t _misses    = 0;
+  uint8_t  _nrEntries = 0;
+};
+
+#endif // ifndef DATASTRUCTS_EXTRATASKSETTINGSLRU_H
@@ -3,24 +3,42 @@
 
 #include "../../ESPEasy_common.h"
 
-class LogEntry_t {
-public:
+#define LOG_STRUCT_MESSAGE_SIZE 128
 
-  LogEntry_t() = default;
+#ifdef ESP32
+  #define LOG_BUFFER_EXPIRE         30000  // Time after which a buffered log item is considered expired.
+#else
+  #define LOG_BUFFER_EXPIRE         5000  // Time after which a buffered log item is considered expired.
+#endif
 
-  bool add(const uint8_t loglevel,
-           const String& line);
-  bool add(const uint8_t loglevel,
-           String     && line);
 
-  void clear();
+/*********************************************************************************************\
+ * Header of a log entry stored in the LogStruct byte ring buffer.
+ * The header is followed by either the message text (not zero terminated)
+ * or a pointer to a string in flash, which is only copied when the entry is read.
+\*********************************************************************************************/
+struct LogEntry_t {
+  enum Flags : uint8_t {
+    FlashString = 1
+  };
+
+  bool isFlashString() const {
+    return (_flags & FlashString) != 0;
+  }
 
   bool isExpired() const;
 
+  // Nr of bytes stored in the ring buffer after the header.
+  uint16_t payloadSize() const {
+    return isFlashString() ? sizeof(const __FlashStringHelper *) : _length;
+  }
+
+  uint32_t _timestamp{};
 
-  String _message;
-  unsigned long _timestamp{};
-  uint8_t _loglevel{};
+  // Message length, also for flash strings so they can be truncated when read.
+  uint16_t _length{};
+  uint8_t  _loglevel{};
+  uint8_t  _flags{};
 };
 
 
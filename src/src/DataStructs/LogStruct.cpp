@@ -3,69 +3,214 @@
 #include "../Helpers/ESPEasy_time_calc.h"
 #include "../Helpers/StringConverter.h"
 
-void LogStruct::add_end() {
-  if (isFull()) {
-    read_idx = nextIndex(read_idx);
-  }
-  write_idx = nextIndex(write_idx);
-  is_full   = (write_idx == read_idx);
-}
+static_assert((LOG_STRUCT_BUFFER_SIZE & (LOG_STRUCT_BUFFER_SIZE - 1)) == 0, "LOG_STRUCT_BUFFER_SIZE must be a power of 2");
+
 
 void LogStruct::add(const uint8_t loglevel, const String& line) {
-  if (Message[write_idx].add(loglevel, line)) {
-    add_end();
+  uint32_t length = line.length();
+
+  if (length == 0) {
+    return;
+  }
+
+  if (length > LOG_STRUCT_MESSAGE_SIZE - 1) {
+    length = LOG_STRUCT_MESSAGE_SIZE - 1;
+  }
+  LogEntry_t entry;
+  entry._timestamp = millis();
+  entry._length    = length;
+  entry._loglevel  = loglevel;
+
+  if (reserveSpace(sizeof(LogEntry_t) + length)) {
+    writeBytes(&entry,       sizeof(LogEntry_t));
+    writeBytes(line.c_str(), length);
+    ++_nrEntries;
   }
 }
 
 void LogStruct::add(const uint8_t loglevel, String&& line) {
-  if (Message[write_idx].add(loglevel, std::move(line))) {
-    add_end();
+  // The message is copied into the ring buffer, so no need to keep the allocated string.
+  add(loglevel, line);
+  line = String();
+}
+
+void LogStruct::add(const uint8_t loglevel, const __FlashStringHelper *line) {
+  uint32_t length = strlen_P((PGM_P)line);
+
+  if (length == 0) {
+    return;
+  }
+
+  if (length > LOG_STRUCT_MESSAGE_SIZE - 1) {
+    length = LOG_STRUCT_MESSAGE_SIZE - 1;
+  }
+  LogEntry_t entry;
+  entry._timestamp = millis();
+  entry._length    = length;
+  entry._loglevel  = loglevel;
+  entry._flags     = LogEntry_t::FlashString;
+
+  if (reserveSpace(sizeof(LogEntry_t) + entry.payloadSize())) {
+    writeBytes(&entry, sizeof(LogEntry_t));
+    writeBytes(&line,  sizeof(line));
+    ++_nrEntries;
   }
 }
 
-bool LogStruct::getNext(bool& logLinesAvailable, unsigned long& timestamp, String& message, uint8_t& loglevel) {
-  lastReadTimeStamp = millis();
-  logLinesAvailable = false;
+bool LogStruct::getNext(Reader reader, bool& logLinesAvailable, unsigned long& timestamp, String& message, uint8_t& loglevel) {
+  const uint8_t readerIndex = static_cast<uint8_t>(reader);
 
-  if (isEmpty()) {
+  if (readerIndex >= static_cast<uint8_t>(Reader::NrReaders)) {
     return false;
   }
-  timestamp = Message[read_idx]._timestamp;
-  message   = std::move(Message[read_idx]._message);
-  loglevel  = Message[read_idx]._loglevel;
-  clearOldest();
+  _lastReadTimeStamp[readerIndex] = millis();
+  logLinesAvailable               = false;
 
-  if (!isEmpty()) {
-    logLinesAvailable = true;
+  uint32_t& pos = _readPos[readerIndex];
+
+  if (isBefore(pos, _tail)) {
+    // Entries not yet read by this reader have been overwritten.
+    pos = _tail;
   }
-  return true;
+
+  while (pos != _head) {
+    LogEntry_t entry;
+    readBytes(pos, &entry, sizeof(LogEntry_t));
+    const uint32_t payloadPos = pos + sizeof(LogEntry_t);
+    pos = payloadPos + entry.payloadSize();
+
+    if (!entry.isExpired()) {
+      timestamp         = entry._timestamp;
+      loglevel          = entry._loglevel;
+      message           = readMessage(entry, payloadPos);
+      logLinesAvailable = pos != _head;
+      return true;
+    }
+  }
+  return false;
 }
 
+uint32_t LogStruct::getCapacityInEntries() const {
+  if (_nrEntries == 0) {
+    return LOG_STRUCT_MESSAGE_LINES;
+  }
+  return (LOG_STRUCT_BUFFER_SIZE * _nrEntries) / (_head - _tail);
+}
 
 bool LogStruct::logActiveRead() {
-  clearExpiredEntries();
-  return timePassedSince(lastReadTimeStamp) < LOG_BUFFER_ACTIVE_READ_TIMEOUT;
+  for (uint8_t i = 0; i < static_cast<uint8_t>(Reader::NrReaders); ++i) {
+    if (timePassedSince(_lastReadTimeStamp[i]) < LOG_BUFFER_ACTIVE_READ_TIMEOUT) {
+      return true;
+    }
+  }
+
+  if (!_buffer.empty()) {
+    clear();
+  }
+  return false;
 }
 
-void LogStruct::clearExpiredEntries() {
-  unsigned int maxLoops = LOG_STRUCT_MESSAGE_LINES;
+bool LogStruct::reserveSpace(uint32_t size) {
+  if (size > LOG_STRUCT_BUFFER_SIZE) {
+    ++_nrDropped;
+    return false;
+  }
+
+  if (_buffer.empty()) {
+    #ifdef USE_SECOND_HEAP
+
+    // Allow to store the logs in 2nd heap if present.
+    HeapSelectIram ephemeral;
+    #endif // ifdef USE_SECOND_HEAP
 
-  while (maxLoops > 0) {
-    --maxLoops;
+    _buffer.resize(LOG_STRUCT_BUFFER_SIZE);
 
-    if (isEmpty() || // Nothing left
-        !Message[read_idx].isExpired())
-    {
-      return;
+    if (_buffer.size() != LOG_STRUCT_BUFFER_SIZE) {
+      clear();
+      ++_nrDropped;
+      return false;
     }
+  }
+
+  while ((_head - _tail) + size > LOG_STRUCT_BUFFER_SIZE) {
     clearOldest();
   }
+  return true;
 }
 
 void LogStruct::clearOldest() {
   if (!isEmpty()) {
-    is_full = false;
-    Message[read_idx].clear();
-    read_idx = nextIndex(read_idx);
+    LogEntry_t entry;
+    readBytes(_tail, &entry, sizeof(LogEntry_t));
+
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Reader::NrReaders); ++i) {
+      if (!isBefore(_tail, _readPos[i]) &&
+          (timePassedSince(_lastReadTimeStamp[i]) < LOG_BUFFER_ACTIVE_READ_TIMEOUT)) {
+        // Entry not yet read by an active reader
+        ++_nrDropped;
+        break;
+      }
+    }
+    _tail += sizeof(LogEntry_t) + entry.payloadSize();
+    --_nrEntries;
+  }
+}
+
+void LogStruct::clear() {
+  // Swap with an empty vector to actually free the memory.
+  std::vector<uint8_t>().swap(_buffer);
+  _head      = 0;
+  _tail      = 0;
+  _nrEntries = 0;
+
+  for (uint8_t i = 0; i < static_cast<uint8_t>(Reader::NrReaders); ++i) {
+    _readPos[i] = 0;
+  }
+}
+
+void LogStruct::writeBytes(const void *src, uint32_t size) {
+  const uint8_t *src_bytes = static_cast<const uint8_t *>(src);
+  const uint32_t index     = bufferIndex(_head);
+  const uint32_t firstPart = std::min<uint32_t>(size, LOG_STRUCT_BUFFER_SIZE - index);
+
+  memcpy(&_buffer[index], src_bytes, firstPart);
+
+  if (firstPart < size) {
+    memcpy(&_buffer[0], src_bytes + firstPart, size - firstPart);
+  }
+  _head += size;
+}
+
+void LogStruct::readBytes(uint32_t pos, void *dst, uint32_t size) const {
+  uint8_t *dst_bytes       = static_cast<uint8_t *>(dst);
+  const uint32_t index     = bufferIndex(pos);
+  const uint32_t firstPart = std::min<uint32_t>(size, LOG_STRUCT_BUFFER_SIZE - index);
+
+  memcpy(dst_bytes, &_buffer[index], firstPart);
+
+  if (firstPart < size) {
+    memcpy(dst_bytes + firstPart, &_buffer[0], size - firstPart);
+  }
+}
+
+String LogStruct::readMessage(const LogEntry_t& entry, uint32_t pos) const {
+  String message;
+
+  if (entry.isFlashString()) {
+    const __FlashStringHelper *line = nullptr;
+    readBytes(pos, &line, sizeof(line));
+    message = line;
+
+    if (message.length() > entry._length) {
+      message.remove(entry._length);
+    }
+    return message;
+  }
+
+  if (message.reserve(entry._length)) {
+    for (uint16_t i = 0; i < entry._length; ++i) {
+      message += static_cast<char>(_buffer[bufferIndex(pos + i)]);
+    }
   }
+  return message;
 }
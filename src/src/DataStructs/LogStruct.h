@@ -6,23 +6,33 @@
 
 #include "../DataStructs/LogEntry.h"
 
+#include <vector>
+
 /*********************************************************************************************\
  * LogStruct
+ * Log lines are kept in a ring buffer of bytes, allocated on first use.
+ * Must be a power of 2.
 \*********************************************************************************************/
-#ifdef ESP32
-  #define LOG_STRUCT_MESSAGE_LINES 60
-#else
-  #ifdef USE_SECOND_HEAP
-    #define LOG_STRUCT_MESSAGE_LINES 60
+#ifndef LOG_STRUCT_BUFFER_SIZE
+  #ifdef ESP32
+    #define LOG_STRUCT_BUFFER_SIZE 8192
   #else
-    #if defined(PLUGIN_BUILD_COLLECTION) || defined(PLUGIN_BUILD_DEV)
-      #define LOG_STRUCT_MESSAGE_LINES 10
+    #ifdef USE_SECOND_HEAP
+      #define LOG_STRUCT_BUFFER_SIZE 4096
     #else
-      #define LOG_STRUCT_MESSAGE_LINES 15
+      #if defined(PLUGIN_BUILD_COLLECTION) || defined(PLUGIN_BUILD_DEV)
+        #define LOG_STRUCT_BUFFER_SIZE 1024
+      #else
+        #define LOG_STRUCT_BUFFER_SIZE 2048
+      #endif
     #endif
   #endif
 #endif
 
+// Estimate of the nr of lines in the buffer, assuming an average message length of 64 bytes.
+// Only used as long as the buffer is empty, see getCapacityInEntries()
+#define LOG_STRUCT_MESSAGE_LINES (LOG_STRUCT_BUFFER_SIZE / (64 + sizeof(LogEntry_t)))
+
 #ifdef ESP32
   #define LOG_BUFFER_ACTIVE_READ_TIMEOUT 30000
 #else
@@ -31,45 +41,88 @@
 
 
 struct LogStruct {
-    
+    // Each reader has its own cursor in the ring buffer.
+    // A reader falling behind only misses the entries which were overwritten,
+    // it does not affect other readers.
+    // Serial, syslog and SD card logging do not read from this buffer:
+    // Serial output has its own byte buffer in ESPEasy_Console and
+    // syslog and SD card lines are written directly when the line is logged.
+    enum class Reader : uint8_t {
+      WebLog,
+
+      NrReaders // Keep as last
+    };
+
     void add(const uint8_t loglevel, const String& line);
     void add(const uint8_t loglevel, String&& line);
 
-    // Read the next item and append it to the given string.
-    // Returns whether new lines are available.
-//    bool get(String& output, const String& lineEnd);
+    // Only store the pointer to the flash string, the message is copied when read.
+    void add(const uint8_t loglevel, const __FlashStringHelper *line);
 
     // Returns whether a line was retrieved.
-    bool getNext(bool& logLinesAvailable, unsigned long& timestamp, String& message, uint8_t& loglevel);
+    bool getNext(Reader reader, bool& logLinesAvailable, unsigned long& timestamp, String& message, uint8_t& loglevel);
+
+    bool getNext(bool& logLinesAvailable, unsigned long& timestamp, String& message, uint8_t& loglevel) {
+      return getNext(Reader::WebLog, logLinesAvailable, timestamp, message, loglevel);
+    }
 
     bool isEmpty() const {
-      return !is_full && (write_idx == read_idx);
+      return _head == _tail;
     }
 
-    bool isFull() const { return is_full; }
+    // Nr of entries the buffer can hold, based on the average size of the entries present.
+    uint32_t getCapacityInEntries() const;
 
+    // Returns whether any reader has been reading recently.
+    // Frees the buffer when no reader is active.
     bool logActiveRead();
 
-  private:
+    // Nr of log entries which could not be stored, or were overwritten before an active reader read them.
+    uint32_t getNrDropped() const {
+      return _nrDropped;
+    }
 
-    void add_end();
+  private:
 
-    void clearExpiredEntries();
+    bool reserveSpace(uint32_t size);
 
     void clearOldest();
 
-    static int nextIndex(int idx) {
-//      return ((++idx) == LOG_STRUCT_MESSAGE_LINES) ? 0 : idx;
-      return (idx + 1) % LOG_STRUCT_MESSAGE_LINES;
+    void clear();
+
+    void writeBytes(const void *src, uint32_t size);
+
+    void readBytes(uint32_t pos, void *dst, uint32_t size) const;
+
+    String readMessage(const LogEntry_t& entry, uint32_t pos) const;
+
+    // Positions are ever increasing byte counters, the index in the buffer is pos % LOG_STRUCT_BUFFER_SIZE
+    static uint32_t bufferIndex(uint32_t pos) {
+      return pos & (LOG_STRUCT_BUFFER_SIZE - 1);
+    }
+
+    // Wrap-around safe check whether position a is before b.
+    static bool isBefore(uint32_t a, uint32_t b) {
+      return static_cast<int32_t>(a - b) < 0;
     }
 
-    LogEntry_t Message[LOG_STRUCT_MESSAGE_LINES];
-    int write_idx = 0;
-    int read_idx = 0;
-    unsigned long lastReadTimeStamp = 0;
-    bool is_full = false;
+    std::vector<uint8_t> _buffer;
+
+    // Write position
+    uint32_t _head = 0;
+
+    // Start of the oldest entry in the buffer
+    uint32_t _tail = 0;
+
+    // Nr of entries between _tail and _head
+    uint32_t _nrEntries = 0;
+
+    uint32_t _readPos[static_cast<uint8_t>(Reader::NrReaders)] = {};
+    unsigned long _lastReadTimeStamp[static_cast<uint8_t>(Reader::NrReaders)] = {};
+
+    uint32_t _nrDropped = 0;
 };
 
 
 
-#endif // DATASTRUCTS_LOGSTRUCT_H
\ No newline at end of file
+#endif // DATASTRUCTS_LOGSTRUCT_H
@@ -0,0 +1,333 @@
+#include "../DataStructs/MetricsRegistry.h"
+
+#if FEATURE_METRICS_REGISTRY
+
+# include "../Globals/TXBuffer.h"
+
+
+static_assert(METRICS_HISTOGRAM_NR_BUCKETS <= 32, "Highest histogram bucket bound must fit in uint32_t");
+
+
+MetricsHistogram::MetricsHistogram(uint8_t bucketShift)
+  : _bucketShift(std::min<uint8_t>(bucketShift, 32 - METRICS_HISTOGRAM_NR_BUCKETS)) {}
+
+void MetricsHistogram::observe(uint32_t value)
+{
+  _sum += value;
+
+  // Bucket i holds values in range (2^(shift+i-1) .. 2^(shift+i)]
+  uint8_t bucket = 0;
+
+  if (value > 1) {
+    // ceil(log2(value))
+    const uint8_t log2_ceil = 32 - __builtin_clz(value - 1);
+
+    if (log2_ceil > _bucketShift) {
+      bucket = log2_ceil - _bucketShift;
+
+      if (bucket > METRICS_HISTOGRAM_NR_BUCKETS) {
+        bucket = METRICS_HISTOGRAM_NR_BUCKETS;
+      }
+    }
+  }
+  ++_counts[bucket];
+}
+
+metricIndex_t MetricsRegistry::addCounter(
+  const __FlashStringHelper *name,
+  const __FlashStringHelper *help,
+  metric_value_function      valueFunction,
+  const __FlashStringHelper *labelName,
+  const String             & labelValue)
+{
+  return add(MetricType::Counter, name, help, valueFunction, labelName, labelValue);
+}
+
+metricIndex_t MetricsRegistry::addGauge(
+  const __FlashStringHelper *name,
+  const __FlashStringHelper *help,
+  metric_value_function      valueFunction,
+  const __FlashStringHelper *labelName,
+  const String             & labelValue)
+{
+  return add(MetricType::Gauge, name, help, valueFunction, labelName, labelValue);
+}
+
+metricIndex_t MetricsRegistry::addHistogram(
+  const __FlashStringHelper *name,
+  const __FlashStringHelper *help,
+  uint8_t                    bucketShift,
+  const __FlashStringHelper *labelName,
+  const String             & labelValue)
+{
+  const metricIndex_t index = add(MetricType::Histogram, name, help, nullptr, labelName, labelValue);
+
+  if (index != INVALID_METRIC_INDEX) {
+    _metrics[index].histogram.reset(new (std::nothrow) MetricsHistogram(bucketShift));
+
+    if (!_metrics[index].histogram) {
+      metricIndex_t tmp = index;
+      remove(tmp);
+      return INVALID_METRIC_INDEX;
+    }
+  }
+  return index;
+}
+
+void MetricsRegistry::remove(metricIndex_t& index)
+{
+  if (isValid(index)) {
+    // Keep the slot, so indices of other metrics remain valid.
+    _metrics[index] = Metric();
+  }
+  index = INVALID_METRIC_INDEX;
+}
+
+void MetricsRegistry::increment(metricIndex_t index, uint32_t count)
+{
+  if (isValid(index)) {
+    _metrics[index].value += count;
+  }
+}
+
+void MetricsRegistry::set(metricIndex_t index, double value)
+{
+  if (isValid(index)) {
+    _metrics[index].value = value;
+  }
+}
+
+void MetricsRegistry::observe(metricIndex_t index, uint32_t value)
+{
+  if (isValid(index) && _metrics[index].histogram) {
+    _metrics[index].histogram->observe(value);
+  }
+}
+
+void MetricsRegistry::serialize() const
+{
+  const size_t nrMetrics = _metrics.size();
+
+  for (size_t i = 0; i < nrMetrics; ++i) {
+    const Metric& metric = _metrics[i];
+
+    if (metric.name == nullptr) {
+      continue;
+    }
+    bool familyWritten = false;
+
+    for (size_t j = 0; j < i && !familyWritten; ++j) {
+      familyWritten = _metrics[j].name == metric.name;
+    }
+
+    if (familyWritten) {
+      continue;
+    }
+
+    TXBuffer += F("# HELP ");
+    writeName(metric);
+    TXBuffer += ' ';
+    TXBuffer += metric.help;
+    TXBuffer += '\n';
+    TXBuffer += F("# TYPE ");
+    writeName(metric);
+
+    switch (metric.type) {
+      case MetricType::Counter:   TXBuffer += F(" counter\n");   break;
+      case MetricType::Gauge:     TXBuffer += F(" gauge\n");     break;
+      case MetricType::Histogram: TXBuffer += F(" histogram\n"); break;
+    }
+
+    // Write all series of this family
+    for (size_t j = i; j < nrMetrics; ++j) {
+      if (_metrics[j].name == metric.name) {
+        serializeSeries(_metrics[j]);
+      }
+    }
+  }
+}
+
+metricIndex_t MetricsRegistry::add(
+  MetricType                 type,
+  const __FlashStringHelper *name,
+  const __FlashStringHelper *help,
+  metric_value_function      valueFunction,
+  const __FlashStringHelper *labelName,
+  const String             & labelValue)
+{
+  if (name == nullptr) {
+    return INVALID_METRIC_INDEX;
+  }
+
+  // Reuse a removed slot first
+  size_t index = 0;
+
+  while (index < _metrics.size() && _metrics[index].name != nullptr) {
+    ++index;
+  }
+
+  if (index >= INVALID_METRIC_INDEX) {
+    return INVALID_METRIC_INDEX;
+  }
+
+  if (index == _metrics.size()) {
+    _metrics.emplace_back();
+  }
+  Metric& metric = _metrics[index];
+
+  metric.name          = name;
+  metric.help          = help;
+  metric.labelName     = labelName;
+  metric.labelValue    = labelValue;
+  metric.valueFunction = valueFunction;
+  metric.type          = type;
+  return index;
+}
+
+bool MetricsRegistry::isValid(metricIndex_t index) const
+{
+  return index < _metrics.size() && _metrics[index].name != nullptr;
+}
+
+void MetricsRegistry::serializeSeries(const Metric& metric)
+{
+  if (metric.type != MetricType::Histogram) {
+    writeName(metric);
+    writeLabels(metric);
+    TXBuffer += ' ';
+    writeValue((metric.valueFunction != nullptr) ? metric.valueFunction() : metric.value);
+    TXBuffer += '\n';
+    return;
+  }
+
+  if (!metric.histogram) {
+    return;
+  }
+
+  // Buckets are cumulative in the Prometheus format.
+  uint64_t count = 0;
+
+  for (uint8_t bucket = 0; bucket <= METRICS_HISTOGRAM_NR_BUCKETS; ++bucket) {
+    count += metric.histogram->_counts[bucket];
+    writeName(metric, F("_bucket"));
+    writeLabels(metric, F("le"),
+                (bucket < METRICS_HISTOGRAM_NR_BUCKETS) ? metric.histogram->getBucketBound(bucket) : 0);
+    TXBuffer += ' ';
+    writeValue(count);
+    TXBuffer += '\n';
+  }
+  writeName(metric, F("_sum"));
+  writeLabels(metric);
+  TXBuffer += ' ';
+  writeValue(metric.histogram->_sum);
+  TXBuffer += '\n';
+  writeName(metric, F("_count"));
+  writeLabels(metric);
+  TXBuffer += ' ';
+  writeValue(count);
+  TXBuffer += '\n';
+}
+
+void MetricsRegistry::writeName(const Metric& metric, const __FlashStringHelper *suffix)
+{
+  TXBuffer += F("espeasy_");
+  TXBuffer += metric.name;
+
+  if (suffix != nullptr) {
+    TXBuffer += suffix;
+  }
+}
+
+void MetricsRegistry::writeLabels(const Metric& metric, const __FlashStringHelper *extraLabel, uint32_t extraValue)
+{
+  const bool hasLabel = metric.labelName != nullptr;
+
+  if (!hasLabel && (extraLabel == nullptr)) {
+    return;
+  }
+  TXBuffer += '{';
+
+  if (hasLabel) {
+    TXBuffer += metric.labelName;
+    TXBuffer += '=';
+    TXBuffer += '"';
+
+    // Label values must escape backslash, double quote and newline
+    const size_t length = metric.labelValue.length();
+
+    for (size_t i = 0; i < length; ++i) {
+      const char c = metric.labelValue[i];
+
+      if ((c == '\\') || (c == '"')) {
+        TXBuffer += '\\';
+        TXBuffer += c;
+      } else if (c == '\n') {
+        TXBuffer += '\\';
+        TXBuffer += 'n';
+      } else {
+        TXBuffer += c;
+      }
+    }
+    TXBuffer += '"';
+  }
+
+  if (extraLabel != nullptr) {
+    if (hasLabel) {
+      TXBuffer += ',';
+    }
+    TXBuffer += extraLabel;
+    TXBuffer += '=';
+    TXBuffer += '"';
+
+    if (extraValue == 0) {
+      TXBuffer += F("+Inf");
+    } else {
+      writeValue(static_cast<uint64_t>(extraValue));
+    }
+    TXBuffer += '"';
+  }
+  TXBuffer += '}';
+}
+
+void MetricsRegistry::writeValue(double value)
+{
+  if (isnan(value)) {
+    TXBuffer += F("NaN");
+    return;
+  }
+
+  if (isinf(value)) {
+    TXBuffer += (value > 0) ? F("+Inf") : F("-Inf");
+    return;
+  }
+
+  if ((value >= 0) && (value < 1e15) && (value == floor(value))) {
+    writeValue(static_cast<uint64_t>(value));
+    return;
+  }
+
+  // Max. 308 digits for a double, so use exponent notation for large values.
+  char buf[32];
+
+  if ((value > -1e15) && (value < 1e15)) {
+    dtostrf(value, 0, 3, buf);
+  } else {
+    snprintf_P(buf, sizeof(buf), PSTR("%e"), value);
+  }
+  TXBuffer.addBuffer(buf, strlen(buf));
+}
+
+void MetricsRegistry::writeValue(uint64_t value)
+{
+  char  buf[21];
+  char *pos = buf + sizeof(buf);
+
+  do {
+    *(--pos) = '0' + (value % 10);
+    value   /= 10;
+  } while (value != 0);
+
+  TXBuffer.addBuffer(pos, (buf + sizeof(buf)) - pos);
+}
+
+#endif // if FEATURE_METRICS_REGISTRY
@@ -0,0 +1,137 @@
+#ifndef DATASTRUCTS_METRICSREGISTRY_H
+#define DATASTRUCTS_METRICSREGISTRY_H
+
+#include "../../ESPEasy_common.h"
+
+#if FEATURE_METRICS_REGISTRY
+
+# include <memory>
+# include <vector>
+
+// Nr of buckets in a histogram, excluding the "+Inf" bucket.
+# ifndef METRICS_HISTOGRAM_NR_BUCKETS
+#  define METRICS_HISTOGRAM_NR_BUCKETS 16
+# endif // ifndef METRICS_HISTOGRAM_NR_BUCKETS
+
+typedef uint8_t metricIndex_t;
+# define INVALID_METRIC_INDEX  255
+
+// Function to read the current value of a counter or gauge when serializing.
+typedef double (*metric_value_function)();
+
+enum class MetricType : uint8_t {
+  Counter,
+  Gauge,
+  Histogram
+};
+
+/*********************************************************************************************\
+* Histogram with power of 2 bucket bounds: 2^bucketShift, 2^(bucketShift+1), ...
+* Uses constant memory and observing a value only takes a few instructions,
+* so it can be left enabled in production builds.
+\*********************************************************************************************/
+struct MetricsHistogram {
+  explicit MetricsHistogram(uint8_t bucketShift);
+
+  void     observe(uint32_t value);
+
+  uint32_t getBucketBound(uint8_t bucket) const {
+    return 1ul << (_bucketShift + bucket);
+  }
+
+  // Count per bucket, not cumulative. Last one is for values above the highest bound.
+  uint32_t _counts[METRICS_HISTOGRAM_NR_BUCKETS + 1]{};
+  uint64_t _sum = 0;
+  uint8_t  _bucketShift;
+};
+
+/*********************************************************************************************\
+* Registry of counters, gauges and histograms, serialized in the Prometheus text format.
+* Subsystems register their metrics once and keep the returned index to update it.
+*
+* Metrics with the same name form a family, distinguished by a single label.
+* All metrics of a family must use the same name pointer, thus use a single F() for the name.
+* The "espeasy_" prefix is added to the name when serializing.
+\*********************************************************************************************/
+class MetricsRegistry {
+public:
+
+  // When valueFunction is set, it is called to get the value when serializing.
+  metricIndex_t addCounter(const __FlashStringHelper *name,
+                           const __FlashStringHelper *help,
+                           metric_value_function      valueFunction = nullptr,
+                           const __FlashStringHelper *labelName     = nullptr,
+                           const String             & labelValue    = EMPTY_STRING);
+
+  metricIndex_t addGauge(const __FlashStringHelper *name,
+                         const __FlashStringHelper *help,
+                         metric_value_function      valueFunction = nullptr,
+                         const __FlashStringHelper *labelName     = nullptr,
+                         const String             & labelValue    = EMPTY_STRING);
+
+  metricIndex_t addHistogram(const __FlashStringHelper *name,
+                             const __FlashStringHelper *help,
+                             uint8_t                    bucketShift,
+                             const __FlashStringHelper *labelName  = nullptr,
+                             const String             & labelValue = EMPTY_STRING);
+
+  // Remove the metric and set index to INVALID_METRIC_INDEX.
+  void remove(metricIndex_t& index);
+
+  void increment(metricIndex_t index,
+                 uint32_t      count = 1);
+
+  void set(metricIndex_t index,
+           double        value);
+
+  void observe(metricIndex_t index,
+               uint32_t      value);
+
+  // Write all metrics in the Prometheus text format to TXBuffer.
+  void serialize() const;
+
+private:
+
+  struct Metric {
+    // nullptr for an unused slot
+    const __FlashStringHelper        *name          = nullptr;
+    const __FlashStringHelper        *help          = nullptr;
+    const __FlashStringHelper        *labelName     = nullptr;
+    String                            labelValue;
+    metric_value_function             valueFunction = nullptr;
+    std::unique_ptr<MetricsHistogram> histogram;
+    double                            value = 0;
+    MetricType                        type  = MetricType::Counter;
+  };
+
+  metricIndex_t add(MetricType                 type,
+                    const __FlashStringHelper *name,
+                    const __FlashStringHelper *help,
+                    metric_value_function      valueFunction,
+                    const __FlashStringHelper *labelName,
+                    const String             & labelValue);
+
+  bool        isValid(metricIndex_t index) const;
+
+  static void serializeSeries(const Metric& metric);
+
+  // Write name including the prefix and optional suffix, like "_bucket"
+  static void writeName(const Metric             & metric,
+                        const __FlashStringHelper *suffix = nullptr);
+
+  // Write the label, with an optional extra label, like le="100"
+  // An extraValue of 0 is written as "+Inf".
+  static void writeLabels(const Metric             & metric,
+                          const __FlashStringHelper *extraLabel = nullptr,
+                          uint32_t                   extraValue = 0);
+
+  static void writeValue(double value);
+
+  static void writeValue(uint64_t value);
+
+  std::vector<Metric> _metrics;
+};
+
+#endif // if FEATURE_METRICS_REGISTRY
+
+#endif // ifndef DATASTRUCTS_METRICSREGISTRY_H
@@ -37,7 +37,7 @@ bool NodeStruct::validate() {
   }
   if (build < 20253) {
     version = 0;
-    dummy = 0;
+    features = 0;
     unix_time_frac = 0;
     unix_time_sec = 0;
   }
@@ -251,6 +251,11 @@ bool NodeStruct::isThisNode() const
     return false;
 }
 
+bool NodeStruct::supportsP2P_DataBatch() const
+{
+  return (features & NODE_FEATURE_P2P_DATA_BATCH) != 0;
+}
+
 void NodeStruct::setAP_MAC(const MAC_address& mac)
 {
   mac.get(ap_mac);
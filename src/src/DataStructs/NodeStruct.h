@@ -11,6 +11,10 @@
 #include <map>
 
 
+// Bits in NodeStruct::features
+#define NODE_FEATURE_P2P_DATA_BATCH  0x01 // Can receive C013 frames with data of multiple tasks
+
+
 /*********************************************************************************************\
 * NodeStruct
 \*********************************************************************************************/
@@ -59,6 +63,8 @@ struct __attribute__((__packed__)) NodeStruct
 
   bool          isThisNode() const;
 
+  bool          supportsP2P_DataBatch() const;
+
   void          setAP_MAC(const MAC_address& mac);
 
 
@@ -97,7 +103,7 @@ struct __attribute__((__packed__)) NodeStruct
   // When kept as node info, this is the last time stamp the node info was updated.
   unsigned long lastUpdated = (1 << 30);
   uint8_t  version = 1;
-  uint8_t  dummy = 0; // Not yet used
+  uint8_t  features = 0; // NODE_FEATURE_xxx bits, 0 on nodes which did not yet use this
   uint32_t unix_time_sec = 0;
   uint32_t unix_time_frac = 0;
 };
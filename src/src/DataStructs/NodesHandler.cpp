@@ -377,6 +377,9 @@ void NodesHandler::updateThisNode() {
   thisNode.build = Settings.Build;
   memcpy(thisNode.nodeName, Settings.getName().c_str(), 25);
   thisNode.nodeType = NODE_TYPE_ID;
+  #ifdef USES_C013
+  thisNode.features |= NODE_FEATURE_P2P_DATA_BATCH;
+  #endif
 
   thisNode.webgui_portnumber = Settings.WebserverPort;
   const int load_int = getCPUload() * 2.55;
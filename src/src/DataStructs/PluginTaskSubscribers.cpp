@@ -0,0 +1,145 @@
+#include "../DataStructs/PluginTaskSubscribers.h"
+
+#include "../DataStructs/ESPEasy_EventStruct.h"
+#include "../DataTypes/ESPEasy_plugin_functions.h"
+
+#include "../Globals/Device.h"
+#include "../Globals/Plugins.h"
+#include "../Globals/Settings.h"
+
+#include "../Helpers/_Plugin_init.h"
+
+
+const taskIndex_t * PluginTaskSubscribers::getTasks(uint8_t Function, uint8_t& nrTasks)
+{
+  refresh();
+  const TaskList *list = nullptr;
+
+  switch (Function) {
+    case PLUGIN_TEN_PER_SECOND:   list = &_tenPerSecond;   break;
+    case PLUGIN_FIFTY_PER_SECOND: list = &_fiftyPerSecond; break;
+    default:
+      nrTasks = 0;
+      return nullptr;
+  }
+  nrTasks = list->count;
+  return list->tasks;
+}
+
+void PluginTaskSubscribers::refresh()
+{
+  if (settingsChanged()) {
+    rebuild();
+  }
+}
+
+bool PluginTaskSubscribers::acceptsCommand(taskIndex_t taskIndex, const String& cmd_lc) const
+{
+  if (!validTaskIndex(taskIndex)) {
+    return true;
+  }
+  const uint8_t index = _commandPrefixesIndex[taskIndex];
+
+  if (index >= _commandPrefixes.size()) {
+    return true;
+  }
+  return matchCommandPrefixes(_commandPrefixes[index], cmd_lc);
+}
+
+bool PluginTaskSubscribers::settingsChanged() const
+{
+  // Only a few compares of TASKS_MAX bytes, which is a lot cheaper than
+  // checking every task each call and needs no hooks where settings are changed.
+  return _deviceCount != getDeviceCount() ||
+         memcmp(_taskDeviceNumber,   Settings.TaskDeviceNumber,   sizeof(_taskDeviceNumber)) != 0 ||
+         memcmp(_taskDeviceDataFeed, Settings.TaskDeviceDataFeed, sizeof(_taskDeviceDataFeed)) != 0 ||
+         memcmp(_taskDeviceEnabled,  Settings.TaskDeviceEnabled,  sizeof(_taskDeviceEnabled)) != 0;
+}
+
+void PluginTaskSubscribers::rebuild()
+{
+  memcpy(_taskDeviceNumber,   Settings.TaskDeviceNumber,   sizeof(_taskDeviceNumber));
+  memcpy(_taskDeviceDataFeed, Settings.TaskDeviceDataFeed, sizeof(_taskDeviceDataFeed));
+  memcpy(_taskDeviceEnabled,  Settings.TaskDeviceEnabled,  sizeof(_taskDeviceEnabled));
+  _deviceCount = getDeviceCount();
+
+  _tenPerSecond.count   = 0;
+  _fiftyPerSecond.count = 0;
+  _commandPrefixes.clear();
+
+  for (taskIndex_t taskIndex = 0; taskIndex < TASKS_MAX; ++taskIndex) {
+    _commandPrefixesIndex[taskIndex] = NO_COMMAND_PREFIXES;
+
+    // Same checks as done in PluginCallForTask()
+    if (!Settings.TaskDeviceEnabled[taskIndex] ||
+        (Settings.TaskDeviceDataFeed[taskIndex] != 0) ||
+        !validPluginID_fullcheck(Settings.getPluginID_for_task(taskIndex))) {
+      continue;
+    }
+    const deviceIndex_t DeviceIndex = getDeviceIndex_from_TaskIndex(taskIndex);
+
+    if (!validDeviceIndex(DeviceIndex)) {
+      continue;
+    }
+
+    if (Device[DeviceIndex].TenPerSecond) {
+      _tenPerSecond.tasks[_tenPerSecond.count++] = taskIndex;
+    }
+
+    if (Device[DeviceIndex].FiftyPerSecond) {
+      _fiftyPerSecond.tasks[_fiftyPerSecond.count++] = taskIndex;
+    }
+
+    // Tasks of the same plugin share the same entry.
+    for (taskIndex_t i = 0; i < taskIndex; ++i) {
+      if ((Settings.getPluginID_for_task(i) == Settings.getPluginID_for_task(taskIndex)) &&
+          (_commandPrefixesIndex[i] != NO_COMMAND_PREFIXES)) {
+        _commandPrefixesIndex[taskIndex] = _commandPrefixesIndex[i];
+        break;
+      }
+    }
+
+    if (_commandPrefixesIndex[taskIndex] == NO_COMMAND_PREFIXES) {
+      struct EventStruct TempEvent(taskIndex);
+      String prefixes;
+
+      if (PluginCall(DeviceIndex, PLUGIN_GET_COMMAND_PREFIXES, &TempEvent, prefixes) &&
+          !prefixes.isEmpty() &&
+          (_commandPrefixes.size() < NO_COMMAND_PREFIXES)) {
+        prefixes.toLowerCase();
+        _commandPrefixesIndex[taskIndex] = _commandPrefixes.size();
+        _commandPrefixes.emplace_back(std::move(prefixes));
+      }
+    }
+  }
+}
+
+bool PluginTaskSubscribers::matchCommandPrefixes(const String& prefixes, const String& cmd_lc)
+{
+  const size_t cmd_length = cmd_lc.length();
+  int start               = 0;
+
+  while (start < static_cast<int>(prefixes.length())) {
+    int end = prefixes.indexOf(',', start);
+
+    if (end < 0) {
+      end = prefixes.length();
+    }
+    size_t length = end - start;
+
+    if ((length > 0) && (prefixes[end - 1] == '*')) {
+      // Prefix, only compare the part before the '*'
+      --length;
+
+      if ((cmd_length >= length) &&
+          (strncmp(cmd_lc.c_str(), prefixes.c_str() + start, length) == 0)) {
+        return true;
+      }
+    } else if ((cmd_length == length) &&
+               (strncmp(cmd_lc.c_str(), prefixes.c_str() + start, length) == 0)) {
+      return true;
+    }
+    start = end + 1;
+  }
+  return false;
+}
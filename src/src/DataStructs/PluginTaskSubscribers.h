@@ -0,0 +1,73 @@
+#ifndef DATASTRUCTS_PLUGINTASKSUBSCRIBERS_H
+#define DATASTRUCTS_PLUGINTASKSUBSCRIBERS_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../CustomBuild/ESPEasyLimits.h"
+#include "../DataTypes/TaskIndex.h"
+
+#include <vector>
+
+
+/*********************************************************************************************\
+* Lists of active tasks per frequently called plugin function.
+* A task is only listed when it is enabled, reads a local sensor and its plugin declared
+* to handle the function in PLUGIN_DEVICE_ADD (e.g. DeviceStruct::FiftyPerSecond).
+*
+* Also keeps the command (prefixes) a plugin declared via PLUGIN_GET_COMMAND_PREFIXES,
+* to only call PLUGIN_WRITE of tasks which may handle the command.
+*
+* The lists are rebuilt when the task settings they depend on have changed,
+* like a task being enabled, disabled or assigned to another plugin.
+\*********************************************************************************************/
+class PluginTaskSubscribers {
+public:
+
+  // Return the tasks to call for Function, sorted by task index.
+  // The returned pointer is only valid until the next call.
+  const taskIndex_t* getTasks(uint8_t  Function,
+                              uint8_t& nrTasks);
+
+  // Rebuild the lists when needed.
+  // Must be called before acceptsCommand() to handle changed settings.
+  void refresh();
+
+  // Return true when PLUGIN_WRITE of the task must be called for the command.
+  // cmd_lc is the first argument of the command, in lower case.
+  // Tasks of plugins not implementing PLUGIN_GET_COMMAND_PREFIXES accept all commands.
+  bool acceptsCommand(taskIndex_t   taskIndex,
+                      const String& cmd_lc) const;
+
+private:
+
+  struct TaskList {
+    taskIndex_t tasks[TASKS_MAX]{};
+    uint8_t     count = 0;
+  };
+
+  bool settingsChanged() const;
+
+  void rebuild();
+
+  static bool matchCommandPrefixes(const String& prefixes,
+                                   const String& cmd_lc);
+
+  static constexpr uint8_t NO_COMMAND_PREFIXES = 255;
+
+  TaskList _tenPerSecond;
+  TaskList _fiftyPerSecond;
+
+  // Comma separated list of commands per plugin, an entry ending with '*' is a prefix.
+  std::vector<String> _commandPrefixes;
+
+  // Per task the index in _commandPrefixes
+  uint8_t _commandPrefixesIndex[TASKS_MAX]{};
+
+  // Copy of the settings used to build the lists.
+  uint8_t _taskDeviceNumber[TASKS_MAX]{};
+  uint8_t _taskDeviceDataFeed[TASKS_MAX]{};
+  boolean _taskDeviceEnabled[TASKS_MAX]{};
+  int     _deviceCount = -1;
+};
+
+#endif // ifndef DATASTRUCTS_PLUGINTASKSUBSCRIBERS_H
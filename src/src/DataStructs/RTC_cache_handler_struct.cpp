@@ -8,9 +8,13 @@
 #include "../Helpers/ESPEasy_Storage.h"
 #include "../Helpers/StringConverter.h"
 
+#include "../ControllerQueue/C016_queue_element.h"
+
 #include "../ESPEasyCore/ESPEasy_backgroundtasks.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
 
+#include <algorithm>
+
 #ifdef ESP8266
 # include <user_interface.h>
 #endif // ifdef ESP8266
@@ -67,24 +71,23 @@ void RTC_cache_handler_struct::resetpeek() {
 
 bool RTC_cache_handler_struct::peekDataAvailable() const {
   if (fp) {
-    if ((_peekreadpos + 1) < fp.size()) { return true; }
+    if ((_peekreadpos + 1) < getPeekFileLogicalSize()) { return true; }
   }
   if (_peekfilenr < RTC_cache.writeFileNr) {
     return true;
   }
 
   if (_peekfilenr == RTC_cache.writeFileNr) {
-    if (fw) {
-      return ((_peekreadpos + 1) < fw.position());
-    }
-//    return true;
+    // Samples not yet flushed from the RTC buffer follow the samples in the write file.
+    const size_t fileSize = fp ? getPeekFileLogicalSize() : getWriteFileLogicalSize();
+    return (_peekreadpos + 1) < (fileSize + RTC_cache.writePos);
   }
   return false;
 }
 
 int RTC_cache_handler_struct::getPeekFilePos(int& peekFileNr) {
   peekFileNr = _peekfilenr;
-  if (fp) {
+  if (fp && !isPeekFileCompressed() && !isPeekInRTCbuffer()) {
     _peekreadpos = fp.position();
   }
   return _peekreadpos;
@@ -92,7 +95,7 @@ int RTC_cache_handler_struct::getPeekFilePos(int& peekFileNr) {
 
 int RTC_cache_handler_struct::getPeekFileSize(int peekFileNr) const {
   if (fp) {
-    return fp.size();
+    return getPeekFileLogicalSize();
   }
   return -1;
 }
@@ -101,12 +104,15 @@ void RTC_cache_handler_struct::setPeekFilePos(int newPeekFileNr, int newPeekRead
   validateFilePos(newPeekFileNr, newPeekReadPos);
 
   if (fp) {
-    if (newPeekReadPos < static_cast<int>(fp.position())) {
+    const int peekFilePos = isPeekFileCompressed() ? _peekreadpos : fp.position();
+
+    if (newPeekReadPos < peekFilePos) {
       _peekfilenr = newPeekFileNr;
       _peekreadpos = newPeekReadPos;
       fp.close();
     } else
-    if (newPeekReadPos >= static_cast<int>(fp.size()) && static_cast<int>(_peekfilenr) == newPeekFileNr) {
+    if (newPeekReadPos >= static_cast<int>(getPeekFileLogicalSize()) && static_cast<int>(_peekfilenr) == newPeekFileNr &&
+        newPeekFileNr < RTC_cache.writeFileNr) {
       newPeekFileNr++;
       newPeekReadPos = 0;
       validateFilePos(newPeekFileNr, newPeekReadPos);
@@ -120,38 +126,119 @@ void RTC_cache_handler_struct::setPeekFilePos(int newPeekFileNr, int newPeekRead
 
 
   if (!fp) {
-    String fname = createCacheFilename(newPeekFileNr);
-
-    if (fname.isEmpty()) { return; }
-
-    fp = tryOpenFile(fname, "r");
+    openPeekFile(newPeekFileNr);
   }
 
   if (fp) {
     _peekfilenr = newPeekFileNr;
 
     if (newPeekReadPos > 0) {
-      const int fileSize = fp.size();
+      const int fileSize = getPeekFileLogicalSize();
 
       if (fileSize <= newPeekReadPos) {
-        fp.seek(0, fs::SeekEnd);
-        _peekreadpos = fp.position();
-        return;
-      }
+        seekPeekFile(fileSize);
 
-      if (fp.seek(newPeekReadPos)) {
-        _peekreadpos = newPeekReadPos;
+        if (newPeekFileNr == RTC_cache.writeFileNr) {
+          // Position in the samples not yet flushed from the RTC buffer
+          _peekreadpos = std::min(newPeekReadPos, fileSize + RTC_cache.writePos);
+        }
+        return;
       }
+      seekPeekFile(newPeekReadPos);
     } else {
       _peekreadpos = 0;
     }
     return;
   }
 
+  if (newPeekFileNr == RTC_cache.writeFileNr) {
+    // Write file not yet created, all samples are still in the RTC buffer
+    _peekfilenr  = newPeekFileNr;
+    _peekreadpos = std::min(newPeekReadPos, static_cast<int>(RTC_cache.writePos));
+    return;
+  }
+
   _peekreadpos = 0;
   _peekfilenr  = 0;
 }
 
+bool RTC_cache_handler_struct::setPeekFilePosByTime(uint32_t fromTime, taskIndex_t taskIndex) {
+  for (int fileNr = RTC_cache.readFileNr; fileNr <= RTC_cache.writeFileNr; ++fileNr) {
+    if (fp) {
+      fp.close();
+    }
+
+    if (!openPeekFile(fileNr)) {
+      continue;
+    }
+    _peekfilenr  = fileNr;
+    _peekreadpos = 0;
+
+    #if FEATURE_C016_COMPRESSED_CACHE
+
+    if (_peekFileCompressed) {
+      for (size_t blockNr = 0; blockNr < _peekBlockIndex.size(); ++blockNr) {
+        const BlockIndexEntry& entry = _peekBlockIndex[blockNr];
+        ESPEasyControllerCache_block_header header;
+
+        // Use the block header to skip blocks without matching samples
+        if (!fp.seek(entry.filePos) ||
+            (fp.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) != sizeof(header)) ||
+            (header.endTime < fromTime) ||
+            (validTaskIndex(taskIndex) && !header.containsTask(taskIndex))) {
+          continue;
+        }
+
+        if (!decodePeekBlock(blockNr)) {
+          // Let peek() report and skip the corrupt block
+          _peekreadpos = entry.logicalPos;
+          return true;
+        }
+
+        for (size_t sampleNr = 0; sampleNr < _peekBlockSamples.size(); ++sampleNr) {
+          if (_peekBlockSamples[sampleNr].unixTime >= fromTime) {
+            _peekreadpos = entry.logicalPos + (sampleNr * sizeof(C016_binary_element));
+            return true;
+          }
+        }
+      }
+      continue;
+    }
+    #endif // if FEATURE_C016_COMPRESSED_CACHE
+
+    if (seekPeekFileByTime_uncompressed(fromTime)) {
+      return true;
+    }
+  }
+
+  // Check the samples not yet flushed from the RTC buffer
+  constexpr size_t elementSize = sizeof(C016_binary_element);
+
+  for (size_t readPos = 0; (readPos + elementSize) <= RTC_cache.writePos; readPos += elementSize) {
+    decltype(C016_binary_element::unixTime) unixTime{};
+
+    memcpy(&unixTime, &RTC_cache_data[readPos + offsetof(C016_binary_element, unixTime)], sizeof(unixTime));
+
+    if (unixTime >= fromTime) {
+      if (_peekfilenr != RTC_cache.writeFileNr) {
+        if (fp) {
+          fp.close();
+        }
+        openPeekFile(RTC_cache.writeFileNr);
+        _peekfilenr = RTC_cache.writeFileNr;
+      }
+      _peekreadpos = getPeekFileLogicalSize() + readPos;
+      return true;
+    }
+  }
+
+  // Nothing found, set peek position to the end.
+  if (fp) {
+    seekPeekFile(getPeekFileLogicalSize());
+  }
+  return false;
+}
+
 bool RTC_cache_handler_struct::peek(uint8_t *data, unsigned int size) {
   if (!fp) {
     if (_peekfilenr == 0) {
@@ -166,13 +253,24 @@ bool RTC_cache_handler_struct::peek(uint8_t *data, unsigned int size) {
 
   if (!peekDataAvailable()) { return false; }
 
+  if (isPeekInRTCbuffer()) {
+    return peekRTCbuffer(data, size);
+  }
+
   if (!fp) { return false; }
 
-  const size_t bytesRead = fp.read(data, size);
+  size_t bytesRead = 0;
 
-  _peekreadpos = fp.position();
+  if (isPeekFileCompressed()) {
+    #if FEATURE_C016_COMPRESSED_CACHE
+    bytesRead = peekCompressed(data, size);
+    #endif // if FEATURE_C016_COMPRESSED_CACHE
+  } else {
+    bytesRead    = fp.read(data, size);
+    _peekreadpos = fp.position();
+  }
 
-  if (_peekreadpos >= fp.size()) {
+  if (_peekreadpos >= getPeekFileLogicalSize()) {
     if (_peekfilenr < RTC_cache.writeFileNr) {
       fp.close();
       _peekreadpos = 0;
@@ -225,6 +323,19 @@ bool RTC_cache_handler_struct::write(const uint8_t *data, unsigned int size) {
 
 // Mark all content as being processed and empty buffer.
 bool RTC_cache_handler_struct::flush() {
+  // Peek position relative to the RTC buffer, when peeking samples not yet flushed.
+  int peekRTCbufferPos = -1;
+
+  if ((RTC_cache.writePos > 0) && (_peekfilenr != 0) && (_peekfilenr == RTC_cache.writeFileNr)) {
+    if (!fp) {
+      openPeekFile(_peekfilenr);
+    }
+
+    if (isPeekInRTCbuffer()) {
+      peekRTCbufferPos = _peekreadpos - getPeekFileLogicalSize();
+    }
+  }
+
   if (prepareFileForWrite()) {
     if (RTC_cache.writePos > 0) {
       #ifdef RTC_STRUCT_DEBUG
@@ -240,7 +351,7 @@ bool RTC_cache_handler_struct::flush() {
         fp.close();
       }
 
-      int bytesWritten = fw.write(&RTC_cache_data[0], RTC_cache.writePos);
+      const bool written = writeToFile();
 
       delay(0);
       fw.flush();
@@ -249,7 +360,7 @@ bool RTC_cache_handler_struct::flush() {
         #endif // ifdef RTC_STRUCT_DEBUG
 
 
-      if ((bytesWritten < RTC_cache.writePos) /*|| (fw.size() == filesize)*/) {
+      if (!written /*|| (fw.size() == filesize)*/) {
           #ifdef RTC_STRUCT_DEBUG
 
         if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
@@ -257,8 +368,6 @@ bool RTC_cache_handler_struct::flush() {
           log += filesize;
           log += F(" after: ");
           log += fw.size();
-          log += F(" written: ");
-          log += bytesWritten;
           addLogMove(LOG_LEVEL_ERROR, log);
         }
           #endif // ifdef RTC_STRUCT_DEBUG
@@ -270,6 +379,12 @@ bool RTC_cache_handler_struct::flush() {
         }
         return false;
       }
+
+      if (peekRTCbufferPos >= 0) {
+        // Keep pointing at the same sample, which may now be in a new write file.
+        _peekfilenr  = RTC_cache.writeFileNr;
+        _peekreadpos = getWriteFileLogicalSize() - RTC_cache.writePos + peekRTCbufferPos;
+      }
       initRTCcache_data();
       clearRTCcacheData();
       saveRTCcache();
@@ -588,6 +703,21 @@ bool RTC_cache_handler_struct::prepareFileForWrite() {
       String fname = createCacheFilename(RTC_cache.writeFileNr);
       fw = tryOpenFile(fname, "a+");
 
+      #if FEATURE_C016_COMPRESSED_CACHE
+
+      if (fw && !initWriteFileFormat(fname)) {
+        // Appending to this file would make the blocks after the incomplete one unreachable.
+        fw.close();
+        ++RTC_cache.writeFileNr;
+        fname = createCacheFilename(RTC_cache.writeFileNr);
+        fw    = tryOpenFile(fname, "a+");
+
+        if (fw) {
+          initWriteFileFormat(fname);
+        }
+      }
+      #endif // if FEATURE_C016_COMPRESSED_CACHE
+
       if (!fw) {
           #ifdef RTC_STRUCT_DEBUG
         addLog(LOG_LEVEL_ERROR, F("RTC  : error opening file"));
@@ -631,6 +761,307 @@ void RTC_cache_handler_struct::validateFilePos(int& fileNr, int& readPos) {
   }
 }
 
+size_t RTC_cache_handler_struct::getPeekFileLogicalSize() const {
+  if (!fp) {
+    return 0;
+  }
+  #if FEATURE_C016_COMPRESSED_CACHE
+
+  if (_peekFileCompressed) {
+    return _peekFileLogicalSize;
+  }
+  #endif // if FEATURE_C016_COMPRESSED_CACHE
+  return fp.size();
+}
+
+size_t RTC_cache_handler_struct::getWriteFileLogicalSize() const {
+  if (!fw) {
+    return 0;
+  }
+  #if FEATURE_C016_COMPRESSED_CACHE
+
+  if (_writeFileCompressed) {
+    return _writeFileLogicalSize;
+  }
+  #endif // if FEATURE_C016_COMPRESSED_CACHE
+  return fw.position();
+}
+
+bool RTC_cache_handler_struct::isPeekInRTCbuffer() const {
+  return (_peekfilenr != 0) &&
+         (_peekfilenr == RTC_cache.writeFileNr) &&
+         (_peekreadpos >= getPeekFileLogicalSize());
+}
+
+bool RTC_cache_handler_struct::peekRTCbuffer(uint8_t *data, unsigned int size) {
+  const size_t readPos = _peekreadpos - getPeekFileLogicalSize();
+
+  if ((readPos + size) > RTC_cache.writePos) {
+    return false;
+  }
+  memcpy(data, &RTC_cache_data[readPos], size);
+  _peekreadpos += size;
+  return true;
+}
+
+bool RTC_cache_handler_struct::isPeekFileCompressed() const {
+  #if FEATURE_C016_COMPRESSED_CACHE
+  return _peekFileCompressed;
+  #else // if FEATURE_C016_COMPRESSED_CACHE
+  return false;
+  #endif // if FEATURE_C016_COMPRESSED_CACHE
+}
+
+bool RTC_cache_handler_struct::openPeekFile(int fileNr) {
+  const String fname = createCacheFilename(fileNr);
+
+  if (fname.isEmpty()) { return false; }
+
+  fp = tryOpenFile(fname, "r");
+
+  if (!fp) {
+    return false;
+  }
+  #if FEATURE_C016_COMPRESSED_CACHE
+  size_t indexedSize = 0;
+
+  _peekBlockNr = -1;
+  _peekBlockSamples.clear();
+  _peekFileCompressed = readBlockIndex(fp, &_peekBlockIndex, _peekFileLogicalSize, indexedSize);
+  fp.seek(0);
+  #endif // if FEATURE_C016_COMPRESSED_CACHE
+  return true;
+}
+
+void RTC_cache_handler_struct::seekPeekFile(size_t readPos) {
+  #if FEATURE_C016_COMPRESSED_CACHE
+
+  if (_peekFileCompressed) {
+    // Only whole samples can be read from a compressed file.
+    readPos -= readPos % sizeof(C016_binary_element);
+
+    if (readPos > _peekFileLogicalSize) {
+      readPos = _peekFileLogicalSize;
+    }
+    _peekreadpos = readPos;
+    return;
+  }
+  #endif // if FEATURE_C016_COMPRESSED_CACHE
+
+  if (fp.seek(readPos)) {
+    _peekreadpos = readPos;
+  }
+}
+
+bool RTC_cache_handler_struct::seekPeekFileByTime_uncompressed(uint32_t fromTime) {
+  // Samples are appended in time order, unless the system time was changed.
+  constexpr size_t elementSize = sizeof(C016_binary_element);
+  const size_t     nrSamples   = fp.size() / elementSize;
+  size_t low                   = 0;
+  size_t high                  = nrSamples;
+
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    decltype(C016_binary_element::unixTime) unixTime{};
+
+    if (!fp.seek((mid * elementSize) + offsetof(C016_binary_element, unixTime)) ||
+        (fp.read(reinterpret_cast<uint8_t *>(&unixTime), sizeof(unixTime)) != sizeof(unixTime))) {
+      return false;
+    }
+
+    if (unixTime < fromTime) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  if (low >= nrSamples) {
+    return false;
+  }
+  seekPeekFile(low * elementSize);
+  return true;
+}
+
+bool RTC_cache_handler_struct::writeToFile() {
+  #if FEATURE_C016_COMPRESSED_CACHE
+
+  if (_writeFileCompressed) {
+    // RTC cache data only contains complete samples
+    const uint16_t nrSamples = RTC_cache.writePos / sizeof(C016_binary_element);
+    std::vector<uint8_t> block;
+
+    if (!ESPEasyControllerCache_block::encode(&RTC_cache_data[0], nrSamples, block)) {
+      return false;
+    }
+
+    if (fw.write(&block[0], block.size()) < block.size()) {
+      return false;
+    }
+    _writeFileLogicalSize += nrSamples * sizeof(C016_binary_element);
+    return true;
+  }
+  #endif // if FEATURE_C016_COMPRESSED_CACHE
+  return fw.write(&RTC_cache_data[0], RTC_cache.writePos) >= RTC_cache.writePos;
+}
+
+#if FEATURE_C016_COMPRESSED_CACHE
+bool RTC_cache_handler_struct::readBlockIndex(fs::File                    & file,
+                                              std::vector<BlockIndexEntry> *index,
+                                              size_t                      & logicalSize,
+                                              size_t                      & indexedSize)
+{
+  if (index != nullptr) {
+    index->clear();
+  }
+  logicalSize = 0;
+  indexedSize = 0;
+
+  const size_t fileSize = file.size();
+  bool compressed       = false;
+
+  while ((indexedSize + sizeof(ESPEasyControllerCache_block_header)) <= fileSize) {
+    ESPEasyControllerCache_block_header header;
+
+    if (!file.seek(indexedSize) ||
+        (file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) != sizeof(header)) ||
+        !header.isValid()) {
+      break;
+    }
+    const size_t blockSize = sizeof(header) + header.payloadSize;
+
+    if ((indexedSize + blockSize) > fileSize) {
+      // Incomplete block, e.g. when power was lost while writing
+      break;
+    }
+
+    if (index != nullptr) {
+      index->push_back({ static_cast<uint32_t>(indexedSize), static_cast<uint32_t>(logicalSize) });
+    }
+    compressed   = true;
+    logicalSize += header.nrSamples * sizeof(C016_binary_element);
+    indexedSize += blockSize;
+    delay(0);
+  }
+  return compressed;
+}
+
+bool RTC_cache_handler_struct::initWriteFileFormat(const String& fname)
+{
+  _writeFileLogicalSize = 0;
+  const size_t fileSize = fw.size();
+
+  if (fileSize == 0) {
+    _writeFileCompressed = true;
+    return true;
+  }
+
+  // Use a separate file handle, as the write file is opened for appending.
+  fs::File file        = tryOpenFile(fname, "r");
+  size_t   indexedSize = 0;
+
+  _writeFileCompressed = file && readBlockIndex(file, nullptr, _writeFileLogicalSize, indexedSize);
+
+  if (file) {
+    file.close();
+  }
+
+  if (!_writeFileCompressed) {
+    // File written by a build without compression, keep appending uncompressed samples.
+    return true;
+  }
+  return indexedSize == fileSize;
+}
+
+bool RTC_cache_handler_struct::decodePeekBlock(size_t blockNr)
+{
+  if (static_cast<int>(blockNr) == _peekBlockNr) {
+    return true;
+  }
+  _peekBlockNr = -1;
+
+  if (blockNr >= _peekBlockIndex.size()) {
+    return false;
+  }
+  ESPEasyControllerCache_block_header header;
+
+  if (!fp.seek(_peekBlockIndex[blockNr].filePos) ||
+      (fp.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) != sizeof(header)) ||
+      !header.isValid()) {
+    return false;
+  }
+  std::vector<uint8_t> payload;
+
+  payload.resize(header.payloadSize);
+
+  if ((fp.read(&payload[0], payload.size()) != payload.size()) ||
+      !ESPEasyControllerCache_block::decode(header, &payload[0], _peekBlockSamples)) {
+    return false;
+  }
+  _peekBlockNr = blockNr;
+  return true;
+}
+
+size_t RTC_cache_handler_struct::peekCompressed(uint8_t *data, unsigned int size)
+{
+  constexpr size_t elementSize = sizeof(C016_binary_element);
+
+  if (size != elementSize) {
+    return 0;
+  }
+
+  if (_peekreadpos >= _peekFileLogicalSize) {
+    // Peeking in the file currently written to, check for blocks appended after opening.
+    // Existing entries do not change, so the decoded block is still valid.
+    size_t indexedSize = 0;
+    readBlockIndex(fp, &_peekBlockIndex, _peekFileLogicalSize, indexedSize);
+  }
+
+  if (_peekBlockIndex.empty()) {
+    return 0;
+  }
+
+  // Find the last block starting at or before the peek position
+  auto it = std::upper_bound(
+    _peekBlockIndex.begin(), _peekBlockIndex.end(), _peekreadpos,
+    [](size_t readPos, const BlockIndexEntry& entry) {
+      return readPos < entry.logicalPos;
+    });
+
+  if (it == _peekBlockIndex.begin()) {
+    return 0;
+  }
+  size_t blockNr = (it - _peekBlockIndex.begin()) - 1;
+
+  while (blockNr < _peekBlockIndex.size()) {
+    const BlockIndexEntry& entry = _peekBlockIndex[blockNr];
+    const size_t nextBlockPos    = (blockNr + 1) < _peekBlockIndex.size()
+      ? _peekBlockIndex[blockNr + 1].logicalPos
+      : _peekFileLogicalSize;
+
+    if (!decodePeekBlock(blockNr)) {
+      addLog(LOG_LEVEL_ERROR, F("RTC  : Error decoding cache block, skipped"));
+      _peekreadpos = nextBlockPos;
+      ++blockNr;
+      continue;
+    }
+
+    const size_t sampleNr = (_peekreadpos - entry.logicalPos) / elementSize;
+
+    if (sampleNr >= _peekBlockSamples.size()) {
+      _peekreadpos = nextBlockPos;
+      ++blockNr;
+      continue;
+    }
+    memcpy(data, &_peekBlockSamples[sampleNr], elementSize);
+    _peekreadpos = entry.logicalPos + ((sampleNr + 1) * elementSize);
+    return elementSize;
+  }
+  return 0;
+}
+
+#endif // if FEATURE_C016_COMPRESSED_CACHE
+
 #ifdef RTC_STRUCT_DEBUG
 void RTC_cache_handler_struct::rtc_debug_log(const String& description, size_t nrBytes) {
   if (loglevelActiveFor(LOG_LEVEL_INFO)) {
@@ -8,6 +8,11 @@
 #if FEATURE_RTC_CACHE_STORAGE
 
 #include "../DataStructs/RTCCacheStruct.h"
+#include "../DataTypes/TaskIndex.h"
+
+#if FEATURE_C016_COMPRESSED_CACHE
+# include "../DataStructs/ESPEasyControllerCache_block.h"
+#endif // if FEATURE_C016_COMPRESSED_CACHE
 
 #include <FS.h>
 #include <vector>
@@ -50,6 +55,12 @@ struct RTC_cache_handler_struct
 
   void         setPeekFilePos(int peekFileNr, int peekReadPos);
 
+  // Set the peek position to the first sample with a timestamp at or after fromTime.
+  // When taskIndex is valid, compressed blocks without samples of this task are skipped.
+  // Return false when there is no such sample.
+  bool         setPeekFilePosByTime(uint32_t    fromTime,
+                                    taskIndex_t taskIndex = INVALID_TASK_INDEX);
+
   bool         peek(uint8_t     *data,
                     unsigned int size);
 
@@ -99,6 +110,65 @@ private:
 
   bool     prepareFileForWrite();
 
+  // Size of the peek file as if it only contained uncompressed samples.
+  size_t   getPeekFileLogicalSize() const;
+
+  // Size of the write file as if it only contained uncompressed samples.
+  size_t   getWriteFileLogicalSize() const;
+
+  bool     isPeekFileCompressed() const;
+
+  // Samples still in the RTC buffer are peeked as if appended to the write file.
+  bool     isPeekInRTCbuffer() const;
+
+  bool     peekRTCbuffer(uint8_t     *data,
+                         unsigned int size);
+
+  // Open the peek file and read its block index when compressed.
+  bool     openPeekFile(int fileNr);
+
+  void     seekPeekFile(size_t readPos);
+
+  // Binary search in a file with uncompressed samples.
+  bool     seekPeekFileByTime_uncompressed(uint32_t fromTime);
+
+  // Write the RTC cache data to the write file
+  bool     writeToFile();
+
+#if FEATURE_C016_COMPRESSED_CACHE
+  struct BlockIndexEntry {
+    uint32_t filePos;    // Position of the block header in the file
+    uint32_t logicalPos; // Position of the first sample as if the file was not compressed
+  };
+
+  // Return true when the file contains compressed blocks.
+  // indexedSize is the nr of bytes of the file covered by complete blocks.
+  // index is optional.
+  static bool readBlockIndex(fs::File                    & file,
+                             std::vector<BlockIndexEntry> *index,
+                             size_t                      & logicalSize,
+                             size_t                      & indexedSize);
+
+  // Determine the format of the opened write file.
+  // Return false when the file ends with an incomplete block and should no longer be appended.
+  bool     initWriteFileFormat(const String& fname);
+
+  // Decode the block from the peek file into _peekBlockSamples, unless already decoded.
+  bool     decodePeekBlock(size_t blockNr);
+
+  // Decode the block at the current peek position and copy the sample to data.
+  size_t   peekCompressed(uint8_t     *data,
+                          unsigned int size);
+
+  std::vector<BlockIndexEntry>     _peekBlockIndex;
+  std::vector<C016_binary_element> _peekBlockSamples;
+  int                              _peekBlockNr          = -1;
+  size_t                           _peekFileLogicalSize  = 0;
+  size_t                           _writeFileLogicalSize = 0;
+  bool                             _peekFileCompressed   = false;
+  bool                             _writeFileCompressed  = false;
+#endif // if FEATURE_C016_COMPRESSED_CACHE
+
 #ifdef RTC_STRUCT_DEBUG
   void     rtc_debug_log(const String& description,
                          size_t        nrBytes);
@@ -7,6 +7,8 @@
 void RulesEventCache::clear()
 {
   _eventCache.clear();
+  _eventIndex.clear();
+  _nonIndexedEvents.clear();
   _initialized = false;
 }
 
@@ -20,57 +22,124 @@ bool RulesEventCache::addLine(const String& line, const String& filename, size_t
   String event, action;
 
   if (getEventFromRulesLine(line, event, action)) {
+    const uint16_t index = _eventCache.size();
+    String key;
+
+    if (getIndexKey(event, true, key)) {
+      _eventIndex[key].push_back(index);
+    } else {
+      _nonIndexedEvents.push_back(index);
+    }
     _eventCache.emplace_back(filename, pos, std::move(event), std::move(action));
     return true;
   }
   return false;
 }
 
-RulesEventCache_vector::const_iterator RulesEventCache::findMatchingRule(const String& event, bool optimize)
+bool RulesEventCache::getIndexKey(const String& event, bool isRulesEvent, String& key)
 {
-  RulesEventCache_vector::iterator it   = _eventCache.begin();
-//  RulesEventCache_vector::iterator prev = _eventCache.end();
+  if (event.isEmpty() || (event[0] == '!')) {
+    // Literal string events are matched using a 'wildcard' match on the event source.
+    return false;
+  }
 
+  if (isRulesEvent) {
+    if ((event.indexOf('*') != -1) ||
+        (event.indexOf('%') != -1) ||
+        (event.indexOf('[') != -1) ||
+        (event.indexOf('{') != -1)) {
+      // Wildcards or templates, which may match on anything.
+      return false;
+    }
+
+    if (event.substring(0, 6).equalsIgnoreCase(F("clock#"))) {
+      // Clock events need special handling in ruleMatch()
+      return false;
+    }
+  }
+
+  // Strip any value or compare condition.
+  // Must use the same set of characters for events and rules events,
+  // to make sure both result in the same key when ruleMatch() may match.
+  int endpos = event.length();
+
+  for (int i = 0; i < endpos; ++i) {
+    switch (event[i]) {
+      case '=':
+      case '<':
+      case '>':
+      case '!':
+        endpos = i;
+        break;
+    }
+  }
+  key = event.substring(0, endpos);
+  key.trim();
+  key.toLowerCase();
+  return true;
+}
+
+RulesEventCache_vector::const_iterator RulesEventCache::findMatchingRule(const String& event, bool optimize)
+{
   // FIXME TD-er: Disable optimize as it has some side effects.
   // For example, matching a specific event first and then a more generic one is perfectly normal to do.
   // But this optimization will then put the generic one in front as it will be matched more often.
   // Thus it will never match the more specific one anymore.
+  //
+  // Only rules events with the same event name can match.
+  // The remaining rules events (wildcards etc.) must be checked too.
+  // Both lists are sorted on their order in the rules, so check them in that same order
+  // to keep the "first match" behavior.
+  START_TIMER
+  const RulesEventIndices *indexed = nullptr;
+  {
+    String key;
 
+    if (getIndexKey(event, false, key)) {
+      auto it = _eventIndex.find(key);
 
-  for (; it != _eventCache.end(); ++it)
-  {
-    START_TIMER
-    const bool match = ruleMatch(event, it->_event);
-    STOP_TIMER(RULES_MATCH);
+      if (it != _eventIndex.end()) {
+        indexed = &(it->second);
+      }
+    }
+  }
+
+  const size_t nrIndexed    = indexed == nullptr ? 0 : indexed->size();
+  const size_t nrNonIndexed = _nonIndexedEvents.size();
+  size_t i_indexed          = 0;
+  size_t i_nonIndexed       = 0;
+
+  while (i_indexed < nrIndexed || i_nonIndexed < nrNonIndexed) {
+    bool fromIndex = false;
+    uint16_t index = 0;
+
+    if ((i_indexed < nrIndexed) &&
+        ((i_nonIndexed >= nrNonIndexed) || ((*indexed)[i_indexed] < _nonIndexedEvents[i_nonIndexed]))) {
+      fromIndex = true;
+      index     = (*indexed)[i_indexed];
+      ++i_indexed;
+    } else {
+      index = _nonIndexedEvents[i_nonIndexed];
+      ++i_nonIndexed;
+    }
+
+    RulesEventCache_vector::const_iterator it = _eventCache.begin() + index;
+    bool match = false;
+    {
+      START_TIMER
+      match = ruleMatch(event, it->_event);
+      STOP_TIMER(RULES_MATCH);
+    }
 
     if (match) {
-      /*
-      if (optimize) {
-        it->_nrTimesMatched++;
-
-        if (prev != _eventCache.end()) {
-          // Check to see if we need to place this one more to the front of the vector
-          // to speed up parsing.
-          if (prev->_nrTimesMatched < it->_nrTimesMatched) {
-            std::swap(*prev, *it);
-            return prev;
-          }
-        }
+      if (fromIndex) {
+        STOP_TIMER(RULES_MATCH_INDEXED);
+      } else {
+        STOP_TIMER(RULES_MATCH_NON_INDEXED);
       }
-      */
       return it;
     }
-/*
-    if (optimize) {
-      if (prev == _eventCache.end()) {
-        prev = it;
-      }
-      else if (prev->_nrTimesMatched > it->_nrTimesMatched) {
-        // Found one that's having a lower match rate
-        prev = it;
-      }
-    }
-    */
   }
-  return it;
+  STOP_TIMER(RULES_MATCH_NON_INDEXED);
+  return _eventCache.end();
 }
@@ -3,6 +3,7 @@
 
 #include "../../ESPEasy_common.h"
 
+#include <map>
 #include <vector>
 
 struct RulesEventCache_element {
@@ -45,7 +46,26 @@ public:
 
 private:
 
+  // Compute the key used to look up rules events in the index.
+  // This is the lower case event name, without any value or compare condition.
+  // e.g. "bme#temperature" for "BME#Temperature>20"
+  // Return false when the rules event cannot be indexed and must be checked for every event.
+  // For example events with wildcards, templates or special handling like Clock#Time.
+  static bool getIndexKey(const String& event,
+                          bool          isRulesEvent,
+                          String      & key);
+
+  typedef std::vector<uint16_t>                RulesEventIndices;
+  typedef std::map<String, RulesEventIndices> RulesEventIndexMap;
+
   RulesEventCache_vector _eventCache;
+
+  // Index into _eventCache, keyed on the lower case event name
+  RulesEventIndexMap _eventIndex;
+
+  // Indices of rules events which must always be checked using ruleMatch()
+  RulesEventIndices _nonIndexedEvents;
+
   bool _initialized = false;
 };
 
@@ -0,0 +1,78 @@
+#include "../DataStructs/RulesLineInfo.h"
+
+
+RulesLineInfo::RulesLineInfo(const String& line)
+{
+  type = getLineType(line);
+
+  const size_t length = line.length();
+
+  for (size_t i = 0; i < length && !needsParseTemplate; ++i) {
+    switch (line[i]) {
+      case '%':
+      case '[':
+      case '{':
+      case '&': // HTML entities like &deg; handled by parseSpecialCharacters
+        needsParseTemplate = true;
+        break;
+    }
+  }
+
+  if (needsParseTemplate) {
+    startsWithEventValue = line.startsWith(F("%event"));
+    usesEventValue       = startsWithEventValue || (line.indexOf(F("%event")) != -1);
+  }
+}
+
+// Case insensitive check for a keyword at the start of the line,
+// without allocating a substring for every check.
+static bool lineStartsWith_P(const String& line, PGM_P keyword, size_t keywordLength)
+{
+  return line.length() >= keywordLength &&
+         strncasecmp_P(line.c_str(), keyword, keywordLength) == 0;
+}
+
+static bool lineEquals_P(const String& line, PGM_P keyword)
+{
+  return strcasecmp_P(line.c_str(), keyword) == 0;
+}
+
+RulesLineType RulesLineInfo::getLineType(const String& line)
+{
+  if (line.isEmpty()) {
+    return RulesLineType::Empty;
+  }
+
+  switch (line[0]) {
+    case '%':
+    case '[':
+    case '{':
+      // Keyword may only be known after parsing the line
+      return RulesLineType::Dynamic;
+  }
+
+  if (lineStartsWith_P(line, PSTR("on "), 3)) {
+    return RulesLineType::On;
+  }
+
+  if (lineEquals_P(line, PSTR("endon"))) {
+    return RulesLineType::EndOn;
+  }
+
+  if (lineStartsWith_P(line, PSTR("if "), 3)) {
+    return RulesLineType::If;
+  }
+
+  if (lineStartsWith_P(line, PSTR("elseif "), 7)) {
+    return RulesLineType::ElseIf;
+  }
+
+  if (lineEquals_P(line, PSTR("else"))) {
+    return RulesLineType::Else;
+  }
+
+  if (lineEquals_P(line, PSTR("endif"))) {
+    return RulesLineType::EndIf;
+  }
+  return RulesLineType::Command;
+}
@@ -0,0 +1,48 @@
+#ifndef DATASTRUCTS_RULESLINEINFO_H
+#define DATASTRUCTS_RULESLINEINFO_H
+
+#include "../../ESPEasy_common.h"
+
+
+/*********************************************************************************************\
+* Pre-parsed information about a single (trimmed, comment stripped) rules line.
+* This is determined only once when a rules file is read, so the rules engine
+* does not need to perform the same string checks on every line for every event.
+\*********************************************************************************************/
+enum class RulesLineType : uint8_t {
+  Empty,
+  On,
+  EndOn,
+  If,
+  ElseIf,
+  Else,
+  EndIf,
+  Command,
+
+  // Line starts with a variable or template which must be parsed first
+  // before the type of the line can be determined.
+  Dynamic
+};
+
+struct RulesLineInfo {
+  RulesLineInfo() = default;
+
+  explicit RulesLineInfo(const String& line);
+
+  // Determine the line type by looking at the keyword at the start of the line.
+  static RulesLineType getLineType(const String& line);
+
+  RulesLineType type = RulesLineType::Empty;
+
+  // Line contains markup which must be processed by parseTemplate: '%', '[', '{' or '&'
+  bool needsParseTemplate = false;
+
+  // Line contains "%event" which must be replaced by substitute_eventvalue
+  bool usesEventValue = false;
+
+  // Line starts with "%event", which must be executed as restricted command.
+  bool startsWithEventValue = false;
+};
+
+
+#endif // ifndef DATASTRUCTS_RULESLINEINFO_H
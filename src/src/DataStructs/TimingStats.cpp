@@ -13,7 +13,7 @@ std::map<TimingStatsElements, TimingStats> miscStats;
 unsigned long timingstats_last_reset(0);
 
 
-TimingStats::TimingStats() : _timeTotal(0.0f), _count(0), _maxVal(0), _minVal(4294967295) {}
+TimingStats::TimingStats() : _timeTotal(0.0f), _count(0), _maxVal(0), _minVal(4294967295), _histogram{} {}
 
 void TimingStats::add(int64_t time) {
   _timeTotal += static_cast<float>(time);
@@ -22,6 +22,12 @@ void TimingStats::add(int64_t time) {
   if (time > static_cast<int64_t>(_maxVal)) { _maxVal = time; }
 
   if (time < static_cast<int64_t>(_minVal)) { _minVal = time; }
+
+  // floor(log2(time)), values below 2 usec end up in the first bucket.
+  uint8_t bucket = (time > 1) ? (63 - __builtin_clzll(time)) : 0;
+
+  if (bucket >= TIMING_STATS_NR_BUCKETS) { bucket = TIMING_STATS_NR_BUCKETS - 1; }
+  ++_histogram[bucket];
 }
 
 void TimingStats::reset() {
@@ -29,6 +35,10 @@ void TimingStats::reset() {
   _count     = 0;
   _maxVal    = 0;
   _minVal    = 4294967295;
+
+  for (uint8_t i = 0; i < TIMING_STATS_NR_BUCKETS; ++i) {
+    _histogram[i] = 0;
+  }
 }
 
 bool TimingStats::isEmpty() const {
@@ -58,6 +68,48 @@ bool TimingStats::thresholdExceeded(const uint64_t& threshold) const {
   return _maxVal > threshold;
 }
 
+uint32_t TimingStats::getBucketCount(uint8_t bucket) const {
+  if (bucket >= TIMING_STATS_NR_BUCKETS) { return 0; }
+  return _histogram[bucket];
+}
+
+uint64_t TimingStats::getPercentile(uint8_t percentile) const {
+  if (_count == 0) { return 0; }
+
+  // Nr of samples at or below the percentile, rounded up
+  const uint32_t target = (static_cast<uint64_t>(_count) * percentile + 99) / 100;
+  uint32_t cumulative   = 0;
+
+  for (uint8_t i = 0; i < (TIMING_STATS_NR_BUCKETS - 1); ++i) {
+    cumulative += _histogram[i];
+
+    if (cumulative >= target) {
+      return std::min<uint64_t>(getBucketUpperBound(i), _maxVal);
+    }
+  }
+  return _maxVal;
+}
+
+uint32_t TimingStats::getBucketUpperBound(uint8_t bucket) {
+  if (bucket >= (TIMING_STATS_NR_BUCKETS - 1)) { return 0; }
+  return 2ul << bucket;
+}
+
+String TimingStats::getBucketLabel(uint8_t bucket) {
+  const bool lastBucket = bucket >= (TIMING_STATS_NR_BUCKETS - 1);
+  uint32_t   bound      = lastBucket ? (1ul << (TIMING_STATS_NR_BUCKETS - 1)) : getBucketUpperBound(bucket);
+  String     res        = lastBucket ? F(">=") : F("<");
+
+  if (bound < 1000) {
+    res += bound;
+    res += F("us");
+  } else {
+    res += (bound + 500) / 1000;
+    res += F("ms");
+  }
+  return res;
+}
+
 /********************************************************************************************\
    Functions used for displaying timing stats
  \*********************************************************************************************/
@@ -214,6 +266,8 @@ const __FlashStringHelper* getMiscStatsName_F(TimingStatsElements stat) {
     case TimingStatsElements::CPLUGIN_CALL_10PS:          return F("CPlugin call 10 p/s");
     case TimingStatsElements::SENSOR_SEND_TASK:           return F("SensorSendTask()");
     case TimingStatsElements::COMMAND_EXEC_INTERNAL:      return F("Exec Internal Command");
+    case TimingStatsElements::COMMAND_DISPATCH_INTERNAL:  return F("executeInternalCommand()");
+    case TimingStatsElements::COMMAND_DISPATCH_PLUGIN:    return F("PluginCall(PLUGIN_WRITE)");
     case TimingStatsElements::CONSOLE_LOOP:               return F("Console loop()");
     case TimingStatsElements::CONSOLE_WRITE_SERIAL:       return F("Console out");
     case TimingStatsElements::SEND_DATA_STATS:            return F("sendData()");
@@ -230,6 +284,7 @@ const __FlashStringHelper* getMiscStatsName_F(TimingStatsElements stat) {
     case TimingStatsElements::WIFI_ISCONNECTED_STATS:     return F("WiFi.isConnected()");
     case TimingStatsElements::WIFI_NOTCONNECTED_STATS:    return F("WiFi.isConnected() (fail)");
     case TimingStatsElements::LOAD_TASK_SETTINGS:         return F("LoadTaskSettings()");
+    case TimingStatsElements::LOAD_TASK_SETTINGS_C:       return F("LoadTaskSettings() (cached)");
     case TimingStatsElements::SAVE_TASK_SETTINGS:         return F("SaveTaskSettings()");
     case TimingStatsElements::LOAD_CONTROLLER_SETTINGS:   return F("LoadControllerSettings()");
     #ifdef ESP32
@@ -243,6 +298,8 @@ const __FlashStringHelper* getMiscStatsName_F(TimingStatsElements stat) {
     case TimingStatsElements::RULES_PARSE_LINE:           return F("parseCompleteNonCommentLine()");
     case TimingStatsElements::RULES_PROCESS_MATCHED:      return F("processMatchedRule()");
     case TimingStatsElements::RULES_MATCH:                return F("rulesMatch()");
+    case TimingStatsElements::RULES_MATCH_INDEXED:        return F("findMatchingRule() indexed");
+    case TimingStatsElements::RULES_MATCH_NON_INDEXED:    return F("findMatchingRule() scan");
     case TimingStatsElements::GRAT_ARP_STATS:             return F("sendGratuitousARP()");
     case TimingStatsElements::SAVE_TO_RTC:                return F("saveToRTC()");
     case TimingStatsElements::BACKGROUND_TASKS:           return F("backgroundtasks()");
@@ -253,6 +310,7 @@ const __FlashStringHelper* getMiscStatsName_F(TimingStatsElements stat) {
     case TimingStatsElements::HANDLE_SCHEDULER_IDLE:      return F("handle_schedule() idle");
     case TimingStatsElements::HANDLE_SCHEDULER_TASK:      return F("handle_schedule() task");
     case TimingStatsElements::PARSE_TEMPLATE_PADDED:      return F("parseTemplate_padded()");
+    case TimingStatsElements::PARSE_TEMPLATE_COMPILED:    return F("CompiledTemplate::render()");
     case TimingStatsElements::PARSE_SYSVAR:               return F("parseSystemVariables()");
     case TimingStatsElements::PARSE_SYSVAR_NOCHANGE:      return F("parseSystemVariables() No change");
     case TimingStatsElements::HANDLE_SERVING_WEBPAGE:     return F("handle webpage");
@@ -263,6 +321,10 @@ const __FlashStringHelper* getMiscStatsName_F(TimingStatsElements stat) {
     case TimingStatsElements::NTP_FAIL:                   return F("NTP Fail");
     case TimingStatsElements::SYSTIME_UPDATED:            return F("Systime Set");
     case TimingStatsElements::C018_AIR_TIME:              return F("C018 LoRa TTN - Air Time");
+    case TimingStatsElements::CONTROLLER_QUEUE_BATCH:     return F("Controller queue batch");
+    case TimingStatsElements::MQTT_QUEUE_ADD_STRING:      return F("MQTTpublish() String payload");
+    case TimingStatsElements::MQTT_QUEUE_ADD_TASKVALUE:   return F("MQTTpublish() task value");
+    case TimingStatsElements::MQTT_PUBLISH_TASKVALUE:     return F("MQTT publish task value");
 #ifdef LIMIT_BUILD_SIZE
     default: break;
 #else
@@ -51,6 +51,10 @@ enum class TimingStatsElements {
   C023_DELAY_QUEUE,
   C024_DELAY_QUEUE,
   C025_DELAY_QUEUE,
+  CONTROLLER_QUEUE_BATCH,
+  MQTT_QUEUE_ADD_STRING,
+  MQTT_QUEUE_ADD_TASKVALUE,
+  MQTT_PUBLISH_TASKVALUE,
 
   
   // Related to Task runs & sending data + rules
@@ -67,21 +71,27 @@ enum class TimingStatsElements {
   PARSE_SYSVAR,
   PARSE_SYSVAR_NOCHANGE,
   PARSE_TEMPLATE_PADDED,
+  PARSE_TEMPLATE_COMPILED,
   IS_NUMERICAL,
   GET_TASKVALUE_AS_STRING,
   FORMAT_USER_VAR,
   PROCESS_SYSTEM_EVENT_QUEUE,
   RULES_MATCH,
+  RULES_MATCH_INDEXED,
+  RULES_MATCH_NON_INDEXED,
   RULES_PROCESSING,
   RULES_PROCESS_MATCHED,
   RULES_PARSE_LINE,
   COMMAND_EXEC_INTERNAL,
+  COMMAND_DISPATCH_INTERNAL,
+  COMMAND_DISPATCH_PLUGIN,
   CONSOLE_LOOP,
   CONSOLE_WRITE_SERIAL,
   
   // Related to file access
   LOADFILE_STATS,
   LOAD_TASK_SETTINGS,
+  LOAD_TASK_SETTINGS_C,
   LOAD_CUSTOM_TASK_STATS,
   LOAD_CONTROLLER_SETTINGS,
   #ifdef ESP32
@@ -128,6 +138,12 @@ enum class TimingStatsElements {
 
 #if FEATURE_TIMING_STATS
 
+// Nr of histogram buckets per timing stat.
+// Bucket i counts durations in range [2^i .. 2^(i+1)) usec, the last bucket also counts all longer durations.
+# ifndef TIMING_STATS_NR_BUCKETS
+#  define TIMING_STATS_NR_BUCKETS 20
+# endif // ifndef TIMING_STATS_NR_BUCKETS
+
 class TimingStats {
 public:
 
@@ -141,12 +157,25 @@ public:
                      uint64_t& maxVal) const;
   bool     thresholdExceeded(const uint64_t& threshold) const;
 
+  uint32_t getBucketCount(uint8_t bucket) const;
+
+  // Estimate of the percentile in usec, based on the upper bound of the bucket containing it.
+  // Never larger than the max value.
+  uint64_t getPercentile(uint8_t percentile) const;
+
+  // Upper bound in usec (exclusive) of the bucket, 0 for the last bucket as it has no upper bound.
+  static uint32_t getBucketUpperBound(uint8_t bucket);
+
+  // Short description of the bucket range, like "<512us" or ">=524ms"
+  static String   getBucketLabel(uint8_t bucket);
+
 private:
 
   float _timeTotal;
   uint32_t _count;
   uint64_t _maxVal;
   uint64_t _minVal;
+  uint32_t _histogram[TIMING_STATS_NR_BUCKETS];
 };
 
 
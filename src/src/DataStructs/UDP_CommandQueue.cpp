@@ -0,0 +1,45 @@
+#include "../DataStructs/UDP_CommandQueue.h"
+
+#if FEATURE_ESPEASY_P2P
+
+UDP_CommandQueue::UDP_CommandQueue(size_t maxSize) : _maxSize(maxSize) {}
+
+bool UDP_CommandQueue::add(const char *line)
+{
+  bool res = false;
+
+  _mutex.lock();
+
+  if (_queue.size() < _maxSize) {
+    _queue.emplace_back(line);
+    res = true;
+  }
+  _mutex.unlock();
+  return res;
+}
+
+bool UDP_CommandQueue::get(String& line)
+{
+  bool res = false;
+
+  _mutex.lock();
+
+  if (!_queue.empty()) {
+    line = std::move(_queue.front());
+    _queue.pop_front();
+    res = true;
+  }
+  _mutex.unlock();
+  return res;
+}
+
+size_t UDP_CommandQueue::size()
+{
+  _mutex.lock();
+  const size_t res = _queue.size();
+
+  _mutex.unlock();
+  return res;
+}
+
+#endif // if FEATURE_ESPEASY_P2P
@@ -0,0 +1,40 @@
+#ifndef DATASTRUCTS_UDP_COMMANDQUEUE_H
+#define DATASTRUCTS_UDP_COMMANDQUEUE_H
+
+#include "../../ESPEasy_common.h"
+
+#if FEATURE_ESPEASY_P2P
+
+# include "../Helpers/ESPEasyMutex.h"
+
+# include <list>
+
+/*********************************************************************************************\
+* Bounded queue of commands received on the ESPEasy p2p UDP port.
+* Commands are executed from the main loop, so reading packets from the network stack
+* is not held up by the execution of a command.
+* With USE_RTOS_MULTITASKING and the "Enable RTOS Multitasking" setting (ESP32 only),
+* the packets are read in another RTOS task than where the commands are executed.
+\*********************************************************************************************/
+struct UDP_CommandQueue {
+  explicit UDP_CommandQueue(size_t maxSize);
+
+  // Return false when the queue is full, thus the command is not added.
+  bool   add(const char *line);
+
+  // Take the oldest command from the queue.
+  // Return false when the queue is empty.
+  bool   get(String& line);
+
+  size_t size();
+
+private:
+
+  std::list<String> _queue;
+  const size_t      _maxSize;
+  ESPEasy_Mutex     _mutex;
+};
+
+#endif // if FEATURE_ESPEASY_P2P
+
+#endif // ifndef DATASTRUCTS_UDP_COMMANDQUEUE_H
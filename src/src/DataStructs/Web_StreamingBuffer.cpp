@@ -1,7 +1,10 @@
 #include "../DataStructs/Web_StreamingBuffer.h"
 
+#include "../../ESPEasy-Globals.h"
+
 #include "../DataStructs/tcp_cleanup.h"
 #include "../DataTypes/ESPEasyTimeSource.h"
+#include "../ESPEasyCore/ESPEasy_backgroundtasks.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
 #include "../ESPEasyCore/ESPEasyNetwork.h"
 
@@ -14,25 +17,15 @@
 
 #include "../../ESPEasy_common.h"
 
-#ifdef ESP8266
-#define CHUNKED_BUFFER_SIZE         512
-#else 
-#define CHUNKED_BUFFER_SIZE         4096
-#endif
-
 Web_StreamingBuffer::Web_StreamingBuffer(void) : lowMemorySkip(false),
   initialRam(0), beforeTXRam(0), duringTXRam(0), finalRam(0), maxCoreUsage(0),
   maxServerUsage(0), sentBytes(0), flashStringCalls(0), flashStringData(0)
-{
-  buf.reserve(CHUNKED_BUFFER_SIZE + 50);
-  buf.clear();
-}
+{}
 
 Web_StreamingBuffer& Web_StreamingBuffer::operator+=(char a)                   {
-  if (this->buf.length() >= CHUNKED_BUFFER_SIZE) {
-    flush();
+  if (!lowMemorySkip) {
+    append(a);
   }
-  this->buf += a;
   return *this;
 }
 
@@ -80,15 +73,11 @@ Web_StreamingBuffer& Web_StreamingBuffer::addFlashString(PGM_P str, int length)
   if (mmu_is_iram(str)) {
     // Have to copy the string using mmu_get functions
     // This is not a flash string.
-    bool done = false;
     const char* cur_char = str;
-    while (!done) {
+    while (true) {
       const uint8_t ch = mmu_get_uint8(cur_char++);
       if (ch == 0) return *this;
-      if (this->buf.length() >= CHUNKED_BUFFER_SIZE) {
-        flush();
-      }
-      this->buf += (char)ch;
+      append((char)ch);
     }
   }
   #endif
@@ -99,28 +88,23 @@ Web_StreamingBuffer& Web_StreamingBuffer::addFlashString(PGM_P str, int length)
 
   checkFull();
 
-  int flush_step = CHUNKED_BUFFER_SIZE - this->buf.length();
-  if (flush_step < 1) { flush_step = 0; }
-
-  {
-    // Copy to internal buffer and send in chunks
-    PGM_P pos = str;
-    while (length != 0) {
-      if (flush_step == 0) {
-        flush();
-        flush_step = CHUNKED_BUFFER_SIZE;
-      }
-      const char c = (char)pgm_read_byte(pos);
-      if (c == '\0' && length < 0) {
-        // Only check for \0 when length was given (e.g. binary data)
-        return *this;
-      }
-      this->buf += c;
-      ++flashStringData;
-      ++pos;
-      --length;
-      --flush_step;
+  // Only check for \0 when no length was given (e.g. binary data)
+  const size_t str_length = (length < 0) ? strlen_P(str) : length;
+  size_t pos = 0;
+
+  while (pos < str_length) {
+    if (fillLength >= CHUNKED_BUFFER_SIZE) {
+      flush();
     }
+
+    if (chunks.empty() && !allocateChunks()) {
+      return *this;
+    }
+    const size_t copy_length = std::min<size_t>(str_length - pos, CHUNKED_BUFFER_SIZE - fillLength);
+    memcpy_P(fillChunk() + fillLength, str + pos, copy_length);
+    fillLength      += copy_length;
+    flashStringData += copy_length;
+    pos             += copy_length;
   }
   return *this;
 }
@@ -131,48 +115,167 @@ Web_StreamingBuffer& Web_StreamingBuffer::addString(const String& a) {
   if (length == 0) { return *this; }
 
   checkFull();
-  int flush_step = CHUNKED_BUFFER_SIZE - this->buf.length();
+  append(a.c_str(), length);
+  return *this;
+}
 
-  if (flush_step < 1) { flush_step = 0; }
+Web_StreamingBuffer& Web_StreamingBuffer::addBuffer(const char *data, size_t length) {
+  if (lowMemorySkip || (data == nullptr) || (length == 0)) { return *this; }
 
-  if (length < static_cast<unsigned int>(flush_step)) {
-    // Just use the faster String operator to copy flash strings.
-    this->buf += a;
-    return *this;
+  checkFull();
+  append(data, length);
+  return *this;
+}
+
+bool Web_StreamingBuffer::allocateChunks() {
+  #ifdef USE_SECOND_HEAP
+  HeapSelectDram ephemeral;
+  #endif
+
+  chunks.resize(2 * CHUNKED_BUFFER_SIZE);
+
+  if (chunks.size() != (2 * CHUNKED_BUFFER_SIZE)) {
+    freeChunks();
+    lowMemorySkip = true;
+    return false;
+  }
+  return true;
+}
+
+void Web_StreamingBuffer::freeChunks() {
+  // Swap with an empty vector to actually free the memory.
+  std::vector<char>().swap(chunks);
+  fillLength    = 0;
+  pendingLength = 0;
+  fillIndex     = 0;
+}
+
+void Web_StreamingBuffer::append(char c) {
+  if (fillLength >= CHUNKED_BUFFER_SIZE) {
+    flush();
   }
 
-  unsigned int pos = 0;
-  while (pos < length) {
-    if (flush_step == 0) {
+  if (chunks.empty() && !allocateChunks()) {
+    return;
+  }
+  fillChunk()[fillLength] = c;
+  ++fillLength;
+}
+
+void Web_StreamingBuffer::append(const char *data, size_t length) {
+  while (length > 0) {
+    if (fillLength >= CHUNKED_BUFFER_SIZE) {
       flush();
-      flush_step = CHUNKED_BUFFER_SIZE;
-    } else {
-      // Just copy per byte instead of using substring as substring needs to allocate memory.
-      this->buf += a[pos];
-      ++pos;
-      --flush_step;
     }
+
+    if (chunks.empty() && !allocateChunks()) {
+      return;
+    }
+    const size_t copy_length = std::min<size_t>(length, CHUNKED_BUFFER_SIZE - fillLength);
+    memcpy(fillChunk() + fillLength, data, copy_length);
+    fillLength += copy_length;
+    data       += copy_length;
+    length     -= copy_length;
   }
-  return *this;
 }
 
 void Web_StreamingBuffer::flush() {
   if (lowMemorySkip) {
-    this->buf.clear();
-  } else {
-    if (this->buf.length() > 0) {
-      sendContentBlocking(this->buf);
-    }
+    fillLength    = 0;
+    pendingLength = 0;
+    return;
+  }
+
+  if (fillLength == 0) {
+    return;
   }
+
+  // Both chunks are full, so we must wait for the client to accept the pending one.
+  sendPendingChunk(true);
+
+  pendingLength = fillLength;
+  fillLength    = 0;
+  fillIndex    ^= 1;
+
+  // Send right away if the client can accept it, or else continue filling the other chunk.
+  sendPendingChunk(false);
 }
 
 void Web_StreamingBuffer::checkFull() {
-  if (lowMemorySkip) { this->buf.clear(); }
+  if (lowMemorySkip) { 
+    fillLength    = 0;
+    pendingLength = 0;
+    return;
+  }
 
-  if (this->buf.length() >= CHUNKED_BUFFER_SIZE) {
+  if (fillLength >= CHUNKED_BUFFER_SIZE) {
     trackTotalMem();
     flush();
+  } else if (pendingLength > 0) {
+    sendPendingChunk(false);
+  }
+}
+
+bool Web_StreamingBuffer::sendPendingChunk(bool waitForClient) {
+  if (pendingLength == 0) {
+    return true;
+  }
+
+  if (!clientAcceptsChunk(pendingLength)) {
+    if (!waitForClient) {
+      return false;
+    }
+    const uint32_t beginWait = millis();
+
+    while (!clientAcceptsChunk(pendingLength) &&
+           !timeOutReached(beginWait + CHUNKED_BUFFER_WRITE_TIMEOUT)) {
+      trackCoreMem();
+      yieldBetweenChunks();
+      delay(1);
+    }
   }
+  sendContentBlocking(pendingChunk(), pendingLength);
+  pendingLength = 0;
+  yieldBetweenChunks();
+  return true;
+}
+
+bool Web_StreamingBuffer::clientAcceptsChunk(size_t length) const {
+#ifdef ESP8266
+  // Chunk size in hex + 2x "\r\n"
+  constexpr size_t chunkOverhead = 8;
+
+  // When the client is no longer connected, the send will return immediately.
+  WiFiClient client = web_server.client();
+  return !client.connected() ||
+         (static_cast<size_t>(client.availableForWrite()) >= (length + chunkOverhead));
+#else
+  // ESP32 WiFiClient does not report the free space in the send buffer.
+  return true;
+#endif
+}
+
+void Web_StreamingBuffer::yieldBetweenChunks() {
+  #ifdef USE_RTOS_MULTITASKING
+
+  if (UseRTOSMultitasking) {
+    // Request handler runs in its own RTOS task, concurrent with the main loop.
+    // So it is not safe to run backgroundtasks() from here.
+    delay(0);
+    return;
+  }
+  #endif // ifdef USE_RTOS_MULTITASKING
+
+  if (runningBackgroundTasks) {
+    // Request handler was called from backgroundtasks(), a nested call would only yield.
+    delay(0);
+    return;
+  }
+
+  // backgroundtasks() will not handle web requests while yielding.
+  yielding = true;
+  backgroundtasks();
+  yielding = false;
 }
 
 void Web_StreamingBuffer::startStream(int httpCode) {
@@ -204,10 +307,10 @@ void Web_StreamingBuffer::startStream(bool allowOriginAll,
   initialRam   = ESP.getFreeHeap();
   beforeTXRam  = initialRam;
   sentBytes    = 0;
-  buf.clear();
-  buf.reserve(CHUNKED_BUFFER_SIZE);
+  fillLength    = 0;
+  pendingLength = 0;
   
-  if (beforeTXRam < 3000) {
+  if ((beforeTXRam < 3000) || (chunks.empty() && !allocateChunks())) {
     lowMemorySkip = true;
     web_server.send_P(200, (PGM_P)F("text/plain"), (PGM_P)F("Low memory. Cannot display webpage :-("));
       #if defined(ESP8266)
@@ -249,9 +352,12 @@ void Web_StreamingBuffer::endStream() {
   #endif
 
   if (!lowMemorySkip) {
-    if (buf.length() > 0) { sendContentBlocking(buf); }
-    buf.clear();
-    sendContentBlocking(buf);
+    flush();
+    sendPendingChunk(true);
+
+    // Empty chunk marks the end of the chunked transfer.
+    sendContentBlocking(nullptr, 0);
+    freeChunks();
 
     web_server.client().flush();
 
@@ -270,6 +376,7 @@ void Web_StreamingBuffer::endStream() {
 */
 
   } else {
+    freeChunks();
     if (loglevelActiveFor(LOG_LEVEL_ERROR))
       addLog(LOG_LEVEL_ERROR, concat("Webpage skipped: low memory: ", finalRam));
     lowMemorySkip = false;
@@ -279,14 +386,13 @@ void Web_StreamingBuffer::endStream() {
 
 
 
-void Web_StreamingBuffer::sendContentBlocking(String& data) {
+void Web_StreamingBuffer::sendContentBlocking(const char *data, size_t length) {
   #ifdef USE_SECOND_HEAP
   HeapSelectDram ephemeral;
   #endif
 
   delay(0); // Try to prevent WDT reboots
 
-  const uint32_t length   = data.length();
 #ifndef BUILD_NO_DEBUG
   if (loglevelActiveFor(LOG_LEVEL_DEBUG_DEV)) {
     String log;
@@ -313,21 +419,15 @@ void Web_StreamingBuffer::sendContentBlocking(String& data) {
   // do chunked transfer encoding ourselves (WebServer doesn't support it)
   web_server.sendContent(size);
 
-  if (length > 0) { web_server.sendContent(data); }
+  if (length > 0) { web_server.client().write(data, length); }
   web_server.sendContent("\r\n");
 #else // ESP8266 2.4.0rc2 and higher and the ESP32 webserver supports chunked http transfer
   unsigned int timeout = 100;
 
-  web_server.sendContent(data);
-
-  if (data.length() > CHUNKED_BUFFER_SIZE) {
-    data = String(); // Clear also allocated memory
-  } else {
-    data.clear();
-  }
+  web_server.sendContent(length > 0 ? data : "", length);
 
   const uint32_t beginWait = millis();
-  while ((!data.reserve(CHUNKED_BUFFER_SIZE) || (ESP.getFreeHeap() < 4000 /*freeBeforeSend*/ )) &&
+  while ((ESP.getFreeHeap() < 4000 /*freeBeforeSend*/ ) &&
          !timeOutReached(beginWait + timeout)) {
     if (ESP.getFreeHeap() < duringTXRam) {
       duringTXRam = ESP.getFreeHeap();
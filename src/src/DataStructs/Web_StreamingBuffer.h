@@ -2,12 +2,26 @@
 #define DATASTRUCTS_WEB_STREAMINGBUFFER_H
 
 #include <map>
+#include <vector>
 #include "../../ESPEasy_common.h"
 
 
 // ********************************************************************************
 // Core part of WebServer, the chunked streaming buffer
+// Uses 2 fixed size chunks, allocated while streaming.
+// One chunk is being filled while the other is waiting for the client socket
+// to accept it. Only when both are full, we have to wait for the client.
 // ********************************************************************************
+#ifdef ESP8266
+#define CHUNKED_BUFFER_SIZE         512
+#else 
+#define CHUNKED_BUFFER_SIZE         4096
+#endif
+
+// Max. time to wait for the socket to accept a chunk before sending it anyway.
+#ifndef CHUNKED_BUFFER_WRITE_TIMEOUT
+#define CHUNKED_BUFFER_WRITE_TIMEOUT 2000
+#endif
 
 
 class Web_StreamingBuffer {
@@ -29,7 +43,19 @@ public:
 
 private:
 
-  String buf;
+  // Both chunks in one allocation, each CHUNKED_BUFFER_SIZE bytes.
+  std::vector<char> chunks;
+
+  // Nr of bytes in the chunk being filled
+  uint16_t fillLength = 0;
+
+  // Nr of bytes in the other chunk, waiting to be sent.
+  uint16_t pendingLength = 0;
+
+  uint8_t fillIndex = 0;
+
+  // Set while running backgroundtasks() from within sending a chunk.
+  bool yielding = false;
 
 public:
 
@@ -55,15 +81,52 @@ template <typename T>
   Web_StreamingBuffer& operator+=(const __FlashStringHelper* str);
 
   Web_StreamingBuffer& addFlashString(PGM_P str, int length = -1);
+
+  // Add data located in RAM, without the need to wrap it in a String first.
+  Web_StreamingBuffer& addBuffer(const char *data, size_t length);
   
 private:
   Web_StreamingBuffer& addString(const String& a);
 
+  // Returns false when the chunks could not be allocated.
+  bool allocateChunks();
+
+  void freeChunks();
+
+  char* fillChunk() {
+    return &chunks[fillIndex * CHUNKED_BUFFER_SIZE];
+  }
+
+  const char* pendingChunk() const {
+    return &chunks[(fillIndex ^ 1) * CHUNKED_BUFFER_SIZE];
+  }
+
+  void append(char c);
+
+  void append(const char *data, size_t length);
+
+  // Send the pending chunk when the client socket is able to accept it.
+  // When waitForClient is set, wait for the socket to accept it.
+  // While waiting, background tasks are only handled when the request handler was called from the main loop.
+  // Returns whether the pending chunk is sent.
+  bool sendPendingChunk(bool waitForClient);
+
+  bool clientAcceptsChunk(size_t length) const;
+
+  // Run backgroundtasks() when safe, or else only yield.
+  void yieldBetweenChunks();
+
 public:
+  // Mark the chunk being filled as ready to be sent.
   void flush();
 
   void checkFull();
 
+  // Background tasks must not handle other web requests while streaming a page from a request handler.
+  bool isYielding() const {
+    return yielding;
+  }
+
   void startStream(int httpCode = 200);
 
   void startStream(const __FlashStringHelper * origin, int httpCode = 200);
@@ -89,7 +152,7 @@ public:
 
 private: 
 
-  void sendContentBlocking(String& data);
+  void sendContentBlocking(const char *data, size_t length);
   void sendHeaderBlocking(bool          allowOriginAll,
                           const String& content_type,
                           const String& origin,
@@ -8,3 +8,12 @@ bool timer_id_couple::operator<(const timer_id_couple& other) const {
   // timediff > 0, means timer has already passed
   return timeDiff(_timer, now) > timeDiff(other._timer, now);
 }
+
+bool timer_id_couple::isLaterThan(const timer_id_couple& other) const {
+  const int32_t diff = timeDiff(other._timer, _timer);
+
+  if (diff != 0) {
+    return diff > 0;
+  }
+  return timeDiff(other._seq, _seq) > 0;
+}
@@ -17,8 +17,22 @@ struct timer_id_couple {
 
   bool operator<(const timer_id_couple& other) const;
 
+  // Strict weak ordering on the set timer, independent of the current time.
+  // Return true when this timer is scheduled later than the other one.
+  // Equal timers are ordered by sequence number, so the first added will be handled first.
+  bool isLaterThan(const timer_id_couple& other) const;
+
   unsigned long _id;
   unsigned long _timer;
+
+  // Sequence number set by the scheduler to detect outdated entries.
+  uint32_t _seq = 0;
+};
+
+struct timer_id_couple_later {
+  bool operator()(const timer_id_couple& lhs, const timer_id_couple& rhs) const {
+    return lhs.isLaterThan(rhs);
+  }
 };
 
 
@@ -62,6 +62,8 @@ enum PluginFunctions_e {
    PLUGIN_PRIORITY_INIT_ALL           , // Pre-initialize all plugins that are set to PowerManager priority (not implemented in plugins)
    PLUGIN_PRIORITY_INIT               , // Pre-initialize a singe plugins that is set to PowerManager priority
    PLUGIN_WEBFORM_LOAD_ALWAYS         , // Loaded *after* PLUGIN_WEBFORM_LOAD, also shown for remote data-feed devices
+   PLUGIN_GET_COMMAND_PREFIXES        , // Optional, return comma separated list of handled commands in 'string', entries ending with '*' are a prefix (e.g. "neo*")
+                                        // When implemented, PLUGIN_WRITE is only called for matching commands
 
    PLUGIN_MAX_FUNCTION  // Leave as last one.
 };
@@ -526,6 +526,37 @@ bool MQTT_queueFull(controllerIndex_t controller_idx) {
   return false;
 }
 
+static MQTT_QueueStats mqttQueueStats;
+
+const MQTT_QueueStats& getMQTTQueueStats()
+{
+  return mqttQueueStats;
+}
+
+// Count the heap allocations made for a queued element:
+// The element itself and the String buffers which do not fit in the String object.
+static void countMQTTQueueAllocations(const MQTT_queue_element& element, MQTT_QueueStats::Counters& counters)
+{
+  uint32_t allocations = 1;
+
+  if (element._topic.length() >= sizeof(String)) { ++allocations; }
+
+  if (element._payload.length() >= sizeof(String)) { ++allocations; }
+
+  ++counters.elements;
+  counters.allocations += allocations;
+  counters.bytes       += element.getSize();
+}
+
+static bool MQTTaddToQueue(MQTT_queue_element *element, MQTT_QueueStats::Counters& counters)
+{
+  countMQTTQueueAllocations(*element, counters);
+  const bool success = MQTTDelayHandler->addToQueue(std::unique_ptr<MQTT_queue_element>(element));
+
+  scheduleNextMQTTdelayQueue();
+  return success;
+}
+
 bool MQTTpublish(controllerIndex_t controller_idx, taskIndex_t taskIndex, const char *topic, const char *payload, bool retained, bool callbackTask)
 {
   if (MQTTDelayHandler == nullptr) {
@@ -535,9 +566,10 @@ bool MQTTpublish(controllerIndex_t controller_idx, taskIndex_t taskIndex, const
   if (MQTT_queueFull(controller_idx)) {
     return false;
   }
-  const bool success = MQTTDelayHandler->addToQueue(std::unique_ptr<MQTT_queue_element>(new MQTT_queue_element(controller_idx, taskIndex, topic, payload, retained, callbackTask)));
-
-  scheduleNextMQTTdelayQueue();
+  START_TIMER;
+  const bool success = MQTTaddToQueue(new MQTT_queue_element(controller_idx, taskIndex, topic, payload, retained, callbackTask),
+                                      mqttQueueStats.stringPayload);
+  STOP_TIMER(MQTT_QUEUE_ADD_STRING);
   return success;
 }
 
@@ -549,12 +581,72 @@ bool MQTTpublish(controllerIndex_t controller_idx, taskIndex_t taskIndex,  Strin
   if (MQTT_queueFull(controller_idx)) {
     return false;
   }
-  const bool success = MQTTDelayHandler->addToQueue(std::unique_ptr<MQTT_queue_element>(new MQTT_queue_element(controller_idx, taskIndex, std::move(topic), std::move(payload), retained, callbackTask)));
+  START_TIMER;
+  const bool success = MQTTaddToQueue(new MQTT_queue_element(controller_idx, taskIndex, std::move(topic), std::move(payload), retained, callbackTask),
+                                      mqttQueueStats.stringPayload);
+  STOP_TIMER(MQTT_QUEUE_ADD_STRING);
+  return success;
+}
+
+bool MQTTpublish(controllerIndex_t        controller_idx,
+                 taskIndex_t              taskIndex,
+                 const String           & topicTemplate,
+                 uint8_t                  valueIndex,
+                 Sensor_VType             sensorType,
+                 const TaskValues_Data_t& values,
+                 bool                     retained)
+{
+  if (MQTTDelayHandler == nullptr) {
+    return false;
+  }
 
-  scheduleNextMQTTdelayQueue();
+  if (MQTT_queueFull(controller_idx)) {
+    return false;
+  }
+  START_TIMER;
+  const bool success = MQTTaddToQueue(new MQTT_queue_element(controller_idx, taskIndex, topicTemplate, valueIndex, sensorType, values, retained),
+                                      mqttQueueStats.taskValue);
+  STOP_TIMER(MQTT_QUEUE_ADD_TASKVALUE);
   return success;
 }
 
+static bool MQTTpublishStreamed(const String& topic, const String& payload, bool retained)
+{
+  const size_t length = payload.length();
+
+  if (!MQTTclient.beginPublish(topic.c_str(), length, retained)) {
+    return false;
+  }
+  const size_t written = MQTTclient.write(reinterpret_cast<const uint8_t *>(payload.c_str()), length);
+
+  // Always finish the message, as the header with the payload length is already sent.
+  return (MQTTclient.endPublish() == 1) && (written == length);
+}
+
+bool MQTTsendQueueElement(const MQTT_queue_element& element)
+{
+  if (!element._processByController) {
+    return MQTTpublishStreamed(element._topic, element._payload, element._retained);
+  }
+
+  // Topic and payload are formatted from the stored task value, right before sending.
+  #if FEATURE_TIMING_STATS
+  const uint64_t publishTimerStart(getMicros64());
+  #endif // if FEATURE_TIMING_STATS
+  const String topic = element.getTopic();
+
+  if (topic.length() >= sizeof(String)) {
+    ++mqttQueueStats.sendAllocations;
+  }
+
+  // A single formatted value does fit in the String object on most builds, so no heap allocation.
+  const bool published = MQTTpublishStreamed(topic, element.getPayload(), element._retained);
+  #if FEATURE_TIMING_STATS
+  stopTimer(TimingStatsElements::MQTT_PUBLISH_TASKVALUE, publishTimerStart);
+  #endif // if FEATURE_TIMING_STATS
+  return published;
+}
+
 /*********************************************************************************************\
 * Send status info back to channel where request came from
 \*********************************************************************************************/
@@ -604,6 +696,18 @@ void MQTTStatus(struct EventStruct *event, const String& status)
 #endif // if FEATURE_MQTT
 
 
+ESPEASY_RULES_FLOAT_TYPE getFormulaValue(struct EventStruct *event, deviceIndex_t DeviceIndex, uint8_t varNr)
+{
+  uint8_t nrDecimals = 0;
+
+  if (Device[DeviceIndex].configurableDecimals()) {
+    nrDecimals = Cache.getTaskDeviceValueDecimals(event->TaskIndex, varNr);
+  }
+  return CompiledExpression::roundToDecimals(
+    UserVar.getAsDouble(event->TaskIndex, varNr, event->sensorType),
+    nrDecimals);
+}
+
 /*********************************************************************************************\
 * send specific sensor task data, effectively calling PluginCall(PLUGIN_READ...)
 \*********************************************************************************************/
@@ -637,15 +741,26 @@ void SensorSendTask(struct EventStruct *event, unsigned long timestampUnixTime,
     const uint8_t valueCount = getValueCountForTask(event->TaskIndex);
     // Store the previous value, in case %pvalue% is used in the formula
     String preValue[VARS_PER_TASK];
+    ESPEASY_RULES_FLOAT_TYPE preValue_compiled[VARS_PER_TASK]{};
+    // Whether the compiled formula is used, decided once so %pvalue% is stored in the matching form.
+    bool usedCompiled[VARS_PER_TASK]{};
     const bool processFormula = Device[DeviceIndex].FormulaOption && Cache.hasFormula(event->TaskIndex);
+    // String values can only be used in the text based formula.
+    const bool useCompiledFormula = TempEvent.sensorType != Sensor_VType::SENSOR_TYPE_STRING;
     if (processFormula) {
       for (uint8_t varNr = 0; varNr < valueCount; varNr++)
       {
-        const String formula = Cache.getTaskDeviceFormula(event->TaskIndex, varNr);
-        if (!formula.isEmpty())
+        CompiledExpression *formula = Cache.getTaskDeviceFormula_compiled(event->TaskIndex, varNr);
+        if (formula != nullptr)
         {
-          if (formula.indexOf(F("%pvalue%")) != -1) {
-            preValue[varNr] = formatUserVarNoCheck(&TempEvent, varNr);
+          usedCompiled[varNr] = useCompiledFormula && formula->canEvaluate();
+
+          if (formula->usesPreviousValue()) {
+            if (usedCompiled[varNr]) {
+              preValue_compiled[varNr] = getFormulaValue(&TempEvent, DeviceIndex, varNr);
+            } else {
+              preValue[varNr] = formatUserVarNoCheck(&TempEvent, varNr);
+            }
           }
         }
       }
@@ -661,18 +776,37 @@ void SensorSendTask(struct EventStruct *event, unsigned long timestampUnixTime,
       if (processFormula) {
         for (uint8_t varNr = 0; varNr < valueCount; varNr++)
         {
-          String formula = Cache.getTaskDeviceFormula(event->TaskIndex, varNr);
-          if (!formula.isEmpty())
+          // Must fetch the formula again, as PLUGIN_READ may have changed the cache.
+          CompiledExpression *formula = Cache.getTaskDeviceFormula_compiled(event->TaskIndex, varNr);
+          if (formula != nullptr)
           {
             START_TIMER;
-
-            // TD-er: Should we use the set nr of decimals here, or not round at all?
-            // See: https://github.com/letscontrolit/ESPEasy/issues/3721#issuecomment-889649437
-            formula.replace(F("%pvalue%"), preValue[varNr]);
-            formula.replace(F("%value%"),  formatUserVarNoCheck(&TempEvent, varNr));
             ESPEASY_RULES_FLOAT_TYPE result{};
+            CalculateReturnCode returnCode;
+
+            if (usedCompiled[varNr]) {
+              // Referenced task values may have changed during PLUGIN_READ.
+              if (formula->collectTaskValues()) {
+                returnCode = Calculate(
+                  *formula,
+                  getFormulaValue(&TempEvent, DeviceIndex, varNr),
+                  preValue_compiled[varNr],
+                  result);
+              } else {
+                returnCode = CalculateReturnCode::ERROR_UNKNOWN_TOKEN;
+              }
+            } else {
+              // Formula refers to other variables, so it must be parsed each time.
+              String formulaString = formula->getExpression();
+
+              // TD-er: Should we use the set nr of decimals here, or not round at all?
+              // See: https://github.com/letscontrolit/ESPEasy/issues/3721#issuecomment-889649437
+              formulaString.replace(F("%pvalue%"), preValue[varNr]);
+              formulaString.replace(F("%value%"),  formatUserVarNoCheck(&TempEvent, varNr));
+              returnCode = Calculate(parseTemplate(formulaString), result);
+            }
 
-            if (!isError(Calculate(parseTemplate(formula), result))) {
+            if (!isError(returnCode)) {
               UserVar.set(event->TaskIndex, varNr, result, TempEvent.sensorType);
             }
 
@@ -3,7 +3,10 @@
 
 #include "../../ESPEasy_common.h"
 
+#include "../DataTypes/DeviceIndex.h"
 #include "../DataTypes/EventValueSource.h"
+#include "../DataTypes/SensorVType.h"
+#include "../DataTypes/TaskValues_Data.h"
 #include "../Globals/CPlugins.h"
 
 // ********************************************************************************
@@ -67,6 +70,40 @@ bool MQTTpublish(controllerIndex_t controller_idx, taskIndex_t taskIndex,  const
 // Publish using the move operator for topic and message
 bool MQTTpublish(controllerIndex_t controller_idx, taskIndex_t taskIndex,  String&& topic, String&& payload, bool retained, bool callbackTask = false);
 
+// Publish a single task value.
+// Only the topic template and the task value are queued.
+// Topic and payload are formatted when the message is sent.
+// The topic template must remain valid while the message is queued. (e.g. the controller's publish topic)
+bool MQTTpublish(controllerIndex_t        controller_idx,
+                 taskIndex_t              taskIndex,
+                 const String           & topicTemplate,
+                 uint8_t                  valueIndex,
+                 Sensor_VType             sensorType,
+                 const TaskValues_Data_t& values,
+                 bool                     retained);
+
+struct MQTT_QueueStats {
+  struct Counters {
+    uint32_t elements    = 0; // Elements added to the queue
+    uint32_t allocations = 0; // Heap allocations for the element, its topic and payload
+    uint32_t bytes       = 0; // Total size of the elements, including topic and payload
+  };
+
+  Counters stringPayload;     // Elements with formatted topic and payload
+  Counters taskValue;         // Elements formatted when sent
+
+  // Heap allocations for topics which did not fit in the String object when formatted at send time.
+  uint32_t sendAllocations = 0;
+};
+
+const MQTT_QueueStats& getMQTTQueueStats();
+
+class MQTT_queue_element;
+
+// Send a queued element to the broker.
+// The payload is streamed into the MQTT client, so no copy of the complete message is needed.
+bool MQTTsendQueueElement(const MQTT_queue_element& element);
+
 
 /*********************************************************************************************\
 * Send status info back to channel where request came from
@@ -81,5 +118,11 @@ void MQTTStatus(struct EventStruct *event, const String& status);
 void SensorSendTask(struct EventStruct *event, unsigned long timestampUnixTime = 0);
 void SensorSendTask(struct EventStruct *event, unsigned long timestampUnixTime, unsigned long lasttimer);
 
+/*********************************************************************************************\
+ * Task value as used for %value% in a compiled task formula.
+ * Rounded to the set nr of decimals, just like formatUserVarNoCheck()
+\*********************************************************************************************/
+ESPEASY_RULES_FLOAT_TYPE getFormulaValue(struct EventStruct *event, deviceIndex_t DeviceIndex, uint8_t varNr);
+
 
 #endif
\ No newline at end of file
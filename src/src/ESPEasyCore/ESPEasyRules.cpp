@@ -10,6 +10,7 @@
 #include "../Globals/Cache.h"
 #include "../Globals/Device.h"
 #include "../Globals/EventQueue.h"
+#include "../Globals/MetricsRegistry.h"
 #include "../Globals/Plugins.h"
 #include "../Globals/Plugins_other.h"
 #include "../Globals/RulesCalculate.h"
@@ -85,11 +86,18 @@ bool processNextEvent() {
 /********************************************************************************************\
    Rules processing
  \*********************************************************************************************/
+#if FEATURE_METRICS_REGISTRY
+static metricIndex_t rulesLatencyMetric = INVALID_METRIC_INDEX;
+#endif // if FEATURE_METRICS_REGISTRY
+
 void rulesProcessing(const String& event) {
   if (!Settings.UseRules) {
     return;
   }
   START_TIMER
+  #if FEATURE_METRICS_REGISTRY
+  const uint64_t rulesStart = getMicros64();
+  #endif // if FEATURE_METRICS_REGISTRY
   #ifndef BUILD_NO_RAM_TRACKER
   checkRAM(F("rulesProcessing"));
   #endif // ifndef BUILD_NO_RAM_TRACKER
@@ -147,6 +155,16 @@ void rulesProcessing(const String& event) {
     addLogMove(LOG_LEVEL_DEBUG, log);
   }
 #endif // ifndef BUILD_NO_DEBUG
+  #if FEATURE_METRICS_REGISTRY
+
+  if (rulesLatencyMetric == INVALID_METRIC_INDEX) {
+    rulesLatencyMetric = Metrics.addHistogram(
+      F("rules_processing_usec"),
+      F("Time in usec to process an event in the rules"),
+      8);
+  }
+  Metrics.observe(rulesLatencyMetric, usecPassedSince(rulesStart));
+  #endif // if FEATURE_METRICS_REGISTRY
   STOP_TIMER(RULES_PROCESSING);
   backgroundtasks();
 }
@@ -197,15 +215,17 @@ bool rulesProcessingFile(const String& fileName,
   bool eventHandled = false;
   while (moreAvailable && !eventHandled) {
     const bool searchNextOnBlock = !codeBlock && !match;
-    String line = Cache.rulesHelper.readLn(fileName, pos, moreAvailable, searchNextOnBlock);
+    RulesLineInfo lineInfo;
+    String line = Cache.rulesHelper.readLn(fileName, pos, moreAvailable, searchNextOnBlock, lineInfo);
 
     // Parse the line and extract the action (if there is any)
     String action;
+    RulesLineType actionType = lineInfo.type;
     {
       START_TIMER
       const bool matched_before_parse = match;
       bool isOneLiner = false;
-      parseCompleteNonCommentLine(line, event, action, match, codeBlock,
+      parseCompleteNonCommentLine(line, lineInfo, event, action, match, codeBlock,
                                   isCommand, isOneLiner, condition, ifBranche, ifBlock,
                                   fakeIfBlock, startOnMatched);
       if ((matched_before_parse && !match) || isOneLiner) {
@@ -215,15 +235,28 @@ bool rulesProcessingFile(const String& fileName,
         eventHandled = true;
         backgroundtasks();
       }
+
+      if (isOneLiner || lineInfo.startsWithEventValue) {
+        // Action is not the same as the pre-parsed line.
+        actionType = RulesLineType::Dynamic;
+      }
       STOP_TIMER(RULES_PARSE_LINE);
     }
 
     if (match) // rule matched for one action or a block of actions
     {
+      // Line is processed as-is, so its expressions are the same on every call.
+      const bool withoutSubstitutions =
+        (actionType != RulesLineType::Dynamic) &&
+        !lineInfo.needsParseTemplate &&
+        !lineInfo.usesEventValue &&
+        (parseTemplate_CallBack_ptr == nullptr) &&
+        (substitute_eventvalue_CallBack_ptr == nullptr);
       START_TIMER
-      processMatchedRule(action, event,
+      processMatchedRule(action, actionType, event,
                          isCommand, condition,
-                         ifBranche, ifBlock, fakeIfBlock);
+                         ifBranche, ifBlock, fakeIfBlock,
+                         withoutSubstitutions);
       STOP_TIMER(RULES_PROCESS_MATCHED);
     }
   }
@@ -741,7 +774,8 @@ void substitute_eventvalue(String& line, const String& event) {
   }
 }
 
-void parseCompleteNonCommentLine(String& line, const String& event,
+void parseCompleteNonCommentLine(String& line, const RulesLineInfo& lineInfo,
+                                 const String& event,
                                  String& action, bool& match,
                                  bool& codeBlock, bool& isCommand, bool& isOneLiner,
                                  bool condition[], bool ifBranche[],
@@ -750,7 +784,7 @@ void parseCompleteNonCommentLine(String& line, const String& event,
   if (line.length() == 0) {
     return;
   }
-  const bool lineStartsWith_on = line.substring(0, 3).equalsIgnoreCase(F("on "));
+  const bool lineStartsWith_on = lineInfo.type == RulesLineType::On;
 
   if (!codeBlock && !match) {
     // We're looking for a new code block.
@@ -760,7 +794,7 @@ void parseCompleteNonCommentLine(String& line, const String& event,
     }
   }
 
-  if (line.equalsIgnoreCase(F("endon"))) // Check if action block has ended, then we will
+  if (lineInfo.type == RulesLineType::EndOn) // Check if action block has ended, then we will
                                            // wait for a new "on" rule
   {
     isCommand   = false;
@@ -771,7 +805,12 @@ void parseCompleteNonCommentLine(String& line, const String& event,
     return;
   }
 
-  const bool lineStartsWith_pct_event = line.startsWith(F("%event"));;
+  const bool lineStartsWith_pct_event = lineInfo.startsWithEventValue;
+
+  // Custom callbacks may act on any line, regardless of its markup.
+  const bool hasParseCallbacks =
+    (parseTemplate_CallBack_ptr != nullptr) ||
+    (substitute_eventvalue_CallBack_ptr != nullptr);
 
   isCommand = true;
 
@@ -779,15 +818,18 @@ void parseCompleteNonCommentLine(String& line, const String& event,
     // only parse [xxx#yyy] if we have a matching ruleblock or need to eval the
     // "on" (no codeBlock)
     // This to avoid wasting CPU time...
-    if (match && !fakeIfBlock) {
+    if (match && !fakeIfBlock &&
+        (lineInfo.usesEventValue || hasParseCallbacks)) {
       // substitution of %eventvalue% is made here so it can be used on if
       // statement too
       substitute_eventvalue(line, event);
     }
 
-    if (match || lineStartsWith_on) {
+    if ((match || lineStartsWith_on) &&
+        (lineInfo.needsParseTemplate || hasParseCallbacks)) {
       // Only parseTemplate when we are actually doing something with the line.
       // When still looking for the "on ... do" part, do not change it before we found the block.
+      // Lines without any markup are left untouched by parseTemplate, so skip those.
       line = parseTemplate(line);
     }
   }
@@ -856,13 +898,16 @@ void parseCompleteNonCommentLine(String& line, const String& event,
 #endif // ifndef BUILD_NO_DEBUG
 }
 
-void processMatchedRule(String& action, const String& event,
+void processMatchedRule(String& action, RulesLineType actionType, const String& event,
                         bool& isCommand, bool condition[], bool ifBranche[],
-                        uint8_t& ifBlock, uint8_t& fakeIfBlock) {
-  String lcAction = action;
-
-  lcAction.toLowerCase();
-  lcAction.trim();
+                        uint8_t& ifBlock, uint8_t& fakeIfBlock,
+                        bool withoutSubstitutions) {
+  if (actionType == RulesLineType::Dynamic) {
+    // Line was modified while parsing, so the line type must be determined now.
+    String trimmedAction = action;
+    trimmedAction.trim();
+    actionType = RulesLineInfo::getLineType(trimmedAction);
+  }
 
   if (fakeIfBlock) {
     isCommand = false;
@@ -872,48 +917,54 @@ void processMatchedRule(String& action, const String& event,
       isCommand = false;
     }
   }
-  int split =
-    lcAction.startsWith(F("elseif ")) ? 0 : -1; // check for optional "elseif" condition
 
-  if (split != -1) {
-    // Found "elseif" condition
-    isCommand = false;
+  switch (actionType) {
+    case RulesLineType::ElseIf:
+    {
+      // Found "elseif" condition
+      isCommand = false;
 
-    if (ifBlock && !fakeIfBlock) {
-      if (ifBranche[ifBlock - 1]) {
-        if (condition[ifBlock - 1]) {
-          ifBranche[ifBlock - 1] = false;
-        }
-        else {
-          String check = lcAction.substring(split + 7);
-          check.trim();
-          condition[ifBlock - 1] = conditionMatchExtended(check);
+      if (ifBlock && !fakeIfBlock) {
+        if (ifBranche[ifBlock - 1]) {
+          if (condition[ifBlock - 1]) {
+            ifBranche[ifBlock - 1] = false;
+          }
+          else {
+            String check = action;
+            check.toLowerCase();
+            check.trim();
+            check = check.substring(7);
+            check.trim();
+            condition[ifBlock - 1] = conditionMatchExtended(check, withoutSubstitutions);
 #ifndef BUILD_NO_DEBUG
 
-          if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
-            String log  = F("Lev.");
-            log += String(ifBlock);
-            log += F(": [elseif ");
-            log += check;
-            log += F("]=");
-            log += boolToString(condition[ifBlock - 1]);
-            addLogMove(LOG_LEVEL_DEBUG, log);
-          }
+            if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+              String log  = F("Lev.");
+              log += String(ifBlock);
+              log += F(": [elseif ");
+              log += check;
+              log += F("]=");
+              log += boolToString(condition[ifBlock - 1]);
+              addLogMove(LOG_LEVEL_DEBUG, log);
+            }
 #endif // ifndef BUILD_NO_DEBUG
+          }
         }
       }
+      break;
     }
-  } else {
-    // check for optional "if" condition
-    split = lcAction.startsWith(F("if ")) ? 0 : -1;
-
-    if (split != -1) {
+    case RulesLineType::If:
+    {
+      // check for optional "if" condition
       if (ifBlock < RULES_IF_MAX_NESTING_LEVEL) {
         if (isCommand) {
           ifBlock++;
-          String check = lcAction.substring(split + 3);
+          String check = action;
+          check.toLowerCase();
+          check.trim();
+          check = check.substring(3);
           check.trim();
-          condition[ifBlock - 1] = conditionMatchExtended(check);
+          condition[ifBlock - 1] = conditionMatchExtended(check, withoutSubstitutions);
           ifBranche[ifBlock - 1] = true;
 #ifndef BUILD_NO_DEBUG
 
@@ -941,36 +992,43 @@ void processMatchedRule(String& action, const String& event,
         }
       }
       isCommand = false;
+      break;
     }
-  }
-
-  if ((equals(lcAction, F("else"))) && !fakeIfBlock) // in case of an "else" block of
-                                               // actions, set ifBranche to
-                                               // false
-  {
-    ifBranche[ifBlock - 1] = false;
-    isCommand              = false;
+    case RulesLineType::Else:
+    {
+      // in case of an "else" block of actions, set ifBranche to false
+      if (!fakeIfBlock) {
+        if (ifBlock) {
+          ifBranche[ifBlock - 1] = false;
+        }
+        isCommand = false;
 #ifndef BUILD_NO_DEBUG
 
-    if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
-      String log  = F("Lev.");
-      log += String(ifBlock);
-      log += F(": [else]=");
-      log += boolToString(condition[ifBlock - 1] == ifBranche[ifBlock - 1]);
-      addLogMove(LOG_LEVEL_DEBUG, log);
-    }
+        if (ifBlock && loglevelActiveFor(LOG_LEVEL_DEBUG)) {
+          String log  = F("Lev.");
+          log += String(ifBlock);
+          log += F(": [else]=");
+          log += boolToString(condition[ifBlock - 1] == ifBranche[ifBlock - 1]);
+          addLogMove(LOG_LEVEL_DEBUG, log);
+        }
 #endif // ifndef BUILD_NO_DEBUG
-  }
-
-  if (equals(lcAction, F("endif"))) // conditional block ends here
-  {
-    if (fakeIfBlock) {
-      fakeIfBlock--;
+      }
+      break;
     }
-    else if (ifBlock) {
-      ifBlock--;
+    case RulesLineType::EndIf:
+    {
+      // conditional block ends here
+      if (fakeIfBlock) {
+        fakeIfBlock--;
+      }
+      else if (ifBlock) {
+        ifBlock--;
+      }
+      isCommand = false;
+      break;
     }
-    isCommand = false;
+    default:
+      break;
   }
 
   // process the action if it's a command and unconditional, or conditional and
@@ -986,11 +1044,16 @@ void processMatchedRule(String& action, const String& event,
       addLogMove(LOG_LEVEL_INFO, actionlog);
     }
 
+    // Keep the previous state, as the command may process another event.
+    const bool prevWithoutSubstitutions = rulesLineWithoutSubstitutions;
+    rulesLineWithoutSubstitutions = withoutSubstitutions;
+
     if (executeRestricted) {
       ExecuteCommand_all(EventValueSource::Enum::VALUE_SOURCE_RULES_RESTRICTED, parseStringToEndKeepCase(action, 2).c_str());
     } else {
       ExecuteCommand_all(EventValueSource::Enum::VALUE_SOURCE_RULES, action.c_str());
     }
+    rulesLineWithoutSubstitutions = prevWithoutSubstitutions;
     delay(0);
   }
 }
@@ -1003,11 +1066,11 @@ void processMatchedRule(String& action, const String& event,
 /********************************************************************************************\
    Check expression
  \*********************************************************************************************/
-bool conditionMatchExtended(String& check) {
+bool conditionMatchExtended(String& check, bool cacheExpressions) {
   int  condAnd   = -1;
   int  condOr    = -1;
   bool rightcond = false;
-  bool leftcond  = conditionMatch(check); // initial check
+  bool leftcond  = conditionMatch(check, cacheExpressions); // initial check
 
   #ifndef BUILD_NO_DEBUG
   String debugstr;
@@ -1035,7 +1098,7 @@ bool conditionMatchExtended(String& check) {
       if ((condAnd > 0) && (((condOr < 0) /*&& (condOr < condAnd)*/) ||
                             ((condOr > 0) && (condOr > condAnd)))) { // AND is first
         check     = check.substring(condAnd + 5);
-        rightcond = conditionMatch(check);
+        rightcond = conditionMatch(check, cacheExpressions);
         leftcond  = (leftcond && rightcond);
 
         #ifndef BUILD_NO_DEBUG
@@ -1046,7 +1109,7 @@ bool conditionMatchExtended(String& check) {
         #endif // ifndef BUILD_NO_DEBUG
       } else { // OR is first
         check     = check.substring(condOr + 4);
-        rightcond = conditionMatch(check);
+        rightcond = conditionMatch(check, cacheExpressions);
         leftcond  = (leftcond || rightcond);
 
         #ifndef BUILD_NO_DEBUG
@@ -1197,7 +1260,7 @@ int balanceParentheses(String& string) {
   return left - right;
 }
 
-bool conditionMatch(const String& check) {
+bool conditionMatch(const String& check, bool cacheExpressions) {
   int  posStart, posEnd;
   char compare;
 
@@ -1243,8 +1306,14 @@ bool conditionMatch(const String& check) {
     }
     balanceParentheses(tmpCheck1);
     balanceParentheses(tmpCheck2);
-    if (isError(Calculate(tmpCheck1, Value1)) ||
-        isError(Calculate(tmpCheck2, Value2)))
+    if (cacheExpressions) {
+      if (isError(CalculateCached(tmpCheck1, Value1)) ||
+          isError(CalculateCached(tmpCheck2, Value2)))
+      {
+        return false;
+      }
+    } else if (isError(Calculate(tmpCheck1, Value1)) ||
+               isError(Calculate(tmpCheck2, Value2)))
     {
       return false;
     }
@@ -1338,20 +1407,41 @@ void createRuleEvents(struct EventStruct *event) {
     }
     eventString += '`';
     eventQueue.addMove(std::move(eventString));    
-  } else if (Settings.CombineTaskValues_SingleEvent(event->TaskIndex)) {
-    String eventvalues;
-    eventvalues.reserve(32); // Enough for most use cases, prevent lots of memory allocations.
+  } else {
+    // Only store a copy of the task values in the event queue.
+    // The event string is generated when the event is processed.
+    // Plugins which format their own values are still formatted right now.
+    const TaskValues_Data_t *taskValues = UserVar.getTaskValues_Data(event->TaskIndex);
+    bool pluginFormatted                = taskValues == nullptr;
+    String formattedValue;
+
+    for (uint8_t varNr = 0; varNr < valueCount && !pluginFormatted; varNr++) {
+      pluginFormatted = pluginFormatUserVar(event, varNr, formattedValue);
+    }
+
+    if (Settings.CombineTaskValues_SingleEvent(event->TaskIndex)) {
+      if (pluginFormatted) {
+        String eventvalues;
+        eventvalues.reserve(32); // Enough for most use cases, prevent lots of memory allocations.
 
-    for (uint8_t varNr = 0; varNr < valueCount; varNr++) {
-      if (varNr != 0) {
-        eventvalues += ',';
+        for (uint8_t varNr = 0; varNr < valueCount; varNr++) {
+          if (varNr != 0) {
+            eventvalues += ',';
+          }
+          eventvalues += formatUserVarNoCheck(event, varNr);
+        }
+        eventQueue.add(event->TaskIndex, F("All"), eventvalues);
+      } else {
+        eventQueue.addTaskValueEvent(event->TaskIndex, VARS_PER_TASK, event->getSensorType(), *taskValues);
+      }
+    } else {
+      for (uint8_t varNr = 0; varNr < valueCount; varNr++) {
+        if (pluginFormatted) {
+          eventQueue.add(event->TaskIndex, getTaskValueName(event->TaskIndex, varNr), formatUserVarNoCheck(event, varNr));
+        } else {
+          eventQueue.addTaskValueEvent(event->TaskIndex, varNr, event->getSensorType(), *taskValues);
+        }
       }
-      eventvalues += formatUserVarNoCheck(event, varNr);
-    }
-    eventQueue.add(event->TaskIndex, F("All"), eventvalues);
-  } else {
-    for (uint8_t varNr = 0; varNr < valueCount; varNr++) {
-      eventQueue.add(event->TaskIndex, getTaskValueName(event->TaskIndex, varNr), formatUserVarNoCheck(event, varNr));
     }
   }
 }
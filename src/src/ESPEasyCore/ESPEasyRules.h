@@ -7,6 +7,7 @@
 #include "../../ESPEasy_common.h"
 
 #include "../CustomBuild/ESPEasyLimits.h"
+#include "../DataStructs/RulesLineInfo.h"
 
 
 
@@ -70,6 +71,7 @@ void substitute_eventvalue(String      & line,
                            const String& event);
 
 void parseCompleteNonCommentLine(String& line,
+                                 const RulesLineInfo& lineInfo,
                                  const String& event,
                                  String& action,
                                  bool  & match,
@@ -82,22 +84,26 @@ void parseCompleteNonCommentLine(String& line,
                                  uint8_t  & fakeIfBlock,
                                  bool   startOnMatched);
 
+// @param withoutSubstitutions  The action is the same on every call, so its expressions can be kept compiled.
 void processMatchedRule(String& action,
+                        RulesLineType actionType,
                         const String& event,
                         bool  & isCommand,
                         bool    condition[],
                         bool    ifBranche[],
                         uint8_t  & ifBlock,
-                        uint8_t  & fakeIfBlock);
+                        uint8_t  & fakeIfBlock,
+                        bool    withoutSubstitutions = false);
 
 
 /********************************************************************************************\
    Check expression
  \*********************************************************************************************/
-bool conditionMatchExtended(String& check);
+// @param cacheExpressions  The check is the same on every call, so keep its expressions compiled.
+bool conditionMatchExtended(String& check, bool cacheExpressions = false);
 
 
-bool conditionMatch(const String& check);
+bool conditionMatch(const String& check, bool cacheExpressions = false);
 
 /********************************************************************************************\
    Matching time notations HH:MM:SS and HH:MM:SS and HH
@@ -16,6 +16,10 @@
 #include "../Helpers/ESPEasy_Storage.h"
 #endif
 
+void addToSerialLog(uint8_t logLevel, const String& string);
+void addToSysLog(uint8_t logLevel, const String& string);
+void addToSDLog(uint8_t logLevel, const String& string);
+
 /********************************************************************************************\
   Init critical variables for logging (important during initial factory reset stuff )
   \*********************************************************************************************/
@@ -174,19 +178,36 @@ bool loglevelActiveFor(uint8_t destination, uint8_t logLevel) {
 void addLog(uint8_t logLevel, const __FlashStringHelper *str)
 {
   if (loglevelActiveFor(logLevel)) {
-    String copy;
-    {
-      #ifdef USE_SECOND_HEAP
-      // Allow to store the logs in 2nd heap if present.
-      HeapSelectIram ephemeral;
-      #endif
+    // Only make a copy when needed for serial, syslog or SD card.
+    if (loglevelActiveFor(LOG_TO_SERIAL, logLevel) ||
+        loglevelActiveFor(LOG_TO_SYSLOG, logLevel) ||
+        loglevelActiveFor(LOG_TO_SDCARD, logLevel)) {
+      String copy;
+      bool   reserved = false;
+      {
+        #ifdef USE_SECOND_HEAP
+        // Allow to store the logs in 2nd heap if present.
+        HeapSelectIram ephemeral;
+        #endif
+
+        reserved = copy.reserve(strlen_P((PGM_P)str));
 
-      if (!copy.reserve(strlen_P((PGM_P)str))) {
-        return;
+        if (reserved) {
+          copy = str;
+        }
+      }
+
+      if (reserved) {
+        addToSerialLog(logLevel, copy);
+        addToSysLog(logLevel, copy);
+        addToSDLog(logLevel, copy);
       }
-      copy = str;
     }
-    addToLogMove(logLevel, std::move(copy));
+
+    if (loglevelActiveFor(LOG_TO_WEBLOG, logLevel)) {
+      // Web log only keeps the pointer to the flash string.
+      Logging.add(logLevel, str);
+    }
   }
 }
 
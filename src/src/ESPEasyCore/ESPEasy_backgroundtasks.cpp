@@ -9,6 +9,7 @@
 #include "../Globals/NetworkState.h"
 #include "../Globals/Services.h"
 #include "../Globals/Settings.h"
+#include "../Globals/TXBuffer.h"
 #if FEATURE_RTTTL && FEATURE_ANYRTTTL_LIB && FEATURE_ANYRTTTL_ASYNC
 #include "../Helpers/Audio.h"
 #endif // if FEATURE_RTTTL && FEATURE_ANYRTTTL_LIB && FEATURE_ANYRTTTL_ASYNC
@@ -78,7 +79,8 @@ void backgroundtasks()
   if (!UseRTOSMultitasking) {
     serial();
 
-    if (webserverRunning) {
+    // Do not handle a new request while a page is being streamed from a request handler.
+    if (webserverRunning && !TXBuffer.isYielding()) {
       web_server.handleClient();
     }
     #if FEATURE_ESPEASY_P2P
@@ -6,4 +6,7 @@
 \*********************************************************************************************/
 void backgroundtasks();
 
+// Set while backgroundtasks() is running, nested calls only yield.
+extern bool runningBackgroundTasks;
+
 #endif
\ No newline at end of file
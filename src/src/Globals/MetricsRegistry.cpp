@@ -0,0 +1,7 @@
+#include "../Globals/MetricsRegistry.h"
+
+#if FEATURE_METRICS_REGISTRY
+
+MetricsRegistry Metrics;
+
+#endif // if FEATURE_METRICS_REGISTRY
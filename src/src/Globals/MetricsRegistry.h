@@ -0,0 +1,12 @@
+#ifndef GLOBALS_METRICSREGISTRY_H
+#define GLOBALS_METRICSREGISTRY_H
+
+#include "../DataStructs/MetricsRegistry.h"
+
+#if FEATURE_METRICS_REGISTRY
+
+extern MetricsRegistry Metrics;
+
+#endif // if FEATURE_METRICS_REGISTRY
+
+#endif // GLOBALS_METRICSREGISTRY_H
@@ -5,6 +5,7 @@
 #include "../../_Plugin_Helper.h"
 
 #include "../DataStructs/ESPEasy_EventStruct.h"
+#include "../DataStructs/PluginTaskSubscribers.h"
 #include "../DataStructs/TimingStats.h"
 
 #include "../DataTypes/ESPEasy_plugin_functions.h"
@@ -398,6 +399,9 @@ bool PluginCallForTask(taskIndex_t taskIndex, uint8_t Function, EventStruct *Tem
   return retval;
 }
 
+// Tasks to call for PLUGIN_TEN_PER_SECOND and PLUGIN_FIFTY_PER_SECOND
+static PluginTaskSubscribers pluginTaskSubscribers;
+
 /*********************************************************************************************\
 * Function call to all or specific plugins
 \*********************************************************************************************/
@@ -518,9 +522,14 @@ bool PluginCall(uint8_t Function, struct EventStruct *event, String& str)
   // info += lastTask;
   // addLog(LOG_LEVEL_INFO, info);
 
+      // Only call the tasks which may handle the command, based on PLUGIN_GET_COMMAND_PREFIXES
+      pluginTaskSubscribers.refresh();
+      const String cmd_lc = parseString(command, 1);
+
       for (taskIndex_t task = firstTask; task < lastTask; task++)
       {
-        bool retval = PluginCallForTask(task, Function, &TempEvent, command);
+        bool retval = pluginTaskSubscribers.acceptsCommand(task, cmd_lc) &&
+                      PluginCallForTask(task, Function, &TempEvent, command);
 
         if (!retval) {
           if (1 == (lastTask - firstTask)) {
@@ -575,10 +584,21 @@ bool PluginCall(uint8_t Function, struct EventStruct *event, String& str)
       return false;
     }
 
-    // Call to all plugins that are used in a task
-    case PLUGIN_ONCE_A_SECOND:
+    // Call to all tasks of plugins which declared to handle the function
     case PLUGIN_TEN_PER_SECOND:
     case PLUGIN_FIFTY_PER_SECOND:
+    {
+      uint8_t nrTasks = 0;
+      const taskIndex_t *tasks = pluginTaskSubscribers.getTasks(Function, nrTasks);
+
+      for (uint8_t i = 0; i < nrTasks; ++i) {
+        PluginCallForTask(tasks[i], Function, &TempEvent, str, event);
+      }
+      return true;
+    }
+
+    // Call to all plugins that are used in a task
+    case PLUGIN_ONCE_A_SECOND:
     case PLUGIN_INIT_ALL:
     case PLUGIN_CLOCK_IN:
     case PLUGIN_TIME_CHANGE:
@@ -4,8 +4,23 @@
 #include "../Helpers/Numerical.h"
 #include "../Helpers/StringConverter_Numerical.h"
 
+#include <map>
+
+// Max. nr of compiled expressions kept by CalculateCached()
+#ifndef RULES_EXPRESSION_CACHE_SIZE
+# ifdef ESP8266
+#  define RULES_EXPRESSION_CACHE_SIZE 16
+# else // ifdef ESP8266
+#  define RULES_EXPRESSION_CACHE_SIZE 64
+# endif // ifdef ESP8266
+#endif // ifndef RULES_EXPRESSION_CACHE_SIZE
+
 RulesCalculate_t RulesCalculate{};
 
+bool rulesLineWithoutSubstitutions = false;
+
+static std::map<String, CompiledExpression> rulesExpressionCache;
+
 /*******************************************************************************************
 * Helper functions to actually interact with the rules calculation functions.
 * *****************************************************************************************/
@@ -39,6 +54,51 @@ int CalculateParam(const String& TmpStr) {
   return returnValue;
 }
 
+void logCalculateError(CalculateReturnCode             returnCode,
+                        const String                  & input,
+                        const ESPEASY_RULES_FLOAT_TYPE& result)
+{
+  if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
+    String log = F("Calculate: ");
+
+    switch (returnCode) {
+      case CalculateReturnCode::ERROR_STACK_OVERFLOW:
+        log += F("Stack Overflow");
+        break;
+      case CalculateReturnCode::ERROR_BAD_OPERATOR:
+        log += F("Bad Operator");
+        break;
+      case CalculateReturnCode::ERROR_PARENTHESES_MISMATCHED:
+        log += F("Parenthesis mismatch");
+        break;
+      case CalculateReturnCode::ERROR_UNKNOWN_TOKEN:
+        log += F("Unknown token");
+        break;
+      case CalculateReturnCode::ERROR_TOKEN_LENGTH_EXCEEDED:
+        log += String(F("Exceeded token length (")) + TOKEN_LENGTH + ')';
+        break;
+      case CalculateReturnCode::OK:
+        // Already handled, but need to have all cases here so the compiler can warn if we're missing one.
+        break;
+    }
+
+    #ifndef BUILD_NO_DEBUG
+    log += F(" input: ");
+    log += input;
+    log += F(" = ");
+
+    const bool trimTrailingZeros = true;
+#if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+    log += doubleToString(result, 6, trimTrailingZeros);
+#else
+    log += floatToString(result, 6, trimTrailingZeros);
+#endif
+    #endif // ifndef BUILD_NO_DEBUG
+
+    addLogMove(LOG_LEVEL_ERROR, log);
+  }
+}
+
 CalculateReturnCode Calculate(const String& input,
                               ESPEASY_RULES_FLOAT_TYPE      & result)
 {
@@ -48,47 +108,42 @@ CalculateReturnCode Calculate(const String& input,
     &result);
 
   if (isError(returnCode)) {
-    if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
-      String log = F("Calculate: ");
-
-      switch (returnCode) {
-        case CalculateReturnCode::ERROR_STACK_OVERFLOW:
-          log += F("Stack Overflow");
-          break;
-        case CalculateReturnCode::ERROR_BAD_OPERATOR:
-          log += F("Bad Operator");
-          break;
-        case CalculateReturnCode::ERROR_PARENTHESES_MISMATCHED:
-          log += F("Parenthesis mismatch");
-          break;
-        case CalculateReturnCode::ERROR_UNKNOWN_TOKEN:
-          log += F("Unknown token");
-          break;
-        case CalculateReturnCode::ERROR_TOKEN_LENGTH_EXCEEDED:
-          log += String(F("Exceeded token length (")) + TOKEN_LENGTH + ')';
-          break;
-        case CalculateReturnCode::OK:
-          // Already handled, but need to have all cases here so the compiler can warn if we're missing one.
-          break;
-      }
-
-      #ifndef BUILD_NO_DEBUG
-      log += F(" input: ");
-      log += input;
-      log += F(" = ");
+    logCalculateError(returnCode, input, result);
+  }
+  STOP_TIMER(COMPUTE_STATS);
+  return returnCode;
+}
 
-      const bool trimTrailingZeros = true;
-#if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
-      log += doubleToString(result, 6, trimTrailingZeros);
-#else
-      log += floatToString(result, 6, trimTrailingZeros);
-#endif
-      #endif // ifndef BUILD_NO_DEBUG
+CalculateReturnCode Calculate(const CompiledExpression& expression,
+                              ESPEASY_RULES_FLOAT_TYPE  value,
+                              ESPEASY_RULES_FLOAT_TYPE  previousValue,
+                              ESPEASY_RULES_FLOAT_TYPE& result)
+{
+  START_TIMER;
+  CalculateReturnCode returnCode = expression.evaluate(value, previousValue, result);
 
-      addLogMove(LOG_LEVEL_ERROR, log);
-    }
+  if (isError(returnCode)) {
+    logCalculateError(returnCode, expression.getExpression(), result);
   }
   STOP_TIMER(COMPUTE_STATS);
   return returnCode;
 }
 
+CalculateReturnCode CalculateCached(const String            & input,
+                                    ESPEASY_RULES_FLOAT_TYPE& result)
+{
+  auto it = rulesExpressionCache.find(input);
+
+  if (it == rulesExpressionCache.end()) {
+    if (rulesExpressionCache.size() >= RULES_EXPRESSION_CACHE_SIZE) {
+      // May contain expressions of rules which are no longer used, so just start over.
+      rulesExpressionCache.clear();
+    }
+    it = rulesExpressionCache.emplace(input, CompiledExpression(input)).first;
+  }
+
+  if (!it->second.canEvaluate()) {
+    return Calculate(input, result);
+  }
+  return Calculate(it->second, 0, 0, result);
+}
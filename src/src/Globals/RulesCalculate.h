@@ -1,6 +1,7 @@
 #ifndef GLOBALS_RULESCALCULATE_H
 #define GLOBALS_RULESCALCULATE_H
 
+#include "../DataStructs/CompiledExpression.h"
 #include "../Helpers/Rules_calculate.h"
 
 /********************************************************************************************\
@@ -19,9 +20,27 @@ extern RulesCalculate_t RulesCalculate;
 
 int                 CalculateParam(const String& TmpStr);
 
+void                logCalculateError(CalculateReturnCode             returnCode,
+                                      const String                  & input,
+                                      const ESPEASY_RULES_FLOAT_TYPE& result);
+
 CalculateReturnCode Calculate(const String& input,
                               ESPEASY_RULES_FLOAT_TYPE      & result);
 
+// Evaluate a compiled expression, canEvaluate() must have returned true.
+CalculateReturnCode Calculate(const CompiledExpression& expression,
+                              ESPEASY_RULES_FLOAT_TYPE  value,
+                              ESPEASY_RULES_FLOAT_TYPE  previousValue,
+                              ESPEASY_RULES_FLOAT_TYPE& result);
+
+// Evaluate an expression which is the same on every call, like one taken from a rules line without substitutions.
+// The expression is kept compiled, so it is not tokenized again on the next call.
+CalculateReturnCode CalculateCached(const String            & input,
+                                    ESPEASY_RULES_FLOAT_TYPE& result);
+
+// Set while a rules line without any substitutions is processed.
+// Commands like Let can then use CalculateCached() on their expression.
+extern bool rulesLineWithoutSubstitutions;
 
 
 #endif
\ No newline at end of file
@@ -7,28 +7,52 @@
 #include "../WebServer/ESPEasy_WebServer.h"
 #include "../Helpers/Convert.h"
 #include "../Helpers/_Plugin_init.h"
+#include "../Helpers/StringConverter.h"
 
 
-void stream_json_timing_stats(const TimingStats& stats, long timeSinceLastReset) {
+void stream_json_timing_stats(JSON_Writer& writer, const TimingStats& stats, long timeSinceLastReset) {
   uint64_t minVal, maxVal;
   uint64_t  count = stats.getMinMax(minVal, maxVal);
   float call_per_sec = static_cast<float>(count) / static_cast<float>(timeSinceLastReset) * 1000.0f;
 
-  json_number(F("count"), ull2String(count));
-  json_number(F("call-per-sec"),   toString(call_per_sec, 2));
-  json_number(F("min"),   ull2String(minVal));
-  json_number(F("max"),   ull2String(maxVal));
-  json_number(F("avg"),   toString(stats.getAvg(), 2));
-  json_prop(F("unit"), F("usec"));
+  writer.write(F("count"),        count);
+  writer.write(F("call-per-sec"), call_per_sec, 2);
+  writer.write(F("min"),          minVal);
+  writer.write(F("max"),          maxVal);
+  writer.write(F("avg"),          stats.getAvg(), 2);
+  writer.write(F("p50"),          stats.getPercentile(50));
+  writer.write(F("p90"),          stats.getPercentile(90));
+  writer.write(F("p99"),          stats.getPercentile(99));
+  writer.write(F("unit"),         F("usec"));
+
+  // Count per bucket as listed in "histogram-bounds", trailing empty buckets are left out.
+  uint8_t nrBuckets = TIMING_STATS_NR_BUCKETS;
+
+  while (nrBuckets > 0 && stats.getBucketCount(nrBuckets - 1) == 0) {
+    --nrBuckets;
+  }
+  writer.openArray(F("histogram"));
+
+  for (uint8_t bucket = 0; bucket < nrBuckets; ++bucket) {
+    writer.add(stats.getBucketCount(bucket));
+  }
+  writer.closeArray();
 }
 
-void jsonStatistics(bool clearStats) {
+void jsonStatistics(JSON_Writer& writer, bool clearStats) {
   bool firstPlugin     = true;
   deviceIndex_t  currentDeviceIndex = INVALID_DEVICE_INDEX;
   long timeSinceLastReset = timePassedSince(timingstats_last_reset);
 
+  // Upper bound in usec per histogram bucket, the last bucket has no upper bound.
+  writer.openArray(F("histogram-bounds"));
+
+  for (uint8_t bucket = 0; bucket < (TIMING_STATS_NR_BUCKETS - 1); ++bucket) {
+    writer.add(TimingStats::getBucketUpperBound(bucket));
+  }
+  writer.closeArray();
 
-  json_open(true, F("plugin"));
+  writer.openArray(F("plugin"));
 
   for (auto& x: pluginStats) {
     if (!x.second.isEmpty()) {
@@ -38,37 +62,37 @@ void jsonStatistics(bool clearStats) {
         // new plugin
         currentDeviceIndex = deviceIndex;
         if (!firstPlugin) {
-          json_close();
-          json_close(true); // close previous function list
-          json_close();     // close previous plugin
+          writer.closeObject();
+          writer.closeArray(); // close previous function list
+          writer.closeObject();     // close previous plugin
         }
         // Start new plugin stream
-        json_open(); // open new plugin
-        json_prop(F("name"), getPluginNameFromDeviceIndex(deviceIndex));
-        json_prop(F("id"),   String(getPluginID_from_DeviceIndex(deviceIndex).value));
-        json_open(true, F("function")); // open function
-        json_open(); // open first function element
+        writer.openObject(); // open new plugin
+        writer.write(F("name"), getPluginNameFromDeviceIndex(deviceIndex));
+        writer.write(F("id"),   static_cast<uint32_t>(getPluginID_from_DeviceIndex(deviceIndex).value));
+        writer.openArray(F("function")); // open function
+        writer.openObject(); // open first function element
       }
 
       // Stream function timing stats
-      json_open(false, getPluginFunctionName(x.first % 256));
+      writer.openObject(getPluginFunctionName(x.first % 256));
       {
-        stream_json_timing_stats(x.second, timeSinceLastReset);
+        stream_json_timing_stats(writer, x.second, timeSinceLastReset);
       }
-      json_close(false);
+      writer.closeObject();
       firstPlugin = false;
     }
   }
   if (!firstPlugin) {
     // We added some, so we must make sure to close the last entry
-    json_close();     // close first function element
-    json_close(true); // close previous function
-    json_close();     // close previous plugin
+    writer.closeObject();     // close first function element
+    writer.closeArray(); // close previous function
+    writer.closeObject();     // close previous plugin
   }
-  json_close(true);   // Close plugin list
+  writer.closeArray();   // Close plugin list
 
 
-  json_open(true, F("controller"));
+  writer.openArray(F("controller"));
   bool firstController = true;
   int  currentProtocolIndex = -1;
   for (auto& x: controllerStats) {
@@ -78,58 +102,133 @@ void jsonStatistics(bool clearStats) {
         // new protocol
         currentProtocolIndex = ProtocolIndex;
         if (!firstController) {
-          json_close();
-          json_close(true); // close previous function list
-          json_close();     // close previous protocol
+          writer.closeObject();
+          writer.closeArray(); // close previous function list
+          writer.closeObject();     // close previous protocol
         }
         // Start new protocol stream
-        json_open(); // open new plugin
-        json_prop(F("name"), getCPluginNameFromProtocolIndex(ProtocolIndex));
-        json_prop(F("id"),   String(getCPluginID_from_ProtocolIndex(ProtocolIndex)));
-        json_open(true, F("function")); // open function
-        json_open(); // open first function element
+        writer.openObject(); // open new plugin
+        writer.write(F("name"), getCPluginNameFromProtocolIndex(ProtocolIndex));
+        writer.write(F("id"),   static_cast<uint32_t>(getCPluginID_from_ProtocolIndex(ProtocolIndex)));
+        writer.openArray(F("function")); // open function
+        writer.openObject(); // open first function element
 
       }
       // Stream function timing stats
-      json_open(false, getCPluginCFunctionName(static_cast<CPlugin::Function>(x.first % 256)));
+      writer.openObject(getCPluginCFunctionName(static_cast<CPlugin::Function>(x.first % 256)));
       {
-        stream_json_timing_stats(x.second, timeSinceLastReset);
+        stream_json_timing_stats(writer, x.second, timeSinceLastReset);
       }
-      json_close(false);
+      writer.closeObject();
       firstController = false;
     }
   }
   if (!firstController) {
     // We added some, so we must make sure to close the last entry
-    json_close();     // close first function element
-    json_close(true); // close previous function
-    json_close();     // close previous plugin
+    writer.closeObject();     // close first function element
+    writer.closeArray(); // close previous function
+    writer.closeObject();     // close previous plugin
   }
 
-  json_close(true);   // Close controller list
+  writer.closeArray();   // Close controller list
 
 
-  json_open(true, F("misc"));
+  writer.openArray(F("misc"));
   for (auto& x: miscStats) {
     if (!x.second.isEmpty()) {
-      json_open(); // open new misc item
-      json_prop(F("name"), getMiscStatsName(x.first));
-      json_prop(F("id"),   String(static_cast<int>(x.first)));
-      json_open(true, F("function")); // open function
-      json_open(); // open first function element
+      writer.openObject(); // open new misc item
+      writer.write(F("name"), getMiscStatsName(x.first));
+      writer.write(F("id"),   static_cast<int32_t>(x.first));
+      writer.openArray(F("function")); // open function
+      writer.openObject(); // open first function element
       // Stream function timing stats
-      json_open(false, to_internal_string(getMiscStatsName(x.first), '-'));
+      writer.openObject(to_internal_string(getMiscStatsName(x.first), '-'));
       {
-        stream_json_timing_stats(x.second, timeSinceLastReset);
+        stream_json_timing_stats(writer, x.second, timeSinceLastReset);
       }
-      json_close(false);
-      json_close();     // close first function element
-      json_close(true); // close function
-      json_close();     // close misc item
+      writer.closeObject();
+      writer.closeObject();     // close first function element
+      writer.closeArray(); // close function
+      writer.closeObject();     // close misc item
+    }
+  }
+
+  writer.closeArray();   // Close misc list
+
+  if (clearStats) {
+    pluginStats.clear();
+    controllerStats.clear();
+    miscStats.clear();
+    timingstats_last_reset = millis();
+  }
+}
+
+
+#ifndef BUILD_NO_DEBUG
+static void logStatistics(uint8_t loglevel, const String& name, const TimingStats& stats) {
+  uint64_t minVal, maxVal;
+  const uint32_t count = stats.getMinMax(minVal, maxVal);
+
+  String log;
+
+  if (!log.reserve(128 + name.length())) { return; }
+  log += F("TimingStats: ");
+  log += name;
+  log += F(" count: ");
+  log += count;
+  log += F(" avg: ");
+  log += toString(stats.getAvg(), 0);
+  log += F(" p50: ");
+  log += ull2String(stats.getPercentile(50));
+  log += F(" p99: ");
+  log += ull2String(stats.getPercentile(99));
+  log += F(" max: ");
+  log += ull2String(maxVal);
+  log += F(" usec hist:");
+
+  for (uint8_t bucket = 0; bucket < TIMING_STATS_NR_BUCKETS; ++bucket) {
+    const uint32_t bucketCount = stats.getBucketCount(bucket);
+
+    if (bucketCount != 0) {
+      log += ' ';
+      log += TimingStats::getBucketLabel(bucket);
+      log += ':';
+      log += bucketCount;
     }
   }
+  addLogMove(loglevel, log);
+}
 
-  json_close(true);   // Close misc list
+void logStatistics(uint8_t loglevel, bool clearStats) {
+  if (loglevelActiveFor(loglevel)) {
+    for (auto& x: pluginStats) {
+      if (!x.second.isEmpty()) {
+        const deviceIndex_t deviceIndex = deviceIndex_t::toDeviceIndex(x.first >> 8);
+
+        if (validDeviceIndex(deviceIndex)) {
+          String name = get_formatted_Plugin_number(getPluginID_from_DeviceIndex(deviceIndex));
+          name += '-';
+          name += getPluginFunctionName(x.first % 256);
+          logStatistics(loglevel, name, x.second);
+        }
+      }
+    }
+
+    for (auto& x: controllerStats) {
+      if (!x.second.isEmpty()) {
+        String name = get_formatted_Controller_number(getCPluginID_from_ProtocolIndex(x.first >> 8));
+        name += '-';
+        name += getCPluginCFunctionName(static_cast<CPlugin::Function>(x.first % 256));
+        logStatistics(loglevel, name, x.second);
+      }
+    }
+
+    for (auto& x: miscStats) {
+      if (!x.second.isEmpty()) {
+        logStatistics(loglevel, getMiscStatsName(x.first), x.second);
+      }
+    }
+  }
 
   if (clearStats) {
     pluginStats.clear();
@@ -139,5 +238,6 @@ void jsonStatistics(bool clearStats) {
   }
 }
 
+#endif // ifndef BUILD_NO_DEBUG
 
 #endif // if FEATURE_TIMING_STATS
\ No newline at end of file
@@ -8,12 +8,16 @@
 #if FEATURE_TIMING_STATS
 
 #include "../DataStructs/TimingStats.h"
+#include "../WebServer/JSON_Writer.h"
 
-//void logStatistics(uint8_t loglevel, bool clearStats);
+#ifndef BUILD_NO_DEBUG
+// Log a line per timing stat, including the non-empty histogram buckets.
+void logStatistics(uint8_t loglevel, bool clearStats);
+#endif // ifndef BUILD_NO_DEBUG
 
-void stream_json_timing_stats(const TimingStats& stats, long timeSinceLastReset);
+void stream_json_timing_stats(JSON_Writer& writer, const TimingStats& stats, long timeSinceLastReset);
 
-void jsonStatistics(bool clearStats);
+void jsonStatistics(JSON_Writer& writer, bool clearStats);
 
 #endif // if FEATURE_TIMING_STATS
 
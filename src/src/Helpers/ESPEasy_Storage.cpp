@@ -163,6 +163,11 @@ bool fileExists(const String& fname) {
   return res;
 }
 
+bool fileMatchesTaskSettingsType(const String& fname) {
+  const String config_dat_file = patch_fname(getFileName(FileType::CONFIG_DAT));
+  return config_dat_file.equalsIgnoreCase(patch_fname(fname));
+}
+
 fs::File tryOpenFile(const String& fname, const String& mode, FileDestination_e destination) {
   START_TIMER;
   fs::File f;
@@ -178,6 +183,18 @@ fs::File tryOpenFile(const String& fname, const String& mode, FileDestination_e
     }
     clearFileCaches();
   }
+  #if FEATURE_SETTINGS_WRITE_CACHE
+  else {
+    // Make sure cached settings are written first, unless the file will be truncated.
+    Cache.settingsBlockCache.beforeFileAccess(fname, equals(mode, 'r'), mode[0] != 'w');
+  }
+  #endif // if FEATURE_SETTINGS_WRITE_CACHE
+
+  if ((mode[0] == 'w') && fileMatchesTaskSettingsType(fname)) {
+    // File will be truncated, so cached task settings are no longer valid.
+    Cache.extraTaskSettingsLRU.clear();
+  }
+
   if ((destination == FileDestination_e::ANY) || (destination == FileDestination_e::FLASH)) {
     f = ESPEASY_FS.open(patch_fname(fname), mode.c_str());
   }
@@ -193,14 +210,12 @@ fs::File tryOpenFile(const String& fname, const String& mode, FileDestination_e
   return f;
 }
 
-bool fileMatchesTaskSettingsType(const String& fname) {
-  const String config_dat_file = patch_fname(getFileName(FileType::CONFIG_DAT));
-  return config_dat_file.equalsIgnoreCase(patch_fname(fname));
-}
-
 bool tryRenameFile(const String& fname_old, const String& fname_new, FileDestination_e destination) {
   clearFileCaches();
   if (fileExists(fname_old) && !fileExists(fname_new)) {
+    #if FEATURE_SETTINGS_WRITE_CACHE
+    Cache.settingsBlockCache.beforeFileAccess(fname_old, false);
+    #endif // if FEATURE_SETTINGS_WRITE_CACHE
     if (fileMatchesTaskSettingsType(fname_old)) {
       clearAllCaches();
     } else {
@@ -228,6 +243,9 @@ bool tryDeleteFile(const String& fname, FileDestination_e destination) {
       ControllerCache.closeOpenFiles();
     }
     #endif
+    #if FEATURE_SETTINGS_WRITE_CACHE
+    Cache.settingsBlockCache.beforeFileAccess(fname, false, false);
+    #endif // if FEATURE_SETTINGS_WRITE_CACHE
     if (fileMatchesTaskSettingsType(fname)) {
       clearAllCaches();
     } else {
@@ -558,6 +576,13 @@ String SaveSettings(bool forFactoryReset)
   checkRAM(F("SaveSettings"));
   #endif
   String     err;
+  #if FEATURE_SETTINGS_WRITE_CACHE
+  // Commit all cached changes to the settings blocks
+  err = Cache.settingsBlockCache.flush();
+  if (err.length()) {
+    return err;
+  }
+  #endif // if FEATURE_SETTINGS_WRITE_CACHE
   {
     Settings.StructSize = sizeof(Settings);
 
@@ -1025,6 +1050,10 @@ String SaveStringArray(SettingsType::Enum settingsType, int index, const String
 
     // Buffer is filled, now write to flash
     // As we write in parts, only count as single write.
+    #if FEATURE_SETTINGS_WRITE_CACHE
+    // Cached writes are counted when flushed.
+    if (!SettingsBlockCacheClass::isCacheable(settingsType))
+    #endif // if FEATURE_SETTINGS_WRITE_CACHE
     if (RTC.flashDayCounter > 0) {
       RTC.flashDayCounter--;
     }
@@ -1075,6 +1104,9 @@ String SaveTaskSettings(taskIndex_t TaskIndex)
                             reinterpret_cast<const uint8_t *>(&ExtraTaskSettings),
                             sizeof(struct ExtraTaskSettingsStruct));
 
+    // Stored content differs from what was loaded, like the default value names.
+    Cache.extraTaskSettingsLRU.erase(TaskIndex);
+
 #if !defined(PLUGIN_BUILD_MINIMAL_OTA) && !defined(ESP8266_1M)
     if (err.isEmpty()) {
       err = checkTaskSettings(TaskIndex);
@@ -1120,6 +1152,15 @@ String LoadTaskSettings(taskIndex_t TaskIndex)
   checkRAM(F("LoadTaskSettings"));
   #endif
 
+  if (Cache.extraTaskSettingsLRU.get(TaskIndex, ExtraTaskSettings)) {
+    // Already patched and validated before it was added to the LRU cache.
+    // The cached values and checksum are computed from the stored content,
+    // just like when it was read from flash.
+    Cache.updateExtraTaskSettingsCache_afterLoad_Save();
+    STOP_TIMER(LOAD_TASK_SETTINGS_C);
+    return EMPTY_STRING;
+  }
+
   const String result = LoadFromFile(
     SettingsType::Enum::TaskSettings_Type, 
     TaskIndex, 
@@ -1139,6 +1180,10 @@ String LoadTaskSettings(taskIndex_t TaskIndex)
   
   ExtraTaskSettings.validate();
   Cache.updateExtraTaskSettingsCache_afterLoad_Save();
+
+  if (result.isEmpty()) {
+    Cache.extraTaskSettingsLRU.put(ExtraTaskSettings);
+  }
   STOP_TIMER(LOAD_TASK_SETTINGS);
 
   return result;
@@ -1684,6 +1729,11 @@ String LoadFromFile(SettingsType::Enum settingsType, int index, uint8_t *memAddr
   if ((datasize + offset_in_block) > max_size) {
     return getSettingsFileDatasizeError(read, settingsType, index, datasize, max_size);
   }
+  #if FEATURE_SETTINGS_WRITE_CACHE
+  if (SettingsBlockCacheClass::isCacheable(settingsType)) {
+    return Cache.settingsBlockCache.load(settingsType, index, memAddress, datasize, offset_in_block);
+  }
+  #endif // if FEATURE_SETTINGS_WRITE_CACHE
   const String fname = SettingsType::getSettingsFileName(settingsType);
   return LoadFromFile(fname.c_str(), (offset + offset_in_block), memAddress, datasize);
 }
@@ -1699,6 +1749,11 @@ String SaveToFile(SettingsType::Enum settingsType, int index, const uint8_t *mem
   if ((datasize > max_size) || ((posInBlock + datasize) > max_size)) {
     return getSettingsFileDatasizeError(read, settingsType, index, datasize, max_size);
   }
+  #if FEATURE_SETTINGS_WRITE_CACHE
+  if (SettingsBlockCacheClass::isCacheable(settingsType)) {
+    return Cache.settingsBlockCache.save(settingsType, index, memAddress, datasize, posInBlock);
+  }
+  #endif // if FEATURE_SETTINGS_WRITE_CACHE
   const String fname = SettingsType::getSettingsFileName(settingsType);
   if (!fileExists(fname)) {
     InitFile(settingsType);
@@ -1716,6 +1771,11 @@ String ClearInFile(SettingsType::Enum settingsType, int index) {
   if (!getAndLogSettingsParameters(read, settingsType, index, offset, max_size)) {
     return getSettingsFileIndexRangeError(read, settingsType, index);
   }
+  #if FEATURE_SETTINGS_WRITE_CACHE
+  if (SettingsBlockCacheClass::isCacheable(settingsType)) {
+    return Cache.settingsBlockCache.clear(settingsType, index);
+  }
+  #endif // if FEATURE_SETTINGS_WRITE_CACHE
   const String fname = SettingsType::getSettingsFileName(settingsType);
   return ClearInFile(fname.c_str(), offset, max_size);
 }
@@ -4,6 +4,7 @@
 #include "../CustomBuild/CompiletimeDefines.h"
 #include "../DataStructs/NodeStruct.h"
 #include "../DataStructs/TimingStats.h"
+#include "../DataStructs/UDP_CommandQueue.h"
 #include "../DataTypes/EventValueSource.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
 #include "../ESPEasyCore/ESPEasy_backgroundtasks.h"
@@ -38,6 +39,8 @@
 #include <IPAddress.h>
 #include <base64.h>
 #include <MD5Builder.h> // for getDigestAuth
+#include <memory>
+#include <new>
 
 #include <WiFiUdp.h>
 
@@ -184,16 +187,16 @@ void SendUDPCommand(uint8_t destUnit, const char *data, uint8_t dataLength)
 /*********************************************************************************************\
    Send UDP message to specific unit (unit 255=broadcast)
 \*********************************************************************************************/
-void sendUDP(uint8_t unit, const uint8_t *data, uint8_t size)
+bool sendUDP(uint8_t unit, const uint8_t *data, uint8_t size)
 {
   if (!NetworkConnected(10)) {
-    return;
+    return false;
   }
 
   IPAddress remoteNodeIP = getIPAddressForUnit(unit);
 
   if (remoteNodeIP[0] == 0) {
-    return;
+    return false;
   }
 
 # ifndef BUILD_NO_DEBUG
@@ -207,11 +210,15 @@ void sendUDP(uint8_t unit, const uint8_t *data, uint8_t size)
 
   statusLED(true);
   FeedSW_watchdog();
-  portUDP.beginPacket(remoteNodeIP, Settings.UDPPort);
-  portUDP.write(data, size);
-  portUDP.endPacket();
+  bool res = portUDP.beginPacket(remoteNodeIP, Settings.UDPPort) != 0;
+
+  if (res) {
+    portUDP.write(data, size);
+    res = portUDP.endPacket() != 0;
+  }
   FeedSW_watchdog();
   delay(0);
+  return res;
 }
 
 /*********************************************************************************************\
@@ -257,118 +264,129 @@ void updateUDPport()
    Check UDP messages (ESPEasy propiertary protocol)
 \*********************************************************************************************/
 boolean runningUPDCheck = false;
-void checkUDP()
-{
-  if (Settings.UDPPort == 0) {
-    return;
-  }
 
-  if (runningUPDCheck) {
-    return;
-  }
+// Single buffer for all received packets, instead of allocating one per packet.
+// Only used while runningUPDCheck is set.
+static char udpPacketBuffer[UDP_PACKETSIZE_MAX];
 
-  runningUPDCheck = true;
+static UDP_CommandQueue udpCommandQueue(UDP_COMMAND_QUEUE_MAX);
 
-  // UDP events
-  int packetSize = portUDP.parsePacket();
+static UDP_ReceiveStats udpReceiveStats;
 
-  if (packetSize > 0 /*&& portUDP.remotePort() == Settings.UDPPort*/)
-  {
-    statusLED(true);
+const UDP_ReceiveStats& getUDPReceiveStats()
+{
+  return udpReceiveStats;
+}
 
-    IPAddress remoteIP = portUDP.remoteIP();
+static void handleUDPPacket(int len, const IPAddress& remoteIP)
+{
+  if (static_cast<uint8_t>(udpPacketBuffer[0]) != 255)
+  {
+    udpPacketBuffer[len] = 0;
+    # ifndef BUILD_NO_DEBUG
+    addLog(LOG_LEVEL_DEBUG, &udpPacketBuffer[0]);
+    #endif
 
-    if (portUDP.remotePort() == 123)
-    {
-      // unexpected NTP reply, drop for now...
-      runningUPDCheck = false;
-      return;
+    // Execute from the main loop, to continue reading packets from the network stack
+    if (udpCommandQueue.add(&udpPacketBuffer[0])) {
+      ++udpReceiveStats.deferred;
+    } else {
+      ++udpReceiveStats.dropped;
+      addLog(LOG_LEVEL_ERROR, F("UDP  : Command queue full, command dropped"));
     }
+    return;
+  }
 
-    // UDP_PACKETSIZE_MAX should be as small as possible but still enough to hold all
-    // data for PLUGIN_UDP_IN or CPLUGIN_UDP_IN calls
-    // This node may also receive other UDP packets which may be quite large
-    // and then crash due to memory allocation failures
-    if ((packetSize >= 2) && (packetSize < UDP_PACKETSIZE_MAX)) {
-      // Allocate buffer to process packet.
-      std::vector<char> packetBuffer;
-      packetBuffer.resize(packetSize + 1);
-
-      if (packetBuffer.size() >= static_cast<size_t>(packetSize)) {
-        memset(&packetBuffer[0], 0, packetSize + 1);
-        int len = portUDP.read(&packetBuffer[0], packetSize);
-
-        if (len >= 2) {
-          if (static_cast<uint8_t>(packetBuffer[0]) != 255)
-          {
-            packetBuffer[len] = 0;
-            # ifndef BUILD_NO_DEBUG
-            addLog(LOG_LEVEL_DEBUG, &packetBuffer[0]);
-            #endif
-            ExecuteCommand_all(EventValueSource::Enum::VALUE_SOURCE_SYSTEM, &packetBuffer[0]);
-          }
-          else
-          {
-            // binary data!
-            switch (packetBuffer[1])
-            {
-              case 1: // sysinfo message
-              {
-                if (len < 13) {
-                  break;
-                }
-                int copy_length = sizeof(NodeStruct);
-                // Older versions sent 80 bytes, regardless of the size of NodeStruct
-                // Make sure the extra data received is ignored as it was also not initialized
-                if (len == 80) {
-                  copy_length = 56;
-                }
+  // binary data!
+  switch (udpPacketBuffer[1])
+  {
+    case 1: // sysinfo message
+    {
+      if (len < 13) {
+        ++udpReceiveStats.dropped;
+        break;
+      }
+      int copy_length = sizeof(NodeStruct);
+      // Older versions sent 80 bytes, regardless of the size of NodeStruct
+      // Make sure the extra data received is ignored as it was also not initialized
+      if (len == 80) {
+        copy_length = 56;
+      }
 
-                if (copy_length > (len - 2)) {
-                  copy_length = (len - 2);
-                }
-                NodeStruct received;
-                memcpy(&received, &packetBuffer[2], copy_length);
+      if (copy_length > (len - 2)) {
+        copy_length = (len - 2);
+      }
+      NodeStruct received;
+      memcpy(&received, &udpPacketBuffer[2], copy_length);
 
-                if (received.validate()) {
-                  {
-                    #ifdef USE_SECOND_HEAP
-                    HeapSelectIram ephemeral;
-                    #endif
+      if (received.validate()) {
+        {
+          #ifdef USE_SECOND_HEAP
+          HeapSelectIram ephemeral;
+          #endif
 
-                    Nodes.addNode(received); // Create a new element when not present
-                  }
+          Nodes.addNode(received); // Create a new element when not present
+        }
 
 # ifndef BUILD_NO_DEBUG
 
-                  if (loglevelActiveFor(LOG_LEVEL_DEBUG_MORE)) {
-                    addLogMove(LOG_LEVEL_DEBUG_MORE,  
-                      strformat(F("UDP  : %s,%s,%d"), 
-                        received.STA_MAC().toString().c_str(), 
-                        formatIP(received.IP()).c_str(), 
-                        received.unit));
-                  }
+        if (loglevelActiveFor(LOG_LEVEL_DEBUG_MORE)) {
+          addLogMove(LOG_LEVEL_DEBUG_MORE,  
+            strformat(F("UDP  : %s,%s,%d"), 
+              received.STA_MAC().toString().c_str(), 
+              formatIP(received.IP()).c_str(), 
+              received.unit));
+        }
 
 #endif // ifndef BUILD_NO_DEBUG
-                }
-                break;
-              }
-
-              default:
-              {
-                struct EventStruct TempEvent;
-                TempEvent.Data = reinterpret_cast<uint8_t *>(&packetBuffer[0]);
-                TempEvent.Par1 = remoteIP[3];
-                TempEvent.Par2 = len;
-                String dummy;
-                PluginCall(PLUGIN_UDP_IN, &TempEvent, dummy);
-                CPluginCall(CPlugin::Function::CPLUGIN_UDP_IN, &TempEvent);
-                break;
-              }
-            }
-          }
-        }
       }
+      break;
+    }
+
+    default:
+    {
+      struct EventStruct TempEvent;
+      TempEvent.Data = reinterpret_cast<uint8_t *>(&udpPacketBuffer[0]);
+      TempEvent.Par1 = remoteIP[3];
+      TempEvent.Par2 = len;
+      String dummy;
+      PluginCall(PLUGIN_UDP_IN, &TempEvent, dummy);
+      CPluginCall(CPlugin::Function::CPLUGIN_UDP_IN, &TempEvent);
+      break;
+    }
+  }
+}
+
+// Return false when no packet was received.
+static bool checkUDP_packet()
+{
+  const int packetSize = portUDP.parsePacket();
+
+  if (packetSize <= 0 /*|| portUDP.remotePort() != Settings.UDPPort*/) {
+    return false;
+  }
+  ++udpReceiveStats.received;
+  statusLED(true);
+
+  if (portUDP.remotePort() == 123)
+  {
+    // unexpected NTP reply, drop for now...
+    ++udpReceiveStats.dropped;
+  } else if (packetSize >= UDP_PACKETSIZE_MAX) {
+    // UDP_PACKETSIZE_MAX should be as small as possible but still enough to hold all
+    // data for PLUGIN_UDP_IN or CPLUGIN_UDP_IN calls
+    // This node may also receive other UDP packets which may be quite large
+    ++udpReceiveStats.oversize;
+  } else if (packetSize < 2) {
+    ++udpReceiveStats.dropped;
+  } else {
+    const IPAddress remoteIP = portUDP.remoteIP();
+    const int len            = portUDP.read(&udpPacketBuffer[0], packetSize);
+
+    if (len >= 2) {
+      handleUDPPacket(len, remoteIP);
+    } else {
+      ++udpReceiveStats.dropped;
     }
   }
 
@@ -377,9 +395,43 @@ void checkUDP()
     // Do not call portUDP.flush() as that's meant to sending the packet (on ESP8266)
     portUDP.read();
   }
+  return true;
+}
+
+void checkUDP()
+{
+  if (Settings.UDPPort == 0) {
+    return;
+  }
+
+  if (runningUPDCheck) {
+    return;
+  }
+
+  runningUPDCheck = true;
+
+  // Handle all packets waiting in the network stack, up to a limit,
+  // as they will be dropped when many nodes send a sysinfo message at the same time.
+  const unsigned long start = millis();
+
+  for (uint8_t i = 0; i < UDP_MAX_PACKETS_PER_CHECK; ++i) {
+    if (!checkUDP_packet() ||
+        (timePassedSince(start) >= UDP_MAX_CHECK_DURATION_MSEC)) {
+      break;
+    }
+  }
   runningUPDCheck = false;
 }
 
+void processUDPCommandQueue()
+{
+  String line;
+
+  if (udpCommandQueue.get(line)) {
+    ExecuteCommand_all(EventValueSource::Enum::VALUE_SOURCE_SYSTEM, line.c_str());
+  }
+}
+
 /*********************************************************************************************\
    Get formatted IP address for unit
    formatcodes: 0 = default toString(), 1 = empty string when invalid, 2 = 0 when invalid
@@ -1567,6 +1619,79 @@ int http_authenticate(const String& logIdentifier,
   return httpCode;
 }
 
+// Connection kept open between calls to send_via_http() when active.
+struct HTTP_KeepAlive_struct {
+  WiFiClient client;
+  HTTPClient http;
+};
+
+static std::unique_ptr<HTTP_KeepAlive_struct> http_keepAlive;
+
+void http_keepAlive_begin()
+{
+  if (!http_keepAlive) {
+    http_keepAlive.reset(new (std::nothrow) HTTP_KeepAlive_struct());
+
+    if (http_keepAlive) {
+      http_keepAlive->http.setReuse(true);
+    }
+  }
+}
+
+void http_keepAlive_end()
+{
+  if (http_keepAlive) {
+    http_keepAlive->http.setReuse(false);
+    http_keepAlive->http.end();
+    http_keepAlive->client.stop();
+    http_keepAlive.reset();
+  }
+}
+
+static String send_via_http(const String& logIdentifier,
+                            WiFiClient  & client,
+                            HTTPClient  & http,
+                            uint16_t      timeout,
+                            const String& user,
+                            const String& pass,
+                            const String& host,
+                            uint16_t      port,
+                            const String& uri,
+                            const String& HttpMethod,
+                            const String& header,
+                            const String& postStr,
+                            int         & httpCode,
+                            bool          must_check_reply) {
+  httpCode = http_authenticate(
+    logIdentifier,
+    client,
+    http,
+    timeout,
+    user,
+    pass,
+    host,
+    port,
+    uri,
+    HttpMethod,
+    header,
+    postStr,
+    must_check_reply);
+
+  String response;
+
+  if ((httpCode > 0) && must_check_reply) {
+    response = http.getString();
+#ifndef BUILD_NO_DEBUG
+    if (!response.isEmpty()) {
+      log_http_result(http, logIdentifier, host, HttpMethod, httpCode, response);
+    }
+#endif
+  }
+  // When reuse is set, http.end() will keep the connection open if the server allows it.
+  http.end();
+  return response;
+}
+
 String send_via_http(const String& logIdentifier,
                      uint16_t      timeout,
                      const String& user,
@@ -1579,11 +1704,35 @@ String send_via_http(const String& logIdentifier,
                      const String& postStr,
                      int         & httpCode,
                      bool          must_check_reply) {
+  if (http_keepAlive) {
+    String response = send_via_http(
+      logIdentifier,
+      http_keepAlive->client,
+      http_keepAlive->http,
+      timeout,
+      user,
+      pass,
+      host,
+      port,
+      uri,
+      HttpMethod,
+      header,
+      postStr,
+      httpCode,
+      must_check_reply);
+
+    if (httpCode <= 0) {
+      // Connection error, make sure to start over with a new connection.
+      http_keepAlive->client.stop();
+    }
+    return response;
+  }
+
   WiFiClient client;
   HTTPClient http;
   http.setReuse(false);
 
-  httpCode = http_authenticate(
+  String response = send_via_http(
     logIdentifier,
     client,
     http,
@@ -1596,19 +1745,9 @@ String send_via_http(const String& logIdentifier,
     HttpMethod,
     header,
     postStr,
+    httpCode,
     must_check_reply);
 
-  String response;
-
-  if ((httpCode > 0) && must_check_reply) {
-    response = http.getString();
-#ifndef BUILD_NO_DEBUG
-    if (!response.isEmpty()) {
-      log_http_result(http, logIdentifier, host, HttpMethod, httpCode, response);
-    }
-#endif
-  }
-  http.end();
   // http.end() does not call client.stop() if it is no longer connected.
   // However the client may still keep its internal state which may prevent 
   // future connections to the same host until there has been a connection to another host inbetween.
@@ -37,6 +37,20 @@ void updateUDPport();
 extern boolean runningUPDCheck;
 void checkUDP();
 
+/*********************************************************************************************\
+   Execute the next command received via UDP, called from the main loop
+\*********************************************************************************************/
+void processUDPCommandQueue();
+
+struct UDP_ReceiveStats {
+  uint32_t received = 0; // Packets received on the p2p UDP port
+  uint32_t dropped  = 0; // Packets not handled, like NTP replies, too short or command queue full
+  uint32_t oversize = 0; // Packets of UDP_PACKETSIZE_MAX bytes or more, not read
+  uint32_t deferred = 0; // Commands added to the queue to be executed from the main loop
+};
+
+const UDP_ReceiveStats& getUDPReceiveStats();
+
 /*********************************************************************************************\
    Send event using UDP message to specific unit
 \*********************************************************************************************/
@@ -55,8 +69,9 @@ IPAddress getIPAddressForUnit(uint8_t unit);
 
 /*********************************************************************************************\
    Send UDP message to specific unit (unit 255=broadcast)
+   Return false when the message could not be sent.
 \*********************************************************************************************/
-void sendUDP(uint8_t unit, const uint8_t *data, uint8_t size);
+bool sendUDP(uint8_t unit, const uint8_t *data, uint8_t size);
 
 /*********************************************************************************************\
    Refresh aging for remote units, drop if too old...
@@ -219,6 +234,12 @@ String send_via_http(const String& logIdentifier,
                      const String& postStr,
                      int         & httpCode,
                      bool          must_check_reply);
+
+// Keep the connection used by send_via_http() open, so subsequent calls to the same host
+// can reuse it. (e.g. when sending a batch of messages from a controller queue)
+// Call http_keepAlive_end() to close the connection.
+void http_keepAlive_begin();
+void http_keepAlive_end();
 #endif // FEATURE_HTTP_CLIENT
 
 #if FEATURE_DOWNLOAD
@@ -14,6 +14,7 @@
 #include "../ESPEasyCore/ESPEasyWifi.h"
 #include "../ESPEasyCore/ESPEasyRules.h"
 #include "../ESPEasyCore/Serial.h"
+#include "../Globals/Cache.h"
 #include "../Globals/ESPEasyWiFiEvent.h"
 #if FEATURE_ETHERNET
 #include "../Globals/ESPEasyEthEvent.h"
@@ -31,6 +32,7 @@
 #include "../Globals/Statistics.h"
 #include "../Globals/WiFi_AP_Candidates.h"
 #include "../Helpers/ESPEasyRTC.h"
+#include "../Helpers/ESPEasyStatistics.h"
 #include "../Helpers/FS_Helper.h"
 #include "../Helpers/Hardware.h"
 #include "../Helpers/Memory.h"
@@ -66,6 +68,9 @@ void run50TimesPerSecond() {
     STOP_TIMER(CPLUGIN_CALL_50PS);
   }
   processNextEvent();
+  #if FEATURE_ESPEASY_P2P
+  processUDPCommandQueue();
+  #endif // if FEATURE_ESPEASY_P2P
 }
 
 /*********************************************************************************************\
@@ -113,6 +118,9 @@ void runOncePerSecond()
 {
   START_TIMER;
   updateLogLevelCache();
+#if FEATURE_SETTINGS_WRITE_CACHE
+  Cache.settingsBlockCache.flushWhenIdle();
+#endif // if FEATURE_SETTINGS_WRITE_CACHE
   dailyResetCounter++;
   if (dailyResetCounter > 86400) // 1 day elapsed... //86400
   {
@@ -301,6 +309,9 @@ void processMQTTdelayQueue() {
     scheduleNextMQTTdelayQueue();
     return;
   }
+  #if FEATURE_CONTROLLER_QUEUE_SPILL
+  MQTTDelayHandler->restoreFromSpill();
+  #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
 
   START_TIMER;
   MQTT_queue_element *element(static_cast<MQTT_queue_element *>(MQTTDelayHandler->getNext()));
@@ -324,7 +335,9 @@ void processMQTTdelayQueue() {
     }
   } else
   if (!handled) {
-    if (MQTTclient.publish(element->_topic.c_str(), element->_payload.c_str(), element->_retained)) {
+    const bool published = MQTTsendQueueElement(*element);
+
+    if (published) {
       if (WiFiEventData.connectionFailures > 0) {
         --WiFiEventData.connectionFailures;
       }
@@ -417,7 +430,10 @@ void logTimerStatistics() {
 #endif
   updateLoopStats_30sec(loglevel);
 #ifndef BUILD_NO_DEBUG
-//  logStatistics(loglevel, true);
+  #if FEATURE_TIMING_STATS
+  // Stats are not cleared, so they remain available on the timing stats pages.
+  logStatistics(loglevel, false);
+  #endif // if FEATURE_TIMING_STATS
   if (loglevelActiveFor(loglevel)) {
     String queueLog = F("Scheduler stats: (called/tasks/max_length/idle%) ");
     queueLog += Scheduler.getQueueStats();
@@ -488,6 +504,9 @@ void flushAndDisconnectAllClients() {
 void prepareShutdown(IntendedRebootReason_e reason)
 {
   WiFiEventData.intent_to_reboot = true;
+#if FEATURE_SETTINGS_WRITE_CACHE
+  Cache.settingsBlockCache.flush();
+#endif // if FEATURE_SETTINGS_WRITE_CACHE
 #if FEATURE_MQTT
   runPeriodicalMQTT(); // Flush outstanding MQTT messages
 #endif // if FEATURE_MQTT
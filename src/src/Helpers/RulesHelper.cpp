@@ -270,11 +270,22 @@ bool RulesHelperClass::addChar(char c, String& line,   bool& firstNonSpaceRead)
   return false;
 }
 
-#ifdef CACHE_RULES_IN_MEMORY
 String RulesHelperClass::readLn(const String& filename,
                                 size_t      & pos,
                                 bool        & moreAvailable,
                                 bool          searchNextOnBlock)
+{
+  RulesLineInfo lineInfo;
+
+  return readLn(filename, pos, moreAvailable, searchNextOnBlock, lineInfo);
+}
+
+#ifdef CACHE_RULES_IN_MEMORY
+String RulesHelperClass::readLn(const String & filename,
+                                size_t       & pos,
+                                bool         & moreAvailable,
+                                bool           searchNextOnBlock,
+                                RulesLineInfo& lineInfo)
 {
   moreAvailable = false;
   auto it = _fileHandleMap.find(filename);
@@ -293,19 +304,18 @@ String RulesHelperClass::readLn(const String& filename,
 
       while (f.available()) {
         if (addChar(char(f.read()), tmpStr, firstNonSpaceRead)) {
-          lines.push_back(tmpStr);
+          lines.emplace_back(std::move(tmpStr));
           ++readPos;
 
           firstNonSpaceRead = false;
-          tmpStr.clear();
+          tmpStr = String();
         }
       }
 
       if (tmpStr.length() > 0) {
         rules_strip_trailing_comments(tmpStr);
         check_rules_line_user_errors(tmpStr);
-        lines.push_back(tmpStr);
-        tmpStr.clear();
+        lines.emplace_back(std::move(tmpStr));
       }
 # ifndef BUILD_NO_DEBUG
 
@@ -327,21 +337,26 @@ String RulesHelperClass::readLn(const String& filename,
       ++pos;
       moreAvailable = pos < it->second.size();
 
+      const CompiledRulesLine& compiled = it->second[pos - 1];
+
       if (!searchNextOnBlock ||
-          it->second[pos - 1].substring(0, 3).equalsIgnoreCase(F("on "))) {
-        return it->second[pos - 1];
+          (compiled.info.type == RulesLineType::On)) {
+        lineInfo = compiled.info;
+        return compiled.line;
       }
     }
   }
+  lineInfo = RulesLineInfo();
   return EMPTY_STRING;
 }
 
 #else // ifdef CACHE_RULES_IN_MEMORY
 
-String RulesHelperClass::readLn(const String& filename,
-                                size_t      & pos,
-                                bool        & moreAvailable,
-                                bool          searchNextOnBlock)
+String RulesHelperClass::readLn(const String & filename,
+                                size_t       & pos,
+                                bool         & moreAvailable,
+                                bool           searchNextOnBlock,
+                                RulesLineInfo& lineInfo)
 {
   std::vector<uint8_t> buf;
 
@@ -377,10 +392,11 @@ String RulesHelperClass::readLn(const String& filename,
         pos = startPos + x;
 
         if (!searchNextOnBlock ||
-            line.substring(0, 3).equalsIgnoreCase(F("on ")))
+            (RulesLineInfo::getLineType(line) == RulesLineType::On))
         {
           done = true;
 
+          lineInfo = RulesLineInfo(line);
           return line;
         } else {
           // Not starting with "on " which we need, so continue to search for a matching line
@@ -391,6 +407,7 @@ String RulesHelperClass::readLn(const String& filename,
   }
   rules_strip_trailing_comments(line);
   check_rules_line_user_errors(line);
+  lineInfo = RulesLineInfo(line);
   return line;
 }
 
@@ -4,6 +4,7 @@
 #include "../../ESPEasy_common.h"
 
 #include "../DataStructs/RulesEventCache.h"
+#include "../DataStructs/RulesLineInfo.h"
 
 #include <FS.h>
 #include <map>
@@ -61,12 +62,29 @@ public:
                 bool        & moreAvailable,
                 bool          searchNextOnBlock);
 
+  // Same as readLn, but also return the pre-parsed line info.
+  // When rules are cached in memory, this info is only computed once
+  // when the rules file is read.
+  String readLn(const String & filename,
+                size_t       & pos,
+                bool         & moreAvailable,
+                bool           searchNextOnBlock,
+                RulesLineInfo& lineInfo);
+
 private:
 
 #ifdef CACHE_RULES_IN_MEMORY
 
   // Cache the entire rules file contents in memory
-  typedef std::vector<String>         RulesLines;
+  // along with the pre-parsed line info.
+  struct CompiledRulesLine {
+    CompiledRulesLine(String&& rulesLine) : line(std::move(rulesLine)), info(line) {}
+
+    String        line;
+    RulesLineInfo info;
+  };
+
+  typedef std::vector<CompiledRulesLine> RulesLines;
   typedef std::map<String, RulesLines>FileHandleMap;
 #else // ifdef CACHE_RULES_IN_MEMORY
 
@@ -1,5 +1,6 @@
 #include "../Helpers/Rules_calculate.h"
 
+#include "../DataStructs/CompiledExpression.h"
 #include "../DataStructs/TimingStats.h"
 #include "../ESPEasyCore/ESPEasy_Log.h"
 #include "../Globals/RamTracker.h"
@@ -37,6 +38,14 @@ bool RulesCalculate_t::is_operator(char c)
   return c == '+' || c == '-' || c == '*' || c == '/' || c == '^' || c == '%';
 }
 
+bool RulesCalculate_t::is_variable(char c)
+{
+  const uint8_t uc = static_cast<uint8_t>(c);
+
+  return uc >= RULES_CALCULATE_FIRST_VARIABLE &&
+         uc < (RULES_CALCULATE_FIRST_VARIABLE + RULES_CALCULATE_NR_VARIABLES);
+}
+
 bool RulesCalculate_t::is_unary_operator(char c)
 {
   const UnaryOperator op = static_cast<UnaryOperator>(c);
@@ -278,6 +287,10 @@ CalculateReturnCode RulesCalculate_t::RPNCalculate(char *token)
     return ret; // Don't bother for an empty string
   }
 
+  if (_program != nullptr) {
+    return _program->addToken(token);
+  }
+
   if (is_operator(token[0]) && (token[1] == 0))
   {
     ESPEASY_RULES_FLOAT_TYPE second = pop();
@@ -357,10 +370,38 @@ unsigned int RulesCalculate_t::op_arg_count(const char c)
 
 CalculateReturnCode RulesCalculate_t::doCalculate(const char *input, ESPEASY_RULES_FLOAT_TYPE *result)
 {
-
   #ifndef BUILD_NO_RAM_TRACKER
   checkRAM(F("Calculate"));
   #endif // ifndef BUILD_NO_RAM_TRACKER
+
+  // *sp=0; // bug, it stops calculating after 50 times
+  sp = globalstack - 1;
+
+  const CalculateReturnCode error = processInput(input);
+
+  if (isError(error))
+  {
+    *result = 0;
+    return error;
+  }
+  *result = *sp;
+  #ifndef BUILD_NO_RAM_TRACKER
+  checkRAM(F("Calculate2"));
+  #endif // ifndef BUILD_NO_RAM_TRACKER
+  return CalculateReturnCode::OK;
+}
+
+CalculateReturnCode RulesCalculate_t::doCompile(const char *input, CompiledExpression& program)
+{
+  _program = &program;
+  const CalculateReturnCode error = processInput(input);
+
+  _program = nullptr;
+  return error;
+}
+
+CalculateReturnCode RulesCalculate_t::processInput(const char *input)
+{
   const char *strpos = input, *strend = input + strlen(input);
   char token[TOKEN_LENGTH];
   char c, oc, *TokenPos = token;
@@ -369,8 +410,6 @@ CalculateReturnCode RulesCalculate_t::doCalculate(const char *input, ESPEASY_RUL
   char sc;                         // used for record stack element
   CalculateReturnCode error = CalculateReturnCode::OK;
 
-  // *sp=0; // bug, it stops calculating after 50 times
-  sp = globalstack - 1;
   oc = c = 0;
 
   if (input[0] == '=') {
@@ -398,6 +437,13 @@ CalculateReturnCode RulesCalculate_t::doCalculate(const char *input, ESPEASY_RUL
         ++TokenPos;
       }
 
+      // A variable placeholder is only allowed when compiling, it is an operand just like a number.
+      else if ((_program != nullptr) && is_variable(c))
+      {
+        *TokenPos = c;
+        ++TokenPos;
+      }
+
       // If the token is an operator, op1, then:
       else if (is_operator(c) || is_unary_operator(c))
       {
@@ -524,19 +570,7 @@ CalculateReturnCode RulesCalculate_t::doCalculate(const char *input, ESPEASY_RUL
   }
 
   *(TokenPos) = 0; // Mark end of token string
-  error       = RPNCalculate(token);
-  TokenPos    = token;
-
-  if (isError(error))
-  {
-    *result = 0;
-    return error;
-  }
-  *result = *sp;
-  #ifndef BUILD_NO_RAM_TRACKER
-  checkRAM(F("Calculate2"));
-  #endif // ifndef BUILD_NO_RAM_TRACKER
-  return CalculateReturnCode::OK;
+  return RPNCalculate(token);
 }
 
 void preProcessReplace(String& input, UnaryOperator op) {
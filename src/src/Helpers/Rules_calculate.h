@@ -13,6 +13,12 @@
 #define TOKEN_LENGTH 25
 #define OPERATOR_STACK_SIZE 32
 
+// Single character placeholders for variables in a compiled expression.
+// Chosen well above the range used by UnaryOperator.
+// See CompiledExpression
+#define RULES_CALCULATE_FIRST_VARIABLE 0xF0u
+#define RULES_CALCULATE_NR_VARIABLES   8
+
 enum class CalculateReturnCode : uint8_t{
   OK                           = 0u,
   ERROR_STACK_OVERFLOW         = 1u,
@@ -57,6 +63,8 @@ void   preProcessReplace(String      & input,
 bool   angleDegree(UnaryOperator op);
 const __FlashStringHelper* toString(UnaryOperator op);
 
+class CompiledExpression;
+
 class RulesCalculate_t {
 private:
 
@@ -70,21 +78,10 @@ private:
   bool                is_number(char oc,
                                 char c);
 
-  bool                is_operator(char c);
-
-  bool                is_unary_operator(char c);
-
   CalculateReturnCode push(ESPEASY_RULES_FLOAT_TYPE value);
 
   ESPEASY_RULES_FLOAT_TYPE              pop();
 
-  ESPEASY_RULES_FLOAT_TYPE              apply_operator(char   op,
-                                     ESPEASY_RULES_FLOAT_TYPE first,
-                                     ESPEASY_RULES_FLOAT_TYPE second);
-
-  ESPEASY_RULES_FLOAT_TYPE apply_unary_operator(char   op,
-                              ESPEASY_RULES_FLOAT_TYPE first);
-
   //  char              * next_token(char *linep);
 
   CalculateReturnCode RPNCalculate(char *token);
@@ -100,13 +97,38 @@ private:
 
   unsigned int op_arg_count(const char c);
 
+  // Convert the infix expression to RPN and process each RPN token.
+  CalculateReturnCode processInput(const char *input);
+
+  // When set, RPN tokens are added to this program instead of being evaluated.
+  CompiledExpression *_program = nullptr;
+
 public:
 
   RulesCalculate_t();
 
+  static bool is_operator(char c);
+
+  static bool is_unary_operator(char c);
+
+  // Placeholder of a variable in a compiled expression
+  static bool is_variable(char c);
+
+  static ESPEASY_RULES_FLOAT_TYPE apply_operator(char                     op,
+                                                 ESPEASY_RULES_FLOAT_TYPE first,
+                                                 ESPEASY_RULES_FLOAT_TYPE second);
+
+  static ESPEASY_RULES_FLOAT_TYPE apply_unary_operator(char                     op,
+                                                       ESPEASY_RULES_FLOAT_TYPE first);
+
   CalculateReturnCode doCalculate(const char *input,
                                   ESPEASY_RULES_FLOAT_TYPE     *result);
 
+  // Store the RPN program of the (preprocessed) input in program, without evaluating it.
+  // Variable placeholders are accepted as operands.
+  CalculateReturnCode doCompile(const char         *input,
+                                CompiledExpression& program);
+
   // Try to replace multi byte operators with single character ones.
   // For example log, sin, cos, tan.
   static String preProces(const String& input);
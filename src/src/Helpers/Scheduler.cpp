@@ -8,6 +8,7 @@
 
 #include "../ESPEasyCore/ESPEasyRules.h"
 
+#include "../Globals/MetricsRegistry.h"
 #include "../Globals/RTC.h"
 
 #include "../Helpers/ESPEasyRTC.h"
@@ -63,6 +64,19 @@ void ESPEasy_Scheduler::handle_schedule() {
 
   const SchedulerTimerID timerID(mixed_id);
 
+#if FEATURE_METRICS_REGISTRY
+
+  if (schedulerLagMetric == INVALID_METRIC_INDEX) {
+    // Register on first use, the registry may not yet be constructed when this object is.
+    schedulerLagMetric = Metrics.addHistogram(
+      F("scheduler_lag_ms"),
+      F("Delay in msec between the scheduled time and actual start of a scheduled job"),
+      0);
+  }
+  const long lag = timePassedSince(timer);
+  Metrics.observe(schedulerLagMetric, lag > 0 ? lag : 0);
+#endif // if FEATURE_METRICS_REGISTRY
+
   delay(0); // See: https://github.com/letscontrolit/ESPEasy/issues/1818#issuecomment-425351328
 
   switch (timerID.getTimerType()) {
@@ -4,6 +4,7 @@
 #include "../../ESPEasy_common.h"
 
 #include "../DataStructs/EventStructCommandWrapper.h"
+#include "../DataStructs/MetricsRegistry.h"
 #include "../DataStructs/SchedulerTimerID.h"
 #include "../DataStructs/SystemTimerStruct.h"
 
@@ -308,6 +309,12 @@ private:
 
   unsigned long last_system_event_run         = 0;
   unsigned long timer_gratuitous_arp_interval = 5000;
+
+#if FEATURE_METRICS_REGISTRY
+
+  // Time in msec a scheduled job was started after its scheduled time.
+  metricIndex_t schedulerLagMetric = INVALID_METRIC_INDEX;
+#endif // if FEATURE_METRICS_REGISTRY
 };
 
 #endif // HELPERS_SCHEDULER_H
@@ -0,0 +1,393 @@
+#include "../Helpers/SettingsBlockCache.h"
+
+#if FEATURE_SETTINGS_WRITE_CACHE
+
+# include "../DataStructs/TimingStats.h"
+# include "../ESPEasyCore/ESPEasy_Log.h"
+# include "../Globals/Cache.h"
+# include "../Helpers/ESPEasy_Storage.h"
+# include "../Helpers/ESPEasy_time_calc.h"
+# include "../Helpers/StringConverter.h"
+
+# include <algorithm>
+
+
+bool SettingsBlockCacheClass::isCacheable(SettingsType::Enum settingsType)
+{
+  switch (settingsType) {
+    case SettingsType::Enum::TaskSettings_Type:
+    case SettingsType::Enum::CustomTaskSettings_Type:
+    case SettingsType::Enum::ControllerSettings_Type:
+    case SettingsType::Enum::CustomControllerSettings_Type:
+    case SettingsType::Enum::NotificationSettings_Type:
+      return true;
+    case SettingsType::Enum::BasicSettings_Type:
+    case SettingsType::Enum::SecuritySettings_Type:
+    case SettingsType::Enum::ExtdControllerCredentials_Type:
+    case SettingsType::Enum::SettingsType_MAX:
+      break;
+  }
+  return false;
+}
+
+String SettingsBlockCacheClass::load(
+  SettingsType::Enum settingsType,
+  int                index,
+  uint8_t           *memAddress,
+  int                datasize,
+  int                offset_in_block)
+{
+  Block *block = findBlock(settingsType, index);
+
+  if (block != nullptr) {
+    memcpy(memAddress, &(block->data[offset_in_block]), datasize);
+    block->lastUsed = millis();
+    return EMPTY_STRING;
+  }
+
+  // Not cached, blocks do not overlap so there is no need to flush first.
+  int offset, max_size;
+
+  SettingsType::getSettingsParameters(settingsType, index, offset, max_size);
+  const String fname = SettingsType::getSettingsFileName(settingsType);
+
+  _accessingFile = true;
+  const String result = LoadFromFile(fname.c_str(), offset + offset_in_block, memAddress, datasize);
+  _accessingFile = false;
+  return result;
+}
+
+String SettingsBlockCacheClass::save(
+  SettingsType::Enum settingsType,
+  int                index,
+  const uint8_t     *memAddress,
+  int                datasize,
+  int                posInBlock)
+{
+  Block *block = findBlock(settingsType, index);
+
+  if (block == nullptr) {
+    int offset, max_size;
+    SettingsType::getSettingsParameters(settingsType, index, offset, max_size);
+
+    // No need to read the block when it will be overwritten completely.
+    const bool readFile = (posInBlock != 0) || (datasize < max_size);
+    block = addBlock(settingsType, index, readFile);
+
+    if (block == nullptr) {
+      // Not enough memory, write directly to file
+      const String fname = SettingsType::getSettingsFileName(settingsType);
+
+      _accessingFile = true;
+
+      if (!fileExists(fname)) {
+        InitFile(settingsType);
+      }
+      const String result = SaveToFile(fname.c_str(), offset + posInBlock, memAddress, datasize);
+      _accessingFile = false;
+      return result;
+    }
+  }
+  memcpy(&(block->data[posInBlock]), memAddress, datasize);
+  block->markDirty(posInBlock, posInBlock + datasize);
+  _lastWrite      = millis();
+  block->lastUsed = _lastWrite;
+  return EMPTY_STRING;
+}
+
+String SettingsBlockCacheClass::clear(SettingsType::Enum settingsType, int index)
+{
+  Block *block = findBlock(settingsType, index);
+
+  if (block == nullptr) {
+    // New blocks are zero filled.
+    block = addBlock(settingsType, index, false);
+
+    if (block == nullptr) {
+      int offset, max_size;
+      SettingsType::getSettingsParameters(settingsType, index, offset, max_size);
+      const String fname = SettingsType::getSettingsFileName(settingsType);
+
+      _accessingFile = true;
+      const String result = ClearInFile(fname.c_str(), offset, max_size);
+      _accessingFile = false;
+      return result;
+    }
+  } else {
+    std::fill(block->data.begin(), block->data.end(), 0);
+  }
+  block->markDirty(0, block->data.size());
+  _lastWrite      = millis();
+  block->lastUsed = _lastWrite;
+  return EMPTY_STRING;
+}
+
+String SettingsBlockCacheClass::flush()
+{
+  if (!isDirty()) {
+    return EMPTY_STRING;
+  }
+  String result = flush(SettingsType::SettingsFileEnum::FILE_CONFIG_type);
+
+  result += flush(SettingsType::SettingsFileEnum::FILE_NOTIFICATION_type);
+  return result;
+}
+
+void SettingsBlockCacheClass::flushWhenIdle()
+{
+  if (_blocks.empty() || (timePassedSince(_lastWrite) < SETTINGS_WRITE_CACHE_FLUSH_DELAY)) {
+    return;
+  }
+
+  if ((_flushRetryDelay != 0) && (timePassedSince(_lastFailedFlush) < static_cast<long>(_flushRetryDelay))) {
+    return;
+  }
+
+  if (!flush().isEmpty()) {
+    // Keep the dirty blocks, as the caller was already told the settings were saved.
+    _lastFailedFlush = millis();
+    _flushRetryDelay = (_flushRetryDelay == 0) ? SETTINGS_WRITE_CACHE_FLUSH_DELAY : 2 * _flushRetryDelay;
+
+    if (_flushRetryDelay > SETTINGS_WRITE_CACHE_MAX_RETRY_DELAY) {
+      _flushRetryDelay = SETTINGS_WRITE_CACHE_MAX_RETRY_DELAY;
+    }
+
+    if (loglevelActiveFor(LOG_LEVEL_ERROR)) {
+      addLogMove(LOG_LEVEL_ERROR, concat(F("FILE : Could not write cached settings, retry in msec: "), _flushRetryDelay));
+    }
+    discardClean();
+    return;
+  }
+  _flushRetryDelay = 0;
+
+  // Swap with an empty vector to actually free the memory.
+  std::vector<Block>().swap(_blocks);
+}
+
+void SettingsBlockCacheClass::beforeFileAccess(const String& fname, bool readOnly, bool keepChanges)
+{
+  if (_blocks.empty() || _accessingFile) {
+    return;
+  }
+  const SettingsType::SettingsFileEnum file_types[] = {
+    SettingsType::SettingsFileEnum::FILE_CONFIG_type,
+    SettingsType::SettingsFileEnum::FILE_NOTIFICATION_type
+  };
+
+  for (size_t i = 0; i < (sizeof(file_types) / sizeof(file_types[0])); ++i) {
+    const String settingsFile(SettingsType::getSettingsFileName(file_types[i]));
+
+    if (patch_fname(settingsFile).equalsIgnoreCase(patch_fname(fname))) {
+      if (keepChanges) {
+        flush(file_types[i]);
+      }
+
+      if (!readOnly) {
+        // File may be changed, so the cached content is no longer valid.
+        discard(file_types[i]);
+      }
+    }
+  }
+}
+
+bool SettingsBlockCacheClass::isDirty() const
+{
+  for (auto it = _blocks.begin(); it != _blocks.end(); ++it) {
+    if (it->isDirty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SettingsBlockCacheClass::Block::markDirty(int start, int end)
+{
+  if (!isDirty() || (start < dirtyStart)) {
+    dirtyStart = start;
+  }
+
+  if (end > dirtyEnd) {
+    dirtyEnd = end;
+  }
+}
+
+SettingsBlockCacheClass::Block * SettingsBlockCacheClass::findBlock(SettingsType::Enum settingsType, int index)
+{
+  for (auto it = _blocks.begin(); it != _blocks.end(); ++it) {
+    if ((it->settingsType == settingsType) && (it->index == index)) {
+      return &(*it);
+    }
+  }
+  return nullptr;
+}
+
+SettingsBlockCacheClass::Block * SettingsBlockCacheClass::addBlock(SettingsType::Enum settingsType, int index, bool readFile)
+{
+  if (_blocks.size() >= SETTINGS_WRITE_CACHE_NR_BLOCKS) {
+    // Write all dirty blocks at once, so the least recently used one can be removed.
+    flush();
+
+    auto lru = _blocks.end();
+
+    for (auto it = _blocks.begin(); it != _blocks.end(); ++it) {
+      if (!it->isDirty() && ((lru == _blocks.end()) || (timeDiff(it->lastUsed, lru->lastUsed) > 0))) {
+        lru = it;
+      }
+    }
+
+    if (lru == _blocks.end()) {
+      // Flush failed
+      return nullptr;
+    }
+    _blocks.erase(lru);
+  }
+
+  int offset, max_size;
+
+  SettingsType::getSettingsParameters(settingsType, index, offset, max_size);
+
+  Block block;
+  {
+    # ifdef USE_SECOND_HEAP
+
+    // Allow to store the blocks in 2nd heap if present.
+    HeapSelectIram ephemeral;
+    # endif // ifdef USE_SECOND_HEAP
+
+    block.data.resize(max_size);
+  }
+
+  if (block.data.size() != static_cast<size_t>(max_size)) {
+    return nullptr;
+  }
+  block.fileOffset   = offset;
+  block.settingsType = settingsType;
+  block.index        = index;
+
+  if (readFile) {
+    const String fname = SettingsType::getSettingsFileName(settingsType);
+
+    _accessingFile = true;
+    const bool loaded = !fileExists(fname) ||
+                        LoadFromFile(fname.c_str(), offset, &(block.data[0]), max_size).isEmpty();
+    _accessingFile = false;
+
+    if (!loaded) {
+      return nullptr;
+    }
+  }
+  _blocks.push_back(std::move(block));
+  return &(_blocks.back());
+}
+
+String SettingsBlockCacheClass::flush(SettingsType::SettingsFileEnum file_type)
+{
+  std::vector<Block *> dirtyBlocks;
+
+  for (auto it = _blocks.begin(); it != _blocks.end(); ++it) {
+    if (it->isDirty() && (SettingsType::getSettingsFile(it->settingsType) == file_type)) {
+      dirtyBlocks.push_back(&(*it));
+    }
+  }
+
+  if (dirtyBlocks.empty()) {
+    return EMPTY_STRING;
+  }
+
+  // Write in file order, to keep seeking to a minimum.
+  std::sort(dirtyBlocks.begin(), dirtyBlocks.end(),
+            [](const Block *a, const Block *b) {
+    return a->fileOffset < b->fileOffset;
+  });
+
+  // All blocks are written in a single file open, so only count as a single flash write.
+  String result = flashGuard();
+
+  if (!result.isEmpty()) {
+    return result;
+  }
+  START_TIMER;
+  const String fname(SettingsType::getSettingsFileName(file_type));
+
+  _accessingFile = true;
+
+  if (!fileExists(fname)) {
+    InitFile(file_type);
+  }
+  fs::File f = tryOpenFile(fname, F("r+"));
+
+  if (f) {
+    clearAllButTaskCaches();
+    size_t nrBytes = 0;
+
+    for (auto it = dirtyBlocks.begin(); it != dirtyBlocks.end(); ++it) {
+      Block *block      = *it;
+      const size_t size = block->dirtyEnd - block->dirtyStart;
+
+      if (f.seek(block->fileOffset + block->dirtyStart, fs::SeekSet) &&
+          (f.write(&(block->data[block->dirtyStart]), size) == size)) {
+        block->dirtyStart = 0;
+        block->dirtyEnd   = 0;
+        nrBytes          += size;
+      } else {
+        # ifndef BUILD_NO_DEBUG
+        result = concat(F("SaveToFile: "), fname) + F(" ERROR, Cannot write to file");
+        # else // ifndef BUILD_NO_DEBUG
+        result = F("Save error");
+        # endif // ifndef BUILD_NO_DEBUG
+      }
+      delay(0);
+    }
+    f.close();
+    # ifndef BUILD_NO_DEBUG
+
+    if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+      String log;
+      log += F("FILE : Saved ");
+      log += fname;
+      log += F(" blocks: ");
+      log += dirtyBlocks.size();
+      log += F(" size: ");
+      log += nrBytes;
+      addLogMove(LOG_LEVEL_INFO, log);
+    }
+    # endif // ifndef BUILD_NO_DEBUG
+  } else {
+    # ifndef BUILD_NO_DEBUG
+    result = concat(F("SaveToFile: "), fname) + F(" ERROR, Cannot save to file");
+    # else // ifndef BUILD_NO_DEBUG
+    result = F("Save error");
+    # endif // ifndef BUILD_NO_DEBUG
+  }
+  _accessingFile = false;
+
+  if (!result.isEmpty()) {
+    addLog(LOG_LEVEL_ERROR, result);
+  }
+  STOP_TIMER(SAVEFILE_STATS);
+  return result;
+}
+
+void SettingsBlockCacheClass::discardClean()
+{
+  for (auto it = _blocks.begin(); it != _blocks.end();) {
+    if (!it->isDirty()) {
+      it = _blocks.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void SettingsBlockCacheClass::discard(SettingsType::SettingsFileEnum file_type)
+{
+  for (auto it = _blocks.begin(); it != _blocks.end();) {
+    if (SettingsType::getSettingsFile(it->settingsType) == file_type) {
+      it = _blocks.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+#endif // if FEATURE_SETTINGS_WRITE_CACHE
@@ -0,0 +1,138 @@
+#ifndef HELPERS_SETTINGSBLOCKCACHE_H
+#define HELPERS_SETTINGSBLOCKCACHE_H
+
+#include "../../ESPEasy_common.h"
+
+#if FEATURE_SETTINGS_WRITE_CACHE
+
+# include "../DataTypes/SettingsType.h"
+
+# include <vector>
+
+// Max. nr of settings blocks kept in memory.
+# ifndef SETTINGS_WRITE_CACHE_NR_BLOCKS
+#  if defined(ESP32)
+#   define SETTINGS_WRITE_CACHE_NR_BLOCKS  8
+#  elif defined(USE_SECOND_HEAP)
+#   define SETTINGS_WRITE_CACHE_NR_BLOCKS  4
+#  else // if defined(ESP32)
+#   define SETTINGS_WRITE_CACHE_NR_BLOCKS  2
+#  endif // if defined(ESP32)
+# endif // ifndef SETTINGS_WRITE_CACHE_NR_BLOCKS
+
+// Time in msec without writes before the cache is flushed from the main loop.
+# ifndef SETTINGS_WRITE_CACHE_FLUSH_DELAY
+#  define SETTINGS_WRITE_CACHE_FLUSH_DELAY  2000
+# endif // ifndef SETTINGS_WRITE_CACHE_FLUSH_DELAY
+
+// Max. time in msec between retries when flushing the cache failed.
+# ifndef SETTINGS_WRITE_CACHE_MAX_RETRY_DELAY
+#  define SETTINGS_WRITE_CACHE_MAX_RETRY_DELAY  60000
+# endif // ifndef SETTINGS_WRITE_CACHE_MAX_RETRY_DELAY
+
+
+// Write-back cache for the settings blocks stored in the settings files.
+// Writes to a block are kept in memory and marked dirty.
+// Dirty blocks are written in a single file open per settings file, sorted by offset.
+// Thus a sweep over all tasks does not result in a flash write per saved block.
+//
+// The cache is flushed:
+// - When SaveSettings() is called
+// - When no writes were made for SETTINGS_WRITE_CACHE_FLUSH_DELAY msec
+// - Before reboot or deep sleep
+// - Before a settings file is opened by something else, e.g. when downloading a backup
+//
+// When flushing fails, e.g. as the daily flash write limit is reached, the dirty blocks are kept
+// and flushing is retried with an increasing delay.
+//
+// Basic settings and security settings are never cached.
+class SettingsBlockCacheClass {
+public:
+
+  static bool isCacheable(SettingsType::Enum settingsType);
+
+  // Only call with cacheable settings types and validated parameters.
+  String load(SettingsType::Enum settingsType,
+              int                index,
+              uint8_t           *memAddress,
+              int                datasize,
+              int                offset_in_block);
+
+  String save(SettingsType::Enum settingsType,
+              int                index,
+              const uint8_t     *memAddress,
+              int                datasize,
+              int                posInBlock);
+
+  String clear(SettingsType::Enum settingsType,
+               int                index);
+
+  // Write all dirty blocks.
+  String flush();
+
+  // Flush and free the memory when no writes were made for a while.
+  // Dirty blocks are kept when the flush failed.
+  void   flushWhenIdle();
+
+  // Must be called before a file is opened, renamed or deleted outside this cache.
+  // Dirty blocks of the file are written when keepChanges is set.
+  // Cached blocks of the file are removed when the file may be changed.
+  void   beforeFileAccess(const String& fname,
+                          bool          readOnly,
+                          bool          keepChanges = true);
+
+  bool   isDirty() const;
+
+private:
+
+  struct Block {
+    std::vector<uint8_t> data;
+    int                  fileOffset = 0;
+    unsigned long        lastUsed   = 0;
+
+    // Range in the block which has to be written, dirtyEnd == 0 when clean.
+    uint16_t             dirtyStart   = 0;
+    uint16_t             dirtyEnd     = 0;
+    SettingsType::Enum   settingsType = SettingsType::Enum::SettingsType_MAX;
+    int                  index        = 0;
+
+    bool                 isDirty() const {
+      return dirtyEnd != 0;
+    }
+
+    void                 markDirty(int start,
+                                   int end);
+  };
+
+  // Returns nullptr when the block is not cached.
+  Block* findBlock(SettingsType::Enum settingsType,
+                   int                index);
+
+  // Add a block to the cache, reading its current content from file when readFile is set.
+  // Returns nullptr when no memory could be allocated.
+  Block* addBlock(SettingsType::Enum settingsType,
+                  int                index,
+                  bool               readFile);
+
+  String flush(SettingsType::SettingsFileEnum file_type);
+
+  // Remove the blocks of the given file, without writing them.
+  void   discard(SettingsType::SettingsFileEnum file_type);
+
+  // Remove the blocks which are not dirty.
+  void   discardClean();
+
+  std::vector<Block> _blocks;
+  unsigned long      _lastWrite = 0;
+
+  // Time of the last failed flush by flushWhenIdle and the delay before retrying, 0 when not failed.
+  unsigned long _lastFailedFlush = 0;
+  uint32_t      _flushRetryDelay = 0;
+
+  // Set while the cache itself accesses the settings files.
+  bool _accessingFile = false;
+};
+
+#endif // if FEATURE_SETTINGS_WRITE_CACHE
+
+#endif // ifndef HELPERS_SETTINGSBLOCKCACHE_H
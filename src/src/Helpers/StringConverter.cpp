@@ -3,6 +3,7 @@
 
 #include "../../_Plugin_Helper.h"
 
+#include "../DataStructs/CompiledTemplate.h"
 #include "../DataStructs/ESPEasy_EventStruct.h"
 #include "../DataStructs/TimingStats.h"
 
@@ -355,6 +356,17 @@ void replaceUnicodeByChar(String& line, char replChar) {
 /*********************************************************************************************\
    Format a value to the set number of decimals
 \*********************************************************************************************/
+bool pluginFormatUserVar(struct EventStruct *event, uint8_t rel_index, String& result)
+{
+  if (event == nullptr) { return false; }
+  EventStruct tempEvent;
+
+  tempEvent.deep_copy(event);
+  tempEvent.idx = rel_index;
+  PluginCall(PLUGIN_FORMAT_USERVAR, &tempEvent, result);
+  return result.length() > 0;
+}
+
 String doFormatUserVar(struct EventStruct *event, uint8_t rel_index, bool mustCheck, bool& isvalid) {
   if (event == nullptr) return EMPTY_STRING;
   START_TIMER;
@@ -370,11 +382,7 @@ String doFormatUserVar(struct EventStruct *event, uint8_t rel_index, bool mustCh
   {
     // First try to format using the plugin specific formatting.
     String result;
-    EventStruct tempEvent;
-    tempEvent.deep_copy(event);
-    tempEvent.idx = rel_index;
-    PluginCall(PLUGIN_FORMAT_USERVAR, &tempEvent, result);
-    if (result.length() > 0) {
+    if (pluginFormatUserVar(event, rel_index, result)) {
       return result;
     }
   }
@@ -459,6 +467,26 @@ String formatUserVar(struct EventStruct *event, uint8_t rel_index, bool& isvalid
   return doFormatUserVar(event, rel_index, true, isvalid);
 }
 
+String formatTaskValue(taskIndex_t              TaskIndex,
+                       uint8_t                  rel_index,
+                       Sensor_VType             sensorType,
+                       const TaskValues_Data_t& values)
+{
+  const deviceIndex_t DeviceIndex = getDeviceIndex_from_TaskIndex(TaskIndex);
+
+  if (!validDeviceIndex(DeviceIndex) ||
+      (getValueCountForTask(TaskIndex) <= rel_index)) {
+    return EMPTY_STRING;
+  }
+
+  uint8_t nrDecimals = 0;
+
+  if (Device[DeviceIndex].configurableDecimals()) {
+    nrDecimals = Cache.getTaskDeviceValueDecimals(TaskIndex, rel_index);
+  }
+  return values.getAsString(rel_index, sensorType, nrDecimals);
+}
+
 String get_formatted_Controller_number(cpluginID_t cpluginID) {
   if (!validCPluginID(cpluginID)) {
     return F("C---");
@@ -1177,8 +1205,39 @@ void parseSpecialCharacters(String& s, bool useURLencode)
 /********************************************************************************************\
    replace other system variables like %sysname%, %systime%, %ip%
  \*********************************************************************************************/
+
+// Controller topics and payloads are mostly the same few templates from the controller settings.
+// So keep the most recently used ones compiled.
+#ifndef CONTROLLER_TEMPLATE_CACHE_SIZE
+# ifdef ESP8266
+#  define CONTROLLER_TEMPLATE_CACHE_SIZE 4
+# else // ifdef ESP8266
+#  define CONTROLLER_TEMPLATE_CACHE_SIZE 8
+# endif // ifdef ESP8266
+#endif // ifndef CONTROLLER_TEMPLATE_CACHE_SIZE
+
+static CompiledTemplate& getCompiledControllerTemplate(const String& templateString) {
+  static CompiledTemplate templates[CONTROLLER_TEMPLATE_CACHE_SIZE];
+  static uint8_t nextToReplace = 0;
+
+  for (uint8_t i = 0; i < CONTROLLER_TEMPLATE_CACHE_SIZE; ++i) {
+    if (templates[i].getTemplate().equals(templateString)) {
+      return templates[i];
+    }
+  }
+
+  // Not present, replace the oldest one.
+  CompiledTemplate& compiled = templates[nextToReplace];
+
+  nextToReplace = (nextToReplace + 1) % CONTROLLER_TEMPLATE_CACHE_SIZE;
+  compiled.setTemplate(templateString);
+  return compiled;
+}
+
 void parseControllerVariables(String& s, struct EventStruct *event, bool useURLencode) {
-  s = parseTemplate(s, useURLencode);
+  if (!s.isEmpty()) {
+    s = getCompiledControllerTemplate(s).render(0, useURLencode);
+  }
   parseEventVariables(s, event, useURLencode);
 }
 
@@ -5,6 +5,8 @@
 
 #include "../Globals/Plugins.h"
 #include "../Globals/CPlugins.h"
+#include "../DataTypes/SensorVType.h"
+#include "../DataTypes/TaskValues_Data.h"
 
 #include "../Helpers/Convert.h"
 #include "../Helpers/StringConverter_Numerical.h"
@@ -141,6 +143,13 @@ void   replaceUnicodeByChar(String& line, char replChar);
 /*********************************************************************************************\
    Format a value to the set number of decimals
 \*********************************************************************************************/
+
+// Try to format the value using the plugin specific formatting (PLUGIN_FORMAT_USERVAR)
+// Return true when the plugin did format the value.
+bool   pluginFormatUserVar(struct EventStruct *event,
+                           uint8_t             rel_index,
+                           String            & result);
+
 String doFormatUserVar(struct EventStruct *event,
                        uint8_t                rel_index,
                        bool                mustCheck,
@@ -160,6 +169,13 @@ String formatUserVar(struct EventStruct *event,
                      uint8_t                rel_index,
                      bool              & isvalid);
 
+// Format a value from a copy of the task values, using the number of decimals set for the task.
+// N.B. Does not use the plugin specific formatting (PLUGIN_FORMAT_USERVAR)
+String formatTaskValue(taskIndex_t              TaskIndex,
+                       uint8_t                  rel_index,
+                       Sensor_VType             sensorType,
+                       const TaskValues_Data_t& values);
+
 
 String get_formatted_Controller_number(cpluginID_t cpluginID);
 
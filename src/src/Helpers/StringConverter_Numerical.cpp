@@ -127,7 +127,7 @@ String toStringNoZero(int64_t value) {
   }
 }
 
-#if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+#if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE || FEATURE_EXTENDED_TASK_VALUE_TYPES
 String doubleToString(const double& value, unsigned int decimalPlaces, bool trimTrailingZeros_b) {
   // This has been fixed in ESP32 code, not (yet) in ESP8266 code
   // https://github.com/espressif/arduino-esp32/pull/6138/files
@@ -32,7 +32,7 @@ String trimTrailingZeros(const String& value);
 
 String toStringNoZero(int64_t value);
 
-#if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+#if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE || FEATURE_EXTENDED_TASK_VALUE_TYPES
 String doubleToString(const double& value,
                       unsigned int  decimalPlaces     = 2,
                       bool          trimTrailingZeros = false);
@@ -20,6 +20,21 @@ String parseTemplate_padded(String& tmpString,
                             uint8_t    minimal_lineSize,
                             bool    useURLencode);
 
+// Replace a single [deviceName#valueName#format] marker and append the result to newString.
+// deviceName and valueName must be lower case.
+// templateLength is the length of the template, used for right justified values.
+void parseTemplate_marker(String      & newString,
+                          uint8_t       minimal_lineSize,
+                          const String& deviceName,
+                          const String& valueName,
+                          String      & format,
+                          int           templateLength);
+
+// Conversions to apply after all markers have been replaced.
+void parseTemplate_finalize(String& newString,
+                            uint8_t minimal_lineSize,
+                            bool    useURLencode);
+
 
 /********************************************************************************************\
    Transform values
@@ -34,6 +49,13 @@ void transformValue(
   String      & valueFormat,
   const String& tmpString);
 
+void transformValue(
+  String      & newString,
+  uint8_t       lineSize,
+  String        value,
+  String      & valueFormat,
+  int           templateLength);
+
 
 
 // Find the first (enabled) task with given name
@@ -13,6 +13,9 @@
 #include "../ESPEasyCore/ESPEasyNetwork.h"
 
 #include "../Globals/CRCValues.h"
+#if FEATURE_ETHERNET
+# include "../Globals/ESPEasyEthEvent.h"
+#endif // if FEATURE_ETHERNET
 #include "../Globals/ESPEasy_time.h"
 #include "../Globals/ESPEasyWiFiEvent.h"
 #if FEATURE_MQTT
@@ -24,6 +27,7 @@
 #include "../Globals/Statistics.h"
 
 #include "../Helpers/Convert.h"
+#include "../Helpers/ESPEasy_time_calc.h"
 #include "../Helpers/Hardware.h"
 #include "../Helpers/Misc.h"
 #include "../Helpers/Numerical.h"
@@ -39,13 +43,8 @@
 #endif // if defined(ESP32)
 
 
-String getReplacementString(const String& format, String& s) {
-  int startpos = s.indexOf(format);
-  int endpos   = s.indexOf('%', startpos + 1);
-  String R     = s.substring(startpos, endpos + 1);
-
 #ifndef BUILD_NO_DEBUG
-
+void logSunTimeReplacement(const String& R) {
   if (loglevelActiveFor(LOG_LEVEL_DEBUG)) {
     String log = F("ReplacementString SunTime: ");
     log += R;
@@ -53,20 +52,18 @@ String getReplacementString(const String& format, String& s) {
     log += ESPEasy_time::getSecOffset(R);
     addLogMove(LOG_LEVEL_DEBUG, log);
   }
-#endif // ifndef BUILD_NO_DEBUG
-  return R;
-}
-
-void replSunRiseTimeString(const String& format, String& s, boolean useURLencode) {
-  String R = getReplacementString(format, s);
-
-  repl(R, node_time.getSunriseTimeString(':', ESPEasy_time::getSecOffset(R)), s, useURLencode);
 }
+#endif // ifndef BUILD_NO_DEBUG
 
-void replSunSetTimeString(const String& format, String& s, boolean useURLencode) {
-  String R = getReplacementString(format, s);
-
-  repl(R, node_time.getSunsetTimeString(':', ESPEasy_time::getSecOffset(R)), s, useURLencode);
+// R is the complete variable including offset, e.g. "%sunrise-1h%"
+String getSunTimeString(const String& R, bool sunrise) {
+#ifndef BUILD_NO_DEBUG
+  logSunTimeReplacement(R);
+#endif // ifndef BUILD_NO_DEBUG
+  const int secOffset = ESPEasy_time::getSecOffset(R);
+  return sunrise
+    ? node_time.getSunriseTimeString(':', secOffset)
+    : node_time.getSunsetTimeString(':', secOffset);
 }
 
 String timeReplacement_leadZero(int value)
@@ -226,112 +223,363 @@ String SystemVariables::getSystemVariable(SystemVariables::Enum enumval) {
   return EMPTY_STRING;
 }
 
-#define SMART_REPL_T(T, S) \
-  while (s.indexOf(T) != -1) { (S((T), s, useURLencode)); }
+/*********************************************************************************************\
+* Cache for system variable values.
+* Values are only cached when they cannot change before the cache key changes.
+\*********************************************************************************************/
+enum class SystemVariableCachePolicy : uint8_t {
+  NoCache,   // May change at any moment
+  PerSecond, // Time based, refreshed once per second
+  Network,   // Refreshed when the network connection state changes
+  Constant   // Does not change while running
+};
+
+SystemVariableCachePolicy getCachePolicy(SystemVariables::Enum enumval) {
+  switch (enumval)
+  {
+    case SystemVariables::CR:
+    case SystemVariables::LF:
+    case SystemVariables::SPACE:
+    case SystemVariables::S_CR:
+    case SystemVariables::S_LF:
+    case SystemVariables::MAC_INT:
+    case SystemVariables::SYSBUILD_DATE:
+    case SystemVariables::SYSBUILD_DESCR:
+    case SystemVariables::SYSBUILD_FILENAME:
+    case SystemVariables::SYSBUILD_GIT:
+    case SystemVariables::SYSBUILD_TIME:
+    case SystemVariables::FLASH_FREQ:
+    case SystemVariables::FLASH_SIZE:
+    case SystemVariables::FLASH_CHIP_VENDOR:
+    case SystemVariables::FLASH_CHIP_MODEL:
+    case SystemVariables::FS_SIZE:
+    case SystemVariables::ESP_CHIP_ID:
+    case SystemVariables::ESP_CHIP_FREQ:
+    case SystemVariables::ESP_CHIP_MODEL:
+    case SystemVariables::ESP_CHIP_REVISION:
+    case SystemVariables::ESP_CHIP_CORES:
+    case SystemVariables::ESP_BOARD_NAME:
+      return SystemVariableCachePolicy::Constant;
+
+    case SystemVariables::BSSID:
+    case SystemVariables::IP:
+    case SystemVariables::IP4:
+    case SystemVariables::SUBNET:
+    case SystemVariables::GATEWAY:
+    case SystemVariables::DNS:
+    case SystemVariables::DNS_1:
+    case SystemVariables::DNS_2:
+    case SystemVariables::ISWIFI:
+    #if FEATURE_ETHERNET
+    case SystemVariables::ETHWIFIMODE:
+    case SystemVariables::ETHCONNECTED:
+    case SystemVariables::ETHDUPLEX:
+    case SystemVariables::ETHSPEED:
+    case SystemVariables::ETHSTATE:
+    case SystemVariables::ETHSPEEDSTATE:
+    #endif // if FEATURE_ETHERNET
+    case SystemVariables::MAC:
+    case SystemVariables::SSID:
+    case SystemVariables::WI_CH:
+      return SystemVariableCachePolicy::Network;
+
+    case SystemVariables::LCLTIME:
+    case SystemVariables::LCLTIME_AM:
+    case SystemVariables::SUNRISE_S:
+    case SystemVariables::SUNSET_S:
+    case SystemVariables::SUNRISE_M:
+    case SystemVariables::SUNSET_M:
+    case SystemVariables::SYSDAY:
+    case SystemVariables::SYSDAY_0:
+    case SystemVariables::SYSHOUR:
+    case SystemVariables::SYSHOUR_0:
+    case SystemVariables::SYSMIN:
+    case SystemVariables::SYSMIN_0:
+    case SystemVariables::SYSMONTH:
+    case SystemVariables::SYSMONTH_S:
+    case SystemVariables::SYSSEC:
+    case SystemVariables::SYSSEC_0:
+    case SystemVariables::SYSSEC_D:
+    case SystemVariables::SYSTIME:
+    case SystemVariables::SYSTIME_AM:
+    case SystemVariables::SYSTIME_AM_0:
+    case SystemVariables::SYSTIME_AM_SP:
+    case SystemVariables::SYSTM_HM:
+    case SystemVariables::SYSTM_HM_0:
+    case SystemVariables::SYSTM_HM_SP:
+    case SystemVariables::SYSTM_HM_AM:
+    case SystemVariables::SYSTM_HM_AM_0:
+    case SystemVariables::SYSTM_HM_AM_SP:
+    case SystemVariables::SYSTZOFFSET:
+    case SystemVariables::SYSWEEKDAY:
+    case SystemVariables::SYSWEEKDAY_S:
+    case SystemVariables::SYSYEAR:
+    case SystemVariables::SYSYEARS:
+    case SystemVariables::SYSYEAR_0:
+    case SystemVariables::SYS_MONTH_0:
+    case SystemVariables::UNIXDAY:
+    case SystemVariables::UNIXDAY_SEC:
+    case SystemVariables::UNIXTIME:
+    case SystemVariables::UPTIME:
+      return SystemVariableCachePolicy::PerSecond;
 
-void SystemVariables::parseSystemVariables(String& s, boolean useURLencode)
-{
-  START_TIMER
+    default:
+      break;
+  }
+  return SystemVariableCachePolicy::NoCache;
+}
 
-  if (s.indexOf('%') == -1) {
-    STOP_TIMER(PARSE_SYSVAR_NOCHANGE);
+uint32_t getCacheKey(SystemVariableCachePolicy policy) {
+  switch (policy) {
+    case SystemVariableCachePolicy::PerSecond:
+      return node_time.getUnixTime();
+    case SystemVariableCachePolicy::Network:
+    {
+      uint32_t key = WiFiEventData.wifiStatus;
+      key += static_cast<uint32_t>(WiFiEventData.wifi_reconnects) << 8;
+      #if FEATURE_ETHERNET
+      key += static_cast<uint32_t>(active_network_medium) << 4;
+      key += static_cast<uint32_t>(EthEventData.ethStatus) << 6;
+      key += static_cast<uint32_t>(EthEventData.eth_reconnects) << 20;
+      #endif // if FEATURE_ETHERNET
+      return key;
+    }
+    default:
+      break;
+  }
+  return 0;
+}
+
+struct SystemVariableCacheElement {
+  String                value;
+  uint32_t              key        = 0;
+  unsigned long         lastUpdate = 0;
+  SystemVariables::Enum enumval    = SystemVariables::UNKNOWN;
+};
+
+// Only contains the system variables which have been used.
+static std::vector<SystemVariableCacheElement> systemVariableCache;
+
+void getCachedSystemVariable(SystemVariables::Enum enumval, String& value) {
+  const SystemVariableCachePolicy policy = getCachePolicy(enumval);
+
+  if (policy == SystemVariableCachePolicy::NoCache) {
+    value = SystemVariables::getSystemVariable(enumval);
     return;
   }
+  const uint32_t key = getCacheKey(policy);
 
-  SystemVariables::Enum enumval = static_cast<SystemVariables::Enum>(0);
+  auto it = systemVariableCache.begin();
 
-  do {
-    enumval = SystemVariables::nextReplacementEnum(s, enumval);
+  for (; it != systemVariableCache.end(); ++it) {
+    if (it->enumval == enumval) {
+      const bool expired =
+        (policy == SystemVariableCachePolicy::PerSecond) &&
+        (timePassedSince(it->lastUpdate) >= 1000);
 
-    switch (enumval)
-    {
-      case SUNRISE:           
-        SMART_REPL_T(SystemVariables::toString(enumval), replSunRiseTimeString); 
-        break;
-      case SUNSET:            
-        SMART_REPL_T(SystemVariables::toString(enumval), replSunSetTimeString); 
-        break;
-      case UNKNOWN:
-
-        // Do not replace
-        break;
-      default:
-      {
-        const String value = getSystemVariable(enumval);
-        repl(SystemVariables::toString(enumval), value, s, useURLencode);
-        break;
+      if ((it->key == key) && !expired) {
+        value = it->value;
+        return;
       }
+      break;
     }
   }
-  while (enumval != SystemVariables::Enum::UNKNOWN);
-
-  int v_index = s.indexOf(F("%v"));
-
-  while ((v_index != -1)) {
-    unsigned int i;
-
-    if (validUIntFromString(s.substring(v_index + 2), i)) {
-      String key = F("%v");
-      key += i;
-      key += '%';
-
-      if (s.indexOf(key) != -1) {
-        const bool trimTrailingZeros = true;
-        #if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
-        const String value = doubleToString(getCustomFloatVar(i), 6, trimTrailingZeros);
-        #else
-        const String value = floatToString(getCustomFloatVar(i), 6, trimTrailingZeros);
-        #endif
-        repl(key, value, s, useURLencode);
-      }
-    }
-    v_index = s.indexOf(F("%v"), v_index + 1); // Find next occurance
+
+  if (it == systemVariableCache.end()) {
+    #ifdef USE_SECOND_HEAP
+    HeapSelectIram ephemeral;
+    #endif // ifdef USE_SECOND_HEAP
+
+    systemVariableCache.emplace_back();
+    it          = systemVariableCache.end() - 1;
+    it->enumval = enumval;
   }
+  it->value      = SystemVariables::getSystemVariable(enumval);
+  it->key        = key;
+  it->lastUpdate = millis();
+  value          = it->value;
+}
 
-  STOP_TIMER(PARSE_SYSVAR);
+/*********************************************************************************************\
+* Lookup table to find a system variable by its name.
+* Open addressing hash table, storing enum value + 1. 0 marks an empty slot.
+\*********************************************************************************************/
+#define SYSTEM_VARIABLES_LOOKUP_TABLE_SIZE 256 // Must be a power of 2
+
+static_assert(SystemVariables::Enum::UNKNOWN < 255, "Enum must fit in lookup table");
+static_assert(SystemVariables::Enum::UNKNOWN < (SYSTEM_VARIABLES_LOOKUP_TABLE_SIZE / 2), "Lookup table too small");
+
+static std::vector<uint8_t> systemVariableLookupTable;
+
+// FNV-1a hash, using pgm_read_byte so it works on strings in both RAM and flash.
+uint32_t systemVariableNameHash(const char *name, size_t length) {
+  uint32_t hash = 2166136261u;
+
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<uint8_t>(pgm_read_byte(name + i));
+    hash *= 16777619u;
+  }
+  return hash;
 }
 
-#undef SMART_REPL_T
+void initSystemVariableLookupTable() {
+  systemVariableLookupTable.resize(SYSTEM_VARIABLES_LOOKUP_TABLE_SIZE, 0);
 
+  for (uint8_t i = 0; i < SystemVariables::Enum::UNKNOWN; ++i) {
+    PGM_P name   = (PGM_P)SystemVariables::toFlashString(static_cast<SystemVariables::Enum>(i));
+    size_t index = systemVariableNameHash(name, strlen_P(name)) & (SYSTEM_VARIABLES_LOOKUP_TABLE_SIZE - 1);
+
+    while (systemVariableLookupTable[index] != 0) {
+      index = (index + 1) & (SYSTEM_VARIABLES_LOOKUP_TABLE_SIZE - 1);
+    }
+    systemVariableLookupTable[index] = i + 1;
+  }
+}
 
-SystemVariables::Enum SystemVariables::nextReplacementEnum(const String& str, SystemVariables::Enum last_tested)
+SystemVariables::Enum SystemVariables::findSystemVariable(const char *name, size_t length)
 {
-  if (str.indexOf('%') == -1) {
-    return Enum::UNKNOWN;
+  if (systemVariableLookupTable.empty()) {
+    initSystemVariableLookupTable();
+  }
+  size_t index = systemVariableNameHash(name, length) & (SYSTEM_VARIABLES_LOOKUP_TABLE_SIZE - 1);
+
+  while (systemVariableLookupTable[index] != 0) {
+    const SystemVariables::Enum enumval = static_cast<SystemVariables::Enum>(systemVariableLookupTable[index] - 1);
+    PGM_P enumName                      = (PGM_P)SystemVariables::toFlashString(enumval);
+
+    if ((strncmp_P(name, enumName, length) == 0) && (pgm_read_byte(enumName + length) == 0)) {
+      return enumval;
+    }
+    index = (index + 1) & (SYSTEM_VARIABLES_LOOKUP_TABLE_SIZE - 1);
   }
+  return Enum::UNKNOWN;
+}
+
+/*********************************************************************************************\
+* Replace system variables in a single pass.
+\*********************************************************************************************/
 
-  SystemVariables::Enum nextTested = static_cast<SystemVariables::Enum>(0);
+// Get the value of %...%, name is the part between the '%' characters
+// Return false when it is not a system variable.
+bool getSystemVariableReplacement(const String& s, int startpos, int endpos, String& value)
+{
+  const char  *name   = s.c_str() + startpos + 1;
+  const size_t length = endpos - startpos - 1;
 
-  if (last_tested > nextTested) {
-    nextTested = static_cast<SystemVariables::Enum>(last_tested + 1);
+  if (length == 0) {
+    return false;
   }
 
-  if (nextTested >= Enum::UNKNOWN) {
-    return Enum::UNKNOWN;
+  if ((name[0] == 'v') && (length > 1) && isDigit(name[1])) {
+    // Custom float variable: %v<index>%
+    if ((name[1] == '0') && (length > 2)) {
+      // Leading zeroes are not supported
+      return false;
+    }
+    unsigned int i = 0;
+
+    for (size_t pos = 1; pos < length; ++pos) {
+      if (!isDigit(name[pos])) {
+        return false;
+      }
+      i = (i * 10) + (name[pos] - '0');
+    }
+    const bool trimTrailingZeros = true;
+    #if FEATURE_USE_DOUBLE_AS_ESPEASY_RULES_FLOAT_TYPE
+    value = doubleToString(getCustomFloatVar(i), 6, trimTrailingZeros);
+    #else
+    value = floatToString(getCustomFloatVar(i), 6, trimTrailingZeros);
+    #endif
+    return true;
   }
 
-  String str_prefix        = SystemVariables::toString(nextTested).substring(0, 2);
-  bool   str_prefix_exists = str.indexOf(str_prefix) != -1;
+  const SystemVariables::Enum enumval = SystemVariables::findSystemVariable(name, length);
 
-  for (int i = nextTested; i < Enum::UNKNOWN; ++i) {
-    SystemVariables::Enum enumval = static_cast<SystemVariables::Enum>(i);
-    const String new_str_prefix   = SystemVariables::toString(enumval).substring(0, 2);
+  switch (enumval) {
+    case SystemVariables::UNKNOWN:
+    {
+      // %sunrise% and %sunset% may have an offset, like %sunrise-1h%
+      const bool sunrise = strncmp_P(name, PSTR("sunrise"), 7) == 0;
+      const bool sunset  = !sunrise && strncmp_P(name, PSTR("sunset"), 6) == 0;
 
-    if ((str_prefix == new_str_prefix) && !str_prefix_exists) {
-      // Just continue
-    } else {
-      str_prefix        = new_str_prefix;
-      str_prefix_exists = str.indexOf(str_prefix) != -1;
+      if (sunrise || sunset) {
+        const char offsetSign = name[sunrise ? 7 : 6];
 
-      if (str_prefix_exists) {
-        if (str.indexOf(SystemVariables::toString(enumval)) != -1) {
-          return enumval;
+        if ((offsetSign == '+') || (offsetSign == '-')) {
+          value = getSunTimeString(s.substring(startpos, endpos + 1), sunrise);
+          return true;
         }
       }
+      return false;
     }
+    case SystemVariables::SUNRISE:
+    case SystemVariables::SUNSET:
+      value = getSunTimeString(s.substring(startpos, endpos + 1), enumval == SystemVariables::SUNRISE);
+      return true;
+    default:
+      getCachedSystemVariable(enumval, value);
+      return true;
   }
+  return false;
+}
 
-  return Enum::UNKNOWN;
+void SystemVariables::parseSystemVariables(String& s, boolean useURLencode)
+{
+  START_TIMER
+
+  int startpos = s.indexOf('%');
+
+  if (startpos == -1) {
+    STOP_TIMER(PARSE_SYSVAR_NOCHANGE);
+    return;
+  }
+
+  String result;
+  int    copiedUpTo = 0;
+  bool   replaced   = false;
+
+  while (startpos != -1) {
+    const int endpos = s.indexOf('%', startpos + 1);
+
+    if (endpos == -1) {
+      break;
+    }
+    String value;
+
+    if (getSystemVariableReplacement(s, startpos, endpos, value)) {
+      if (!replaced) {
+        result.reserve(s.length() + value.length());
+        replaced = true;
+      }
+
+      // Copy everything up to the start of the replaced variable.
+      for (int i = copiedUpTo; i < startpos; ++i) {
+        result += s[i];
+      }
+
+      if (useURLencode) {
+        result += URLEncode(value);
+      } else {
+        result += value;
+      }
+      copiedUpTo = endpos + 1;
+      startpos   = s.indexOf('%', copiedUpTo);
+    } else {
+      // The closing '%' may be the start of the next variable.
+      startpos = endpos;
+    }
+  }
+
+  if (replaced) {
+    const int length = s.length();
+
+    for (int i = copiedUpTo; i < length; ++i) {
+      result += s[i];
+    }
+    s = std::move(result);
+  }
+
+  STOP_TIMER(PARSE_SYSVAR);
 }
 
 String SystemVariables::toString(Enum enumval)
@@ -117,10 +117,10 @@ public:
     UNKNOWN
   };
 
-  // Find the next thing to replace.
-  // Return UNKNOWN when nothing needs to be replaced.
-  static SystemVariables::Enum      nextReplacementEnum(const String        & str,
-                                                        SystemVariables::Enum last_tested);
+  // Find the system variable by its name, without the surrounding '%'.
+  // Return UNKNOWN when not found.
+  static SystemVariables::Enum      findSystemVariable(const char *name,
+                                                       size_t      length);
 
   static String                     toString(SystemVariables::Enum enumval);
   static const __FlashStringHelper* toFlashString(SystemVariables::Enum enumval);
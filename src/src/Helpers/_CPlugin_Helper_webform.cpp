@@ -32,6 +32,8 @@ const __FlashStringHelper * toString(ControllerSettingsStruct::VarType parameter
     case ControllerSettingsStruct::CONTROLLER_FULL_QUEUE_ACTION:        return  F("Full Queue Action");      
     case ControllerSettingsStruct::CONTROLLER_ALLOW_EXPIRE:             return  F("Allow Expire");           
     case ControllerSettingsStruct::CONTROLLER_DEDUPLICATE:              return  F("De-duplicate");           
+    case ControllerSettingsStruct::CONTROLLER_SEND_BATCH:               return  F("Send In Batches");
+    case ControllerSettingsStruct::CONTROLLER_SPILL_TO_FLASH:           return  F("Spill Queue To Flash");
     case ControllerSettingsStruct::CONTROLLER_USE_LOCAL_SYSTEM_TIME:    return  F("Use Local System Time");
     
     case ControllerSettingsStruct::CONTROLLER_CHECK_REPLY:              return  F("Check Reply");            
@@ -210,6 +212,14 @@ void addControllerParameterForm(const ControllerSettingsStruct& ControllerSettin
     case ControllerSettingsStruct::CONTROLLER_DEDUPLICATE:
       addFormCheckBox(displayName, internalName, ControllerSettings.deduplicate());
       break;
+    case ControllerSettingsStruct::CONTROLLER_SEND_BATCH:
+      addFormCheckBox(displayName, internalName, ControllerSettings.sendBatch());
+      addFormNote(F("Send multiple queued messages at once, reusing the connection when possible"));
+      break;
+    case ControllerSettingsStruct::CONTROLLER_SPILL_TO_FLASH:
+      addFormCheckBox(displayName, internalName, ControllerSettings.spillToFlash());
+      addFormNote(F("Store messages on the file system when the queue is full"));
+      break;
     case ControllerSettingsStruct::CONTROLLER_USE_LOCAL_SYSTEM_TIME:
       addFormCheckBox(displayName, internalName, ControllerSettings.useLocalSystemTime());
       break;      
@@ -341,6 +351,12 @@ void saveControllerParameterForm(ControllerSettingsStruct        & ControllerSet
     case ControllerSettingsStruct::CONTROLLER_DEDUPLICATE:
       ControllerSettings.deduplicate(isFormItemChecked(internalName));
       break;
+    case ControllerSettingsStruct::CONTROLLER_SEND_BATCH:
+      ControllerSettings.sendBatch(isFormItemChecked(internalName));
+      break;
+    case ControllerSettingsStruct::CONTROLLER_SPILL_TO_FLASH:
+      ControllerSettings.spillToFlash(isFormItemChecked(internalName));
+      break;
     case ControllerSettingsStruct::CONTROLLER_USE_LOCAL_SYSTEM_TIME:
       ControllerSettings.useLocalSystemTime(isFormItemChecked(internalName));
       break;
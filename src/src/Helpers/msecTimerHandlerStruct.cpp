@@ -3,6 +3,8 @@
 
 #include "../Helpers/ESPEasy_time_calc.h"
 
+#include <algorithm>
+
 
 #define MAX_SCHEDULER_WAIT_TIME 50 // Max delay used in the scheduler for passing idle time.
 
@@ -32,7 +34,9 @@
   unsigned long msecTimerHandlerStruct::getNextId(unsigned long& timer) {
     ++get_called;
 
-    if (_timer_ids.empty()) {
+    discardOutdated();
+
+    if (_timer_ids.empty() || _timer_heap.empty()) {
       recordIdle();
 
       if (eco_mode) {
@@ -40,7 +44,7 @@
       }
       return 0;
     }
-    timer_id_couple item = _timer_ids.front();
+    timer_id_couple item = _timer_heap.front();
     const long passed    = timePassedSince(item._timer);
 
     if (passed < 0) {
@@ -64,7 +68,9 @@
     unsigned long size = _timer_ids.size();
 
     if (size > max_queue_length) { max_queue_length = size; }
-    _timer_ids.pop_front();
+    std::pop_heap(_timer_heap.begin(), _timer_heap.end(), timer_id_couple_later());
+    _timer_heap.pop_back();
+    _timer_ids.erase(item._id);
     timer = item._timer;
     ++get_called_ret_id;
     return item._id;
@@ -72,13 +78,13 @@
 
 
   bool msecTimerHandlerStruct::getTimerForId(unsigned long id, unsigned long& timer) const {
-    for (auto it = _timer_ids.begin(); it != _timer_ids.end(); ++it) {
-      if (it->_id == id) {
-        timer = it->_timer;
-        return true;
-      }
+    auto it = _timer_ids.find(id);
+
+    if (it == _timer_ids.end()) {
+      return false;
     }
-    return false;
+    timer = it->second._timer;
+    return true;
   }
 
   String msecTimerHandlerStruct::getQueueStats() {
@@ -110,38 +116,62 @@
     return idle_time_pct;
   }
 
-  struct match_id {
-    match_id(unsigned long id) : _id(id) {}
-
-    bool operator()(const timer_id_couple& item) {
-      return _id == item._id;
-    }
-
-    unsigned long _id;
-  };
-
   void msecTimerHandlerStruct::insert(const timer_id_couple& item) {
     if (item._id == 0) { return; }
 
     // Make sure only one is present with the same id.
-    _timer_ids.remove_if(match_id(item._id));
-    const bool mustSort = !_timer_ids.empty();
-    _timer_ids.push_front(item);
-
-    if (mustSort) {
-      _timer_ids.sort(); // TD-er: Must check if this is an expensive operation.
+    // Any previous entry in the heap with the same id will become outdated.
+    timer_id_couple newItem(item);
+    newItem._seq = ++_next_seq;
+    auto it = _timer_ids.find(newItem._id);
+
+    if (it == _timer_ids.end()) {
+      _timer_ids.emplace(newItem._id, newItem);
+    } else {
+      it->second = newItem;
     }
 
-    // It should be a relative light operation, to insert into a sorted list.
-    // Perhaps it is better to use std::set ????
-    // Keep in mind: order is based on timer, uniqueness is based on id.
+    _timer_heap.push_back(newItem);
+    std::push_heap(_timer_heap.begin(), _timer_heap.end(), timer_id_couple_later());
+    compactIfNeeded();
   }
 
   void msecTimerHandlerStruct::remove(const timer_id_couple& item) {
     if (item._id == 0) { return; }
 
-    // Make sure only one is present with the same id.
-    _timer_ids.remove_if(match_id(item._id));
+    // Entry in the heap will become outdated.
+    _timer_ids.erase(item._id);
+    compactIfNeeded();
+  }
+
+  bool msecTimerHandlerStruct::isCurrent(const timer_id_couple& item) const {
+    auto it = _timer_ids.find(item._id);
+
+    return it != _timer_ids.end() && it->second._seq == item._seq;
+  }
+
+  void msecTimerHandlerStruct::discardOutdated() {
+    // Only due entries need to be checked.
+    // All current timers are set at or after the top of the heap,
+    // so when the top is not yet due, nothing else is due either.
+    while (!_timer_heap.empty() &&
+           (timePassedSince(_timer_heap.front()._timer) >= 0) &&
+           !isCurrent(_timer_heap.front())) {
+      std::pop_heap(_timer_heap.begin(), _timer_heap.end(), timer_id_couple_later());
+      _timer_heap.pop_back();
+    }
+  }
+
+  void msecTimerHandlerStruct::compactIfNeeded() {
+    if (_timer_heap.size() <= (2 * _timer_ids.size() + 8)) { return; }
+
+    // Too many outdated entries, rebuild from the set timers.
+    _timer_heap.clear();
+
+    for (auto it = _timer_ids.begin(); it != _timer_ids.end(); ++it) {
+      _timer_heap.push_back(it->second);
+    }
+    std::make_heap(_timer_heap.begin(), _timer_heap.end(), timer_id_couple_later());
   }
 
   void msecTimerHandlerStruct::recordIdle() {
@@ -3,7 +3,8 @@
 
 
 #include "../../ESPEasy_common.h"
-#include <list>
+#include <map>
+#include <vector>
 
 #include "../DataStructs/timer_id_couple.h"
 
@@ -39,6 +40,15 @@ private:
 
   void remove(const timer_id_couple& item);
 
+  // Check whether the heap entry is still the currently set timer for its id.
+  bool isCurrent(const timer_id_couple& item) const;
+
+  // Remove outdated entries from the top of the heap, which are already due.
+  void discardOutdated();
+
+  // Rebuild the heap when it contains too many outdated entries.
+  void compactIfNeeded();
+
   void recordIdle();
 
   void recordRunning();
@@ -56,8 +66,16 @@ private:
   bool          is_idle;
   bool          eco_mode;
 
-  // The list of set timers
-  std::list<timer_id_couple>_timer_ids;
+  // Binary min-heap of set timers, ordered on the set timer.
+  // Entries are not removed from the heap when a timer is cancelled or rescheduled.
+  // Instead they become outdated as their sequence number no longer matches
+  // the one stored in _timer_ids.
+  std::vector<timer_id_couple>_timer_heap;
+
+  // The currently set timers per id.
+  std::map<unsigned long, timer_id_couple>_timer_ids;
+
+  uint32_t _next_seq = 0;
 };
 
 #endif // HELPERS_MSECTIMERHANDLERSTRUCT_H
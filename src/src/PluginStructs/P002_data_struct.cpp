@@ -56,6 +56,7 @@ void P002_data_struct::load(struct EventStruct *event)
     const int stored_nr_lines = lines[P002_SAVED_NR_LINES].toInt();
     _formula              = lines[P002_LINE_INDEX_FORMULA];
     _formula_preprocessed = RulesCalculate_t::preProces(_formula);
+    _formula_compiled.setExpression(_formula);
 
     for (size_t i = P002_LINE_IDX_FIRST_MP; i < nr_lines && static_cast<int>(i) < stored_nr_lines; i += P002_STRINGS_PER_MP) {
       float adc, value = 0.0f;
@@ -937,14 +938,23 @@ int P002_data_struct::computeADC_to_bin(const int& currentValue) const
 
   if (!_formula_preprocessed.isEmpty()) {
     // Formula, must be applied before binning
-    String formula = _formula_preprocessed;
+    ESPEASY_RULES_FLOAT_TYPE result{};
 
-    formula.replace(F("%value%"), toString(calibrated_value, _nrDecimals));
+    if (_formula_compiled.canEvaluate()) {
+      const ESPEASY_RULES_FLOAT_TYPE value = CompiledExpression::roundToDecimals(calibrated_value, _nrDecimals);
 
-    ESPEASY_RULES_FLOAT_TYPE result{};
+      // %pvalue% is not supported here, NAN makes evaluate() return an error, just like the text based formula.
+      if (!isError(_formula_compiled.evaluate(value, NAN, result))) {
+        calibrated_value = result;
+      }
+    } else {
+      String formula = _formula_preprocessed;
+
+      formula.replace(F("%value%"), toString(calibrated_value, _nrDecimals));
 
-    if (!isError(RulesCalculate.doCalculate(parseTemplate(formula).c_str(), &result))) {
-      calibrated_value = result;
+      if (!isError(RulesCalculate.doCalculate(parseTemplate(formula).c_str(), &result))) {
+        calibrated_value = result;
+      }
     }
   }
 
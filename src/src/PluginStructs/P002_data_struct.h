@@ -3,6 +3,7 @@
 
 #include "../../_Plugin_Helper.h"
 
+#include "../DataStructs/CompiledExpression.h"
 #include "../Helpers/OversamplingHelper.h"
 
 #ifdef USES_P002
@@ -267,6 +268,7 @@ private:
   uint8_t _nrMultiPointItems = 0;
   String  _formula;
   String  _formula_preprocessed;
+  mutable CompiledExpression _formula_compiled; // Compiled on first use by const function computeADC_to_bin()
 # endif // ifndef LIMIT_BUILD_SIZE
 # ifdef ESP32
   bool        _useFactoryCalibration = false;
@@ -233,7 +233,10 @@ void P023_data_struct::checkDisplayTimer() {
 
 // Perform some specific changes for OLED display
 String P023_data_struct::parseTemplate(String& tmpString, uint8_t lineSize) {
-  String result             = parseTemplate_padded(tmpString, lineSize);
+  return toOLEDcharset(parseTemplate_padded(tmpString, lineSize));
+}
+
+String P023_data_struct::toOLEDcharset(String result) {
   const char degree[3]      = { 0xc2, 0xb0, 0 }; // Unicode degree symbol
   const char degree_oled[2] = { 0x7F, 0 };       // P023_OLED degree symbol
 
@@ -262,9 +265,10 @@ void P023_data_struct::StartUp_OLED(struct EventStruct *event) {
 
 bool P023_data_struct::plugin_read(struct EventStruct *event) {
   for (uint8_t x = 0; x < 8; x++) {
-    String newString = parseTemplate(strings[x], 16);
-
     if (strings[x].length()) {
+      compiledLines[x].setTemplate(strings[x]);
+      const String newString = toOLEDcharset(compiledLines[x].render(16));
+
       sendStrXY(newString.c_str(), x, 0);
       currentLines[x] = newString;
     }
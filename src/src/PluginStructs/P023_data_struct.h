@@ -5,6 +5,8 @@
 #ifdef USES_P023
 # include "../Helpers/OLed_helper.h"
 
+# include "../DataStructs/CompiledTemplate.h"
+
 
 # define P23_Nlines 8 // The number of different lines which can be displayed
 # define P23_Nchars 64
@@ -92,8 +94,14 @@ struct P023_data_struct : public PluginTaskData_base {
 
 private:
 
+  // Replace characters which are displayed differently on the OLED
+  static String toOLEDcharset(String result);
+
   String strings[P23_Nlines]{};
   String currentLines[P23_Nlines]{};
+
+  // Lines are only parsed again when their content or task names have changed.
+  CompiledTemplate compiledLines[P23_Nlines]{};
 };
 
 #endif // ifdef USES_P023
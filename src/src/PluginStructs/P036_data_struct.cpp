@@ -1758,7 +1758,17 @@ String P036_data_struct::P36_parseTemplate(String& tmpString, uint8_t lineIdx) {
   if (tmpString.length() == 0) {
     return EMPTY_STRING;
   }
-  String result = parseTemplate_padded(tmpString, 20);
+  if (CompiledLines.size() < P36_Nlines) {
+    CompiledLines.resize(P36_Nlines);
+  }
+  String result;
+
+  if (lineIdx < CompiledLines.size()) {
+    CompiledLines[lineIdx].setTemplate(tmpString);
+    result = CompiledLines[lineIdx].render(20);
+  } else {
+    result = parseTemplate_padded(tmpString, 20);
+  }
 
   result.trim();
 
@@ -5,6 +5,8 @@
 #ifdef USES_P036
 # include "../Helpers/OLed_helper.h"
 
+# include "../DataStructs/CompiledTemplate.h"
+
 # include <SSD1306.h>
 # include <SH1106Wire.h>
 
@@ -466,6 +468,9 @@ struct P036_data_struct : public PluginTaskData_base {
   // CustomTaskSettings
   P036_LineContent *LineContent = nullptr;
 
+  // Parsed display lines, only parsed again when the line content or task names have changed.
+  std::vector<CompiledTemplate> CompiledLines;
+
   int8_t lastWiFiState   = 0;
   bool   bDisplayingLogo = false;
 
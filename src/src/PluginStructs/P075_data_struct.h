@@ -7,6 +7,8 @@
 
 # include <ESPeasySerial.h>
 
+# include "../DataStructs/CompiledTemplate.h"
+
 
 // Configuration Settings. Custom Configuration Memory must be less than 1024 Bytes (per TD'er findings).
 // #define P75_Nlines 12            // Custom Config, Number of user entered Command Statment Lines. DO NOT USE!
@@ -47,6 +49,9 @@ struct P075_data_struct : public PluginTaskData_base {
   uint32_t       baudrate   = 9600UL;
 
   String displayLines[P75_Nlines];
+
+  // Display lines are parsed once and only compiled again when changed.
+  CompiledTemplate compiledLines[P75_Nlines];
 };
 
 #endif // ifdef USES_P075
@@ -479,10 +479,8 @@ void P104_data_struct::displayOneZoneText(uint8_t                 zone,
   if ((nullptr == P) || (zone >= P104_MAX_ZONES)) { return; } // double check
   sZoneInitial[zone].reserve(text.length());
   sZoneInitial[zone] = text; // Keep the original string for future use
-  sZoneBuffers[zone].reserve(text.length());
-  sZoneBuffers[zone] = text; // We explicitly want a copy here so it can be modified by parseTemplate()
-
-  sZoneBuffers[zone] = parseTemplate(sZoneBuffers[zone]);
+  zoneTemplates[zone].setTemplate(text);
+  sZoneBuffers[zone] = zoneTemplates[zone].render();
 
   # if defined(P104_USE_NUMERIC_DOUBLEHEIGHT_FONT) || defined(P104_USE_FULL_DOUBLEHEIGHT_FONT)
 
@@ -636,8 +634,8 @@ void P104_data_struct::displayBarGraph(uint8_t                 zone,
   sZoneInitial[zone] = graph; // Keep the original string for future use
 
   #  define NOT_A_COMMA 0x02  // Something else than a comma, or the parseString function will get confused
-  String parsedGraph(graph);  // Extra copy created so we don't mess up the incoming String
-  parsedGraph = parseTemplate(parsedGraph);
+  zoneTemplates[zone].setTemplate(graph);
+  String parsedGraph = zoneTemplates[zone].render();
   parsedGraph.replace(',', NOT_A_COMMA);
 
   std::vector<P104_bargraph_struct> barGraphs;
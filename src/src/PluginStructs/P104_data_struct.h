@@ -8,6 +8,7 @@
 // # define P104_DEBUG_DEV // Log some extra development info
 
 # include "../CustomBuild/StorageLayout.h"
+# include "../DataStructs/CompiledTemplate.h"
 # include "../Globals/EventQueue.h"
 # include "../Globals/MQTT.h"
 # include "../Globals/CPlugins.h"
@@ -421,6 +422,9 @@ private:
   String                       sZoneBuffers[P104_MAX_ZONES];
   String                       sZoneInitial[P104_MAX_ZONES];
 
+  // Zone text or bar graph, only compiled again when the zone content changes.
+  CompiledTemplate             zoneTemplates[P104_MAX_ZONES];
+
   MD_MAX72XX::moduleType_t mod;
   taskIndex_t              taskIndex;
   int8_t                   cs_pin;
@@ -423,6 +423,19 @@ bool P146_data_struct::setPeekFilePos(int peekFileNr, int peekReadPos)
   return true;
 }
 
+bool P146_data_struct::setPeekFilePosByTime(uint32_t fromTime, taskIndex_t taskIndex)
+{
+  const bool found = ControllerCache.setPeekFilePosByTime(fromTime, taskIndex);
+
+  if (loglevelActiveFor(LOG_LEVEL_INFO)) {
+    int peekFileNr        = 0;
+    const int peekReadPos = ControllerCache.getPeekFilePos(peekFileNr);
+    addLog(LOG_LEVEL_INFO, concat(F("CacheReader : SeekTime,"), fromTime) + ',' + peekFileNr + ',' + peekReadPos);
+  }
+
+  return found;
+}
+
 void P146_data_struct::flush() {
   C016_flush();
 }
@@ -75,6 +75,9 @@ public:
   static bool setPeekFilePos(int peekFileNr,
                              int peekReadPos);
 
+  static bool setPeekFilePosByTime(uint32_t    fromTime,
+                                   taskIndex_t taskIndex);
+
   static void flush();
 
 private:
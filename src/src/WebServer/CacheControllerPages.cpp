@@ -6,9 +6,12 @@
 # include "../WebServer/AccessControl.h"
 # include "../WebServer/HTML_wrappers.h"
 # include "../WebServer/JSON.h"
+# include "../WebServer/JSON_Writer.h"
 # include "../CustomBuild/ESPEasyLimits.h"
 # include "../DataStructs/DeviceStruct.h"
+# include "../DataStructs/ESPEasyControllerCache_block.h"
 # include "../DataStructs/ESPEasyControllerCache_CSV_dumper.h"
+# include "../DataStructs/ESPEasyControllerCache_query.h"
 # include "../DataTypes/TaskIndex.h"
 # include "../Globals/C016_ControllerCache.h"
 # include "../Globals/Cache.h"
@@ -18,6 +21,7 @@
 # include "../Helpers/ESPEasy_Storage.h"
 # include "../Helpers/ESPEasy_time_calc.h"
 # include "../Helpers/Misc.h"
+# include "../Helpers/Numerical.h"
 
 
 // ********************************************************************************
@@ -53,6 +57,33 @@ void handle_dumpcache() {
     onlySetTasks = true;
   }
 
+  ESPEasyControllerCache_CSV_dumper dumper(
+    joinTimestamp, 
+    onlySetTasks, 
+    separator, 
+    ESPEasyControllerCache_CSV_dumper::Target::CSV_file);
+
+  dumper.setIncludePosition(hasArg(F("position")));
+
+  // Resume an interrupted export at the position given in the "next position" column.
+  // Format: <fileNr>_<filePos>
+  int startFileNr = -1;
+  int startPos    = 0;
+
+  if (hasArg(F("start"))) {
+    const String start = webArg(F("start"));
+
+    if (!validIntFromString(parseString(start, 1, '_'), startFileNr) ||
+        !validIntFromString(parseString(start, 2, '_'), startPos) ||
+        !dumper.setPeekFilePos(startFileNr, startPos)) {
+      // Do not continue at some other position, as the result would not fit the interrupted export.
+      TXBuffer.startStream(F("text/plain"), F("*"), 400);
+      addHtml(F("Invalid start position"));
+      TXBuffer.endStream();
+      return;
+    }
+  }
+
   {
     // Send HTTP headers to directly save the dump as a CSV file
     String str =  F("attachment; filename=cachedump_");
@@ -65,20 +96,23 @@ void handle_dumpcache() {
       str += '_';
       str += node_time.getDateTimeString('\0', '\0', '\0');
     }
+
+    if (startFileNr >= 0) {
+      str += F("_from_");
+      str += startFileNr;
+      str += '_';
+      str += startPos;
+    }
     str += F(".csv");
 
     sendHeader(F("Content-Disposition"), str);
     TXBuffer.startStream(F("application/octet-stream"), F("*"), 200);
   }
 
-
-  ESPEasyControllerCache_CSV_dumper dumper(
-    joinTimestamp, 
-    onlySetTasks, 
-    separator, 
-    ESPEasyControllerCache_CSV_dumper::Target::CSV_file);
-
-  dumper.generateCSVHeader(true);
+  if (startFileNr < 0) {
+    // Skip the header when resuming, as it is already present in the interrupted export
+    dumper.generateCSVHeader(true);
+  }
 
   while (dumper.createCSVLine()) {
     dumper.writeCSVLine(true);
@@ -87,25 +121,140 @@ void handle_dumpcache() {
   TXBuffer.endStream();
 }
 
+// Parse an optional unsigned argument of a cache query.
+// Return false when present, but not a valid number.
+bool parseCacheQueryArg(const __FlashStringHelper *arg, uint32_t& value) {
+  if (!hasArg(arg)) { return true; }
+  unsigned int tmp{};
+
+  if (!validUIntFromString(webArg(arg), tmp)) { return false; }
+  value = tmp;
+  return true;
+}
+
+// Query the cache files
+// Arguments:
+// - from/to   : UNIX timestamps of the time range (inclusive)
+// - task      : Task number (1 ... TASKS_MAX), all tasks when omitted
+// - value     : Task value number (1 ... VARS_PER_TASK), all values when omitted
+// - interval  : Return min/max/avg per task per interval of N seconds, instead of the samples
+void handle_cache_query_json() {
+  ESPEasyControllerCache_query_filter filter;
+  uint32_t taskNr  = 0;
+  uint32_t valueNr = 0;
+
+  if (!parseCacheQueryArg(F("from"), filter.from) ||
+      !parseCacheQueryArg(F("to"), filter.to) ||
+      !parseCacheQueryArg(F("task"), taskNr) ||
+      !parseCacheQueryArg(F("value"), valueNr) ||
+      !parseCacheQueryArg(F("interval"), filter.interval) ||
+      (taskNr > TASKS_MAX) ||
+      (valueNr > VARS_PER_TASK)) {
+    TXBuffer.startJsonStream();
+    JSON_Writer writer;
+    writer.openObject();
+    writer.write(F("error"), F("Invalid query argument"));
+    writer.closeObject();
+    TXBuffer.endStream();
+    return;
+  }
+
+  if (taskNr > 0) { filter.taskIndex = taskNr - 1; }
+
+  if (valueNr > 0) { filter.valueIndex = valueNr - 1; }
+
+  ESPEasyControllerCache_query query(filter);
+  ESPEasyControllerCache_query_result result;
+
+  TXBuffer.startJsonStream();
+  JSON_Writer writer(true);
+  writer.openObject();
+  writer.write(F("from"), filter.from);
+  writer.write(F("to"), filter.to);
+  writer.write(F("interval"), filter.interval);
+  writer.openArray(F("samples"));
+
+  uint32_t nrResults = 0;
+
+  while (query.next(result)) {
+    writer.openObject();
+    writer.write(F("time"), result.unixTime);
+    writer.write(F("task"), static_cast<uint32_t>(result.taskIndex + 1));
+    writer.write(F("count"), result.nrSamples);
+
+    const __FlashStringHelper *labels[] = { F("values"), F("min"), F("max"), F("avg") };
+
+    for (uint8_t l = (filter.interval == 0) ? 0 : 1; l < NR_ELEMENTS(labels); ++l) {
+      writer.openArray(labels[l]);
+
+      for (uint8_t i = 0; i < VARS_PER_TASK; ++i) {
+        if (filter.acceptsValue(i) && (i < result.valueCount)) {
+          const ESPEASY_RULES_FLOAT_TYPE value =
+            (l == 2) ? result.max[i] :
+            (l == 3) ? result.avg[i] : result.min[i];
+          writer.add(static_cast<float>(value), Cache.getTaskDeviceValueDecimals(result.taskIndex, i));
+        }
+      }
+      writer.closeArray();
+
+      if (filter.interval == 0) { break; }
+    }
+    writer.closeObject();
+    ++nrResults;
+
+    if ((nrResults % 16) == 0) {
+      delay(0);
+    }
+  }
+  writer.closeArray();
+  writer.write(F("nrresults"), nrResults);
+  writer.closeObject();
+  addHtml('\n');
+  TXBuffer.endStream();
+}
+
+// A compressed cache file starts with the header of its first block.
+static bool isCompressedCacheFile(const String& fname) {
+  fs::File file   = tryOpenFile(fname, "r");
+  uint32_t magic  = 0;
+  bool     result = false;
+
+  if (file) {
+    result = (file.read(reinterpret_cast<uint8_t *>(&magic), sizeof(magic)) == sizeof(magic)) &&
+             (magic == CONTROLLER_CACHE_BLOCK_MAGIC);
+    file.close();
+  }
+  return result;
+}
+
 void handle_cache_json() {
   if (!isLoggedIn()) { return; }
 
+  if (hasArg(F("from")) || hasArg(F("to")) || hasArg(F("task"))) {
+    handle_cache_query_json();
+    return;
+  }
+
+  # if !FEATURE_C016_COMPRESSED_CACHE
+
   // Flush any data still in RTC memory to the cache files.
+  // With compression, each flush adds a block, so only full RTC buffers are written.
+  // Samples not yet flushed can be queried using the from/to/task arguments.
   C016_flush();
+  # endif // if !FEATURE_C016_COMPRESSED_CACHE
 
   TXBuffer.startJsonStream();
-  addHtml(F("{\"columns\": ["));
+  JSON_Writer writer(true);
+  writer.openObject();
+  writer.openArray(F("columns"));
 
   //     addHtml(F("UNIX timestamp;contr. idx;sensortype;taskindex;value count"));
-  addHtml(to_json_value(F("UNIX timestamp")));
-  addHtml(',');
-  addHtml(to_json_value(F("UTC timestamp")));
-  addHtml(',');
-  addHtml(to_json_value(F("task index")));
+  writer.add(F("UNIX timestamp"));
+  writer.add(F("UTC timestamp"));
+  writer.add(F("task index"));
 
   if (hasArg(F("pluginID"))) {
-    addHtml(',');
-    addHtml(to_json_value(F("plugin ID")));
+    writer.add(F("plugin ID"));
   }
 
   for (taskIndex_t i = 0; i < TASKS_MAX; ++i) {
@@ -113,12 +262,11 @@ void handle_cache_json() {
       String label = getTaskDeviceName(i);
       label += '#';
       label += getTaskValueName(i, j);
-      addHtml(',');
-      addHtml(to_json_value(label));
+      writer.add(label);
     }
   }
-  addHtml(F("],\n"));
-  addHtml(F("\"files\": ["));
+  writer.closeArray();
+  writer.openArray(F("files"));
   bool islast    = false;
   int  filenr    = 0;
   int  fileCount = 0;
@@ -128,25 +276,25 @@ void handle_cache_json() {
     ++filenr;
 
     if (currentFile.length() > 0) {
-      if (fileCount != 0) {
-        addHtml(',');
-      }
-      addHtml(to_json_value(currentFile));
+      // Files written with compression contain blocks, which cannot be parsed as an array of samples.
+      // The format depends on the build which created the file, not on the running build.
+      writer.openObject();
+      writer.write(F("name"), currentFile);
+      writer.writeBool(F("compressed"), isCompressedCacheFile(currentFile));
+      writer.closeObject();
       ++fileCount;
     }
   }
-  addHtml(F("],\n"));
-  addHtml(F("\"pluginID\": ["));
+  writer.closeArray();
+  writer.openArray(F("pluginID"));
 
   for (taskIndex_t taskIndex = 0; validTaskIndex(taskIndex); ++taskIndex) {
-    if (taskIndex != 0) {
-      addHtml(',');
-    }
-    addHtmlInt(getPluginID_from_TaskIndex(taskIndex).value);
+    writer.add(static_cast<uint32_t>(getPluginID_from_TaskIndex(taskIndex).value));
   }
-  addHtml(F("],\n"));
-  stream_next_json_object_value(F("separator"), F(";"));
-  stream_last_json_object_value(F("nrfiles"), fileCount);
+  writer.closeArray();
+  writer.write(F("separator"), F(";"));
+  writer.write(F("nrfiles"), static_cast<int32_t>(fileCount));
+  writer.closeObject();
   addHtml('\n');
   TXBuffer.endStream();
 }
@@ -362,6 +362,10 @@ void handle_controllers_ControllerSettingsPage(controllerIndex_t controllerindex
               addControllerParameterForm(*ControllerSettings, controllerindex, ControllerSettingsStruct::CONTROLLER_ALLOW_EXPIRE);
             }
             addControllerParameterForm(*ControllerSettings, controllerindex, ControllerSettingsStruct::CONTROLLER_DEDUPLICATE);
+            addControllerParameterForm(*ControllerSettings, controllerindex, ControllerSettingsStruct::CONTROLLER_SEND_BATCH);
+            #if FEATURE_CONTROLLER_QUEUE_SPILL
+            addControllerParameterForm(*ControllerSettings, controllerindex, ControllerSettingsStruct::CONTROLLER_SPILL_TO_FLASH);
+            #endif // if FEATURE_CONTROLLER_QUEUE_SPILL
           }
 
           if (proto.usesCheckReply) {
@@ -18,6 +18,7 @@
 #include "../WebServer/HardwarePage.h"
 #include "../WebServer/I2C_Scanner.h"
 #include "../WebServer/JSON.h"
+#include "../WebServer/JSON_Writer.h"
 #include "../WebServer/LoadFromFS.h"
 #include "../WebServer/Log.h"
 #include "../WebServer/Markup.h"
@@ -581,9 +582,7 @@ void json_quote_name(const String& val) {
 }
 
 void json_quote_val(const String& val) {
-  addHtml('\"');
-  addHtml(val);
-  addHtml('\"');
+  JSON_Writer::writeString(val);
 }
 
 void json_open(bool arr) {
@@ -1,7 +1,7 @@
 #include "../WebServer/JSON.h"
 
 #include "../WebServer/ESPEasy_WebServer.h"
-#include "../WebServer/JSON.h"
+#include "../WebServer/JSON_Writer.h"
 #include "../WebServer/Markup_Forms.h"
 
 #include "../CustomBuild/CompiletimeDefines.h"
@@ -140,18 +140,19 @@ void handle_json()
   }
 
   TXBuffer.startJsonStream();
+  JSON_Writer writer(true);
 
   if (!showSpecificTask)
   {
-    addHtml('{');
+    writer.openObject();
 
     if (showSystem) {
-      addHtml(F("\"System\":{\n"));
+      writer.openObject(F("System"));
 
       if (wdcounter > 0)
       {
-        stream_next_json_object_value(LabelType::LOAD_PCT);
-        stream_next_json_object_value(LabelType::LOOP_COUNT);
+        writer.write(LabelType::LOAD_PCT);
+        writer.write(LabelType::LOOP_COUNT);
       }
 
       static const LabelType::Enum labels[] PROGMEM =
@@ -225,12 +226,12 @@ void handle_json()
         LabelType::MAX_LABEL
       };
 
-      stream_json_object_values(labels);
-      stream_comma_newline();
+      writer.write(labels);
+      writer.closeObject();
     }
 
     if (showWifi) {
-      addHtml(F("\"WiFi\":{\n"));
+      writer.openObject(F("WiFi"));
       static const LabelType::Enum labels[] PROGMEM =
       {
         LabelType::HOST_NAME,
@@ -279,16 +280,16 @@ void handle_json()
         LabelType::MAX_LABEL
       };
 
-      stream_json_object_values(labels);
+      writer.write(labels);
 
       // TODO: PKR: Add ETH Objects
-      stream_comma_newline();
+      writer.closeObject();
     }
 
     #if FEATURE_ETHERNET
 
     if (showEthernet) {
-      addHtml(F("\"Ethernet\":{\n"));
+      writer.openObject(F("Ethernet"));
       static const LabelType::Enum labels[] PROGMEM =
       {
         LabelType::ETH_WIFI_MODE,
@@ -302,49 +303,48 @@ void handle_json()
         LabelType::MAX_LABEL
       };
 
-      stream_json_object_values(labels);
-      stream_comma_newline();
+      writer.write(labels);
+      writer.closeObject();
     }
     #endif // if FEATURE_ETHERNET
 
   #if FEATURE_ESPEASY_P2P
     if (showNodes) {
-      bool comma_between = false;
+      bool nodesOpen = false;
 
       for (auto it = Nodes.begin(); it != Nodes.end(); ++it)
       {
         if (it->second.ip[0] != 0)
         {
-          if (comma_between) {
-            addHtml(',');
-          } else {
-            comma_between = true;
-            addHtml(F("\"nodes\":[\n")); // open json array if >0 nodes
+          if (!nodesOpen) {
+            nodesOpen = true;
+            writer.openArray(F("nodes")); // open json array if >0 nodes
           }
 
-          addHtml('{');
-          stream_next_json_object_value(F("nr"), it->first);
-          stream_next_json_object_value(F("name"),
-                                        (it->first != Settings.Unit) ? it->second.getNodeName() : Settings.getName());
+          writer.openObject();
+          writer.write(F("nr"), static_cast<uint32_t>(it->first));
+          writer.writeAuto(F("name"),
+                           (it->first != Settings.Unit) ? it->second.getNodeName() : Settings.getName());
 
           if (it->second.build) {
-            stream_next_json_object_value(F("build"), formatSystemBuildNr(it->second.build));
+            writer.writeAuto(F("build"), formatSystemBuildNr(it->second.build));
           }
 
           if (it->second.nodeType) {
-            stream_next_json_object_value(F("platform"), it->second.getNodeTypeDisplayString());
+            writer.write(F("platform"), it->second.getNodeTypeDisplayString());
           }
           const int8_t rssi = it->second.getRSSI();
           if (rssi < 0) {
-            stream_next_json_object_value(F("rssi"), rssi);
+            writer.write(F("rssi"), static_cast<int32_t>(rssi));
           }
-          stream_next_json_object_value(F("ip"), formatIP(it->second.IP()));
-          stream_last_json_object_value(F("age"), it->second.getAge());
+          writer.write(F("ip"), formatIP(it->second.IP()));
+          writer.write(F("age"), static_cast<uint32_t>(it->second.getAge()));
+          writer.closeObject();
         } // if node info exists
       }   // for loop
 
-      if (comma_between) {
-        addHtml(F("],\n")); // close array if >0 nodes
+      if (nodesOpen) {
+        writer.closeArray(); // close array if >0 nodes
       }
     }
   #endif
@@ -367,7 +367,7 @@ void handle_json()
   }
 
   if (!showSpecificTask) {
-    addHtml(F("\"Sensors\":[\n"));
+    writer.openArray(F("Sensors"));
   }
 
   // Keep track of the lowest reported TTL and use that as refresh interval.
@@ -381,7 +381,7 @@ void handle_json()
     {
       const unsigned long taskInterval = Settings.TaskDeviceTimer[TaskIndex];
       //LoadTaskSettings(TaskIndex);
-      addHtml('{', '\n');
+      writer.openObject();
 
       unsigned long ttl_json = 60; // Default value
 
@@ -400,11 +400,10 @@ void handle_json()
             lowest_ttl_json = ttl_json;
           }
         }
-        addHtml(F("\"TaskValues\": [\n"));
+        writer.openArray(F("TaskValues"));
 
         for (uint8_t x = 0; x < valueCount; x++)
         {
-          addHtml('{');
           const String value = formatUserVarNoCheck(TaskIndex, x);
           uint8_t nrDecimals    = Cache.getTaskDeviceValueDecimals(TaskIndex, x);
 
@@ -412,47 +411,49 @@ void handle_json()
             // Flag as not to treat as a float
             nrDecimals = 255;
           }
-          stream_next_json_object_value(F("ValueNumber"), x + 1);
-          stream_next_json_object_value(F("Name"),        Cache.getTaskDeviceValueName(TaskIndex, x));
-          stream_next_json_object_value(F("NrDecimals"),  nrDecimals);
-          stream_last_json_object_value(F("Value"), value);
-
-          if (x < (valueCount - 1)) {
-            stream_comma_newline();
-          }
+          writer.openObject();
+          writer.write(F("ValueNumber"), static_cast<uint32_t>(x + 1));
+          writer.writeAuto(F("Name"),    Cache.getTaskDeviceValueName(TaskIndex, x));
+          writer.write(F("NrDecimals"),  static_cast<uint32_t>(nrDecimals));
+          writer.writeAuto(F("Value"),   value);
+          writer.closeObject();
         }
-        addHtml(F("],\n"));
+        writer.closeArray();
       }
 
       if (showSpecificTask) {
-        stream_next_json_object_value(F("TTL"), ttl_json * 1000);
+        writer.write(F("TTL"), static_cast<uint32_t>(ttl_json * 1000));
       }
 
       if (showDataAcquisition) {
-        addHtml(F("\"DataAcquisition\": [\n"));
+        writer.openArray(F("DataAcquisition"));
 
         for (controllerIndex_t x = 0; x < CONTROLLER_MAX; x++)
         {
-          addHtml('{');
-          stream_next_json_object_value(F("Controller"), x + 1);
-          stream_next_json_object_value(F("IDX"),        Settings.TaskDeviceID[x][TaskIndex]);
-          stream_last_json_object_value(F("Enabled"), jsonBool(Settings.TaskDeviceSendData[x][TaskIndex]));
-
-          if (x < (CONTROLLER_MAX - 1)) {
-            stream_comma_newline();
-          }
+          writer.openObject();
+          writer.write(F("Controller"), static_cast<uint32_t>(x + 1));
+          writer.write(F("IDX"),        static_cast<uint32_t>(Settings.TaskDeviceID[x][TaskIndex]));
+          writer.writeBool(F("Enabled"), Settings.TaskDeviceSendData[x][TaskIndex]);
+          writer.closeObject();
         }
-        addHtml(F("],\n"));
+        writer.closeArray();
       }
 
       if (showTaskDetails) {
-        stream_next_json_object_value(F("TaskInterval"),     taskInterval);
-        stream_next_json_object_value(F("Type"),             getPluginNameFromDeviceIndex(DeviceIndex));
-        stream_next_json_object_value(F("TaskName"),         getTaskDeviceName(TaskIndex));
-        stream_next_json_object_value(F("TaskDeviceNumber"), Settings.getPluginID_for_task(TaskIndex).value);
+        writer.write(F("TaskInterval"),         static_cast<uint32_t>(taskInterval));
+        writer.writeAuto(F("Type"),             getPluginNameFromDeviceIndex(DeviceIndex));
+        writer.writeAuto(F("TaskName"),         getTaskDeviceName(TaskIndex));
+        writer.write(F("TaskDeviceNumber"),     static_cast<uint32_t>(Settings.getPluginID_for_task(TaskIndex).value));
+
+        // Flash strings as key, to prevent building the key for each pin
+        const __FlashStringHelper *pinKeys[] = {
+          F("TaskDeviceGPIO1"),
+          F("TaskDeviceGPIO2"),
+          F("TaskDeviceGPIO3")
+        };
         for(int i = 0; i < 3; i++) {
           if (Settings.TaskDevicePin[i][TaskIndex] >= 0) {
-            stream_next_json_object_value(concat(F("TaskDeviceGPIO"), i + 1) , String(Settings.TaskDevicePin[i][TaskIndex]));
+            writer.write(pinKeys[i], static_cast<int32_t>(Settings.TaskDevicePin[i][TaskIndex]));
           }
         }
 
@@ -460,47 +461,34 @@ void handle_json()
         if (Device[DeviceIndex].Type == DEVICE_TYPE_I2C && isI2CMultiplexerEnabled()) {
           int8_t channel = Settings.I2C_Multiplexer_Channel[TaskIndex];
           if (bitRead(Settings.I2C_Flags[TaskIndex], I2C_FLAGS_MUX_MULTICHANNEL)) {
-            addHtml(F("\"I2CBus\" : ["));
-            uint8_t b = 0;
+            writer.openArray(F("I2CBus"));
             for (uint8_t c = 0; c < I2CMultiplexerMaxChannels(); c++) {
               if (bitRead(channel, c)) {
-                if (b > 0) { stream_comma_newline(); }
-                b++;
-                addHtml(F("\"Multiplexer channel "));
-                addHtmlInt(c);
-                addHtml('"');
+                writer.add(concat(F("Multiplexer channel "), static_cast<int>(c)));
               }
             }
-            addHtml(F("],\n"));
+            writer.closeArray();
           } else {
             if (channel == -1){
-              stream_next_json_object_value(F("I2Cbus"),       F("Standard I2C bus"));
+              writer.write(F("I2Cbus"),       F("Standard I2C bus"));
             } else {
-              String i2cChannel = F("Multiplexer channel ");
-              i2cChannel += String(channel);
-              stream_next_json_object_value(F("I2Cbus"),       i2cChannel);
+              writer.write(F("I2Cbus"),       concat(F("Multiplexer channel "), static_cast<int>(channel)));
             }
           }
         }
         #endif // if FEATURE_I2CMULTIPLEXER
       }
-      stream_next_json_object_value(F("TaskEnabled"), 
-        // jsonBool(Settings.TaskDeviceEnabled[TaskIndex].enabled));
-        jsonBool(Settings.TaskDeviceEnabled[TaskIndex]));
-
-      stream_last_json_object_value(F("TaskNumber"), TaskIndex + 1);
-
-      if (TaskIndex != lastActiveTaskIndex) {
-        addHtml(',');
-      }
-      addHtml('\n');
+      writer.writeBool(F("TaskEnabled"), Settings.TaskDeviceEnabled[TaskIndex]);
+      writer.write(F("TaskNumber"), static_cast<uint32_t>(TaskIndex + 1));
+      writer.closeObject();
     }
   }
 
   if (!showSpecificTask) {
-    addHtml(F("],\n"));
-    stream_last_json_object_value(F("TTL"), lowest_ttl_json * 1000);
+    writer.closeArray();
+    writer.write(F("TTL"), static_cast<uint32_t>(lowest_ttl_json * 1000));
   }
+  writer.closeAll();
 
   TXBuffer.endStream();
   STOP_TIMER(HANDLE_SERVING_WEBPAGE_JSON);
@@ -513,12 +501,14 @@ void handle_json()
 #ifdef WEBSERVER_NEW_UI
 void handle_timingstats_json() {
   TXBuffer.startJsonStream();
-  json_init();
-  json_open();
+  JSON_Writer writer;
+  writer.openObject();
   # if FEATURE_TIMING_STATS
-  jsonStatistics(false);
+
+  // Stats are only cleared after being read when called with "?reset=1"
+  jsonStatistics(writer, webArg(F("reset")).toInt() != 0);
   # endif // if FEATURE_TIMING_STATS
-  json_close();
+  writer.closeObject();
   TXBuffer.endStream();
 }
 
@@ -530,31 +520,31 @@ void handle_timingstats_json() {
 void handle_nodes_list_json() {
   if (!isLoggedIn()) { return; }
   TXBuffer.startJsonStream();
-  json_init();
-  json_open(true);
+  JSON_Writer writer;
+  writer.openArray();
 
   for (auto it = Nodes.begin(); it != Nodes.end(); ++it)
   {
     if (it->second.ip[0] != 0)
     {
-      json_open();
+      writer.openObject();
       bool isThisUnit = it->first == Settings.Unit;
 
       if (isThisUnit) {
-        json_number(F("thisunit"), String(1));
+        writer.write(F("thisunit"), static_cast<uint32_t>(1));
       }
 
-      json_number(F("first"), String(it->first));
-      json_prop(F("name"), isThisUnit ? Settings.getName() : it->second.getNodeName());
+      writer.write(F("first"), static_cast<uint32_t>(it->first));
+      writer.write(F("name"), isThisUnit ? Settings.getName() : it->second.getNodeName());
 
-      if (it->second.build) { json_prop(F("build"), formatSystemBuildNr(it->second.build)); }
-      json_prop(F("type"), it->second.getNodeTypeDisplayString());
-      json_prop(F("ip"),   formatIP(it->second.ip));
-      json_number(F("age"), String(it->second.getAge() / 1000)); // time in seconds
-      json_close();
+      if (it->second.build) { writer.write(F("build"), formatSystemBuildNr(it->second.build)); }
+      writer.write(F("type"), it->second.getNodeTypeDisplayString());
+      writer.write(F("ip"),   formatIP(it->second.ip));
+      writer.write(F("age"),  static_cast<uint32_t>(it->second.getAge() / 1000)); // time in seconds
+      writer.closeObject();
     }
   }
-  json_close(true);
+  writer.closeArray();
   TXBuffer.endStream();
 }
 #endif
@@ -625,14 +615,14 @@ void stream_to_json_object_value(const __FlashStringHelper *  object, const Stri
   addHtml('\"');
   addHtml(object);
   addHtml('"', ':');
-  addHtml(to_json_value(value));
+  JSON_Writer::writeValueAuto(value);
 }
 
 void stream_to_json_object_value(const String& object, const String& value) {
   addHtml('\"');
   addHtml(object);
   addHtml('"', ':');
-  addHtml(to_json_value(value));
+  JSON_Writer::writeValueAuto(value);
 }
 
 void stream_to_json_object_value(const __FlashStringHelper *  object, int value) {
@@ -0,0 +1,352 @@
+#include "../WebServer/JSON_Writer.h"
+
+#include "../Globals/Settings.h"
+#include "../Globals/TXBuffer.h"
+
+#include "../Helpers/Numerical.h"
+#include "../Helpers/StringConverter.h"
+
+static_assert(JSON_WRITER_MAX_DEPTH <= 32, "JSON_WRITER_MAX_DEPTH must fit in the uint32_t bit fields");
+
+
+JSON_Writer::JSON_Writer(bool newlines) : _newlines(newlines) {}
+
+void JSON_Writer::openObject()
+{
+  nextElement();
+  open('{');
+}
+
+void JSON_Writer::openArray()
+{
+  nextElement();
+  open('[');
+}
+
+void JSON_Writer::openObject(const __FlashStringHelper *key)
+{
+  writeKey(key);
+  open('{');
+}
+
+void JSON_Writer::openObject(const String& key)
+{
+  writeKey(key);
+  open('{');
+}
+
+void JSON_Writer::openArray(const __FlashStringHelper *key)
+{
+  writeKey(key);
+  open('[');
+}
+
+void JSON_Writer::openArray(const String& key)
+{
+  writeKey(key);
+  open('[');
+}
+
+void JSON_Writer::closeObject()
+{
+  close('}');
+}
+
+void JSON_Writer::closeArray()
+{
+  close(']');
+}
+
+void JSON_Writer::closeAll()
+{
+  while (_depth > 0) {
+    close(bitRead(_isArray, _depth - 1) ? ']' : '}');
+  }
+}
+
+void JSON_Writer::write(const __FlashStringHelper *key, const String& value)
+{
+  writeKey(key);
+  writeString(value);
+}
+
+void JSON_Writer::write(const __FlashStringHelper *key, const __FlashStringHelper *value)
+{
+  writeKey(key);
+  TXBuffer += '"';
+  TXBuffer += value;
+  TXBuffer += '"';
+}
+
+void JSON_Writer::write(const __FlashStringHelper *key, int32_t value)
+{
+  writeKey(key);
+
+  if (value < 0) {
+    writeNumber(static_cast<uint64_t>(-static_cast<int64_t>(value)), true);
+  } else {
+    writeNumber(static_cast<uint64_t>(value), false);
+  }
+}
+
+void JSON_Writer::write(const __FlashStringHelper *key, uint32_t value)
+{
+  writeKey(key);
+  writeNumber(static_cast<uint64_t>(value), false);
+}
+
+void JSON_Writer::write(const __FlashStringHelper *key, int64_t value)
+{
+  writeKey(key);
+
+  if (value < 0) {
+    // Cast first to prevent overflow on INT64_MIN
+    writeNumber(0ull - static_cast<uint64_t>(value), true);
+  } else {
+    writeNumber(static_cast<uint64_t>(value), false);
+  }
+}
+
+void JSON_Writer::write(const __FlashStringHelper *key, uint64_t value)
+{
+  writeKey(key);
+  writeNumber(value, false);
+}
+
+void JSON_Writer::write(const __FlashStringHelper *key, float value, unsigned int nrDecimals)
+{
+  writeKey(key);
+  writeNumber(value, nrDecimals);
+}
+
+void JSON_Writer::writeBool(const __FlashStringHelper *key, bool value)
+{
+  writeKey(key);
+
+  if (Settings.JSONBoolWithoutQuotes()) {
+    TXBuffer += boolToString(value);
+  } else {
+    TXBuffer += '"';
+    TXBuffer += boolToString(value);
+    TXBuffer += '"';
+  }
+}
+
+void JSON_Writer::writeAuto(const __FlashStringHelper *key, const String& value)
+{
+  writeKey(key);
+  writeValueAuto(value);
+}
+
+void JSON_Writer::writeAuto(const String& key, const String& value)
+{
+  writeKey(key);
+  writeValueAuto(value);
+}
+
+void JSON_Writer::write(LabelType::Enum label)
+{
+  writeKey(getLabel(label));
+  writeValueAuto(getValue(label));
+}
+
+void JSON_Writer::write(const LabelType::Enum labels[])
+{
+  for (size_t i = 0;; ++i) {
+    const LabelType::Enum label = static_cast<const LabelType::Enum>(pgm_read_byte(labels + i));
+
+    if (label == LabelType::MAX_LABEL) {
+      return;
+    }
+    write(label);
+  }
+}
+
+void JSON_Writer::add(const String& value)
+{
+  nextElement();
+  writeString(value);
+}
+
+void JSON_Writer::add(const __FlashStringHelper *value)
+{
+  nextElement();
+  TXBuffer += '"';
+  TXBuffer += value;
+  TXBuffer += '"';
+}
+
+void JSON_Writer::add(int32_t value)
+{
+  nextElement();
+
+  if (value < 0) {
+    writeNumber(static_cast<uint64_t>(-static_cast<int64_t>(value)), true);
+  } else {
+    writeNumber(static_cast<uint64_t>(value), false);
+  }
+}
+
+void JSON_Writer::add(uint32_t value)
+{
+  nextElement();
+  writeNumber(static_cast<uint64_t>(value), false);
+}
+
+void JSON_Writer::add(float value, unsigned int nrDecimals)
+{
+  nextElement();
+  writeNumber(value, nrDecimals);
+}
+
+void JSON_Writer::writeString(const String& value)
+{
+  TXBuffer += '"';
+
+  const char  *str    = value.c_str();
+  const size_t length = value.length();
+
+  // Start of the characters which do not need to be escaped and are not yet written.
+  size_t start = 0;
+
+  for (size_t i = 0; i < length; ++i) {
+    const char c = str[i];
+
+    if ((c == '"') || (c == '\\') || (static_cast<uint8_t>(c) < 0x20)) {
+      TXBuffer.addBuffer(str + start, i - start);
+      start = i + 1;
+
+      TXBuffer += '\\';
+
+      switch (c) {
+        case '"':  TXBuffer += '"';  break;
+        case '\\': TXBuffer += '\\'; break;
+        case '\n': TXBuffer += 'n';  break;
+        case '\r': TXBuffer += 'r';  break;
+        case '\t': TXBuffer += 't';  break;
+        case '\b': TXBuffer += 'b';  break;
+        case '\f': TXBuffer += 'f';  break;
+        default:
+        {
+          // Other control characters
+          static const char hexChars[] PROGMEM = "0123456789abcdef";
+          TXBuffer += F("u00");
+          TXBuffer += static_cast<char>(pgm_read_byte(hexChars + ((c >> 4) & 0x0F)));
+          TXBuffer += static_cast<char>(pgm_read_byte(hexChars + (c & 0x0F)));
+          break;
+        }
+      }
+    }
+  }
+  TXBuffer.addBuffer(str + start, length - start);
+  TXBuffer += '"';
+}
+
+void JSON_Writer::writeKey(const __FlashStringHelper *key)
+{
+  nextElement();
+  TXBuffer += '"';
+  TXBuffer += key;
+  TXBuffer += '"';
+  TXBuffer += ':';
+}
+
+void JSON_Writer::writeKey(const String& key)
+{
+  nextElement();
+  writeString(key);
+  TXBuffer += ':';
+}
+
+void JSON_Writer::nextElement()
+{
+  if (_depth == 0) {
+    return;
+  }
+
+  if (bitRead(_hasElements, _depth - 1)) {
+    TXBuffer += ',';
+
+    if (_newlines) {
+      TXBuffer += '\n';
+    }
+  } else {
+    bitSet(_hasElements, _depth - 1);
+  }
+}
+
+void JSON_Writer::open(char bracket)
+{
+  TXBuffer += bracket;
+
+  if (_depth < JSON_WRITER_MAX_DEPTH) {
+    bitClear(_hasElements, _depth);
+    bitWrite(_isArray, _depth, bracket == '[');
+    ++_depth;
+  }
+}
+
+void JSON_Writer::close(char bracket)
+{
+  if (_newlines && (bracket == '}')) {
+    TXBuffer += '\n';
+  }
+  TXBuffer += bracket;
+
+  if (_depth > 0) {
+    --_depth;
+  }
+}
+
+void JSON_Writer::writeValueAuto(const String& value)
+{
+  if (mustConsiderAsJSONString(value)) {
+    writeString(value);
+  } else {
+    // Numerical or boolean value, no need to escape.
+    TXBuffer += value;
+  }
+}
+
+void JSON_Writer::writeNumber(uint64_t value, bool negative)
+{
+  // Max. 20 digits for uint64_t and the minus sign
+  char  buf[22];
+  char *pos = buf + sizeof(buf);
+
+  if (value <= UINT32_MAX) {
+    // 32-bit division is a lot faster
+    uint32_t value32 = static_cast<uint32_t>(value);
+
+    do {
+      *(--pos) = '0' + (value32 % 10);
+      value32 /= 10;
+    } while (value32 != 0);
+  } else {
+    do {
+      *(--pos) = '0' + (value % 10);
+      value   /= 10;
+    } while (value != 0);
+  }
+
+  if (negative) {
+    *(--pos) = '-';
+  }
+  TXBuffer.addBuffer(pos, (buf + sizeof(buf)) - pos);
+}
+
+void JSON_Writer::writeNumber(float value, unsigned int nrDecimals)
+{
+  if (!isValidFloat(value)) {
+    // NaN and infinity cannot be represented as a JSON number.
+    TXBuffer += F("null");
+    return;
+  }
+
+  // Max. 39 digits for a float, minus sign, dot and decimals.
+  constexpr unsigned int maxDecimals = 16;
+  char buf[64];
+
+  dtostrf(value, 0, std::min(nrDecimals, maxDecimals), buf);
+  TXBuffer.addBuffer(buf, strlen(buf));
+}
@@ -0,0 +1,120 @@
+#ifndef WEBSERVER_JSON_WRITER_H
+#define WEBSERVER_JSON_WRITER_H
+
+#include "../../ESPEasy_common.h"
+
+#include "../Helpers/StringProvider.h"
+
+#ifndef JSON_WRITER_MAX_DEPTH
+# define JSON_WRITER_MAX_DEPTH 32
+#endif // ifndef JSON_WRITER_MAX_DEPTH
+
+
+/*********************************************************************************************\
+* Streaming JSON writer, writing directly to TXBuffer.
+* Keeps track of the separators between elements, so the caller does not need to know
+* whether an element is the first or last one in an object or array.
+*
+* - String values are escaped while being written, no (quoted) copy is made.
+* - Numbers are formatted on the stack.
+* - Keys are flash strings, or taken from a PROGMEM table of LabelType::Enum.
+*   Keys given as flash string must not contain characters which need escaping.
+\*********************************************************************************************/
+class JSON_Writer {
+public:
+
+  // When newlines is set, a newline is added after each separator.
+  explicit JSON_Writer(bool newlines = false);
+
+  // Object or array as element of an array, or as root element.
+  void openObject();
+  void openArray();
+
+  // Object or array as member of an object
+  void openObject(const __FlashStringHelper *key);
+  void openObject(const String& key);
+  void openArray(const __FlashStringHelper *key);
+  void openArray(const String& key);
+
+  void closeObject();
+  void closeArray();
+
+  // Close all objects and arrays which are still open.
+  void closeAll();
+
+  // Members of an object.
+  // String values are always written as quoted string.
+  void write(const __FlashStringHelper *key,
+             const String             & value);
+  void write(const __FlashStringHelper *key,
+             const __FlashStringHelper *value);
+  void write(const __FlashStringHelper *key,
+             int32_t                    value);
+  void write(const __FlashStringHelper *key,
+             uint32_t                   value);
+  void write(const __FlashStringHelper *key,
+             int64_t                    value);
+  void write(const __FlashStringHelper *key,
+             uint64_t                   value);
+  void write(const __FlashStringHelper *key,
+             float                      value,
+             unsigned int               nrDecimals);
+  void writeBool(const __FlashStringHelper *key,
+                 bool                       value);
+
+  // Only quote the value when it is not considered a numerical or boolean value.
+  // Same logic as to_json_value()
+  void writeAuto(const __FlashStringHelper *key,
+                 const String             & value);
+  void writeAuto(const String& key,
+                 const String& value);
+
+  // Write the label with its value as given by getValue().
+  void write(LabelType::Enum label);
+
+  // Write all labels from a PROGMEM table, terminated with LabelType::MAX_LABEL
+  void write(const LabelType::Enum labels[]);
+
+  // Elements of an array.
+  void add(const String& value);
+  void add(const __FlashStringHelper *value);
+  void add(int32_t value);
+  void add(uint32_t value);
+  void add(float        value,
+           unsigned int nrDecimals);
+
+  // Write value as quoted and escaped JSON string.
+  static void writeString(const String& value);
+
+  // Write value, only quoted and escaped when not considered a numerical or boolean value.
+  static void writeValueAuto(const String& value);
+
+private:
+
+  // Write separator when needed and the key, including the ':'
+  void writeKey(const __FlashStringHelper *key);
+  void writeKey(const String& key);
+
+  // Write separator when needed for an array element.
+  void nextElement();
+
+  void open(char bracket);
+
+  void close(char bracket);
+
+  static void writeNumber(uint64_t value,
+                          bool     negative);
+
+  static void writeNumber(float        value,
+                          unsigned int nrDecimals);
+
+  // Bit per level, set when the level already contains an element.
+  uint32_t _hasElements = 0;
+
+  // Bit per level, set when the level is an array
+  uint32_t _isArray = 0;
+  uint8_t  _depth   = 0;
+  bool     _newlines;
+};
+
+#endif // ifndef WEBSERVER_JSON_WRITER_H
@@ -99,7 +99,7 @@ void handle_log_JSON() {
   if ((nrEntries > 2) && (logTimeSpan > 1)) {
     // May need to lower the TTL for refresh when time needed
     // to fill half the log is lower than current TTL
-    newOptimum = logTimeSpan * (LOG_STRUCT_MESSAGE_LINES / 2);
+    newOptimum = logTimeSpan * (Logging.getCapacityInEntries() / 2);
     newOptimum = newOptimum / (nrEntries - 1);
   }
 
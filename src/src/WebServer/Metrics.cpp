@@ -2,10 +2,22 @@
 #include "../WebServer/ESPEasy_WebServer.h"
 #include "../../ESPEasy-Globals.h"
 #include "../Commands/Diagnostic.h"
+#include "../ESPEasyCore/Controller.h"
 #include "../ESPEasyCore/ESPEasyNetwork.h"
 #include "../ESPEasyCore/ESPEasyWifi.h"
 #include "../../_Plugin_Helper.h"
+#include "../DataStructs/TimingStats.h"
+#include "../Globals/Cache.h"
+#include "../Globals/ESPEasyEthEvent.h"
+#include "../Globals/ESPEasyWiFiEvent.h"
+#include "../Globals/EventQueue.h"
+#include "../Globals/Logging.h"
+#include "../Globals/MetricsRegistry.h"
+#include "../Globals/NetworkState.h"
 #include "../Helpers/ESPEasyStatistics.h"
+#include "../Helpers/Memory.h"
+#include "../Helpers/Misc.h"
+#include "../Helpers/Networking.h"
 #include "../Static/WebStaticData.h"
 
 #ifdef WEBSERVER_METRICS
@@ -14,8 +26,148 @@
 #  include <esp_partition.h>
 # endif // ifdef ESP32
 
+# if FEATURE_METRICS_REGISTRY
+
+// Value functions for the system metrics, called when serializing.
+static double metric_uptime()          { return getUptimeMinutes(); }
+
+static double metric_load()            { return getCPUload(); }
+
+static double metric_free_ram()        { return FreeMem(); }
+
+static double metric_free_stack()      { return getCurrentFreeStack(); }
+
+static double metric_wifi_rssi()       { return WiFi.RSSI(); }
+
+static double metric_wifi_connected() {
+  #  if FEATURE_ETHERNET
+
+  if (active_network_medium == NetworkMedium_t::Ethernet) {
+    return EthEventData.lastConnectMoment.millisPassedSince();
+  }
+  #  endif // if FEATURE_ETHERNET
+  return WiFiEventData.lastConnectMoment.millisPassedSince();
+}
+
+static double metric_wifi_reconnects() { return WiFiEventData.wifi_reconnects; }
+
+#  if defined(CORE_POST_2_5_0)
+static double metric_heap_fragmentation() { return ESP.getHeapFragmentation(); }
+
+#  elif defined(ESP32)
+static double metric_heap_fragmentation() {
+  const uint32_t freeHeap = ESP.getFreeHeap();
+
+  if (freeHeap == 0) { return 0; }
+  return 100.0 - (100.0 * ESP.getMaxAllocHeap()) / freeHeap;
+}
+
+#  endif // if defined(CORE_POST_2_5_0)
+
+static double metric_log_dropped()     { return Logging.getNrDropped(); }
+
+static double metric_events_dropped()  { return eventQueue.getNrDropped(); }
+
+static double metric_task_settings_cache_hits()   { return Cache.extraTaskSettingsLRU.getHits(); }
+
+static double metric_task_settings_cache_misses() { return Cache.extraTaskSettingsLRU.getMisses(); }
+
+#  if FEATURE_ESPEASY_P2P
+static double metric_udp_received() { return getUDPReceiveStats().received; }
+
+static double metric_udp_dropped()  { return getUDPReceiveStats().dropped; }
+
+static double metric_udp_oversize() { return getUDPReceiveStats().oversize; }
+
+static double metric_udp_deferred() { return getUDPReceiveStats().deferred; }
+
+#  endif // if FEATURE_ESPEASY_P2P
+
+#  if FEATURE_MQTT
+static double metric_mqtt_queue_string_allocations()    { return getMQTTQueueStats().stringPayload.allocations; }
+
+static double metric_mqtt_queue_taskvalue_allocations() { return getMQTTQueueStats().taskValue.allocations; }
+
+static double metric_mqtt_queue_string_bytes()          { return getMQTTQueueStats().stringPayload.bytes; }
+
+static double metric_mqtt_queue_taskvalue_bytes()       { return getMQTTQueueStats().taskValue.bytes; }
+
+static double metric_mqtt_send_allocations()            { return getMQTTQueueStats().sendAllocations; }
+
+#  endif // if FEATURE_MQTT
+
+// Register the system metrics on the first request, so they don't use memory when never requested.
+static void register_system_metrics() {
+  static bool registered = false;
+
+  if (registered) { return; }
+  registered = true;
+
+  Metrics.addCounter(F("uptime"),          F("current device uptime in minutes"),             metric_uptime);
+  Metrics.addGauge(F("load"),              F("device percentage load"),                       metric_load);
+  Metrics.addGauge(F("free_ram"),          F("device amount of RAM free in Bytes"),           metric_free_ram);
+  Metrics.addGauge(F("free_stack"),        F("device amount of Stack free in Bytes"),         metric_free_stack);
+  Metrics.addGauge(F("wifi_rssi"),         F("Wifi connection Strength"),                     metric_wifi_rssi);
+  Metrics.addCounter(F("wifi_connected"),  F("Time wifi has been connected in milliseconds"), metric_wifi_connected);
+  Metrics.addCounter(F("wifi_reconnects"), F("Number of times Wifi has reconnected since boot"), metric_wifi_reconnects);
+  #  if defined(CORE_POST_2_5_0) || defined(ESP32)
+  Metrics.addGauge(F("heap_fragmentation"), F("Heap fragmentation in percent"), metric_heap_fragmentation);
+  #  endif // if defined(CORE_POST_2_5_0) || defined(ESP32)
+  Metrics.addCounter(F("log_dropped"),
+                     F("Number of log lines dropped before they could be read"),
+                     metric_log_dropped);
+  Metrics.addCounter(F("events_dropped"),
+                     F("Number of rules events dropped because the event queue was full"),
+                     metric_events_dropped);
+  {
+    // Both series must use the same name pointer to form a single family.
+    const __FlashStringHelper *name = F("task_settings_cache");
+    const __FlashStringHelper *help = F("Number of LoadTaskSettings calls served from RAM (hit) or flash (miss)");
+    Metrics.addCounter(name, help, metric_task_settings_cache_hits,   F("result"), F("hit"));
+    Metrics.addCounter(name, help, metric_task_settings_cache_misses, F("result"), F("miss"));
+  }
+  #  if FEATURE_ESPEASY_P2P
+  {
+    // Received is the total of all packets, so it is not part of the labelled family.
+    Metrics.addCounter(F("p2p_udp_packets_received"),
+                       F("Number of packets received on the ESPEasy p2p UDP port"),
+                       metric_udp_received);
+
+    const __FlashStringHelper *name = F("p2p_udp_packets");
+    const __FlashStringHelper *help = F("Number of received packets on the ESPEasy p2p UDP port which were not handled right away");
+    Metrics.addCounter(name, help, metric_udp_dropped,  F("result"), F("dropped"));
+    Metrics.addCounter(name, help, metric_udp_oversize, F("result"), F("oversize"));
+    Metrics.addCounter(name, help, metric_udp_deferred, F("result"), F("deferred"));
+  }
+  #  endif // if FEATURE_ESPEASY_P2P
+  #  if FEATURE_MQTT
+  {
+    const __FlashStringHelper *name = F("mqtt_queue_allocations");
+    const __FlashStringHelper *help = F("Number of heap allocations for queued MQTT messages, by type of payload");
+    Metrics.addCounter(name, help, metric_mqtt_queue_string_allocations,    F("payload"), F("string"));
+    Metrics.addCounter(name, help, metric_mqtt_queue_taskvalue_allocations, F("payload"), F("taskvalue"));
+  }
+  {
+    const __FlashStringHelper *name = F("mqtt_queue_bytes");
+    const __FlashStringHelper *help = F("Number of bytes allocated for queued MQTT messages, by type of payload");
+    Metrics.addCounter(name, help, metric_mqtt_queue_string_bytes,    F("payload"), F("string"));
+    Metrics.addCounter(name, help, metric_mqtt_queue_taskvalue_bytes, F("payload"), F("taskvalue"));
+  }
+  Metrics.addCounter(F("mqtt_send_allocations"),
+                     F("Number of heap allocations for MQTT topics formatted when sent"),
+                     metric_mqtt_send_allocations);
+  #  endif // if FEATURE_MQTT
+}
+
+# endif // if FEATURE_METRICS_REGISTRY
+
 void handle_metrics() {
   TXBuffer.startStream(F("text/plain"), F("*"));
+
+  # if FEATURE_METRICS_REGISTRY
+  register_system_metrics();
+  Metrics.serialize();
+  # else // if FEATURE_METRICS_REGISTRY
   const __FlashStringHelper *prefixHELP = F("# HELP espeasy_");
   const __FlashStringHelper *prefixTYPE = F("# TYPE espeasy_");
 
@@ -81,6 +233,11 @@ void handle_metrics() {
   addHtml(F("espeasy_wifi_reconnects "));
   addHtml(getValue(LabelType::NUMBER_RECONNECTS));
   addHtml('\n');
+  # endif // if FEATURE_METRICS_REGISTRY
+
+  # if FEATURE_TIMING_STATS
+  handle_metrics_timing_stats();
+  # endif // if FEATURE_TIMING_STATS
 
   // devices
   handle_metrics_devices();
@@ -88,6 +245,58 @@ void handle_metrics() {
   TXBuffer.endStream();
 }
 
+# if FEATURE_TIMING_STATS
+void handle_metrics_timing_stats() {
+  if (!Settings.EnableTimingStats() || miscStats.empty()) {
+    return;
+  }
+
+  // Serialized from the collected timing stats, to not keep a copy in the metrics registry.
+  const __FlashStringHelper *names[] = {
+    F("timing_count"),
+    F("timing_avg_usec"),
+    F("timing_max_usec")
+  };
+  const __FlashStringHelper *help[] = {
+    F("Number of calls since the timing stats were reset"),
+    F("Average duration in usec since the timing stats were reset"),
+    F("Maximum duration in usec since the timing stats were reset")
+  };
+
+  for (uint8_t i = 0; i < (sizeof(names) / sizeof(names[0])); ++i) {
+    addHtml(F("# HELP espeasy_"));
+    addHtml(names[i]);
+    addHtml(' ');
+    addHtml(help[i]);
+    addHtml(F("\n# TYPE espeasy_"));
+    addHtml(names[i]);
+    addHtml(F(" gauge\n"));
+
+    for (auto it = miscStats.begin(); it != miscStats.end(); ++it) {
+      if (it->second.isEmpty()) {
+        continue;
+      }
+      uint64_t minVal, maxVal;
+      const uint32_t count = it->second.getMinMax(minVal, maxVal);
+
+      addHtml(F("espeasy_"));
+      addHtml(names[i]);
+      addHtml(F("{name=\""));
+      addHtml(getMiscStatsName(it->first));
+      addHtml(F("\"} "));
+
+      switch (i) {
+        case 0: addHtmlInt(count); break;
+        case 1: addHtmlFloat(it->second.getAvg(), 3); break;
+        default: addHtmlInt(maxVal); break;
+      }
+      addHtml('\n');
+    }
+  }
+}
+
+# endif // if FEATURE_TIMING_STATS
+
 void handle_metrics_devices() {
   for (taskIndex_t x = 0; validTaskIndex(x); x++) {
     const deviceIndex_t DeviceIndex = getDeviceIndex_from_TaskIndex(x);
@@ -8,6 +8,10 @@
 void handle_metrics();
 void handle_metrics_devices();
 
+# if FEATURE_TIMING_STATS
+void handle_metrics_timing_stats();
+# endif // if FEATURE_TIMING_STATS
+
 #endif    // ifdef WEBSERVER_METRICS
 
 #endif
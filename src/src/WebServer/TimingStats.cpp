@@ -9,11 +9,13 @@
 
 #include "../DataTypes/ESPEasy_plugin_functions.h"
 
+#include "../Globals/Cache.h"
 #include "../Globals/ESPEasy_time.h"
 #include "../Globals/RamTracker.h"
 
 #include "../Globals/Device.h"
 
+#include "../Helpers/StringConverter.h"
 #include "../Helpers/_Plugin_init.h"
 
 
@@ -36,8 +38,14 @@ void handle_timingstats() {
   html_table_header(F("min (ms)"));
   html_table_header(F("Avg (ms)"));
   html_table_header(F("max (ms)"));
+  html_table_header(F("p50 (ms)"));
+  html_table_header(F("p99 (ms)"));
+  html_table_header(F("Distribution"));
 
-  const long timeSinceLastReset = stream_timing_statistics(true);
+  // Stats are cleared after being shown, unless called with "?reset=0"
+  const bool clearStats = !hasArg(F("reset")) || (webArg(F("reset")).toInt() != 0);
+
+  const long timeSinceLastReset = stream_timing_statistics(clearStats);
   html_end_table();
 
   html_table_class_normal();
@@ -50,6 +58,13 @@ void handle_timingstats() {
   addRowLabel(F("Time span"));
   addHtmlFloat(timespan);
   addHtml(F(" sec"));
+  addRowLabel(F("Task Settings Cache"));
+  addHtml(strformat(
+            F("%u hits, %u misses, %u/%u cached"),
+            static_cast<unsigned int>(Cache.extraTaskSettingsLRU.getHits()),
+            static_cast<unsigned int>(Cache.extraTaskSettingsLRU.getMisses()),
+            Cache.extraTaskSettingsLRU.size(),
+            ExtraTaskSettingsLRU::maxSize()));
   addRowLabel(F("*"));
   addHtml(F("Duty cycle based on average < 1 msec is highly unreliable"));
   html_end_table();
@@ -103,6 +118,28 @@ void stream_html_timing_stats(const TimingStats& stats, long timeSinceLastReset)
   format_using_threshhold(avg);
   html_TD();
   format_using_threshhold(maxVal);
+  html_TD();
+  format_using_threshhold(stats.getPercentile(50));
+  html_TD();
+  format_using_threshhold(stats.getPercentile(99));
+  html_TD();
+
+  // Only show the non-empty histogram buckets
+  bool first = true;
+
+  for (uint8_t bucket = 0; bucket < TIMING_STATS_NR_BUCKETS; ++bucket) {
+    const uint32_t bucketCount = stats.getBucketCount(bucket);
+
+    if (bucketCount != 0) {
+      if (!first) {
+        addHtml(F("<BR>"));
+      }
+      first = false;
+      addHtml(TimingStats::getBucketLabel(bucket));
+      addHtml(':', ' ');
+      addHtmlInt(bucketCount);
+    }
+  }
 }
 
 long stream_timing_statistics(bool clearStats) {
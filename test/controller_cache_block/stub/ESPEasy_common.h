@@ -0,0 +1,54 @@
+// Minimal host replacement of ESPEasy_common.h, only what ESPEasyControllerCache_block needs.
+#ifndef ESPEASY_COMMON_H
+#define ESPEASY_COMMON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define FEATURE_C016_COMPRESSED_CACHE 1
+#define TASKS_MAX                     32
+#define VARS_PER_TASK                 4
+#define NR_ELEMENTS(ARR) (sizeof(ARR) / sizeof *(ARR))
+
+typedef uint8_t taskIndex_t;
+#define INVALID_TASK_INDEX 255
+
+inline bool validTaskIndex(taskIndex_t taskIndex) {
+  return taskIndex < TASKS_MAX;
+}
+
+struct pluginID_t {
+  static pluginID_t toPluginID(unsigned other) {
+    pluginID_t res;
+
+    res.value = other;
+    return res;
+  }
+
+  bool operator==(const pluginID_t& other) const {
+    return value == other.value;
+  }
+
+  uint8_t value = 0;
+};
+
+static const pluginID_t INVALID_PLUGIN_ID{};
+
+enum class Sensor_VType : uint8_t {
+  SENSOR_TYPE_NONE   = 0,
+  SENSOR_TYPE_SINGLE = 1,
+  SENSOR_TYPE_QUAD   = 4
+};
+
+struct TaskValues_Data_t {
+  union {
+    uint8_t  binary[VARS_PER_TASK * sizeof(float)];
+    float    floats[VARS_PER_TASK];
+    uint32_t uint32s[VARS_PER_TASK];
+  };
+};
+
+inline void delay(unsigned long) {}
+
+#endif // ifndef ESPEASY_COMMON_H
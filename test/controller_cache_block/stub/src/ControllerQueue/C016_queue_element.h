@@ -0,0 +1,17 @@
+// Host replacement of C016_queue_element.h, with the same layout of C016_binary_element.
+// unixTime is uint32_t, as unsigned long is 32 bit on the ESP.
+#ifndef CONTROLLERQUEUE_C016_QUEUE_ELEMENT_H
+#define CONTROLLERQUEUE_C016_QUEUE_ELEMENT_H
+
+#include "../../ESPEasy_common.h"
+
+struct C016_binary_element {
+  TaskValues_Data_t values{};
+  uint32_t          unixTime{};
+  taskIndex_t       TaskIndex{ INVALID_TASK_INDEX };
+  pluginID_t        pluginID{ INVALID_PLUGIN_ID };
+  Sensor_VType      sensorType{ Sensor_VType::SENSOR_TYPE_NONE };
+  uint8_t           valueCount{};
+};
+
+#endif // ifndef CONTROLLERQUEUE_C016_QUEUE_ELEMENT_H
@@ -0,0 +1,138 @@
+// Round-trip check of ESPEasyControllerCache_block: encode samples into a block and decode them again.
+// Build and run on the host using: make -C test/controller_cache_block
+
+#include "src/src/DataStructs/ESPEasyControllerCache_block.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+static_assert(sizeof(C016_binary_element) == 24, "Must match the size of C016_binary_element on the ESP");
+
+static int nrFailed = 0;
+
+static void check(bool condition, const char *what, int iteration)
+{
+  if (!condition) {
+    printf("FAIL: %s (iteration %d)\n", what, iteration);
+    ++nrFailed;
+  }
+}
+
+// Samples of a few tasks with slowly changing values, sampled at a fixed interval.
+// Some iterations use random tasks, random timestamps or random bit patterns as values.
+static std::vector<C016_binary_element> createSamples(std::mt19937& rng, int iteration)
+{
+  const int nrSamples = 1 + rng() % 32;
+  std::vector<C016_binary_element> samples(nrSamples);
+  uint32_t    unixTime = 1700000000 + rng() % 1000;
+  const float base[3]  = { 20.5f, 55.0f, 1013.2f };
+
+  for (int i = 0; i < nrSamples; ++i) {
+    C016_binary_element& sample = samples[i];
+    taskIndex_t taskIndex       = (iteration % 5 == 0) ? rng() % TASKS_MAX : i % 3;
+
+    if ((iteration % 97 == 0) && (i == 3)) {
+      taskIndex = INVALID_TASK_INDEX;
+    }
+    sample.TaskIndex      = taskIndex;
+    sample.pluginID.value = taskIndex + 1;
+    sample.sensorType     = (taskIndex % 2) ? Sensor_VType::SENSOR_TYPE_QUAD : Sensor_VType::SENSOR_TYPE_SINGLE;
+    sample.valueCount     = taskIndex % VARS_PER_TASK + 1;
+
+    if (iteration % 7 == 0) {
+      unixTime += rng();
+    } else if (i % 3 == 0) {
+      unixTime += (iteration % 11 == 0) ? 60 + static_cast<int>(rng() % 5) - 2 : 60;
+    }
+    sample.unixTime = unixTime;
+
+    for (int v = 0; v < VARS_PER_TASK; ++v) {
+      if (iteration % 13 == 0) {
+        sample.values.uint32s[v] = rng();
+      } else {
+        sample.values.floats[v] = base[taskIndex % 3] + v + std::round((rng() % 5) * 10.0f) / 100.0f;
+      }
+    }
+  }
+  return samples;
+}
+
+int main()
+{
+  std::mt19937 rng(1);
+  size_t rawSize        = 0;
+  size_t compressedSize = 0;
+
+  for (int iteration = 0; iteration < 2000; ++iteration) {
+    const std::vector<C016_binary_element> samples = createSamples(rng, iteration);
+    const uint16_t nrSamples                       = samples.size();
+    std::vector<uint8_t> block;
+
+    if (!ESPEasyControllerCache_block::encode(reinterpret_cast<const uint8_t *>(samples.data()), nrSamples, block)) {
+      check(false, "encode", iteration);
+      continue;
+    }
+    ESPEasyControllerCache_block_header header;
+
+    check(block.size() >= sizeof(header), "block size", iteration);
+    memcpy(&header, block.data(), sizeof(header));
+    check(header.isValid(),                                      "header valid",        iteration);
+    check(header.nrSamples == nrSamples,                         "header nrSamples",    iteration);
+    check(sizeof(header) + header.payloadSize == block.size(),   "header payloadSize",  iteration);
+
+    uint32_t startTime  = UINT32_MAX;
+    uint32_t endTime    = 0;
+    uint32_t taskBitmap = 0;
+
+    for (const C016_binary_element& sample : samples) {
+      startTime = std::min(startTime, static_cast<uint32_t>(sample.unixTime));
+      endTime   = std::max(endTime, static_cast<uint32_t>(sample.unixTime));
+
+      if (validTaskIndex(sample.TaskIndex)) {
+        taskBitmap |= 1u << sample.TaskIndex;
+      }
+    }
+    check(header.startTime == startTime,   "header startTime",  iteration);
+    check(header.endTime == endTime,       "header endTime",    iteration);
+    check(header.taskBitmap == taskBitmap, "header taskBitmap", iteration);
+
+    std::vector<C016_binary_element> decoded;
+
+    if (!ESPEasyControllerCache_block::decode(header, block.data() + sizeof(header), decoded)) {
+      check(false, "decode", iteration);
+      continue;
+    }
+    check(decoded.size() == samples.size(), "nr decoded samples", iteration);
+
+    for (size_t i = 0; i < samples.size() && i < decoded.size(); ++i) {
+      if (memcmp(&decoded[i], &samples[i], sizeof(C016_binary_element)) != 0) {
+        check(false, "decoded sample differs", iteration);
+        break;
+      }
+    }
+
+    // A block which is cut short must be rejected.
+    if (header.payloadSize > 1) {
+      ESPEasyControllerCache_block_header truncated = header;
+      truncated.payloadSize = header.payloadSize / 2;
+      check(!ESPEasyControllerCache_block::decode(truncated, block.data() + sizeof(header), decoded), "decode truncated", iteration);
+    }
+
+    // Only count the typical samples: few tasks with slowly changing values at a fixed interval.
+    if ((iteration % 5) && (iteration % 7) && (iteration % 13)) {
+      rawSize        += samples.size() * sizeof(C016_binary_element);
+      compressedSize += block.size();
+    }
+  }
+
+  printf("Compression ratio of typical samples: %.2f\n", static_cast<double>(rawSize) / compressedSize);
+
+  if (nrFailed != 0) {
+    printf("%d checks failed\n", nrFailed);
+    return 1;
+  }
+  printf("All checks passed\n");
+  return 0;
+}